@@ -1,6 +1,8 @@
 #pragma once
 
 #include <stdexcept>
+#include <string>
+#include <vector>
 #include "Common/Position.h"
 
 namespace CXX {
@@ -24,6 +26,13 @@ namespace CXX {
 		void generate_message(const std::string& error_name, const std::string& details);
 	};
 
+	// 错误已经由ErrorReporter输出，只需中止执行，不再输出
+	class ReportedError : public std::exception
+	{
+	public:
+		const char* what() const noexcept override { return "error reported"; }
+	};
+
 	class ErrorReporter
 	{
 	public:
@@ -31,8 +40,17 @@ namespace CXX {
 		static void reset();
 		static int count();
 
+		// 后台线程中产生的错误先暂存到messages，由主线程在需要时按原顺序输出
+		// messages为nullptr时恢复直接输出
+		static void capture(std::vector<std::string>* messages);
+		static void replay(const std::vector<std::string>& messages);
+
 	public:
-		static int errorCount;
+		// 每个线程单独计数，后台解析模块时不影响主线程
+		static thread_local int errorCount;
+
+	private:
+		static thread_local std::vector<std::string>* captured;
 	};
 
 }
\ No newline at end of file
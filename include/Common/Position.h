@@ -1,35 +1,37 @@
 #pragma once
 
-#include <string_view>
-#include <string>
+#include <cstdint>
+#include "Common/SourceFile.h"
 
 namespace CXX {
 
-    // Track line number, column number and current index
-    // also the FileName, and FileContent
+    // 源码位置，仅记录在全局源码表(SourceFile)中的偏移
+    // 文件名、行号、列号只在报错时才由偏移计算
     class Position
     {
 
     public:
-        Position(int idx = -1, int line = 0, int col = -1, const std::string& filename = "", const std::string& ftx = "");
+        Position() = default;
 
-        Position(const Position& other);
+        explicit Position(uint32_t offset) : offset(offset) {}
 
-        void advance(char current_char = '\0');
+        void advance() { offset++; }
+
+        bool valid() const { return offset != 0; }
+
+        const SourceFile& file() const;
+
+        // 在所属文件中的下标，无效位置为-1
+        int index() const;
+
+        int row() const;
+
+        int column() const;
 
         static const Position preset;
 
     public:
-        int index;
-        int row;
-        int column;
-#ifdef USE_STRING_VIEW
-        std::string_view fileName;
-        std::string_view fileContent;
-#else
-        std::string fileName;
-        std::string fileContent;
-#endif
+        uint32_t offset{ 0 };
     };
 
-}
\ No newline at end of file
+}
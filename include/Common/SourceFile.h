@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace CXX {
+
+    // 全局源码表：每份源码只保存一份，Position只需记录一个32位的偏移
+    // 所有源码依次排布在同一个偏移空间中，第一份从1开始，0表示无效位置
+    // 每份源码额外占用一个偏移，用于表示文件末尾(EOF)
+    // 源码表只增不减，注册后的内容在整个进程中始终有效
+    class SourceFile
+    {
+    public:
+        SourceFile(std::string name, std::string content, uint32_t base);
+
+        // 注册一份源码，内容移入源码表
+        static const SourceFile& add(std::string name, std::string content);
+
+        // 查找offset所在的源码，offset无效时返回一份空源码
+        static const SourceFile& find(uint32_t offset);
+
+        const std::string& name() const { return m_name; }
+
+        const std::string& content() const { return m_content; }
+
+        uint32_t base() const { return m_base; }
+
+        // 由文件内的下标计算行号与列号(均从0开始)，行首表在首次报错时才建立
+        int row(size_t index) const;
+
+        int column(size_t index) const;
+
+    private:
+        std::string m_name;
+        std::string m_content;
+        uint32_t m_base;
+
+        mutable std::vector<size_t> lineStarts;
+
+        size_t lineOf(size_t index) const;
+    };
+
+}
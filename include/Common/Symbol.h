@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <optional>
+
+namespace CXX {
+
+	// 驻留字符串(interned string)
+	// 内容相同的字符串在全局符号表中只存一份，Symbol仅保存其地址
+	// 因此比较与哈希都只需要处理一个指针，适合作为变量名、属性名等的键
+	// 符号表只增不减，Symbol在整个进程中始终有效
+	class Symbol
+	{
+	public:
+		Symbol() : ptr(&empty()) {}
+
+		// 运行时产生的字符串须显式驻留，避免无意中扩大符号表
+		explicit Symbol(const std::string& str) : ptr(&intern(str)) {}
+
+		Symbol(const char* str) : ptr(&intern(str)) {}
+
+		explicit Symbol(std::string_view str) : ptr(&intern(str)) {}
+
+		const std::string& str() const { return *ptr; }
+
+		const char* c_str() const { return ptr->c_str(); }
+
+		bool operator==(const Symbol& rhs) const { return ptr == rhs.ptr; }
+
+		bool operator!=(const Symbol& rhs) const { return ptr != rhs.ptr; }
+
+		size_t hash() const { return std::hash<const void*>()(ptr); }
+
+		// 只查找已驻留的字符串，不存在时返回std::nullopt，不会加入符号表
+		// 以运行时字符串读取属性时使用：没有驻留过的名字不可能是任何属性
+		static std::optional<Symbol> find(std::string_view str);
+
+		// 在其他线程中使用Symbol之前调用，此后驻留时加锁
+		// 单线程运行时不必承担加锁的开销
+		static void shareAcrossThreads();
+
+	private:
+		explicit Symbol(const std::string* interned) : ptr(interned) {}
+
+		static const std::string& intern(std::string_view str);
+
+		static const std::string& empty();
+
+		const std::string* ptr;
+	};
+
+}
+
+template <>
+struct std::hash<CXX::Symbol>
+{
+	size_t operator()(const CXX::Symbol& symbol) const noexcept
+	{
+		return symbol.hash();
+	}
+};
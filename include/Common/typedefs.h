@@ -6,9 +6,12 @@ namespace CXX {
 	class Expr;
 	class Stmt;
 	class Context;
+	class AstArena;
 
-	using ExprPtr = std::shared_ptr<Expr>;
-	using StmtPtr = std::shared_ptr<Stmt>;
+	// AST节点由所属编译单元的AstArena持有
+	using ExprPtr = Expr*;
+	using StmtPtr = Stmt*;
+	using AstArenaPtr = std::shared_ptr<AstArena>;
 	using ContextPtr = std::shared_ptr<Context>;
 
 }
\ No newline at end of file
@@ -12,6 +12,8 @@ namespace CXX {
 
     class Interpreter;
 
+    class GarbageCollector;
+
     class Callable
     {
     public:
@@ -21,6 +23,15 @@ namespace CXX {
             CLASS
         };
 
+        // 字节码虚拟机中的函数可以直接压入调用帧，不必经过call()
+        // 虚拟机据此分派，避免在调用路径上使用dynamic_cast
+        enum class VMKind
+        {
+            NONE,
+            CLOSURE,
+            BOUND_METHOD
+        };
+
         Callable(CallableType type = CallableType::FUNCTION) : type(type) {}
 
         virtual ~Callable() = default;
@@ -33,12 +44,20 @@ namespace CXX {
 
         virtual std::shared_ptr<Callable> bindThis(std::shared_ptr<Instance> instance) = 0;
 
+        // 以receiver为this调用成员函数
+        // 默认先bindThis再call，类成员函数可以重写以省去绑定产生的中间对象
+        virtual Object invoke(Interpreter& interpreter, const std::shared_ptr<Instance>& receiver, const std::vector<Object>& arguments);
+
         virtual std::string to_string() = 0;
 
         virtual std::string name() = 0;
 
+        // 向回收器报告持有的强引用(闭包环境、默认参数值等)
+        virtual void trace(GarbageCollector& gc) const {}
+
     public:
         CallableType type;
+        VMKind vmKind{ VMKind::NONE };
     };
 
 }
\ No newline at end of file
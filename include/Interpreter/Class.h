@@ -6,6 +6,8 @@
 #include <unordered_set>
 #include "Interpreter/Object.h"
 #include "Interpreter/Callable.h"
+#include "Interpreter/GarbageCollector.h"
+#include "Interpreter/Shape.h"
 
 namespace CXX {
 
@@ -16,7 +18,7 @@ namespace CXX {
 	class Class : public Callable, public std::enable_shared_from_this<Class>
 	{
 	public:
-		explicit Class(std::string name, std::unordered_map<std::string, CallablePtr> methods,
+		explicit Class(std::string name, std::unordered_map<Symbol, CallablePtr> methods,
 			std::optional<std::shared_ptr<Class>> superclass = std::nullopt, bool isNative = false);
 
 		~Class() = default;
@@ -33,42 +35,80 @@ namespace CXX {
 
 		std::string name() override;
 
-		CallablePtr findMethods(const std::string& name);
+		CallablePtr findMethods(Symbol name);
 
-		static std::unordered_set<std::string> reservedMethods;
+		void trace(GarbageCollector& gc) const override;
+
+		static std::unordered_set<Symbol> reservedMethods;
 
 	public:
 		std::string className;
-		std::unordered_map<std::string, CallablePtr> methods;
+		std::unordered_map<Symbol, CallablePtr> methods;
 		std::optional<std::shared_ptr<Class>> superClass;
 		bool isNative;
 	};
 
 	class Token;
 
-	class Instance : public std::enable_shared_from_this<Instance>
+	class Instance : public Collectable, public std::enable_shared_from_this<Instance>
 	{
 	public:
 		explicit Instance(std::shared_ptr<Class> ClassPtr);
 
-		~Instance();
+		~Instance() override;
 
 		Object get(const Token& identifier);
 
-		Object get(const std::string& identifier);
+		Object get(Symbol identifier);
 
 		void set(const Token& identifier, const Object& val);
 
-		void set(const std::string& identifier, const Object& val);
+		void set(Symbol identifier, const Object& val);
+
+		// 以运行时字符串读取属性，名字不会被驻留
+		Object getAttr(const std::string& name);
+
+		// 带内联缓存的属性读写，cache来自属性访问的AST节点
+		Object get(Symbol name, InlineCache& cache);
+
+		void set(Symbol name, const Object& val, InlineCache& cache);
+
+		// 查找成员函数并绑定到该实例，不存在时返回Nil
+		Object getMethod(Symbol name);
+
+		// 字段所在的槽位，不存在时返回nullptr
+		Object* field(Symbol name)
+		{
+			int offset = shape->lookup(name);
+			return offset < 0 ? nullptr : &values[offset];
+		}
+
+		Object* field(Symbol name, InlineCache& cache);
+
+		// 直接设定字段，不做内部类的检查
+		void setField(Symbol name, const Object& val);
+
+		// 按Shape转移并追加新字段的值，调用者需保证next由当前shape添加一个字段得到
+		void appendField(ShapePtr next, const Object& val)
+		{
+			shape = std::move(next);
+			values.push_back(val);
+		}
 
 		std::string to_string();
 
+		void trace(GarbageCollector& gc) const override;
+
+		void clear(std::vector<Object>& trash) override;
+
 	public:
 		std::shared_ptr<Class> belonging;
 
 		// 这里将存储该实例包含的字段，即类数据成员
 		// 不同于属性(property)，因为属性既包含类成员函数，也包含类数据成员
-		std::unordered_map<std::string, Object> fields;
+		// 字段名到槽位的映射由shape记录，values按槽位存放字段值
+		ShapePtr shape;
+		std::vector<Object> values;
 	};
 
 }
\ No newline at end of file
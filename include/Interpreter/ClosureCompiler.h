@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include "Common/typedefs.h"
+#include "Interpreter/Object.h"
+#include "Interpreter/Specialize.h"
+
+namespace CXX {
+
+	class Interpreter;
+	class FuncDeclarationStmt;
+	class BinaryExpr;
+
+	// 表达式与语句编译后的形式
+	using Evaluator = std::function<Object(Interpreter&)>;
+	using Executor = std::function<void(Interpreter&)>;
+
+	// 函数体编译一次，由同一声明创建的所有函数对象共享
+	using CompiledBody = std::shared_ptr<const std::vector<Executor>>;
+
+	// 闭包编译：把Resolver处理过的AST一次性转换为预先绑定好的C++闭包树
+	// 运算符、变量的查找方式、调用的形式等都在编译时确定，子节点直接以闭包的形式被捕获
+	// 运行时不再经过accept/visit的双重分派，也不再对节点类型做判断
+	// 运行时状态(环境、控制流信号、调用栈)仍由Interpreter维护，行为与报错位置同AST解释执行完全一致
+	class ClosureCompiler
+	{
+	public:
+		static Evaluator compile(ExprPtr expr);
+
+		static Executor compile(StmtPtr stmt);
+
+		static CompiledBody compile(const std::vector<StmtPtr>& statements);
+
+		// 逐条编译并执行顶层语句
+		static void run(Interpreter& interpreter, const std::vector<StmtPtr>& statements);
+
+		// 执行编译后的语句序列，遇到break、continue、return时停止
+		static void execute(Interpreter& interpreter, const std::vector<Executor>& body);
+
+	private:
+		static Evaluator compileBinary(ExprPtr expr);
+
+		// 两侧静态推断为数字，直接取出double计算
+		static Evaluator compileNumberBinary(BinaryExpr* binary, Evaluator left, Evaluator right, NumberOp numberOp);
+
+		// 两侧静态推断为字符串，不支持的运算符返回空
+		static Evaluator compileStringBinary(BinaryExpr* binary, Evaluator left, Evaluator right);
+
+		static Evaluator compileVariable(ExprPtr expr);
+
+		static Evaluator compileAssignment(ExprPtr expr);
+
+		static Evaluator compileCall(ExprPtr expr);
+
+		static Evaluator compileInvoke(ExprPtr expr);
+
+		static Evaluator compileRetrieve(ExprPtr expr);
+
+		static Evaluator compileSet(ExprPtr expr);
+
+		// ++与--，delta为1或-1
+		static Evaluator compileStep(ExprPtr expr, ExprPtr holder, bool postfix, double delta);
+
+		static Executor compileFunction(StmtPtr stmt);
+
+		// 预解析的函数体推迟到首次执行时再编译
+		static CompiledBody compileBody(FuncDeclarationStmt* declaration);
+
+		static Executor compileClass(StmtPtr stmt);
+
+		static Executor compileFor(StmtPtr stmt);
+
+		static std::vector<Evaluator> compileAll(const std::vector<ExprPtr>& exprs);
+
+		static std::vector<Object> evaluateAll(Interpreter& interpreter, const std::vector<Evaluator>& evaluators);
+	};
+
+}
@@ -1,13 +1,14 @@
 #pragma once
 #include <string>
+#include "Interpreter/GarbageCollector.h"
 
 namespace CXX {
 
-	class Container
+	class Container : public Collectable
 	{
 	public:
 		Container(const char* name) :type(name) {}
-		virtual ~Container() = default;
+		~Container() override = default;
 		virtual std::string to_string() = 0;
 
 	public:
@@ -2,49 +2,61 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include <unordered_map>
 #include "Common/typedefs.h"
+#include "Common/Symbol.h"
 #include "Interpreter/Object.h"
+#include "Interpreter/GarbageCollector.h"
 
 namespace CXX {
 
 	class Token;
 
-	class Context
+	// 局部变量按Resolver分配的槽位存放在slots中，访问时无需哈希
+	// 全局、模块顶层以及内置环境的变量仍以名字存放在variables中
+	class Context : public Collectable
 	{
 	public:
-		explicit Context(ContextPtr parent = nullptr);
+		explicit Context(ContextPtr parent = nullptr, size_t size = 0);
 
-		~Context();
+		~Context() override;
 
 		void set(const Token& identifier, const Object& val);
 
-		void set(const std::string& key, const Object& val);
-
-		void change(const Token& identifier, const Object& val);
-
-		void changeAt(const Token& identifier, const Object& val, int distance);
+		void set(Symbol key, const Object& val);
 
 		Object& get(const Token& identifier);
 
-		Object& get(const std::string& identifier);
+		Object& get(Symbol identifier);
 
-		Object& getAt(const Token& identifier, int distance);
+		// 获取距离当前环境distance层的环境中，指定槽位的局部变量
+		Object& getAt(int distance, int slot);
 
-		Object& getAt(const std::string& identifier, int distance);
+		// 获取距离当前环境distance层的环境中，以名字存放的变量（不向上查找）
+		Object& getAt(int distance, const Token& identifier);
 
 		Context* ancestor(int distance);
 
+		void trace(GarbageCollector& gc) const override;
+
+		void clear(std::vector<Object>& trash) override;
+
 	public:
 		ContextPtr parent;
-		std::unordered_map<std::string, Object> variables;
+
+		// 大小在创建时确定，运行中不会重新分配，因此可以保存元素的引用
+		std::vector<Object> slots;
+
+		std::unordered_map<Symbol, Object> variables;
 	};
 
 	// 对于{}包括起来的代码，其拥有独立的(Scoped)变量环境
+	// 离开作用域后环境可能仍被闭包持有，由GarbageCollector负责回收引用环
 	class ScopedContext
 	{
 	public:
-		ScopedContext(ContextPtr& origin, ContextPtr newContext, bool shouldClear = true);
+		ScopedContext(ContextPtr& origin, ContextPtr newContext);
 
 		~ScopedContext();
 
@@ -54,8 +66,6 @@ namespace CXX {
 
 		// copy一份原本的Context内容
 		ContextPtr previous_copy;
-
-		bool shouldClear;
 	};
 
 }
\ No newline at end of file
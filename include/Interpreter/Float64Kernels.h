@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+namespace CXX {
+
+	// Float64Array使用的数值内核
+	// x86-64上按CPU支持的指令集选择AVX或SSE2实现，其他平台使用标量实现
+	// 向量化的求和、点积改变了累加顺序，结果可能与逐个相加有最后几位的差别
+	namespace kernels {
+
+		double sum(const double* data, size_t n);
+
+		// n必须大于0
+		double min(const double* data, size_t n);
+
+		double max(const double* data, size_t n);
+
+		double dot(const double* x, const double* y, size_t n);
+
+		// x *= a
+		void scale(double* x, double a, size_t n);
+
+		// y += a * x
+		void axpy(double* y, double a, const double* x, size_t n);
+
+		// x += y
+		void add(double* x, const double* y, size_t n);
+
+		// x *= y
+		void mul(double* x, const double* y, size_t n);
+
+		// 原地求前缀和，x[i] = x[0] + ... + x[i]
+		void prefixSum(double* x, size_t n);
+
+		// 当前使用的实现："avx"、"sse2"或"scalar"
+		const char* isa();
+
+	}
+
+}
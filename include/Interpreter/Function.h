@@ -5,6 +5,7 @@
 #include "Interpreter/Callable.h"
 #include "Interpreter/Object.h"
 #include "Interpreter/Context.h"
+#include "Interpreter/ClosureCompiler.h"
 
 namespace CXX {
 
@@ -15,12 +16,15 @@ namespace CXX {
 	class Function : public Callable
 	{
 	public:
-		Function(Object& belonging, std::shared_ptr<FuncDeclarationStmt> funcDeclarationStmt, ContextPtr env);
+		Function(Object& belonging, FuncDeclarationStmt* funcDeclarationStmt, ContextPtr env);
 
-		explicit Function(Object& belonging, std::shared_ptr<FuncDeclarationStmt> body, const std::vector<Object>& default_values, ContextPtr env);
+		explicit Function(Object& belonging, FuncDeclarationStmt* body, const std::vector<Object>& default_values, ContextPtr env,
+			InstancePtr receiver);
 
 		Object call(Interpreter& interpreter, const std::vector<Object>& arguments) override;
 
+		Object invoke(Interpreter& interpreter, const InstancePtr& receiver, const std::vector<Object>& arguments) override;
+
 		int arity() override;
 
 		size_t required_params() override;
@@ -32,12 +36,17 @@ namespace CXX {
 		// 将"this"绑定到类成员函数中
 		CallablePtr bindThis(InstancePtr instance) override;
 
+		void trace(GarbageCollector& gc) const override;
+
 	public:
 		// 记录函数属于哪个类，如果不是类成员函数，则给Nil
 		// 这将方便我们判断super指向的是哪个类(应为定义时所处类的父类)
 		Object& belonging;
 
-		std::shared_ptr<FuncDeclarationStmt> funcBody;
+		FuncDeclarationStmt* funcBody;
+
+		// funcBody所在的AST，函数存活期间须保持有效
+		AstArenaPtr arena;
 
 		// 默认值不需要每次call时都计算一次
 		// 构造Function时我们就将其存储起来
@@ -47,14 +56,24 @@ namespace CXX {
 		// 一旦函数内调用了"自由变量"，就需要保存闭包
 		ContextPtr closure;
 
+		// bindThis得到的函数所绑定的实例，调用时放入this的槽位
+		InstancePtr receiver;
+
+		// 闭包编译后的函数体，为空时按AST解释执行
+		CompiledBody compiled;
+
 	private:
+		Object execute(Interpreter& interpreter, const InstancePtr& self, const std::vector<Object>& arguments);
+
 		void init_default_values();
 	};
 
 	class LambdaFunction : public Callable
 	{
 	public:
-		LambdaFunction(std::shared_ptr<LambdaExpr> lambdaExpr, ContextPtr env);
+		LambdaFunction(LambdaExpr* lambdaExpr, ContextPtr env);
+
+		LambdaFunction(LambdaExpr* lambdaExpr, const std::vector<Object>& default_values, ContextPtr env);
 
 		Object call(Interpreter& interpreter, const std::vector<Object>& arguments) override;
 
@@ -69,8 +88,13 @@ namespace CXX {
 		// 将"this"绑定到类成员函数中
 		CallablePtr bindThis(InstancePtr instance) override;
 
+		void trace(GarbageCollector& gc) const override;
+
 	public:
-		std::shared_ptr<LambdaExpr> funcBody;
+		LambdaExpr* funcBody;
+
+		// funcBody所在的AST，函数存活期间须保持有效
+		AstArenaPtr arena;
 
 		// 默认值不需要每次call时都计算一次
 		// 构造Function时我们就将其存储起来
@@ -78,9 +102,11 @@ namespace CXX {
 
 		// 闭包，当前函数定义时所位于的外部环境
 		// 一旦函数内调用了"自由变量"，就需要保存闭包
-		// TODO: Context和Function循环引用，内存泄漏
 		ContextPtr closure;
 
+		// 闭包编译后的函数体，为空时按AST解释执行
+		CompiledBody compiled;
+
 	private:
 		void init_default_values();
 	};
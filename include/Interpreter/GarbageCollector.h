@@ -0,0 +1,133 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <type_traits>
+#include <unordered_map>
+#include "Interpreter/Object.h"
+#include "Interpreter/Callable.h"
+
+namespace CXX {
+
+	class GarbageCollector;
+
+	// 可变的、可能构成引用环的对象：Context、Instance、Container、Upvalue
+	// 构造时加入回收器的侵入式链表，析构时移除
+	class Collectable
+	{
+	public:
+		Collectable();
+
+		Collectable(const Collectable&) = delete;
+
+		Collectable& operator=(const Collectable&) = delete;
+
+		virtual ~Collectable();
+
+		// 将自身持有的强引用逐一报告给回收器
+		virtual void trace(GarbageCollector& gc) const = 0;
+
+		// 打破引用环：把持有的值移入trash，由回收器统一释放
+		virtual void clear(std::vector<Object>& trash) = 0;
+
+	private:
+		friend class GarbageCollector;
+
+		Collectable* gcPrev{ nullptr };
+		Collectable* gcNext{ nullptr };
+	};
+
+	// 引用计数之上的环回收器(mark-sweep)
+	// 对象的生命周期仍由shared_ptr与Object的引用计数管理，回收器只负责找出不可达的引用环并打破它们：
+	// 1. 从所有Collectable出发遍历引用图，统计每个对象来自图内部的引用数
+	// 2. 引用总数多于内部引用数的对象被图外持有(解释器的环境链、模块表、虚拟机的栈、C++中的临时值等)，作为根
+	// 3. 从根出发标记，不可达的对象即为垃圾，清空其中的Collectable后交由引用计数释放
+	class GarbageCollector
+	{
+	public:
+		static void collect();
+
+		// 存活的Collectable个数比上次回收后翻倍时回收
+		// 不成环的对象由引用计数及时释放，不会触发回收
+		static void maybeCollect()
+		{
+			if (tracked >= threshold)
+				collect();
+		}
+
+		// 析构实例时会执行__del__，此时不能回收
+		class Pause
+		{
+		public:
+			Pause() { paused++; }
+
+			~Pause() { paused--; }
+		};
+
+		void mark(const Object& value);
+
+		template <typename T>
+		void mark(const std::shared_ptr<T>& ptr);
+
+	private:
+		struct Node
+		{
+			long refs{ -1 }; // 强引用总数，-1表示没有被图内的引用指向过
+			long internal{ 0 };
+			bool reachable{ false };
+
+			const Collectable* collectable{ nullptr };
+			const Callable* callable{ nullptr };
+			const Object* cell{ nullptr };
+
+			std::weak_ptr<void> handle; // 用于在清理期间保活
+			std::vector<Node*> children;
+		};
+
+		static constexpr size_t MIN_THRESHOLD = 10000;
+
+		static Collectable*& head();
+
+		static void track(Collectable* object);
+
+		static void untrack(Collectable* object);
+
+		void edge(const void* key, long refs, const Collectable* collectable, const Callable* callable, const Object* cell,
+			std::weak_ptr<void> handle);
+
+		void scan();
+
+		void sweep();
+
+	private:
+		friend class Collectable;
+
+		static size_t tracked;
+		static size_t threshold;
+		static int paused;
+
+		std::unordered_map<const void*, Node> nodes;
+		std::vector<Node*> worklist;
+		Node* current{ nullptr };
+	};
+
+	template <typename T>
+	void GarbageCollector::mark(const std::shared_ptr<T>& ptr)
+	{
+		if (!ptr)
+			return;
+
+		if constexpr (std::is_base_of_v<Collectable, T>)
+		{
+			const Collectable* object = ptr.get();
+			edge(object, ptr.use_count(), object, nullptr, nullptr, ptr);
+		}
+		else
+		{
+			static_assert(std::is_base_of_v<Callable, T>, "Untraceable object type");
+			const Callable* object = ptr.get();
+			edge(object, ptr.use_count(), nullptr, object, nullptr, ptr);
+		}
+	}
+
+}
@@ -12,13 +12,14 @@ namespace CXX {
 
 	class Interpreter : public ExprVisitor, public StmtVisitor
 	{
+		// 闭包编译后的代码直接使用解释器的运行时状态与辅助函数
+		friend class ClosureCompiler;
+
 	public:
 		Interpreter();
 
 		void interpret(const std::vector<StmtPtr>& statements);
 
-		void interpret(std::vector<StmtPtr>&& statements);
-
 		Object interpret(Expr* expr);
 
 		void execute(Stmt* pStmt);
@@ -27,12 +28,19 @@ namespace CXX {
 
 		std::unique_ptr<Finally> toggleRepl();
 
+		// 读取并解析模块文件，出错时返回nullptr(错误已报告)
+		// 字节码虚拟机导入模块时同样使用，AST所在的arena通过arena返回
+		static BlockStmt* parseModule(const Token& filepath, AstArenaPtr& arena);
+
+		// 解析已读入的模块源码，ModuleLoader在工作线程中同样使用
+		static BlockStmt* parseModuleSource(const std::string& path, std::string content, AstArenaPtr& arena);
+
 	public:
 		void visit(const ExpressionStmt* expressionStmt) override;
 
 		void visit(const VarDeclarationStmt* varStmt) override;
 
-		void visit(std::shared_ptr<FuncDeclarationStmt> funcDeclStmt) override;
+		void visit(FuncDeclarationStmt* funcDeclStmt) override;
 
 		void visit(const ClassDeclarationStmt* classDeclStmt) override;
 
@@ -66,7 +74,7 @@ namespace CXX {
 
 		Object visit(const TernaryExpr* ternaryExpr) override;
 
-		Object visit(std::shared_ptr<LambdaExpr> lambdaExpr) override;
+		Object visit(LambdaExpr* lambdaExpr) override;
 
 		Object visit(const OrExpr* orExpr) override;
 
@@ -95,9 +103,20 @@ namespace CXX {
 		ContextPtr globalContext; // 此处用来存储全局变量
 		ContextPtr context;		  // 指向运行时的"当前环境"
 
-		// 记录代码执行过程中的返回值
-		// TEST：我没有发现返回值栈大小超过1的情况，因此改用optional
-		std::optional<Object> m_returns;
+		// 语句执行后的控制流信号，由块、循环、函数逐层检查并处理
+		// break、continue与return都不再借助异常传播
+		enum class Completion
+		{
+			NORMAL,
+			BREAK,
+			CONTINUE,
+			RETURN
+		};
+
+		Completion completion{ Completion::NORMAL };
+
+		// completion为RETURN时的返回值
+		Object m_returns;
 
 		// filepath : module
 		std::unordered_map<std::string, std::shared_ptr<Module>> m_modules;
@@ -109,7 +128,27 @@ namespace CXX {
 	private:
 		void loadPresetEnvironment();
 
-		Object& lookupVariable(const Token& identifier, int depth);
+		Object& lookupVariable(const Token& identifier, int depth, int slot);
+
+		// 在当前环境中定义变量，slot为-1时以名字存放
+		Object& define(const Token& identifier, int slot, const Object& value);
+
+		// 循环体执行完毕后处理completion，返回true表示应退出循环
+		bool loopExit();
+
+		// obj.method(args)：以obj为接收者直接调用成员函数，不创建绑定this的函数对象
+		Object invoke(const CallExpr* callExpr);
+
+		// 对实参求值、检查个数后调用，receiver非空时经由invoke调用
+		// receiver是实例或列表，列表的成员函数均为NativeMethod
+		Object call(const CallExpr* callExpr, const CallablePtr& callable, const Object* receiver);
+
+		// 以已求值的实参调用
+		Object apply(const CallExpr* callExpr, const CallablePtr& callable, const Object* receiver,
+			const std::vector<Object>& args);
+
+		// ++/--作用于数字变量时的特化路径，守卫失败时返回false并退化为通用路径
+		bool stepNumber(Expr* holder, Specialization& specialization, double delta, Object& prev, Object& result);
 
 		Object handleAssign(const Object& lhs, const Object& rhs, TokenType op);
 
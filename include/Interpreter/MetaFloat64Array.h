@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include "Interpreter/Container.h"
+
+namespace CXX {
+
+    class Object;
+
+    // 实际处理时使用内部类Float64Array(instance)
+    // 连续存放的double，批量运算交给Float64Kernels中的向量化实现
+    class MetaFloat64Array : public Container
+    {
+    public:
+        explicit MetaFloat64Array(size_t length);
+        explicit MetaFloat64Array(std::vector<double> data);
+        ~MetaFloat64Array() = default;
+
+        // get/set
+        double& at(int index);
+
+        // 原地运算，other的长度必须相同
+        void scale(double factor);
+        void axpy(double factor, const MetaFloat64Array& other);
+        void add(const MetaFloat64Array& other);
+        void mul(const MetaFloat64Array& other);
+        void prefixSum();
+
+        // reduce，min/max在数组为空时返回nil
+        double sum() const;
+        Object min() const;
+        Object max() const;
+        double dot(const MetaFloat64Array& other) const;
+
+        // util
+        std::shared_ptr<MetaFloat64Array> copy() const;
+        Object toList() const;
+
+        // properties
+        size_t length() const;
+        std::string to_string();
+
+        // gc
+        // 只存放数字，不引用其他对象
+        void trace(GarbageCollector& gc) const override {}
+        void clear(std::vector<Object>& trash) override {}
+
+    private:
+        std::vector<double> data;
+
+    private:
+        void assertBound(int& index) const;
+        void assertSameLength(const MetaFloat64Array& other, const char* name) const;
+    };
+
+    using MetaFloat64ArrayPtr = std::shared_ptr<MetaFloat64Array>;
+
+    bool isMetaFloat64Array(const Object& obj);
+
+    MetaFloat64ArrayPtr getMetaFloat64Array(const Object& obj);
+
+}
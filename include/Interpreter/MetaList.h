@@ -9,7 +9,8 @@ namespace CXX {
     class Object;
     class Callable;
 
-    // 实际处理时使用内部类List(instance)
+    // 列表值(ObjectType::LIST)直接持有MetaList，成员函数由内部类List提供
+    // 元素存放在items[head, items.size())，头部预留空位，首尾的插入删除(包括交替进行时)均为均摊O(1)
     class MetaList :public Container
     {
         friend bool operator==(const MetaList& lhs, const MetaList& rhs);
@@ -20,6 +21,7 @@ namespace CXX {
         // get/set
         void append(const Object& val);
         Object pop();
+        Object shift();
         void remove(const Object& val);
         void unshift(const Object& val);
         Object& at(int index);
@@ -36,11 +38,17 @@ namespace CXX {
         size_t length();
         std::string to_string();
 
+        // gc
+        void trace(GarbageCollector& gc) const override;
+        void clear(std::vector<Object>& trash) override;
+
     private:
         std::vector<Object> items;
+        size_t head{ 0 }; // 第一个元素的位置，之前的空位均为nil
 
     private:
         void assertBound(int& index);
+        void reset();
     };
 
     using MetaListPtr = std::shared_ptr<MetaList>;
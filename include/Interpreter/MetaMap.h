@@ -0,0 +1,81 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "Interpreter/Container.h"
+#include "Interpreter/Object.h"
+
+namespace CXX {
+
+    // 实际处理时使用内部类Map(instance)
+    // 开放寻址(线性探测)的哈希表，键的比较与Object::operator==一致
+    // entries按插入顺序存放键值对，index只存放entries的下标，遍历时保持插入顺序
+    class MetaMap : public Container
+    {
+    public:
+        MetaMap();
+        ~MetaMap() = default;
+
+        // get/set
+        // 不存在时返回nullptr，返回的指针在下一次修改前有效
+        Object* find(const Object& key);
+        // 不存在时插入nil并返回其引用
+        Object& at(const Object& key);
+        void set(const Object& key, const Object& value);
+        bool remove(const Object& key);
+
+        // util
+        Object keys();
+        Object values();
+
+        // properties
+        size_t size();
+        std::string to_string();
+
+        // gc
+        void trace(GarbageCollector& gc) const override;
+        void clear(std::vector<Object>& trash) override;
+
+    protected:
+        // 供MetaSet使用
+        explicit MetaMap(const char* type);
+
+        struct Entry
+        {
+            Object key;
+            Object value;
+            size_t hash;
+            bool removed;
+        };
+
+        static constexpr int32_t EMPTY = -1;
+        static constexpr int32_t DELETED = -2;
+
+        std::vector<Entry> entries;
+        std::vector<int32_t> index; // 容量为2的幂
+        size_t count{ 0 };          // 有效的键值对数
+        size_t used{ 0 };           // 不为EMPTY的槽位数，包括DELETED
+        size_t version{ 0 };        // 每次结构变化时增加
+
+    protected:
+        // 返回key所在的槽位，不存在时返回-1
+        long lookup(const Object& key, size_t hash);
+        // 调用者需保证key不存在
+        Entry& insert(const Object& key, size_t hash);
+
+    private:
+        void rehash(size_t capacity);
+    };
+
+    using MetaMapPtr = std::shared_ptr<MetaMap>;
+
+    // 与Object::operator==一致的哈希：相等的Object哈希值一定相同
+    // 实例优先使用__hash__，只定义了__equal__的实例按所属的类哈希
+    size_t hashObject(const Object& obj);
+
+    bool isMetaMap(const Object& obj);
+
+    MetaMapPtr getMetaMap(const Object& obj);
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include "Interpreter/MetaMap.h"
+
+namespace CXX {
+
+    class MetaSet;
+    using MetaSetPtr = std::shared_ptr<MetaSet>;
+
+    // 实际处理时使用内部类Set(instance)
+    // 复用MetaMap的哈希表，值总为nil，元素保持插入顺序
+    class MetaSet : public MetaMap
+    {
+    public:
+        MetaSet();
+        explicit MetaSet(const std::vector<Object>& items);
+        ~MetaSet() = default;
+
+        // get/set
+        void add(const Object& val);
+        bool has(const Object& val);
+
+        // 集合运算，结果为新的集合，已算好的哈希值直接复用
+        MetaSetPtr unite(MetaSet& other);
+        MetaSetPtr intersect(MetaSet& other);
+        MetaSetPtr subtract(MetaSet& other);
+
+        // properties
+        std::string to_string() override;
+
+    private:
+        // 把entries[position]加入result，position处的元素可能已被删除
+        void copyEntry(size_t position, MetaSet& result);
+    };
+
+    bool isMetaSet(const Object& obj);
+
+    MetaSetPtr getMetaSet(const Object& obj);
+
+}
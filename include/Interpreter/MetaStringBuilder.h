@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <memory>
+#include "Interpreter/Container.h"
+
+namespace CXX {
+
+    class Object;
+
+    // 实际处理时使用内部类StringBuilder(instance)
+    // 追加写入同一块缓冲区，避免s = s + piece每次复制整个字符串
+    class MetaStringBuilder : public Container
+    {
+    public:
+        explicit MetaStringBuilder(size_t capacity = 0);
+        ~MetaStringBuilder() = default;
+
+        // 字符串和String实例写入其内容，其他对象按print的格式写入
+        void append(const Object& obj);
+        void append(const std::string& str);
+
+        // properties
+        size_t length() const;
+        const std::string& str() const;
+        std::string to_string();
+
+        // gc
+        // 只存放字符，不引用其他对象
+        void trace(GarbageCollector& gc) const override {}
+        void clear(std::vector<Object>& trash) override {}
+
+    private:
+        std::string buffer;
+    };
+
+    using MetaStringBuilderPtr = std::shared_ptr<MetaStringBuilder>;
+
+    bool isMetaStringBuilder(const Object& obj);
+
+    MetaStringBuilderPtr getMetaStringBuilder(const Object& obj);
+
+}
@@ -2,21 +2,26 @@
 #include <unordered_map>
 #include <string>
 #include "Interpreter/Object.h"
+#include "Common/Symbol.h"
+#include "Common/typedefs.h"
 
 namespace CXX {
 
 	class Module
 	{
 	public:
-		Module(std::unordered_map<std::string, Object> values);
+		Module(std::unordered_map<Symbol, Object> values, AstArenaPtr arena = nullptr);
 		~Module();
 
-		Object& get(const std::string& name);
+		Object& get(Symbol name);
 
-		void set(const std::string& name, const Object& obj);
+		void set(Symbol name, const Object& obj);
 
 	public:
-		std::unordered_map<std::string, Object> m_values;
+		std::unordered_map<Symbol, Object> m_values;
+
+		// 模块的AST，与模块同生命周期
+		AstArenaPtr m_arena;
 	};
 
 }
\ No newline at end of file
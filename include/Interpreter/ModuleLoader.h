@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+#include "Common/typedefs.h"
+
+namespace CXX {
+
+	class BlockStmt;
+
+	// 导入图的并行预处理
+	// 脚本解析完成后，从顶层的import出发递归找出所有可达的模块，在线程池中并发完成它们的前端处理(读取、词法、语法、Resolver)
+	// 模块仍在执行到import时才按原来的顺序运行，预处理期间产生的错误也推迟到那时才按原顺序输出
+	class ModuleLoader
+	{
+	public:
+		struct Result
+		{
+			BlockStmt* block{ nullptr }; // 出错时为nullptr
+			AstArenaPtr arena;
+			std::vector<std::string> errors;
+		};
+
+		// 把statements中顶层import的模块提交到线程池，已提交过的路径不再重复提交
+		static void prefetch(const std::vector<StmtPtr>& statements);
+
+		// 等待并取出path的预处理结果
+		// 未提交过、已被取出或无法读取的模块返回std::nullopt，由调用者同步解析
+		static std::optional<Result> take(const std::string& path);
+
+	private:
+		// 在工作线程中执行，模块本身的顶层import随后继续提交
+		static std::optional<Result> load(const std::string& path);
+	};
+
+}
@@ -2,8 +2,12 @@
 
 #include <memory>
 #include <string>
-#include <variant>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <variant> // std::bad_variant_access
 #include <optional>
+#include "Common/Symbol.h"
 
 namespace CXX {
 
@@ -17,7 +21,8 @@ namespace CXX {
 		STRING,
 		CALLABLE,
 		INSTANCE,
-		CONTAINER
+		CONTAINER,
+		LIST // 列表直接存放MetaList，不经过List实例
 	};
 
 	const char* ObjectTypeName(ObjectType type);
@@ -25,10 +30,12 @@ namespace CXX {
 	class Callable;
 	class Instance;
 	class Container;
+	class MetaList;
 
 	using CallablePtr = std::shared_ptr<Callable>;
 	using InstancePtr = std::shared_ptr<Instance>;
 	using ContainerPtr = std::shared_ptr<Container>;
+	using MetaListPtr = std::shared_ptr<MetaList>;
 
 	class Object
 	{
@@ -69,6 +76,11 @@ namespace CXX {
 
 		explicit Object(const std::string& str);
 
+		explicit Object(std::string&& str);
+
+		// 驻留的字符串常量，同一个Symbol总是返回共享同一个Cell的Object
+		explicit Object(Symbol symbol);
+
 		explicit Object(bool boolean);
 
 		explicit Object(CallablePtr callable);
@@ -77,6 +89,8 @@ namespace CXX {
 
 		explicit Object(ContainerPtr list);
 
+		explicit Object(MetaListPtr list);
+
 		static Object& Nil();
 
 		[[nodiscard]] bool isNumber() const;
@@ -93,27 +107,254 @@ namespace CXX {
 
 		[[nodiscard]] bool isContainer() const;
 
+		[[nodiscard]] bool isList() const;
+
 		[[nodiscard]] double getNumber() const;
 
 		[[nodiscard]] bool getBoolean() const;
 
-		[[nodiscard]] std::string getString() const;
+		// 不检查类型，仅用于已经确认类型的快速路径(特化节点、VM的数值运算)
+		[[nodiscard]] double asNumber() const;
+
+		[[nodiscard]] bool asBoolean() const;
 
-		[[nodiscard]] CallablePtr getCallable() const;
+		[[nodiscard]] const std::string& getString() const;
 
-		[[nodiscard]] InstancePtr getInstance() const;
+		[[nodiscard]] const CallablePtr& getCallable() const;
 
-		[[nodiscard]] ContainerPtr getContainer() const;
+		[[nodiscard]] const InstancePtr& getInstance() const;
+
+		[[nodiscard]] const ContainerPtr& getContainer() const;
+
+		[[nodiscard]] const MetaListPtr& getList() const;
 
 		[[nodiscard]] std::string to_string() const;
 
 		[[nodiscard]] bool is_true() const;
 
+		[[nodiscard]] ObjectType type() const;
+
 	public:
-		ObjectType type = ObjectType::NIL;
+		Object(const Object& rhs);
+
+		Object(Object&& rhs) noexcept;
+
+		Object& operator=(const Object& rhs);
+
+		Object& operator=(Object&& rhs) noexcept;
+
+		~Object();
 
 	private:
-		std::variant<bool, double, std::string, CallablePtr, InstancePtr, ContainerPtr> value;
+		friend class GarbageCollector;
+
+		// 字符串、函数、实例、容器存放在堆上，以非原子的引用计数管理
+		struct Cell
+		{
+			size_t refCount;
+			ObjectType type;
+			bool interned; // 驻留的字符串，内容相同则必为同一个Cell；永不释放，不参与引用计数
+		};
+
+		template <typename T>
+		struct Boxed : Cell
+		{
+			T value;
+		};
+
+		template <typename T>
+		static uint64_t box(ObjectType type, T&& value);
+
+		template <typename T>
+		[[nodiscard]] const T& unbox(ObjectType expected) const;
+
+		[[nodiscard]] bool isHeap() const;
+
+		[[nodiscard]] Cell* cell() const;
+
+		void retain() const;
+
+		void release();
+
+		static void destroy(Cell* cell);
+
+	private:
+		// NaN-boxing：
+		// 非NaN的double按原样存放，运算产生的NaN统一为CANONICAL_NAN
+		// nil与bool存放在静默NaN的低位
+		// 堆指针存放在符号位与静默NaN同时置位时的低48位
+		static constexpr uint64_t SIGN_BIT = 0x8000000000000000;
+		static constexpr uint64_t QNAN = 0x7ffc000000000000;
+		static constexpr uint64_t CANONICAL_NAN = 0x7ff8000000000000;
+		static constexpr uint64_t TAG_NIL = QNAN | 1;
+		static constexpr uint64_t TAG_FALSE = QNAN | 2;
+		static constexpr uint64_t TAG_TRUE = QNAN | 3;
+		static constexpr uint64_t TAG_POINTER = SIGN_BIT | QNAN;
+
+		uint64_t bits;
 	};
 
-}
\ No newline at end of file
+	static_assert(sizeof(Object) == 8, "Object should be a single NaN-boxed word");
+
+	// 以下为频繁调用的简单成员，定义在头文件中以便内联
+
+	template <typename T>
+	inline uint64_t Object::box(ObjectType type, T&& value)
+	{
+		using Value = std::decay_t<T>;
+		Cell* cell = new Boxed<Value>{ { 1, type, false }, std::forward<T>(value) };
+		return reinterpret_cast<uintptr_t>(cell) | TAG_POINTER;
+	}
+
+	template <typename T>
+	inline const T& Object::unbox(ObjectType expected) const
+	{
+		// 与原先std::get的行为保持一致，类型不符时抛出异常而不是访问非法内存
+		if (!isHeap() || cell()->type != expected)
+			throw std::bad_variant_access();
+
+		return static_cast<Boxed<T>*>(cell())->value;
+	}
+
+	inline bool Object::isHeap() const { return (bits & TAG_POINTER) == TAG_POINTER; }
+
+	inline Object::Cell* Object::cell() const { return reinterpret_cast<Cell*>(bits & ~TAG_POINTER); }
+
+	// 驻留的字符串可能同时被多个线程复制(见ModuleLoader)，不修改其引用计数
+	inline void Object::retain() const
+	{
+		if (isHeap() && !cell()->interned)
+			cell()->refCount++;
+	}
+
+	inline void Object::release()
+	{
+		if (isHeap() && !cell()->interned && --cell()->refCount == 0)
+			destroy(cell());
+	}
+
+	inline Object::Object() : bits(TAG_NIL) {}
+
+	inline Object::Object(double number)
+	{
+		if (number != number)
+			bits = CANONICAL_NAN;
+		else
+			std::memcpy(&bits, &number, sizeof(double));
+	}
+
+	inline Object::Object(const std::string& str) : bits(box(ObjectType::STRING, str)) {}
+
+	inline Object::Object(std::string&& str) : bits(box(ObjectType::STRING, std::move(str))) {}
+
+	inline Object::Object(bool boolean) : bits(boolean ? TAG_TRUE : TAG_FALSE) {}
+
+	inline Object::Object(CallablePtr callable) : bits(box(ObjectType::CALLABLE, std::move(callable))) {}
+
+	inline Object::Object(InstancePtr instance) : bits(box(ObjectType::INSTANCE, std::move(instance))) {}
+
+	inline Object::Object(ContainerPtr list) : bits(box(ObjectType::CONTAINER, std::move(list))) {}
+
+	inline Object::Object(MetaListPtr list) : bits(box(ObjectType::LIST, std::move(list))) {}
+
+	inline Object::Object(const Object& rhs) : bits(rhs.bits) { retain(); }
+
+	inline Object::Object(Object&& rhs) noexcept : bits(rhs.bits) { rhs.bits = TAG_NIL; }
+
+	inline Object& Object::operator=(const Object& rhs)
+	{
+		// 先增加rhs的计数，自赋值或rhs被当前值间接持有时也是安全的
+		rhs.retain();
+		release();
+		bits = rhs.bits;
+		return *this;
+	}
+
+	inline Object& Object::operator=(Object&& rhs) noexcept
+	{
+		uint64_t moved = rhs.bits;
+		rhs.bits = TAG_NIL;
+		release();
+		bits = moved;
+		return *this;
+	}
+
+	inline Object::~Object() { release(); }
+
+	inline bool Object::isNumber() const { return (bits & QNAN) != QNAN; }
+
+	inline bool Object::isBoolean() const { return (bits | 1) == TAG_TRUE; }
+
+	inline bool Object::isString() const { return isHeap() && cell()->type == ObjectType::STRING; }
+
+	inline bool Object::isCallable() const { return isHeap() && cell()->type == ObjectType::CALLABLE; }
+
+	inline bool Object::isNil() const { return bits == TAG_NIL; }
+
+	inline bool Object::isInstance() const { return isHeap() && cell()->type == ObjectType::INSTANCE; }
+
+	inline bool Object::isContainer() const { return isHeap() && cell()->type == ObjectType::CONTAINER; }
+
+	inline bool Object::isList() const { return isHeap() && cell()->type == ObjectType::LIST; }
+
+	inline ObjectType Object::type() const
+	{
+		if (isNumber())
+			return ObjectType::NUMBER;
+		if (isHeap())
+			return cell()->type;
+
+		return bits == TAG_NIL ? ObjectType::NIL : ObjectType::BOOL;
+	}
+
+	inline double Object::getNumber() const
+	{
+		// 与unbox一致，类型不符时抛出异常
+		if (!isNumber())
+			throw std::bad_variant_access();
+
+		return asNumber();
+	}
+
+	inline bool Object::getBoolean() const
+	{
+		if (!isBoolean())
+			throw std::bad_variant_access();
+
+		return asBoolean();
+	}
+
+	inline double Object::asNumber() const
+	{
+		double number;
+		std::memcpy(&number, &bits, sizeof(double));
+		return number;
+	}
+
+	inline bool Object::asBoolean() const { return bits == TAG_TRUE; }
+
+	inline const std::string& Object::getString() const { return unbox<std::string>(ObjectType::STRING); }
+
+	inline const CallablePtr& Object::getCallable() const { return unbox<CallablePtr>(ObjectType::CALLABLE); }
+
+	inline const InstancePtr& Object::getInstance() const { return unbox<InstancePtr>(ObjectType::INSTANCE); }
+
+	inline const ContainerPtr& Object::getContainer() const { return unbox<ContainerPtr>(ObjectType::CONTAINER); }
+
+	inline const MetaListPtr& Object::getList() const { return unbox<MetaListPtr>(ObjectType::LIST); }
+
+	inline bool Object::is_true() const
+	{
+		switch (bits)
+		{
+		case TAG_TRUE:
+			return true;
+		case TAG_FALSE:
+		case TAG_NIL:
+			return false;
+		default:
+			return isNumber() ? asNumber() > 0 : true;
+		}
+	}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "Common/Symbol.h"
+
+namespace CXX {
+
+	class Shape;
+
+	using ShapePtr = std::shared_ptr<Shape>;
+
+	// 隐藏类：记录字段名到槽位的映射
+	// 以相同顺序添加了相同字段的实例共享同一个Shape，字段值按槽位存放在实例中
+	// 共享的Shape构成一棵以root()为根的转移树，永不释放，因此可以放心缓存其裸指针
+	// 字段过多或分支过多时，实例转为字典模式：独占一个Shape并原地修改，这种Shape不会被缓存
+	class Shape : public std::enable_shared_from_this<Shape>
+	{
+	public:
+		static const ShapePtr& root();
+
+		// 返回字段的槽位，不存在时返回-1
+		int lookup(Symbol name) const
+		{
+			auto it = offsets.find(name);
+			return it == offsets.end() ? -1 : it->second;
+		}
+
+		// 返回添加字段name后的Shape，新字段位于槽位size()
+		ShapePtr transition(Symbol name);
+
+		size_t size() const { return names.size(); }
+
+		bool isDictionary() const { return dictionary; }
+
+		// 按添加顺序排列的字段名
+		const std::vector<Symbol>& fieldNames() const { return names; }
+
+	private:
+		static constexpr size_t MAX_FIELDS = 64;
+		static constexpr size_t MAX_TRANSITIONS = 64;
+
+		std::unordered_map<Symbol, int> offsets;
+		std::vector<Symbol> names;
+		std::unordered_map<Symbol, ShapePtr> transitions;
+		bool dictionary{ false };
+	};
+
+	// 内联缓存：保存在属性访问的AST节点上，记录该处见过的Shape与对应槽位
+	// 同一处访问的对象往往形状相同，命中时只需一次指针比较与一次下标访问
+	struct InlineCache
+	{
+		static constexpr int WAYS = 4;
+
+		struct Entry
+		{
+			const Shape* shape{ nullptr };
+			Shape* next{ nullptr };		  // 赋值新字段时转移到的Shape，否则为nullptr
+			int offset{ -1 };			  // -1表示该Shape没有这个字段
+		};
+
+		const Entry* find(const Shape* shape) const
+		{
+			for (int i = 0; i < count; i++)
+			{
+				if (entries[i].shape == shape)
+					return &entries[i];
+			}
+			return nullptr;
+		}
+
+		// 超过WAYS种形状后不再缓存(megamorphic)
+		void update(const Shape* shape, int offset, Shape* next = nullptr)
+		{
+			if (shape->isDictionary() || (next && next->isDictionary()) || count == WAYS)
+				return;
+			entries[count++] = { shape, next, offset };
+		}
+
+		Entry entries[WAYS];
+		int count{ 0 };
+	};
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include "Common/TokenType.h"
+#include "Interpreter/Object.h"
+
+namespace CXX {
+
+	class MetaList;
+	class MetaMap;
+	class MetaFloat64Array;
+
+	// 节点依据运行中观察到的操作数类型改写自身的求值方式
+	// 首次求值时选择特化，之后每次只需一个廉价的守卫判断
+	// 守卫失败即退化(deoptimize)为通用路径，此后不再特化，避免反复改写
+	enum class Specialization : uint8_t
+	{
+		UNINITIALIZED,
+		NUMBER,	 // 操作数均为数字
+		LIST,	 // 以数字下标访问List
+		STATIC_NUMBER, // 静态推断出操作数均为数字，无需守卫
+		GENERIC
+	};
+
+	// 只处理数字的二元运算
+	using NumberOp = Object (*)(double, double);
+
+	// 返回运算符op的数字版本，op不是算术或比较运算符时返回nullptr
+	NumberOp numberOperator(TokenType op);
+
+	// 返回列表值中的MetaList，不是列表时返回nullptr
+	// 位于下标访问的热路径上，定义在头文件中以便内联
+	inline MetaList* asList(const Object& obj)
+	{
+		return obj.isList() ? obj.getList().get() : nullptr;
+	}
+
+	// 返回内置Map实例中的MetaMap，不是Map时返回nullptr
+	MetaMap* asMap(const Object& obj);
+
+	// 返回内置Float64Array实例中的MetaFloat64Array，不是Float64Array时返回nullptr
+	MetaFloat64Array* asFloat64Array(const Object& obj);
+
+}
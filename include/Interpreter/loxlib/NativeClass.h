@@ -7,6 +7,10 @@
 
 namespace CXX {
 
+	class MetaSet;
+	class MetaFloat64Array;
+	class MetaStringBuilder;
+
 	class NativeClass : public Class
 	{
 	public:
@@ -14,7 +18,7 @@ namespace CXX {
 		~NativeClass() = default;
 
 	public:
-		std::unordered_map<std::string, ObjectType> allowedFields;
+		std::unordered_map<Symbol, ObjectType> allowedFields;
 	};
 
 	class String : public NativeClass
@@ -33,7 +37,49 @@ namespace CXX {
 		List();
 		static std::shared_ptr<List> getSingleton();
 
-		static InstancePtr instantiate(std::vector<Object> items);
+		// 列表是独立的值类型(ObjectType::LIST)，List(...)不创建实例
+		Object call(Interpreter& interpreter, const std::vector<Object>& arguments) override;
+
+		static Object instantiate(std::vector<Object> items);
+
+		// 查找成员函数并绑定到列表list上，不存在时返回Nil
+		static Object getMethod(const Object& list, Symbol name);
+	};
+
+	class Map : public NativeClass
+	{
+	public:
+		Map();
+		static std::shared_ptr<Map> getSingleton();
+
+		static InstancePtr instantiate();
+	};
+
+	class Set : public NativeClass
+	{
+	public:
+		Set();
+		static std::shared_ptr<Set> getSingleton();
+
+		static InstancePtr instantiate(std::shared_ptr<MetaSet> items);
+	};
+
+	class Float64Array : public NativeClass
+	{
+	public:
+		Float64Array();
+		static std::shared_ptr<Float64Array> getSingleton();
+
+		static InstancePtr instantiate(std::shared_ptr<MetaFloat64Array> data);
+	};
+
+	class StringBuilder : public NativeClass
+	{
+	public:
+		StringBuilder();
+		static std::shared_ptr<StringBuilder> getSingleton();
+
+		static InstancePtr instantiate(std::shared_ptr<MetaStringBuilder> buffer);
 	};
 
 	class Mathematics : public NativeClass
@@ -47,8 +47,18 @@ namespace CXX {
 
 		std::shared_ptr<Callable> bindThis(std::shared_ptr<Instance> instance) override;
 
+		// this不一定是实例，内部类List的成员函数以列表值为this
+		std::shared_ptr<Callable> bindReceiver(const Object& receiver);
+
+		Object invoke(Interpreter& interpreter, const std::shared_ptr<Instance>& receiver, const std::vector<Object>& arguments) override;
+
+		// 只创建放置this的环境，不创建绑定后的函数
+		Object invoke(Interpreter& interpreter, const Object& receiver, const std::vector<Object>& arguments);
+
 		std::string to_string() override;
 
+		void trace(GarbageCollector& gc) const override;
+
 	public:
 		ContextPtr context;
 	};
@@ -4,7 +4,7 @@
 #include "Lexer/IllegalCharError.h"
 #include "Lexer/ExpectCharError.h"
 #include <vector>
-#include <unordered_map>
+#include <string_view>
 #include <optional>
 
 namespace CXX
@@ -13,15 +13,27 @@ namespace CXX
 	class Lexer
 	{
 	public:
-		Lexer(const std::string &filename, const std::string &text);
+		Lexer(const std::string &filename, std::string text);
 
+		// 切分已登记在源码表中的源码
+		explicit Lexer(const SourceFile &source);
+
+		// 从start处开始切分，用于补全预解析时跳过的函数体
+		Lexer(const SourceFile &source, const Position &start);
+
+		// 一次性切分全部源码，Token的lexeme指向源码表中的源码，不做拷贝
 		std::vector<Token> &tokenize();
 
-		static std::unordered_map<std::string, TokenType> reservedKeywords;
+		// 按需切分出下一个Token，到达末尾后重复返回END_OF_FILE
+		Token next();
+
+		// 关键字返回对应的TokenType，否则返回IDENTIFIER
+		static TokenType keyword(std::string_view word);
 
 	private:
+		// 源码在构造时登记到源码表，Token的位置即为其中的偏移
+		const SourceFile &source;
 		std::string_view text;
-		std::string_view filename;
 		Position pos;
 		char current_char;
 		std::vector<Token> tokens;
@@ -31,18 +43,23 @@ namespace CXX
 
 		void skip_comment();
 
-		void make_string();
+		Token make_single(TokenType type, std::string_view lexeme);
+
+		Token make_string();
+
+		Token make_identifier();
 
-		void make_identifier();
+		Token make_number();
 
-		void make_number();
+		Token make_optional_token(char expect, TokenType optional, std::string_view optional_lexeme,
+								 TokenType fallback, std::string_view fallback_lexeme);
 
-		void make_optional_token(char expect, TokenType optional, std::string optional_lexeme,
-								 TokenType fallback, std::string fallback_lexeme);
+		Token make_plus_plus();
 
-		void make_plus_plus();
+		Token make_minus_minus();
 
-		void make_minus_minus();
+		// [start, end)对应的源码
+		std::string_view slice(const Position &start, const Position &end) const;
 	};
 
 }
\ No newline at end of file
@@ -1,19 +1,19 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include "Common/TokenType.h"
 #include "Common/Position.h"
+#include "Common/Symbol.h"
 
 namespace CXX {
 
 	class Token
 	{
 	public:
-		Token(const TokenType& type = TokenType::NIL, std::string lexeme = "NIL",
+		Token(const TokenType& type = TokenType::NIL, std::string_view lexeme = "NIL",
 			const Position& start = Position::preset, const Position& end = Position::preset);
 
-		Token(const Token& other);
-
 		[[nodiscard]] std::string to_string() const;
 
 		bool operator==(const Token& rhs) const;
@@ -22,7 +22,10 @@ namespace CXX {
 
 	public:
 		TokenType type;
-		std::string lexeme; // 词素(也就是value)
+		// 词素(也就是value)，指向源码表中的源码或驻留的字符串，不持有内存
+		// 因此lexeme必须来自SourceFile、Symbol或字符串字面量
+		std::string_view lexeme;
+		Symbol symbol; // 驻留后的lexeme，运行时以此作为变量名、属性名的键，仅标识符、字符串与关键字驻留
 		Position pos_start;
 		Position pos_end;
 	};
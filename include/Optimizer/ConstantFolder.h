@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include "Common/typedefs.h"
+#include "Interpreter/Object.h"
+
+namespace CXX {
+
+	class FuncDeclarationStmt;
+
+	// 常量折叠与死分支消除，作用于Resolver之后
+	// 1. 操作数均为字面量的算术、比较、字符串拼接直接算出结果，换成LiteralExpr
+	// 2. 条件为常量的if、while、三元表达式只保留会执行的分支
+	// 3. 左侧为常量的and、or直接短路
+	// 运行时会报错的运算(例如除以0)不折叠，留到运行时在原位置报错
+	// 只会删除节点或换成字面量，Resolver计算的槽位与作用域不受影响
+	class ConstantFolder
+	{
+	public:
+		// 新的字面量节点分配在arena中
+		explicit ConstantFolder(AstArena& arena) : arena(arena) {}
+
+		void fold(std::vector<StmtPtr>& statements);
+
+		// 延迟解析的函数体补全后单独折叠
+		static void foldBody(FuncDeclarationStmt* function);
+
+	private:
+		ExprPtr fold(ExprPtr expr);
+
+		// 返回nullptr表示整条语句可以删除
+		StmtPtr fold(StmtPtr stmt);
+
+		// 语法上必须有一条语句的位置(循环体、if分支)，被删除时换成空块
+		StmtPtr foldRequired(StmtPtr stmt);
+
+		ExprPtr foldBinary(ExprPtr expr);
+
+		ExprPtr foldUnary(ExprPtr expr);
+
+		ExprPtr foldLogical(ExprPtr expr);
+
+		StmtPtr foldIf(StmtPtr stmt);
+
+		ExprPtr literal(ExprPtr origin, Object value);
+
+		// expr为nil、bool、数字或字符串字面量时返回其值
+		static std::optional<Object> constant(ExprPtr expr);
+
+		AstArena& arena;
+	};
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <optional>
+#include <unordered_map>
+#include "Common/typedefs.h"
+#include "Parser/Expr.h"
+
+namespace CXX {
+
+	class BlockStmt;
+	class FuncDeclarationStmt;
+
+	// 流不敏感的静态类型推断，作用于常量折叠之后
+	// 结果写入Expr::staticType，只推断number、string、bool三种类型
+	// 1. 字面量、算术、比较、逻辑运算按运算符的语义推断
+	// 2. 局部变量(有槽位的)的类型为其所有赋值(声明、=、+=、++等)的类型的并，任一赋值类型未知则未知
+	// 3. 全局变量、模块顶层变量、参数、调用结果、属性等一律未知
+	// 局部变量只能在其作用域内(包括其中的闭包)被赋值，遍历整个编译单元即可看到全部赋值
+	// 变量的类型之间可能互相依赖，反复遍历直到不再变化，最后一遍写入结果
+	class TypeInferencer
+	{
+	public:
+		// 为真时输出每个推断出类型的表达式，用于检查推断的覆盖率
+		static bool print;
+
+		// 脚本顶层的变量都是全局变量
+		static void infer(const std::vector<StmtPtr>& statements);
+
+		// 模块顶层是具名作用域，其中的变量按名字存放
+		static void inferModule(BlockStmt* module);
+
+		// 延迟解析的函数体补全后单独推断，函数外的变量一律未知
+		static void inferFunction(FuncDeclarationStmt* function);
+
+	private:
+		// std::nullopt表示尚未得到任何信息，两者的并为另一者
+		using Type = std::optional<StaticType>;
+
+		// 一个作用域(块、for、函数)中各槽位变量的类型
+		using Slots = std::vector<Type>;
+
+		template <typename Walk>
+		void solve(Walk pass);
+
+		// 推断expr的类型，最后一遍遍历时写入expr->staticType
+		Type walk(ExprPtr expr);
+
+		Type typeOf(ExprPtr expr);
+
+		void walk(StmtPtr stmt);
+
+		void walk(const std::vector<StmtPtr>& statements);
+
+		void walkFunction(const void* key, int localCount, size_t params, int thisSlot, const std::vector<StmtPtr>& body);
+
+		void beginScope(const void* key, int localCount);
+
+		void endScope();
+
+		// 变量所在的槽位，不是局部变量时返回nullptr
+		Type* variable(int depth, int slot);
+
+		Type lookup(int depth, int slot);
+
+		void assign(int depth, int slot, Type type);
+
+		static Type join(Type lhs, Type rhs);
+
+		static Type binary(TokenType op, Type lhs, Type rhs);
+
+		void report(ExprPtr expr, StaticType type);
+
+	private:
+		std::unordered_map<const void*, Slots> variables;
+
+		// 当前所处的各层作用域，nullptr表示具名作用域
+		std::vector<Slots*> scopes;
+
+		bool changed = false;
+		bool annotating = false;
+
+		size_t typed = 0;
+		size_t total = 0;
+	};
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+namespace CXX {
+
+	// 一个编译单元(脚本或模块)的所有AST节点都分配在同一个Arena中
+	// 节点之间以裸指针相互引用，没有逐个节点的堆分配与引用计数
+	// Arena析构时统一析构所有节点，并整块释放内存
+	// 函数对象通过节点上记录的arena持有它，保证闭包引用的函数体始终有效
+	class AstArena : public std::enable_shared_from_this<AstArena>
+	{
+	public:
+		AstArena() = default;
+
+		AstArena(const AstArena&) = delete;
+
+		AstArena& operator=(const AstArena&) = delete;
+
+		~AstArena();
+
+		template <typename T, typename... Args>
+		T* make(Args&&... args)
+		{
+			T* node = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+			if constexpr (!std::is_trivially_destructible_v<T>)
+				destructors.emplace_back(node, [](void* ptr) { static_cast<T*>(ptr)->~T(); });
+
+			return node;
+		}
+
+	private:
+		static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+		void* allocate(size_t size, size_t align);
+
+		std::vector<std::unique_ptr<char[]>> blocks;
+		char* cursor{ nullptr };
+		char* limit{ nullptr };
+
+		std::vector<std::pair<void*, void (*)(void*)>> destructors;
+	};
+
+}
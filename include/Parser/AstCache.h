@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include "Common/typedefs.h"
+#include "Common/SourceFile.h"
+
+namespace CXX {
+
+	// 经Resolver处理后的AST的磁盘缓存
+	// 以源码内容、文件名、工作目录、LOXLIB与VERSION为键，任一变化都会换用新的缓存文件
+	// 文件名取键的哈希，文件内保存完整的键，读取时逐字节比较
+	// 命中时直接在新的arena中重建AST，跳过词法分析、语法分析与Resolver
+	// 节点中的位置与词素以源码内的偏移保存，读取时指回当前登记的源码
+	class AstCache
+	{
+	public:
+		// 作为脚本运行与作为模块导入时，Resolver的作用域不同，分开缓存
+		enum class Unit : uint8_t
+		{
+			SCRIPT,
+			MODULE
+		};
+
+		// AST结构或缓存格式变化时须增加
+		static constexpr uint32_t VERSION = 4;
+
+		// 缓存目录，为空时不使用缓存
+		static std::string directory;
+
+		static bool enabled() { return !directory.empty(); }
+
+		// 查找source对应的缓存，未命中或缓存损坏时返回std::nullopt
+		// 内容先经校验和检查，重建时再检查每个下标、偏移、槽位与深度
+		static std::optional<std::vector<StmtPtr>> load(const SourceFile& source, Unit unit, AstArenaPtr& arena);
+
+		// 写入缓存，失败时静默忽略
+		static void store(const SourceFile& source, Unit unit, const std::vector<StmtPtr>& statements);
+
+	private:
+		static std::string identity(const SourceFile& source, Unit unit);
+
+		static uint64_t key(std::string_view identity);
+
+		static std::string path(uint64_t key);
+	};
+
+}
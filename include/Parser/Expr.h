@@ -2,10 +2,13 @@
 
 #include <memory>
 #include <vector>
+#include <cstdint>
 #include "Common/typedefs.h"
 #include "Common/Position.h"
 #include "Lexer/Token.h"
 #include "Interpreter/Object.h"
+#include "Interpreter/Shape.h"
+#include "Interpreter/Specialize.h"
 
 namespace CXX {
 
@@ -51,6 +54,16 @@ namespace CXX {
 
 	class PackExpr; // 同理PackStmt，这是一个vector<ExprPtr>
 
+	// 静态类型推断的结果，见TypeInferencer
+	// 非UNKNOWN时，表达式每次求值的结果必为该类型(求值中途报错的除外)
+	enum class StaticType : uint8_t
+	{
+		UNKNOWN,
+		NUMBER,
+		STRING,
+		BOOL
+	};
+
 	enum class ExprType
 	{
 		Binary,
@@ -104,7 +117,7 @@ namespace CXX {
 
 		virtual Object visit(const SetExpr* setExpr) = 0;
 
-		virtual Object visit(std::shared_ptr<LambdaExpr> lambdaExpr) = 0;
+		virtual Object visit(LambdaExpr* lambdaExpr) = 0;
 
 		virtual Object visit(const ThisExpr* thisExpr) = 0;
 
@@ -134,6 +147,9 @@ namespace CXX {
 		Position pos_start;
 		Position pos_end;
 		ExprType exprType;
+
+		// 由TypeInferencer填写，执行引擎据此省去运行时的类型检查
+		StaticType staticType{ StaticType::UNKNOWN };
 	};
 
 	class BinaryExpr : public Expr
@@ -146,9 +162,12 @@ namespace CXX {
 		[[nodiscard]] std::string to_string() const override;
 
 	public:
-		ExprPtr left;
-		ExprPtr right;
+		ExprPtr left{ nullptr };
+		ExprPtr right{ nullptr };
 		Token op;
+
+		mutable Specialization specialization{ Specialization::UNINITIALIZED };
+		mutable NumberOp numberOp{ nullptr }; // 特化为NUMBER时使用
 	};
 
 	class UnaryExpr : public Expr
@@ -162,7 +181,7 @@ namespace CXX {
 
 	public:
 		Token op;
-		ExprPtr expr;
+		ExprPtr expr{ nullptr };
 	};
 
 	class LiteralExpr : public Expr
@@ -188,11 +207,12 @@ namespace CXX {
 
 		[[nodiscard]] std::string to_string() const override;
 
-		void resolve(int depth);
+		void resolve(int depth, int slot);
 
 	public:
 		Token identifier;
 		int depth;
+		int slot; // 局部变量在所处Context中的槽位
 	};
 
 	class AssignmentExpr : public Expr
@@ -204,13 +224,14 @@ namespace CXX {
 
 		[[nodiscard]] std::string to_string() const override;
 
-		void resolve(int depth);
+		void resolve(int depth, int slot);
 
 	public:
 		Token identifier;
 		Token operation;
-		ExprPtr value;
+		ExprPtr value{ nullptr };
 		int depth;
+		int slot; // 局部变量在所处Context中的槽位
 	};
 
 	class TernaryExpr : public Expr
@@ -223,9 +244,9 @@ namespace CXX {
 		[[nodiscard]] std::string to_string() const override;
 
 	public:
-		ExprPtr expr;
-		ExprPtr thenBranch;
-		ExprPtr elseBranch;
+		ExprPtr expr{ nullptr };
+		ExprPtr thenBranch{ nullptr };
+		ExprPtr elseBranch{ nullptr };
 	};
 
 	class OrExpr : public Expr
@@ -270,8 +291,10 @@ namespace CXX {
 		[[nodiscard]] std::string to_string() const override;
 
 	public:
-		ExprPtr holder; // 可以是Variable或Retrieve
+		ExprPtr holder{ nullptr }; // 可以是Variable或Retrieve
 		IncrementExpr::Type type;
+
+		mutable Specialization specialization{ Specialization::UNINITIALIZED }; // 仅对Variable特化
 	};
 
 	class DecrementExpr : public Expr
@@ -290,8 +313,10 @@ namespace CXX {
 		[[nodiscard]] std::string to_string() const override;
 
 	public:
-		ExprPtr holder; // 可以是Variable或Retrieve
+		ExprPtr holder{ nullptr }; // 可以是Variable或Retrieve
 		DecrementExpr::Type type;
+
+		mutable Specialization specialization{ Specialization::UNINITIALIZED }; // 仅对Variable特化
 	};
 
 	class CallExpr : public Expr
@@ -303,8 +328,12 @@ namespace CXX {
 
 		[[nodiscard]] std::string to_string() const override;
 
+		// 原生函数报错时指向的表达式，三种执行方式一致
+		// 最后一个实参；没有实参时为方法的接收者，或被调用的表达式
+		[[nodiscard]] const Expr* culprit() const;
+
 	public:
-		ExprPtr callee;
+		ExprPtr callee{ nullptr };
 		std::vector<ExprPtr> arguments;
 	};
 
@@ -326,10 +355,13 @@ namespace CXX {
 		[[nodiscard]] std::string to_string() const override;
 
 	public:
-		ExprPtr holder;
+		ExprPtr holder{ nullptr };
 		Token identifier; // 从对象中取元素，使用identifier
-		ExprPtr index;	  // 从列表中取元素，则为Number；否则应为string
+		ExprPtr index{ nullptr };	  // 从列表中取元素，则为Number；否则应为string
 		OpType type;
+
+		mutable InlineCache cache; // 仅用于DOT
+		mutable Specialization specialization{ Specialization::UNINITIALIZED }; // 仅用于BRACKET
 	};
 
 	class SetExpr : public Expr
@@ -348,15 +380,17 @@ namespace CXX {
 		[[nodiscard]] std::string to_string() const override;
 
 	public:
-		ExprPtr holder;
+		ExprPtr holder{ nullptr };
 		Token identifier; // 从对象中取元素，使用identifier
-		ExprPtr index;	  // 从列表中取元素，则为Number；否则应为string
+		ExprPtr index{ nullptr };	  // 从列表中取元素，则为Number；否则应为string
 		Token operation;  // +=、-=、*=、/=、=
-		ExprPtr value;
+		ExprPtr value{ nullptr };
 		OpType type;
+
+		mutable InlineCache cache; // 仅用于DOT
 	};
 
-	class LambdaExpr : public Expr, public std::enable_shared_from_this<LambdaExpr>
+	class LambdaExpr : public Expr
 	{
 	public:
 		LambdaExpr(std::vector<Token> params, std::vector<ExprPtr> default_values, std::vector<StmtPtr> body);
@@ -369,6 +403,12 @@ namespace CXX {
 		std::vector<Token> params;
 		std::vector<ExprPtr> default_values;
 		std::vector<StmtPtr> body;
+
+		// 函数作用域内局部变量(含参数)的个数，由Resolver计算
+		int localCount = 0;
+
+		// 节点所在的Arena，由Parser设置
+		AstArena* arena = nullptr;
 	};
 
 	class ThisExpr : public Expr
@@ -380,11 +420,12 @@ namespace CXX {
 
 		[[nodiscard]] std::string to_string() const override;
 
-		void resolve(int depth);
+		void resolve(int depth, int slot);
 
 	public:
 		Token keyword;
 		int depth;
+		int slot; // 局部变量在所处Context中的槽位
 	};
 
 	class SuperExpr : public Expr
@@ -396,12 +437,13 @@ namespace CXX {
 
 		[[nodiscard]] std::string to_string() const override;
 
-		void resolve(int depth);
+		void resolve(int depth, int slot);
 
 	public:
 		Token keyword;
 		Token identifier;
 		int depth;
+		int slot; // 局部变量在所处Context中的槽位
 	};
 
 	class ListExpr : public Expr
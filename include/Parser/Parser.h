@@ -5,21 +5,33 @@
 #include <algorithm>
 #include "Common/typedefs.h"
 #include "Lexer/Token.h"
+#include "Lexer/Lexer.h"
 #include "Parser/ParsingError.h"
+#include "Parser/AstArena.h"
 
 namespace CXX
 {
 
+	class FuncDeclarationStmt;
+
 	class Parser
 	{
 	public:
-		explicit Parser(const std::vector<Token> &tokens);
-		explicit Parser(std::vector<Token> &&tokens);
+		// 解析时按需向lexer索取Token，词法错误会直接抛出
+		// lazy为真时预解析顶层函数与顶层类的成员函数，函数体只做括号匹配
+		explicit Parser(Lexer &lexer, bool lazy = false);
 
 		~Parser() = default;
 
 		std::vector<StmtPtr> parse();
 
+		// 持有本次解析产生的所有节点
+		const AstArenaPtr &arena() const { return m_arena; }
+
+		// 补全预解析时跳过的函数体，新节点分配在函数所在的arena中
+		// 有语法错误时报告错误并返回false
+		static bool parseBody(FuncDeclarationStmt *function);
+
 	private:
 		StmtPtr declaration();
 
@@ -90,10 +102,26 @@ namespace CXX
 
 		ExprPtr func_body();
 
+		// 解析带括号的参数列表
+		void parameters(std::vector<Token> &params, std::vector<ExprPtr> &default_values);
+
+		// 预解析：跳过函数体直到与之匹配的'}'
+		void skipBlock();
+
 	private:
+		// 最近取出的Token保存在环形缓冲区中，内存占用与源码长度无关
+		// reverse最多回退WINDOW - 2步(回退后仍需保留其前一个Token供previous使用)
+		static constexpr int WINDOW = 4;
+
+		Lexer &lexer;
+		Token window[WINDOW];
 		Token current_tok;
-		int tok_idx;
-		std::vector<Token> tokens;
+		int tok_idx;	// current_tok的序号
+		int fetched;	// 已从lexer取出的Token个数
+		AstArenaPtr m_arena;
+		std::vector<ParsingError> errors;
+		bool lazy;
+		int blockDepth; // 当前所处的块层数，只有顶层的函数才预解析
 
 	private:
 		void advance();
@@ -123,6 +151,12 @@ namespace CXX
 		bool match(const std::initializer_list<TokenType> &types);
 
 		void synchronize();
+
+		template <typename T, typename... Args>
+		T *make(Args &&...args)
+		{
+			return m_arena->make<T>(std::forward<Args>(args)...);
+		}
 	};
 
 }
\ No newline at end of file
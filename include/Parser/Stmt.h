@@ -41,6 +41,8 @@ namespace CXX {
 	// PackStmt中将存储三个varDeclarationStmt
 	class PackStmt;
 
+	struct LazyScope; // 见Resolver
+
 	enum class StmtType
 	{
 		Expression,
@@ -66,7 +68,7 @@ namespace CXX {
 
 		virtual void visit(const VarDeclarationStmt* varStmt) = 0;
 
-		virtual void visit(std::shared_ptr<FuncDeclarationStmt> funcStmt) = 0;
+		virtual void visit(FuncDeclarationStmt* funcStmt) = 0;
 
 		virtual void visit(const ClassDeclarationStmt* classStmt) = 0;
 
@@ -120,7 +122,7 @@ namespace CXX {
 		[[nodiscard]] std::string to_string() const override;
 
 	public:
-		ExprPtr expr;
+		ExprPtr expr{ nullptr };
 	};
 
 	class VarDeclarationStmt : public Stmt
@@ -137,9 +139,12 @@ namespace CXX {
 
 		// 你可以只声明而不赋值
 		std::optional<ExprPtr> expr;
+
+		// 局部变量的槽位，全局变量为-1
+		int slot = -1;
 	};
 
-	class FuncDeclarationStmt : public Stmt, public std::enable_shared_from_this<FuncDeclarationStmt>
+	class FuncDeclarationStmt : public Stmt
 	{
 	public:
 		FuncDeclarationStmt(const Token& name, std::vector<Token> params, std::vector<ExprPtr> default_values, std::vector<StmtPtr> body);
@@ -153,6 +158,26 @@ namespace CXX {
 		std::vector<Token> params;
 		std::vector<ExprPtr> default_values;
 		std::vector<StmtPtr> body;
+
+		// 函数名的槽位，全局函数为-1
+		int slot = -1;
+
+		// 函数作用域内局部变量(含参数)的个数，由Resolver计算
+		int localCount = 0;
+
+		// 类成员函数中this所在的槽位(紧随参数之后)，普通函数为-1
+		int thisSlot = -1;
+
+		// 节点所在的Arena，由Parser设置
+		AstArena* arena = nullptr;
+
+		// 预解析时函数体只做括号匹配，记录'{'之后的位置
+		// 首次调用前由Resolver::resolveBody补全，此后body与localCount才有效
+		bool lazy = false;
+		Position bodyStart;
+
+		// 补全函数体时需要恢复的Resolver状态
+		std::shared_ptr<const LazyScope> lazyScope;
 	};
 
 	class VariableExpr; // 类可以继承自另一个类
@@ -160,8 +185,8 @@ namespace CXX {
 	class ClassDeclarationStmt : public Stmt
 	{
 	public:
-		ClassDeclarationStmt(const Token& identifier, std::vector<std::shared_ptr<FuncDeclarationStmt>> methods,
-			std::optional<std::shared_ptr<VariableExpr>> superclass = std::nullopt);
+		ClassDeclarationStmt(const Token& identifier, std::vector<FuncDeclarationStmt*> methods,
+			std::optional<VariableExpr*> superclass = std::nullopt);
 
 		void accept(StmtVisitor& visitor) override;
 
@@ -169,9 +194,12 @@ namespace CXX {
 
 	public:
 		Token name;
-		std::vector<std::shared_ptr<FuncDeclarationStmt>> methods;
+		std::vector<FuncDeclarationStmt*> methods;
 		// 仅支持单继承
-		std::optional<std::shared_ptr<VariableExpr>> superClass;
+		std::optional<VariableExpr*> superClass;
+
+		// 类名的槽位，全局类为-1
+		int slot = -1;
 	};
 
 	class BlockStmt : public Stmt
@@ -185,6 +213,9 @@ namespace CXX {
 
 	public:
 		std::vector<StmtPtr> statements;
+
+		// 块内局部变量的个数，由Resolver计算
+		int localCount = 0;
 	};
 
 	class IfStmt : public Stmt
@@ -197,8 +228,8 @@ namespace CXX {
 		[[nodiscard]] std::string to_string() const override;
 
 	public:
-		ExprPtr condition;
-		StmtPtr thenBranch;
+		ExprPtr condition{ nullptr };
+		StmtPtr thenBranch{ nullptr };
 		std::optional<StmtPtr> elseBranch;
 	};
 
@@ -212,8 +243,8 @@ namespace CXX {
 		[[nodiscard]] std::string to_string() const override;
 
 	public:
-		ExprPtr condition;
-		StmtPtr body;
+		ExprPtr condition{ nullptr };
+		StmtPtr body{ nullptr };
 	};
 
 	class ForStmt : public Stmt
@@ -230,7 +261,10 @@ namespace CXX {
 		std::optional<StmtPtr> initializer;
 		std::optional<ExprPtr> condition;
 		std::optional<ExprPtr> increment;
-		StmtPtr body;
+		StmtPtr body{ nullptr };
+
+		// for作用域内局部变量的个数，由Resolver计算
+		int localCount = 0;
 	};
 
 	class BreakStmt : public Stmt
@@ -248,13 +282,6 @@ namespace CXX {
 		Token keyword;
 	};
 
-	class BreakFlag
-	{
-		// throw一个Break标志是最直接的方式
-		// try catch性能效率很低，但是Break和Continue不是常触发语句
-		// 可以接受
-	};
-
 	class ContinueStmt : public Stmt
 	{
 	public:
@@ -270,13 +297,6 @@ namespace CXX {
 		Token keyword;
 	};
 
-	class ContinueFlag
-	{
-		// throw一个Continue标志是最直接的方式
-		// try catch性能效率很低，但是Break和Continue不是常触发语句
-		// 可以接受
-	};
-
 	class ReturnStmt : public Stmt
 	{
 	public:
@@ -304,6 +324,9 @@ namespace CXX {
 		Token keyword;
 		std::map<Token, std::optional<Token>> symbols;
 		Token filepath;
+
+		// 与symbols的遍历顺序一一对应，记录导入名的槽位
+		std::vector<int> slots;
 	};
 
 	class PackStmt : public Stmt
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <vector>
+#include <utility>
+#include <memory>
 #include <unordered_map>
 #include "Common/typedefs.h"
 #include "Parser/Expr.h"
@@ -24,10 +26,16 @@ namespace CXX {
 	public:
 		bool resolve(const std::vector<StmtPtr>& stmts);
 
+		// 模块的顶层作用域，变量以名字存放，以便导出
+		void resolveModule(const BlockStmt* blockStmt);
+
 		void resolve(Stmt* stmt);
 
 		void resolve(Expr* expr);
 
+		// 补全并解析预解析时跳过的函数体，有错误时报告错误并返回false
+		static bool resolveBody(FuncDeclarationStmt* function);
+
 		Object visit(const BinaryExpr* binaryExpr) override;
 
 		Object visit(const UnaryExpr* unaryExpr) override;
@@ -54,7 +62,7 @@ namespace CXX {
 
 		Object visit(const DecrementExpr* decrementExpr) override;
 
-		Object visit(std::shared_ptr<LambdaExpr> lambdaExpr) override;
+		Object visit(LambdaExpr* lambdaExpr) override;
 
 		Object visit(const ThisExpr* thisExpr) override;
 
@@ -80,7 +88,7 @@ namespace CXX {
 
 		void visit(const ForStmt* forStmt) override;
 
-		void visit(std::shared_ptr<FuncDeclarationStmt> funcDeclStmt) override;
+		void visit(FuncDeclarationStmt* funcDeclStmt) override;
 
 		void visit(const ClassDeclarationStmt* classDeclStmt) override;
 
@@ -91,9 +99,24 @@ namespace CXX {
 		void visit(const PackStmt* packStmt) override;
 
 	private:
+		friend struct LazyScope;
+
+		struct Variable
+		{
+			bool defined;	// 表示一个变量在此作用域内已经初始化过与否
+			int slot;		// 变量在运行时Context中的槽位
+			int order = 0;	// 变量在作用域中声明的次序
+		};
+
+		struct Scope
+		{
+			std::unordered_map<std::string, Variable> variables;
+			int localCount = 0;
+			bool named = false; // 为真时变量不分配槽位
+		};
+
 		// 实际上，这些作用域应该是栈结构，我们这里用vector手动模拟
-		// 哈希表：表示一个变量在此作用域内已经初始化过与否
-		std::vector<std::unordered_map<std::string, bool>> scopes;
+		std::vector<Scope> scopes;
 
 		// 用于记录程序执行过程中的循环层数
 		// 防止错误使用break和continue
@@ -120,20 +143,47 @@ namespace CXX {
 		};
 		ClassType currentClass = ClassType::NONE;
 
+		// 模块的顶层作用域，在resolveModule结束时填入，供延迟解析的函数体使用
+		std::shared_ptr<Scope> moduleScope;
+
+		// 补全函数体时，函数外的模块作用域(不在scopes中)
+		// 只有次序小于outerVisible的变量在函数声明处可见
+		const Scope* outer = nullptr;
+		int outerVisible = 0;
+
 	private:
-		int resolveLocal(const Token& name);
+		// 返回变量的(距离, 槽位)，全局变量距离为-1
+		std::pair<int, int> resolveLocal(const Token& name);
 
 		void resolveFunction(const FuncDeclarationStmt* functionStmt, FunctionType type);
 
+		// 记录函数声明处的状态，推迟解析函数体；无法推迟时立即补全函数体并返回false
+		bool defer(const FuncDeclarationStmt* functionStmt, FunctionType type);
+
 		void resolveFunction(const LambdaExpr* lambdaExpr);
 
-		void beginScope();
+		void beginScope(bool named = false);
 
-		void endScope();
+		// 返回该作用域的局部变量个数
+		int endScope();
 
 		void define(const Token& name);
 
-		void declare(const Token& name);
+		// 返回变量的槽位，同一作用域内重复声明将复用槽位
+		int declare(const Token& name);
+
+		// 函数参数总是按顺序占据新的槽位
+		int declareParam(const Token& name);
+	};
+
+	// 延迟解析的函数体在声明处的Resolver状态
+	// 只有脚本或模块顶层的函数会被推迟，外部至多只有一个模块作用域
+	struct LazyScope
+	{
+		std::shared_ptr<const Resolver::Scope> module; // 脚本顶层的函数为空
+		int visible = 0;							   // 声明时模块作用域中已有的变量个数
+		Resolver::FunctionType type;
+		Resolver::ClassType currentClass;
 	};
 
 }
\ No newline at end of file
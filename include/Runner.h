@@ -6,6 +6,7 @@ namespace CXX
 
 	class Interpreter;
 	class Transpiler;
+	class VM;
 	class Position;
 
 	class Runner
@@ -17,11 +18,22 @@ namespace CXX
 
 		static int runTranspile();
 
+		// 测量词法分析的吞吐量(tokens/s)，取多轮中最快的一轮
+		static int benchLexer(const std::string &filename);
+
 	public:
 		static bool DEBUG;
+		static bool USE_VM; // 使用字节码虚拟机执行
+		static bool USE_CLOSURE; // 将AST编译为闭包后执行
+		static bool LAZY; // 预解析顶层函数，函数体在首次调用时才解析
+
+		// 脚本与模块是否延迟解析函数体
+		// 字节码虚拟机需要完整的AST；使用AST缓存时缓存命中即可跳过全部解析，二者均不延迟
+		static bool lazyParsing();
 
 		static Interpreter interpreter;
 		static Transpiler transpiler;
+		static VM vm;
 
 		// Point to current exectuing code position
 		static Position *pos_start;
@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <utility>
+#include <unordered_map>
+#include "Interpreter/Object.h"
+#include "Common/Symbol.h"
+#include "VM/OpCode.h"
+
+namespace CXX {
+
+	class Position;
+	class Context;
+
+	class Chunk
+	{
+	public:
+		void write(uint8_t byte, Position* start, Position* end);
+
+		void write(OpCode op, Position* start, Position* end);
+
+		void writeShort(uint16_t value, Position* start, Position* end);
+
+		size_t addConstant(const Object& value);
+
+		// 字符串常量去重，主要用于变量名、属性名
+		size_t addName(Symbol name);
+
+		void disassemble(const std::string& name) const;
+
+		size_t disassembleInstruction(size_t offset) const;
+
+	public:
+		std::vector<uint8_t> code;
+		std::vector<Object> constants;
+
+		// 与constants一一对应，由addName加入的名字在此存有驻留后的Symbol
+		std::vector<Symbol> symbols;
+
+		// 与code一一对应，记录每个字节所属AST节点的位置，用于运行时报错
+		// 指向的AST节点由Prototype保活
+		std::vector<std::pair<Position*, Position*>> positions;
+
+		// 全局变量缓存，与constants一一对应
+		// 只缓存模块自身哈希表中的变量，unordered_map的节点地址在rehash后不变
+		struct GlobalSlot
+		{
+			Context* context{ nullptr };
+			Object* slot{ nullptr };
+		};
+		std::vector<GlobalSlot> globalCache;
+
+	private:
+		std::unordered_map<Symbol, size_t> names;
+	};
+
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include "Common/typedefs.h"
+#include "Interpreter/Callable.h"
+#include "Interpreter/Object.h"
+#include "Interpreter/GarbageCollector.h"
+#include "VM/Chunk.h"
+
+namespace CXX {
+
+	class ImportStmt;
+	class Class;
+
+	enum class FunctionKind
+	{
+		SCRIPT,	 // 脚本或模块的顶层代码
+		FUNCTION,
+		METHOD,	 // 类成员函数，0号槽位为this
+		LAMBDA
+	};
+
+	// 函数编译后的产物，同一函数定义的所有闭包共享一个Prototype
+	class Prototype
+	{
+	public:
+		std::string name;
+		FunctionKind kind{ FunctionKind::SCRIPT };
+		int arity{ 0 };
+		size_t defaults{ 0 };	// 默认参数个数
+		int upvalueCount{ 0 };
+		Chunk chunk;
+
+		// 内部定义的函数
+		std::vector<std::shared_ptr<Prototype>> protos;
+		std::vector<const ImportStmt*> imports;
+
+		// chunk中的位置信息与import语句指向AST，在此保活
+		std::shared_ptr<const void> source;
+	};
+
+	using PrototypePtr = std::shared_ptr<Prototype>;
+
+	// 被闭包捕获的变量
+	// 变量仍在栈上时location指向栈槽位，离开作用域后拷贝到closed中
+	class Upvalue : public Collectable
+	{
+	public:
+		explicit Upvalue(Object* slot) : location(slot) {}
+
+		void trace(GarbageCollector& gc) const override;
+
+		void clear(std::vector<Object>& trash) override;
+
+	public:
+		Object* location;
+		Object closed;
+		std::shared_ptr<Upvalue> next; // VM中按栈地址排序的open upvalue链表
+	};
+
+	using UpvaluePtr = std::shared_ptr<Upvalue>;
+
+	class Closure : public Callable, public std::enable_shared_from_this<Closure>
+	{
+	public:
+		Closure(PrototypePtr proto, ContextPtr globals);
+
+		Object call(Interpreter& interpreter, const std::vector<Object>& arguments) override;
+
+		int arity() override;
+
+		size_t required_params() override;
+
+		CallablePtr bindThis(InstancePtr instance) override;
+
+		std::string to_string() override;
+
+		std::string name() override;
+
+		void trace(GarbageCollector& gc) const override;
+
+	public:
+		PrototypePtr proto;
+		std::vector<UpvaluePtr> upvalues;
+
+		// 默认值在定义函数时求值
+		std::vector<Object> default_values;
+
+		// 函数定义时所在模块的全局变量环境
+		ContextPtr globals;
+
+		// 类成员函数(及其内部定义的函数)所属的类，用于查找super
+		// 类持有其成员函数，这里不能再持有类
+		Class* belonging{ nullptr };
+	};
+
+	// 绑定了this的类成员函数
+	class BoundMethod : public Callable
+	{
+	public:
+		BoundMethod(InstancePtr receiver, std::shared_ptr<Closure> method);
+
+		Object call(Interpreter& interpreter, const std::vector<Object>& arguments) override;
+
+		int arity() override;
+
+		size_t required_params() override;
+
+		CallablePtr bindThis(InstancePtr instance) override;
+
+		std::string to_string() override;
+
+		std::string name() override;
+
+		void trace(GarbageCollector& gc) const override;
+
+	public:
+		InstancePtr receiver;
+		std::shared_ptr<Closure> method;
+	};
+
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Common/typedefs.h"
+#include "Parser/Expr.h"
+#include "Parser/Stmt.h"
+#include "VM/Closure.h"
+
+namespace CXX {
+
+	// 将AST编译为字节码
+	// 局部变量分配在栈上，被捕获的变量转为upvalue(同clox)
+	// 顶层代码中的变量为全局变量，存放于模块的Context中
+	class Compiler : public ExprVisitor, public StmtVisitor
+	{
+	public:
+		// source用于保活AST，编译产物中的位置信息指向AST节点
+		PrototypePtr compile(const std::vector<StmtPtr>& statements, std::shared_ptr<const void> source, bool repl = false);
+
+	public:
+		void visit(const ExpressionStmt* expressionStmt) override;
+
+		void visit(const VarDeclarationStmt* varStmt) override;
+
+		void visit(FuncDeclarationStmt* funcDeclStmt) override;
+
+		void visit(const ClassDeclarationStmt* classDeclStmt) override;
+
+		void visit(const BlockStmt* blockStmt) override;
+
+		void visit(const IfStmt* ifStmt) override;
+
+		void visit(const WhileStmt* whileStmt) override;
+
+		void visit(const ForStmt* forStmt) override;
+
+		void visit(const BreakStmt* breakStmt) override;
+
+		void visit(const ContinueStmt* continueStmt) override;
+
+		void visit(const ReturnStmt* returnStmt) override;
+
+		void visit(const ImportStmt* importStmt) override;
+
+		void visit(const PackStmt* packStmt) override;
+
+		Object visit(const BinaryExpr* binaryExpr) override;
+
+		Object visit(const UnaryExpr* unaryExpr) override;
+
+		Object visit(const LiteralExpr* literalExpr) override;
+
+		Object visit(const VariableExpr* variableExpr) override;
+
+		Object visit(const AssignmentExpr* assignmentExpr) override;
+
+		Object visit(const TernaryExpr* ternaryExpr) override;
+
+		Object visit(LambdaExpr* lambdaExpr) override;
+
+		Object visit(const OrExpr* orExpr) override;
+
+		Object visit(const AndExpr* andExpr) override;
+
+		Object visit(const IncrementExpr* incrementExpr) override;
+
+		Object visit(const DecrementExpr* decrementExpr) override;
+
+		Object visit(const CallExpr* callExpr) override;
+
+		Object visit(const RetrieveExpr* retrieveExpr) override;
+
+		Object visit(const SetExpr* setExpr) override;
+
+		Object visit(const ThisExpr* thisExpr) override;
+
+		Object visit(const SuperExpr* superExpr) override;
+
+		Object visit(const ListExpr* listExpr) override;
+
+		Object visit(const PackExpr* packExpr) override;
+
+	private:
+		struct Local
+		{
+			std::string name;
+			int depth;
+			bool isCaptured;
+		};
+
+		struct UpvalueInfo
+		{
+			uint8_t index;
+			bool isLocal;
+		};
+
+		struct Loop
+		{
+			int scopeDepth;
+			size_t start;
+			std::vector<size_t> breaks;
+			std::vector<size_t> continues;
+		};
+
+		// 每个正在编译的函数对应一个FunctionState，嵌套函数通过enclosing链接
+		struct FunctionState
+		{
+			FunctionState* enclosing{ nullptr };
+			PrototypePtr proto;
+			std::vector<Local> locals;
+			std::vector<UpvalueInfo> upvalues;
+			std::vector<Loop> loops;
+			int scopeDepth{ 0 };
+		};
+
+		// 变量的存取方式
+		struct Variable
+		{
+			OpCode get, set;
+			uint16_t arg;
+		};
+
+	private:
+		void compile(Expr* expr);
+
+		void compile(Stmt* stmt);
+
+		void function(FunctionKind kind, const std::string& name, const std::vector<Token>& params,
+			const std::vector<ExprPtr>& default_values, const std::vector<StmtPtr>& body,
+			std::shared_ptr<const void> source);
+
+		// ++/--，flags见OpCode::INCREMENT
+		void step(const Expr* holder, uint8_t flags);
+
+		Chunk& chunk();
+
+		void emit(OpCode op);
+
+		void emit(OpCode op, uint8_t operand);
+
+		void emitShort(OpCode op, uint16_t operand);
+
+		void emitVariable(OpCode op, uint16_t operand);
+
+		size_t emitJump(OpCode op);
+
+		void patchJump(size_t offset);
+
+		void emitLoop(size_t start);
+
+		uint16_t makeConstant(const Object& value);
+
+		uint16_t makeName(Symbol name);
+
+		void beginScope();
+
+		void endScope();
+
+		// 弹出作用域深度大于depth的局部变量，但不从编译期记录中删除(用于break/continue)
+		void discardLocals(int depth);
+
+		void declareVariable(const std::string& name);
+
+		void defineVariable(const std::string& name);
+
+		Variable resolveVariable(const std::string& name);
+
+		int resolveLocal(FunctionState* state, const std::string& name);
+
+		int resolveUpvalue(FunctionState* state, const std::string& name);
+
+		int addUpvalue(FunctionState* state, uint8_t index, bool isLocal);
+
+		bool isGlobalScope() const;
+
+		[[noreturn]] void error(const std::string& message);
+
+	private:
+		FunctionState* current{ nullptr };
+		bool replEcho{ false };
+
+		// 当前编译节点的位置，写入字节码时一并记录
+		Position* pos_start{ nullptr };
+		Position* pos_end{ nullptr };
+	};
+
+}
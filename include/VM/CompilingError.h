@@ -0,0 +1,12 @@
+#pragma once
+#include "Common/Error.h"
+
+namespace CXX {
+
+    class CompilingError : public Error
+    {
+    public:
+        CompilingError(const Position& start, const Position& end, std::string message);
+    };
+
+}
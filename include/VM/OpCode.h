@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+
+namespace CXX {
+
+	// 字节码指令，注释中标注了操作数(按字节)与栈的变化
+	enum class OpCode : uint8_t
+	{
+		CONSTANT,		// u16 常量下标                  -> value
+		NIL,			//                                -> nil
+		TRUE,			//                                -> true
+		FALSE,			//                                -> false
+		POP,			// value ->
+		DUP,			// a -> a a
+		DUP2,			// a b -> a b a b
+
+		GET_LOCAL,		// u8 slot                        -> value
+		SET_LOCAL,		// u8 slot        value -> value
+		GET_UPVALUE,	// u8 index                       -> value
+		SET_UPVALUE,	// u8 index       value -> value
+		DEFINE_GLOBAL,	// u16 name       value ->
+		GET_GLOBAL,		// u16 name                       -> value
+		SET_GLOBAL,		// u16 name       value -> value
+
+		GET_PROPERTY,	// u16 name       holder -> value
+		SET_PROPERTY,	// u16 name       holder value -> value
+		GET_INDEX,		// holder index -> value
+		SET_INDEX,		// holder index value -> value
+		GET_SUPER,		// u16 name       this -> bound method
+
+		EQUAL,			// a b -> bool
+		NOT_EQUAL,
+		GREATER,
+		GREATER_EQUAL,
+		LESS,
+		LESS_EQUAL,
+		ADD,			// a b -> a+b
+		SUBTRACT,
+		MULTIPLY,
+		DIVIDE,
+		MODULO,
+		NEGATE,			// a -> -a
+		NOT,			// a -> !a
+		TRUTHY,			// a -> bool(a)
+
+		// u8 flags: bit0 自减, bit1 后缀, 高位为holder个数(0~2)
+		// holders... value -> ret holders... new
+		INCREMENT,
+
+		JUMP,			// u16 offset
+		JUMP_IF_FALSE,	// u16 offset     cond ->
+		JUMP_IF_TRUE,	// u16 offset     cond ->
+		LOOP,			// u16 offset
+
+		CALL,			// u8 argc        callee args... -> result
+		INVOKE,			// u16 name, u8 argc   holder args... -> result
+		CLOSURE,		// u16 proto, u8 count, (u8 isLocal, u8 index) * count    defaults... -> closure
+		CLOSE_UPVALUE,	// value ->
+		RETURN,			// value ->
+
+		CLASS,			// u16 name                       -> class
+		INHERIT,		// superclass class ->
+		METHOD,			// u16 name       class closure -> class
+		LIST,			// u16 count      items... -> list
+
+		IMPORT,			// u16 import
+		IMPORT_SYMBOL,	// u16 import, u16 name           -> value
+
+		ECHO			// value ->   (REPL中回显表达式结果)
+	};
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "Common/typedefs.h"
+#include "Interpreter/Object.h"
+#include "Interpreter/Module.h"
+#include "VM/Closure.h"
+
+namespace CXX {
+
+	class ImportStmt;
+
+	// 基于栈的字节码虚拟机
+	// 值栈与调用帧均预先分配，运行中不会重新分配，因此可以放心保存栈上的指针
+	class VM
+	{
+	public:
+		VM();
+
+		void interpret(const std::vector<StmtPtr>& statements, AstArenaPtr arena, bool repl = false);
+
+		// 供内置函数、运算符重载等从C++侧回调字节码函数
+		Object call(Closure* closure, const InstancePtr& receiver, const std::vector<Object>& arguments);
+
+	public:
+		static constexpr size_t FRAMES_MAX = 4096;
+		static constexpr size_t STACK_MAX = FRAMES_MAX * 32;
+
+		// filepath : module
+		std::unordered_map<std::string, std::shared_ptr<Module>> m_modules;
+
+	private:
+		struct CallFrame
+		{
+			Closure* closure;
+			const uint8_t* ip;
+			Object* slots;
+			bool constructing; // 由类调用init，返回值应为实例
+		};
+
+		Object run(size_t exitDepth);
+
+		// 调用栈上的callee，若压入了新的调用帧返回true，否则结果已经留在栈顶
+		bool callValue(const Object& callee, int argc);
+
+		bool callClosure(Closure* closure, int argc, bool constructing = false);
+
+		void callNative(Callable* callable, int argc);
+
+		void invoke(Symbol name, int argc);
+
+		// 列表的成员函数调用，由invoke转交
+		void invokeList(Symbol name, int argc);
+
+		UpvaluePtr captureUpvalue(Object* local);
+
+		void closeUpvalues(Object* last);
+
+		// 释放[newTop, stackTop)的值
+		void discard(Object* newTop);
+
+		void checkArity(Callable* callable, int argc);
+
+		// 报错位置改为span，span为空时不变
+		void locate(const std::pair<Position*, Position*>& span);
+
+		std::shared_ptr<Module> importModule(const ImportStmt* importStmt);
+
+		void reset();
+
+		void push(const Object& value)
+		{
+			if (stackTop == stackEnd)
+				stackOverflow();
+			*stackTop++ = value;
+		}
+
+		void push(Object&& value)
+		{
+			if (stackTop == stackEnd)
+				stackOverflow();
+			*stackTop++ = std::move(value);
+		}
+
+		Object pop()
+		{
+			return std::move(*--stackTop);
+		}
+
+		Object& peek(int distance = 0)
+		{
+			return stackTop[-1 - distance];
+		}
+
+		[[noreturn]] void stackOverflow();
+
+		[[noreturn]] void runtimeError(const std::string& message);
+
+	private:
+		std::vector<Object> stack;
+		Object* stackTop;
+		Object* stackEnd;
+
+		std::vector<CallFrame> frames;
+		size_t frameCount{ 0 };
+
+		UpvaluePtr openUpvalues;
+
+		// 当前调用指令记录的报错位置，见Compiler::visit(CallExpr)
+		// 从C++侧回调时为空，沿用Runner中的位置
+		std::pair<Position*, Position*> calleeSpan, culpritSpan;
+	};
+
+}
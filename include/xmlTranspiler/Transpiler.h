@@ -25,7 +25,7 @@ namespace CXX
 
 		void visit(const VarDeclarationStmt *varStmt) override;
 
-		void visit(std::shared_ptr<FuncDeclarationStmt> funcDeclStmt) override;
+		void visit(FuncDeclarationStmt* funcDeclStmt) override;
 
 		void visit(const ClassDeclarationStmt *classDeclStmt) override;
 
@@ -59,7 +59,7 @@ namespace CXX
 
 		Object visit(const TernaryExpr *ternaryExpr) override;
 
-		Object visit(std::shared_ptr<LambdaExpr> lambdaExpr) override;
+		Object visit(LambdaExpr* lambdaExpr) override;
 
 		Object visit(const OrExpr *orExpr) override;
 
@@ -0,0 +1,39 @@
+# 以三种执行方式运行test_cploxplox/error_position中的用例
+# 输出(包括报错信息与下划线标出的位置)应完全相同
+
+function Invoke-Backend {
+    param (
+        [string]$mode,
+        [string]$file
+    )
+
+    $arguments = @('-f', $file)
+    if ($mode) {
+        $arguments = @($mode) + $arguments
+    }
+
+    # 报错写入stderr，一并收集；报错后等待回车，由管道输入空行结束
+    return ('' | & .\cploxplox.exe @arguments 2>&1 | ForEach-Object { "$_" }) -join "`n"
+}
+
+$failed = 0
+
+Get-ChildItem './test_cploxplox/error_position' -Filter *.lox |
+ForEach-Object {
+    $expected = Invoke-Backend '' $_.FullName
+
+    foreach ($mode in @('--closure', '--vm')) {
+        $actual = Invoke-Backend $mode $_.FullName
+        if ($actual -ne $expected) {
+            Write-Host ("{0} differs under {1}" -f $_.BaseName, $mode) -ForegroundColor Red
+            Write-Host $expected
+            Write-Host $actual
+            $failed++
+        }
+    }
+}
+
+if ($failed -eq 0) {
+    Write-Host "All backends report the same output" -ForegroundColor Green
+}
+Read-Host
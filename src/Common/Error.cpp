@@ -10,20 +10,24 @@ namespace CXX {
 	{
 		std::string result;
 
+		// 行号与列号只在这里才计算
+		int start_row = start.row(), start_col = start.column();
+		int end_row = end.row(), end_col = end.column();
+
 		// indices
-		size_t idx_start = content.rfind('\n', start.index);
+		size_t idx_start = content.rfind('\n', start.index());
 		idx_start = (idx_start == std::string::npos) ? 0 : idx_start;
 		size_t idx_end = content.find('\n', idx_start + 1);
 
 		// Generate Line
-		int line_count = end.row - start.row + 1;
+		int line_count = end_row - start_row + 1;
 		for (int i = 0; i < line_count; i++)
 		{
 			std::string line = content.substr(idx_start, idx_end - idx_start);
 
 			// calculate line column
-			int col_start = i == 0 ? start.column : 0;
-			int col_end = (i == line_count - 1) ? end.column : line.length() - 1;
+			int col_start = i == 0 ? start_col : 0;
+			int col_end = (i == line_count - 1) ? end_col : line.length() - 1;
 
 			// append to result
 			result += line + "\n";
@@ -64,14 +68,18 @@ namespace CXX {
 	void Error::generate_message(const std::string& error_name, const std::string& details)
 	{
 		message = format("%s: %s\n", error_name.c_str(), details.c_str());
-		message += format("File %s, line %s\n\n", this->pos_start.fileName.data(),
-			std::to_string(this->pos_start.row + 1).c_str());
-		message += string_with_arrows(this->pos_start.fileContent.data(), this->pos_start, this->pos_end);
+		const SourceFile& file = this->pos_start.file();
+		message += format("File %s, line %s\n\n", file.name().c_str(),
+			std::to_string(this->pos_start.row() + 1).c_str());
+		message += string_with_arrows(file.content(), this->pos_start, this->pos_end);
 	}
 
 	void ErrorReporter::report(const std::exception& error)
 	{
-		std::cerr << error.what() << "\n";
+		if (captured)
+			captured->push_back(error.what());
+		else
+			std::cerr << error.what() << "\n";
 		errorCount++;
 	}
 
@@ -87,6 +95,19 @@ namespace CXX {
 		return count;
 	}
 
-	int ErrorReporter::errorCount = 0;
+	void ErrorReporter::capture(std::vector<std::string>* messages)
+	{
+		captured = messages;
+	}
+
+	void ErrorReporter::replay(const std::vector<std::string>& messages)
+	{
+		for (const std::string& message : messages)
+			std::cerr << message << "\n";
+		errorCount += (int)messages.size();
+	}
+
+	thread_local int ErrorReporter::errorCount = 0;
+	thread_local std::vector<std::string>* ErrorReporter::captured = nullptr;
 
 }
\ No newline at end of file
@@ -2,32 +2,26 @@
 
 namespace CXX {
 
-    Position::Position(int idx, int line, int col, const std::string& filename, const std::string& ftx) : 
-        index(idx), row(line), column(col),
-        fileName(filename),
-        fileContent(ftx) {}
+    const SourceFile& Position::file() const
+    {
+        return SourceFile::find(offset);
+    }
 
-    Position::Position(const Position& other)
+    int Position::index() const
     {
-        this->column = other.column;
-        this->row = other.row;
-        this->index = other.index;
-        this->fileName = other.fileName;
-        this->fileContent = other.fileContent;
+        return valid() ? (int)(offset - file().base()) : -1;
     }
 
-    void Position::advance(char current_char)
+    int Position::row() const
     {
-        this->index++;
-        this->column++;
+        return valid() ? file().row(index()) : 0;
+    }
 
-        if (current_char == '\n')
-        {
-            this->row++;
-            this->column = 0;
-        }
+    int Position::column() const
+    {
+        return valid() ? file().column(index()) : -1;
     }
 
     const Position Position::preset = Position();
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,76 @@
+#include "Common/SourceFile.h"
+#include <memory>
+#include <algorithm>
+#include <mutex>
+
+namespace CXX {
+
+    // 按base递增排列
+    static std::vector<std::unique_ptr<SourceFile>>& files()
+    {
+        static std::vector<std::unique_ptr<SourceFile>> table;
+        return table;
+    }
+
+    // 导入的模块可能在后台线程中登记
+    static std::mutex& filesMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    SourceFile::SourceFile(std::string name, std::string content, uint32_t base) :
+        m_name(std::move(name)), m_content(std::move(content)), m_base(base) {}
+
+    const SourceFile& SourceFile::add(std::string name, std::string content)
+    {
+        std::lock_guard<std::mutex> lock(filesMutex());
+        auto& table = files();
+
+        uint32_t base = table.empty() ? 1 : table.back()->m_base + (uint32_t)table.back()->m_content.size() + 1;
+        table.push_back(std::make_unique<SourceFile>(std::move(name), std::move(content), base));
+
+        return *table.back();
+    }
+
+    const SourceFile& SourceFile::find(uint32_t offset)
+    {
+        static const SourceFile empty("", "", 0);
+
+        std::lock_guard<std::mutex> lock(filesMutex());
+        auto& table = files();
+        auto it = std::upper_bound(table.begin(), table.end(), offset,
+            [](uint32_t offset, const std::unique_ptr<SourceFile>& file) { return offset < file->m_base; });
+
+        if (offset == 0 || it == table.begin())
+            return empty;
+
+        return **(it - 1);
+    }
+
+    size_t SourceFile::lineOf(size_t index) const
+    {
+        if (lineStarts.empty())
+        {
+            lineStarts.push_back(0);
+            for (size_t i = 0; i < m_content.size(); i++)
+            {
+                if (m_content[i] == '\n')
+                    lineStarts.push_back(i + 1);
+            }
+        }
+
+        return std::upper_bound(lineStarts.begin(), lineStarts.end(), index) - lineStarts.begin() - 1;
+    }
+
+    int SourceFile::row(size_t index) const
+    {
+        return (int)lineOf(index);
+    }
+
+    int SourceFile::column(size_t index) const
+    {
+        return (int)(index - lineStarts[lineOf(index)]);
+    }
+
+}
@@ -0,0 +1,69 @@
+#include "Common/Symbol.h"
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+namespace CXX {
+
+	static std::atomic<bool> shared{ false };
+
+	// 使用函数内静态变量，避免静态对象初始化顺序的问题
+	// deque在尾部插入时已有元素的地址不变，键指向其中的字符串
+	struct SymbolTable
+	{
+		std::deque<std::string> storage;
+		std::unordered_map<std::string_view, const std::string*> table;
+		std::mutex mutex;
+
+		static SymbolTable& instance()
+		{
+			static SymbolTable symbols;
+			return symbols;
+		}
+	};
+
+	const std::string& Symbol::intern(std::string_view str)
+	{
+		// 以string_view为键查找，已驻留的字符串无需构造临时的std::string
+		SymbolTable& symbols = SymbolTable::instance();
+
+		std::unique_lock<std::mutex> lock(symbols.mutex, std::defer_lock);
+		if (shared.load(std::memory_order_relaxed))
+			lock.lock();
+
+		if (auto it = symbols.table.find(str); it != symbols.table.end())
+			return *it->second;
+
+		const std::string& interned = symbols.storage.emplace_back(str);
+		symbols.table.emplace(interned, &interned);
+		return interned;
+	}
+
+	std::optional<Symbol> Symbol::find(std::string_view str)
+	{
+		SymbolTable& symbols = SymbolTable::instance();
+
+		std::unique_lock<std::mutex> lock(symbols.mutex, std::defer_lock);
+		if (shared.load(std::memory_order_relaxed))
+			lock.lock();
+
+		if (auto it = symbols.table.find(str); it != symbols.table.end())
+			return Symbol(it->second);
+
+		return std::nullopt;
+	}
+
+	void Symbol::shareAcrossThreads()
+	{
+		// 须在创建其他线程之前调用，线程的创建保证了其他线程能看到这次写入
+		shared.store(true, std::memory_order_relaxed);
+	}
+
+	const std::string& Symbol::empty()
+	{
+		static const std::string& str = intern(std::string_view());
+		return str;
+	}
+
+}
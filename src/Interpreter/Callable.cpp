@@ -0,0 +1,12 @@
+#include "Interpreter/Callable.h"
+#include "Interpreter/Object.h"
+
+namespace CXX
+{
+
+	Object Callable::invoke(Interpreter &interpreter, const std::shared_ptr<Instance> &receiver, const std::vector<Object> &arguments)
+	{
+		return bindThis(receiver)->call(interpreter, arguments);
+	}
+
+}
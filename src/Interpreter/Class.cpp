@@ -3,11 +3,12 @@
 #include "Interpreter/loxlib/NativeClass.h"
 #include "Common/utils.h"
 #include "Runner.h"
+#include <utility>
 
 namespace CXX
 {
 
-	Class::Class(std::string name, std::unordered_map<std::string, CallablePtr> methods,
+	Class::Class(std::string name, std::unordered_map<Symbol, CallablePtr> methods,
 				 std::optional<std::shared_ptr<Class>> superclass, bool isNative) : Callable(CallableType::CLASS), className(std::move(name)),
 																					methods(std::move(methods)), superClass(std::move(superclass)),
 																					isNative(isNative) {}
@@ -15,9 +16,10 @@ namespace CXX
 	Object Class::call(Interpreter &interpreter, const std::vector<Object> &arguments)
 	{
 		InstancePtr instance = std::make_shared<Instance>(shared_from_this());
-		if (auto initializer = findMethods("init"))
+		static const Symbol initializerName("init");
+		if (auto initializer = findMethods(initializerName))
 		{
-			initializer->bindThis(instance)->call(interpreter, arguments);
+			initializer->invoke(interpreter, instance, arguments);
 		}
 
 		return Object(instance);
@@ -25,7 +27,8 @@ namespace CXX
 
 	int Class::arity()
 	{
-		if (auto initializer = findMethods("init"))
+		static const Symbol initializerName("init");
+		if (auto initializer = findMethods(initializerName))
 		{
 			return initializer->arity();
 		}
@@ -35,7 +38,8 @@ namespace CXX
 
 	size_t Class::required_params()
 	{
-		if (auto initializer = findMethods("init"))
+		static const Symbol initializerName("init");
+		if (auto initializer = findMethods(initializerName))
 		{
 			return initializer->required_params();
 		}
@@ -53,19 +57,13 @@ namespace CXX
 		return className;
 	}
 
-	CallablePtr Class::findMethods(const std::string &name)
+	CallablePtr Class::findMethods(Symbol name)
 	{
-		// reservedMethods是每个类专有的，不要去父类中寻找
-		bool look_in_this = false;
-		if (reservedMethods.find(name) != reservedMethods.end())
-		{
-			look_in_this = true;
-		}
-
-		if (methods.find(name) != methods.end())
-			return methods[name];
+		if (auto it = methods.find(name); it != methods.end())
+			return it->second;
 
-		if (!look_in_this && superClass)
+		// reservedMethods是每个类专有的，不要去父类中寻找
+		if (superClass && reservedMethods.find(name) == reservedMethods.end())
 		{
 			return superClass.value()->findMethods(name);
 		}
@@ -78,12 +76,24 @@ namespace CXX
 		return shared_from_this();
 	}
 
-	Instance::Instance(std::shared_ptr<Class> ClassPtr) : belonging(std::move(ClassPtr))
+	void Class::trace(GarbageCollector &gc) const
+	{
+		for (auto &[_, method] : methods)
+			gc.mark(method);
+
+		if (superClass)
+			gc.mark(superClass.value());
+	}
+
+	Instance::Instance(std::shared_ptr<Class> ClassPtr) : belonging(std::move(ClassPtr)), shape(Shape::root())
 	{
 	}
 
 	Instance::~Instance()
 	{
+		// __del__中的代码不应触发回收，此时实例及其持有者都处于析构的中途
+		GarbageCollector::Pause pause;
+
 		Class *ptr = belonging.get();
 		// 不能在析构函数中调用shared_from_this
 		// 但是调用函数需要绑定实例，所以我们手动shared
@@ -92,11 +102,20 @@ namespace CXX
 							 { ptr = nullptr; });
 
 		// 由子类到父类依次析构
+		static const Symbol destructorName("__del__");
 		do
 		{
-			if (auto destructor = ptr->findMethods("__del__"))
+			if (auto destructor = ptr->findMethods(destructorName))
 			{
-				destructor->bindThis(instance)->call(Runner::interpreter, {});
+				// 析构可能发生在return向外传递的途中，先保存控制流状态
+				Interpreter &interpreter = Runner::interpreter;
+				auto completion = std::exchange(interpreter.completion, Interpreter::Completion::NORMAL);
+				Object returns = std::move(interpreter.m_returns);
+
+				destructor->invoke(interpreter, instance, {});
+
+				interpreter.completion = completion;
+				interpreter.m_returns = std::move(returns);
 			}
 
 			if (ptr->superClass)
@@ -111,33 +130,58 @@ namespace CXX
 		} while (ptr);
 
 		belonging.reset();
-		fields.clear();
+		values.clear();
 	}
 
 	Object Instance::get(const Token &identifier)
 	{
-		const std::string &key = identifier.lexeme;
+		return get(identifier.symbol);
+	}
 
-		auto it = fields.find(key);
-		if (it != fields.end())
-			return it->second;
+	Object Instance::get(Symbol key)
+	{
+		if (Object *value = field(key))
+			return *value;
+
+		return getMethod(key);
+	}
 
-		if (auto method = belonging->findMethods(key))
+	Object *Instance::field(Symbol name, InlineCache &cache)
+	{
+		const Shape *current = shape.get();
+
+		int offset;
+		if (auto entry = cache.find(current))
+			offset = entry->offset;
+		else
 		{
-			CallablePtr bindFunc(method->bindThis(shared_from_this()));
-			return Object(bindFunc);
+			offset = current->lookup(name);
+			cache.update(current, offset);
 		}
 
+		return offset < 0 ? nullptr : &values[offset];
+	}
+
+	Object Instance::getAttr(const std::string &name)
+	{
+		// 没有驻留过的名字不可能是字段或成员函数
+		if (std::optional<Symbol> key = Symbol::find(name))
+			return get(*key);
+
 		return Object();
 	}
 
-	Object Instance::get(const std::string &key)
+	Object Instance::get(Symbol name, InlineCache &cache)
 	{
-		auto it = fields.find(key);
-		if (it != fields.end())
-			return it->second;
+		if (Object *value = field(name, cache))
+			return *value;
+
+		return getMethod(name);
+	}
 
-		if (auto method = belonging->findMethods(key))
+	Object Instance::getMethod(Symbol name)
+	{
+		if (auto method = belonging->findMethods(name))
 		{
 			CallablePtr bindFunc(method->bindThis(shared_from_this()));
 			return Object(bindFunc);
@@ -147,6 +191,11 @@ namespace CXX
 	}
 
 	void Instance::set(const Token &identifier, const Object &val)
+	{
+		set(identifier.symbol, val);
+	}
+
+	void Instance::set(Symbol identifier, const Object &val)
 	{
 		if (belonging->isNative)
 		{
@@ -154,30 +203,69 @@ namespace CXX
 
 			// 内部类只允许设定固定的几个字段(因为自定义的没意义)，并且有类型要求
 			// 我们也不会报错，只是不会真的设定
-			if (ptr->allowedFields.find(identifier.lexeme) == ptr->allowedFields.end())
+			if (ptr->allowedFields.find(identifier) == ptr->allowedFields.end())
 				return;
-			else if (ptr->allowedFields[identifier.lexeme] != val.type)
+			else if (ptr->allowedFields[identifier] != val.type())
 				return;
 		}
 
-		fields[identifier.lexeme] = val;
+		setField(identifier, val);
 	}
 
-	void Instance::set(const std::string &identifier, const Object &val)
+	void Instance::set(Symbol name, const Object &val, InlineCache &cache)
 	{
 		if (belonging->isNative)
 		{
-			auto ptr = std::static_pointer_cast<NativeClass>(belonging);
+			set(name, val);
+			return;
+		}
 
-			// 内部类只允许设定固定的几个字段(因为自定义的没意义)，并且有类型要求
-			// 我们也不会报错，只是不会真的设定
-			if (ptr->allowedFields.find(identifier) == ptr->allowedFields.end())
-				return;
-			else if (ptr->allowedFields[identifier] != val.type)
-				return;
+		const Shape *current = shape.get();
+
+		if (auto entry = cache.find(current))
+		{
+			if (entry->next)
+				appendField(entry->next->shared_from_this(), val);
+			else
+				values[entry->offset] = val;
+			return;
 		}
 
-		fields[identifier] = val;
+		if (int offset = current->lookup(name); offset >= 0)
+		{
+			cache.update(current, offset);
+			values[offset] = val;
+			return;
+		}
+
+		ShapePtr next = shape->transition(name);
+		cache.update(current, (int)next->size() - 1, next.get());
+		appendField(std::move(next), val);
+	}
+
+	void Instance::setField(Symbol name, const Object &val)
+	{
+		if (Object *value = field(name))
+			*value = val;
+		else
+			appendField(shape->transition(name), val);
+	}
+
+	void Instance::trace(GarbageCollector &gc) const
+	{
+		gc.mark(belonging);
+
+		for (auto &value : values)
+			gc.mark(value);
+	}
+
+	void Instance::clear(std::vector<Object> &trash)
+	{
+		for (auto &value : values)
+			trash.push_back(std::move(value));
+
+		values.clear();
+		shape = Shape::root();
 	}
 
 	std::string Instance::to_string()
@@ -194,12 +282,13 @@ namespace CXX
 		// 默认方法将显示实例的所属类与当前拥有字段
 		std::string result = format("<Instance of %s>", belonging->name().c_str());
 
-		if (!fields.empty())
+		if (!values.empty())
 		{
 			result += "\n{\n";
-			for (auto &[name, prop] : fields)
+			const auto &names = shape->fieldNames();
+			for (size_t i = 0; i < values.size(); i++)
 			{
-				result += format("  %s: %s\n", name.c_str(), prop.to_string().c_str());
+				result += format("  %s: %s\n", names[i].c_str(), values[i].to_string().c_str());
 			}
 			result.push_back('}');
 		}
@@ -207,13 +296,14 @@ namespace CXX
 		return result;
 	}
 
-	std::unordered_set<std::string> Class::reservedMethods = {
+	std::unordered_set<Symbol> Class::reservedMethods = {
 		"__add__",	 // +
 		"__sub__",	 // -
 		"__mul__",	 // *
 		"__div__",	 // /
 		"__mod__",	 // %
 		"__equal__", // ==
+		"__hash__",	 // 作为Map的键
 		"__repr__",	 // for print()
 		"__del__"	 // destructor
 	};
@@ -0,0 +1,1079 @@
+#include "Common/utils.h"
+#include "Interpreter/ClosureCompiler.h"
+#include "Interpreter/Interpreter.h"
+#include "Interpreter/Function.h"
+#include "Interpreter/Class.h"
+#include "Interpreter/GarbageCollector.h"
+#include "Interpreter/MetaList.h"
+#include "Interpreter/MetaMap.h"
+#include "Interpreter/MetaFloat64Array.h"
+#include "Interpreter/Specialize.h"
+#include "Interpreter/loxlib/NativeClass.h"
+#include "Runner.h"
+#include <iostream>
+
+namespace CXX {
+
+	using Completion = Interpreter::Completion;
+	using OpType = RetrieveExpr::OpType;
+
+	// 与Interpreter::interpret相同，Runner跟踪当前执行位置
+	static inline void track(Expr* expr)
+	{
+		Runner::pos_start = &expr->pos_start;
+		Runner::pos_end = &expr->pos_end;
+	}
+
+	// 运算出错时指向运算符
+	static inline void track(Token& op)
+	{
+		Runner::pos_start = &op.pos_start;
+		Runner::pos_end = &op.pos_end;
+	}
+
+	// 与Interpreter::execute相同，语句之间是安全的回收时机
+	static inline void enter(Stmt* stmt)
+	{
+		Runner::pos_start = &stmt->pos_start;
+		Runner::pos_end = &stmt->pos_end;
+
+		GarbageCollector::maybeCollect();
+	}
+
+	void ClosureCompiler::run(Interpreter& interpreter, const std::vector<StmtPtr>& statements)
+	{
+		for (auto& stmt : statements)
+		{
+			compile(stmt)(interpreter);
+		}
+	}
+
+	void ClosureCompiler::execute(Interpreter& interpreter, const std::vector<Executor>& body)
+	{
+		for (auto& executor : body)
+		{
+			executor(interpreter);
+
+			if (interpreter.completion != Completion::NORMAL)
+				return;
+		}
+	}
+
+	CompiledBody ClosureCompiler::compile(const std::vector<StmtPtr>& statements)
+	{
+		auto body = std::make_shared<std::vector<Executor>>();
+		body->reserve(statements.size());
+
+		for (auto& stmt : statements)
+			body->push_back(compile(stmt));
+
+		return body;
+	}
+
+	std::vector<Evaluator> ClosureCompiler::compileAll(const std::vector<ExprPtr>& exprs)
+	{
+		std::vector<Evaluator> evaluators;
+		evaluators.reserve(exprs.size());
+
+		for (auto& expr : exprs)
+			evaluators.push_back(compile(expr));
+
+		return evaluators;
+	}
+
+	std::vector<Object> ClosureCompiler::evaluateAll(Interpreter& interpreter, const std::vector<Evaluator>& evaluators)
+	{
+		std::vector<Object> values;
+		values.reserve(evaluators.size());
+
+		for (auto& evaluator : evaluators)
+			values.push_back(evaluator(interpreter));
+
+		return values;
+	}
+
+	Evaluator ClosureCompiler::compile(ExprPtr expr)
+	{
+		switch (expr->exprType)
+		{
+		case ExprType::Binary:
+			return compileBinary(expr);
+
+		case ExprType::Unary:
+		{
+			auto unary = static_cast<UnaryExpr*>(expr);
+			Evaluator operand = compile(unary->expr);
+
+			if (unary->op.type == TokenType::MINUS)
+				return [unary, operand](Interpreter& interpreter)
+				{
+					track(unary);
+					Object value = operand(interpreter);
+					track(unary->op);
+					return -value;
+				};
+
+			if (unary->op.type == TokenType::BANG)
+				return [unary, operand](Interpreter& interpreter)
+				{
+					track(unary);
+					Object value = operand(interpreter);
+					track(unary->op);
+					return !value;
+				};
+
+			return [unary, operand](Interpreter& interpreter) -> Object
+			{
+				track(unary);
+				operand(interpreter);
+				throw RuntimeError(unary->pos_start, unary->pos_end, "Invalid Binary operand");
+			};
+		}
+
+		case ExprType::Literal:
+		{
+			auto literal = static_cast<LiteralExpr*>(expr);
+			return [literal, value = literal->value](Interpreter&)
+			{
+				track(literal);
+				return value;
+			};
+		}
+
+		case ExprType::Variable:
+			return compileVariable(expr);
+
+		case ExprType::Assignment:
+			return compileAssignment(expr);
+
+		case ExprType::Ternary:
+		{
+			auto ternary = static_cast<TernaryExpr*>(expr);
+			Evaluator check = compile(ternary->expr);
+			Evaluator thenBranch = compile(ternary->thenBranch);
+			Evaluator elseBranch = compile(ternary->elseBranch);
+
+			return [ternary, check, thenBranch, elseBranch](Interpreter& interpreter)
+			{
+				track(ternary);
+				return check(interpreter).is_true() ? thenBranch(interpreter) : elseBranch(interpreter);
+			};
+		}
+
+		case ExprType::Or:
+		{
+			auto orExpr = static_cast<OrExpr*>(expr);
+			Evaluator left = compile(orExpr->left), right = compile(orExpr->right);
+
+			return [orExpr, left, right](Interpreter& interpreter)
+			{
+				track(orExpr);
+				if (left(interpreter).is_true())
+					return Object(true);
+
+				return Object(right(interpreter).is_true());
+			};
+		}
+
+		case ExprType::And:
+		{
+			auto andExpr = static_cast<AndExpr*>(expr);
+			Evaluator left = compile(andExpr->left), right = compile(andExpr->right);
+
+			return [andExpr, left, right](Interpreter& interpreter)
+			{
+				track(andExpr);
+				if (!left(interpreter).is_true())
+					return Object(false);
+
+				return Object(right(interpreter).is_true());
+			};
+		}
+
+		case ExprType::Increment:
+		{
+			auto increment = static_cast<IncrementExpr*>(expr);
+			return compileStep(expr, increment->holder, increment->type == IncrementExpr::Type::POSTFIX, 1.0);
+		}
+
+		case ExprType::Decrement:
+		{
+			auto decrement = static_cast<DecrementExpr*>(expr);
+			return compileStep(expr, decrement->holder, decrement->type == DecrementExpr::Type::POSTFIX, -1.0);
+		}
+
+		case ExprType::Call:
+			return compileCall(expr);
+
+		case ExprType::Retrieve:
+			return compileRetrieve(expr);
+
+		case ExprType::Set:
+			return compileSet(expr);
+
+		case ExprType::This:
+		{
+			auto thisExpr = static_cast<ThisExpr*>(expr);
+			return [thisExpr](Interpreter& interpreter)
+			{
+				track(thisExpr);
+				return interpreter.lookupVariable(thisExpr->keyword, thisExpr->depth, thisExpr->slot);
+			};
+		}
+
+		case ExprType::Super:
+		{
+			auto superExpr = static_cast<SuperExpr*>(expr);
+			return [superExpr](Interpreter& interpreter)
+			{
+				track(superExpr);
+				return interpreter.visit(superExpr);
+			};
+		}
+
+		case ExprType::Lambda:
+		{
+			auto lambda = static_cast<LambdaExpr*>(expr);
+			CompiledBody body = compile(lambda->body);
+			std::vector<Evaluator> defaults = compileAll(lambda->default_values);
+
+			return [lambda, body, defaults](Interpreter& interpreter)
+			{
+				track(lambda);
+				auto function = std::make_shared<LambdaFunction>(lambda, evaluateAll(interpreter, defaults), interpreter.context);
+				function->compiled = body;
+				return Object(std::move(function));
+			};
+		}
+
+		case ExprType::List:
+		{
+			auto list = static_cast<ListExpr*>(expr);
+			std::vector<Evaluator> items = compileAll(list->items);
+
+			return [list, items](Interpreter& interpreter)
+			{
+				track(list);
+				return Object(List::instantiate(evaluateAll(interpreter, items)));
+			};
+		}
+
+		case ExprType::Pack:
+		{
+			auto pack = static_cast<PackExpr*>(expr);
+			std::vector<Evaluator> expressions = compileAll(pack->expressions);
+
+			// 对于用','分隔的一整句，返回最后一个值
+			return [pack, expressions](Interpreter& interpreter)
+			{
+				track(pack);
+				Object ret;
+				for (auto& evaluator : expressions)
+					ret = evaluator(interpreter);
+
+				return ret;
+			};
+		}
+		}
+
+		return [expr](Interpreter& interpreter) { return interpreter.interpret(expr); };
+	}
+
+	Evaluator ClosureCompiler::compileBinary(ExprPtr expr)
+	{
+		auto binary = static_cast<BinaryExpr*>(expr);
+		Evaluator left = compile(binary->left), right = compile(binary->right);
+
+		// 运算符在编译时确定，每种运算生成各自的闭包，两侧均为数字时直接计算
+		NumberOp numberOp = numberOperator(binary->op.type);
+
+		// 静态推断出两侧类型时省去类型检查
+		StaticType lhsType = binary->left->staticType, rhsType = binary->right->staticType;
+		if (numberOp && lhsType == StaticType::NUMBER && rhsType == StaticType::NUMBER)
+			return compileNumberBinary(binary, left, right, numberOp);
+		if (lhsType == StaticType::STRING && rhsType == StaticType::STRING)
+		{
+			if (Evaluator evaluator = compileStringBinary(binary, left, right))
+				return evaluator;
+		}
+
+#define BINARY_CLOSURE(operation)                                              \
+	[binary, left, right, numberOp](Interpreter& interpreter)                   \
+	{                                                                            \
+		track(binary);                                                           \
+		Object lhs = left(interpreter), rhs = right(interpreter);                \
+		track(binary->op);                                                       \
+		if (lhs.isNumber() && rhs.isNumber())                                    \
+			return numberOp(lhs.asNumber(), rhs.asNumber());                   \
+		return Object(operation);                                                \
+	}
+
+		switch (binary->op.type)
+		{
+		case TokenType::PLUS:
+			return BINARY_CLOSURE(lhs + rhs);
+		case TokenType::MINUS:
+			return BINARY_CLOSURE(lhs - rhs);
+		case TokenType::MUL:
+			return BINARY_CLOSURE(lhs * rhs);
+		case TokenType::DIV:
+			return BINARY_CLOSURE(lhs / rhs);
+		case TokenType::MOD:
+			return BINARY_CLOSURE(lhs % rhs);
+		case TokenType::GT:
+			return BINARY_CLOSURE(lhs > rhs);
+		case TokenType::GTE:
+			return BINARY_CLOSURE(lhs >= rhs);
+		case TokenType::LT:
+			return BINARY_CLOSURE(lhs < rhs);
+		case TokenType::LTE:
+			return BINARY_CLOSURE(lhs <= rhs);
+		case TokenType::EQEQ:
+			return BINARY_CLOSURE(lhs == rhs);
+		case TokenType::BANGEQ:
+			return BINARY_CLOSURE(lhs != rhs);
+		default:
+			return [binary, left, right](Interpreter& interpreter) -> Object
+			{
+				track(binary);
+				left(interpreter);
+				right(interpreter);
+				throw RuntimeError(binary->pos_start, binary->pos_end, "Invalid Binary operand");
+			};
+		}
+
+#undef BINARY_CLOSURE
+	}
+
+	Evaluator ClosureCompiler::compileNumberBinary(BinaryExpr* binary, Evaluator left, Evaluator right, NumberOp numberOp)
+	{
+#define NUMBER_CLOSURE(operation)                                                         \
+	[binary, left, right](Interpreter& interpreter)                                        \
+	{                                                                                      \
+		track(binary);                                                                     \
+		double lhs = left(interpreter).asNumber(), rhs = right(interpreter).asNumber(); \
+		return Object(operation);                                                          \
+	}
+
+		switch (binary->op.type)
+		{
+		case TokenType::PLUS:
+			return NUMBER_CLOSURE(lhs + rhs);
+		case TokenType::MINUS:
+			return NUMBER_CLOSURE(lhs - rhs);
+		case TokenType::MUL:
+			return NUMBER_CLOSURE(lhs * rhs);
+		case TokenType::GT:
+			return NUMBER_CLOSURE(lhs > rhs);
+		case TokenType::GTE:
+			return NUMBER_CLOSURE(lhs >= rhs);
+		case TokenType::LT:
+			return NUMBER_CLOSURE(lhs < rhs);
+		case TokenType::LTE:
+			return NUMBER_CLOSURE(lhs <= rhs);
+		case TokenType::EQEQ:
+			return NUMBER_CLOSURE(lhs == rhs);
+		case TokenType::BANGEQ:
+			return NUMBER_CLOSURE(lhs != rhs);
+		default:
+			// 除法与取余需检查除数
+			return [binary, left, right, numberOp](Interpreter& interpreter)
+			{
+				track(binary);
+				double lhs = left(interpreter).asNumber(), rhs = right(interpreter).asNumber();
+				track(binary->op);
+				return numberOp(lhs, rhs);
+			};
+		}
+
+#undef NUMBER_CLOSURE
+	}
+
+	Evaluator ClosureCompiler::compileStringBinary(BinaryExpr* binary, Evaluator left, Evaluator right)
+	{
+#define STRING_CLOSURE(operation)                                          \
+	[binary, left, right](Interpreter& interpreter)                         \
+	{                                                                       \
+		track(binary);                                                      \
+		Object lhsObj = left(interpreter), rhsObj = right(interpreter);     \
+		const std::string &lhs = lhsObj.getString(), &rhs = rhsObj.getString(); \
+		return Object(operation);                                           \
+	}
+
+		switch (binary->op.type)
+		{
+		case TokenType::PLUS:
+			return STRING_CLOSURE(lhs + rhs);
+		case TokenType::GT:
+			return STRING_CLOSURE(lhs > rhs);
+		case TokenType::GTE:
+			return STRING_CLOSURE(lhs >= rhs);
+		case TokenType::LT:
+			return STRING_CLOSURE(lhs < rhs);
+		case TokenType::LTE:
+			return STRING_CLOSURE(lhs <= rhs);
+		default:
+			// ==与!=对驻留字符串有指针比较的捷径，仍走通用路径
+			return nullptr;
+		}
+
+#undef STRING_CLOSURE
+	}
+
+	Evaluator ClosureCompiler::compileVariable(ExprPtr expr)
+	{
+		auto variable = static_cast<VariableExpr*>(expr);
+
+		auto check = [variable](Object& var) -> Object&
+		{
+			if (&var == &Object::Nil())
+			{
+				throw RuntimeError(variable->identifier.pos_start, variable->identifier.pos_end,
+					format("Undefined variable %s", variable->identifier.symbol.c_str()));
+			}
+
+			return var;
+		};
+
+		// 查找方式由Resolver的结果决定：槽位、具名的局部变量或全局变量
+		if (variable->depth == -1)
+			return [variable, check](Interpreter& interpreter)
+			{
+				track(variable);
+				return check(interpreter.globalContext->get(variable->identifier.symbol));
+			};
+
+		if (variable->slot != -1)
+			return [variable, check, depth = variable->depth, slot = variable->slot](Interpreter& interpreter)
+			{
+				track(variable);
+				return check(interpreter.context->getAt(depth, slot));
+			};
+
+		return [variable, check](Interpreter& interpreter)
+		{
+			track(variable);
+			return check(interpreter.context->getAt(variable->depth, variable->identifier));
+		};
+	}
+
+	Evaluator ClosureCompiler::compileAssignment(ExprPtr expr)
+	{
+		auto assignment = static_cast<AssignmentExpr*>(expr);
+		Evaluator value = compile(assignment->value);
+
+		return [assignment, value](Interpreter& interpreter)
+		{
+			track(assignment);
+
+			Object& var = interpreter.lookupVariable(assignment->identifier, assignment->depth, assignment->slot);
+			if (&var == &Object::Nil())
+			{
+				throw RuntimeError(assignment->identifier.pos_start, assignment->value->pos_end,
+					format("Undefined variable %s", assignment->identifier.symbol.c_str()));
+			}
+
+			Object result = interpreter.handleAssign(var, value(interpreter), assignment->operation.type);
+			var = result;
+			return result;
+		};
+	}
+
+	Evaluator ClosureCompiler::compileStep(ExprPtr expr, ExprPtr holder, bool postfix, double delta)
+	{
+		Expr* step = expr;
+		Evaluator current = compile(holder);
+		const char* op = delta > 0 ? "++" : "--";
+
+		// 写回的位置在编译时确定
+		std::function<void(Interpreter&, const Object&)> store;
+		if (holder->exprType == ExprType::Variable)
+		{
+			auto var = static_cast<VariableExpr*>(holder);
+			store = [var](Interpreter& interpreter, const Object& result)
+			{
+				interpreter.lookupVariable(var->identifier, var->depth, var->slot) = result;
+			};
+		}
+		else
+		{
+			auto retrieve = static_cast<RetrieveExpr*>(holder);
+			Evaluator object = compile(retrieve->holder);
+			Evaluator index = retrieve->index ? compile(retrieve->index) : Evaluator();
+
+			store = [retrieve, object, index](Interpreter& interpreter, const Object& result)
+			{
+				Object holder = object(interpreter);
+				MetaMap* map = retrieve->type == OpType::BRACKET ? asMap(holder) : nullptr;
+				MetaFloat64Array* array = retrieve->type == OpType::BRACKET ? asFloat64Array(holder) : nullptr;
+				if (map)
+					map->set(index(interpreter), result);
+				else if (array)
+				{
+					Object i = index(interpreter);
+					if (!i.isNumber())
+						throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Index should be a number");
+
+					array->at((int)i.getNumber()) = result.getNumber();
+				}
+				else if (holder.isList() && retrieve->type == OpType::BRACKET)
+				{
+					Object i = index(interpreter);
+					if (!i.isNumber())
+						throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Index should be a number");
+
+					interpreter.listAt(holder, i) = result;
+				}
+				else if (holder.isInstance())
+				{
+					if (retrieve->type == OpType::DOT)
+						holder.getInstance()->set(retrieve->identifier, result);
+					else
+					{
+						Object attr = index(interpreter);
+						if (!attr.isString())
+							throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Attr should be a string");
+						holder.getInstance()->set(Symbol(attr.getString()), result);
+					}
+				}
+			};
+		}
+
+		return [step, holder = holder, current, store, postfix, delta, op](Interpreter& interpreter)
+		{
+			track(step);
+
+			Object prev = current(interpreter);
+			if (!prev.isNumber())
+				throw RuntimeError(holder->pos_start, holder->pos_end,
+					format("Operator '%s' does not support type(%s)", op, ObjectTypeName(prev.type())));
+
+			Object result = prev + Object(delta);
+			store(interpreter, result);
+
+			return postfix ? prev : result;
+		};
+	}
+
+	Evaluator ClosureCompiler::compileCall(ExprPtr expr)
+	{
+		auto call = static_cast<CallExpr*>(expr);
+
+		if (call->callee->exprType == ExprType::Retrieve &&
+			static_cast<RetrieveExpr*>(call->callee)->type == OpType::DOT)
+			return compileInvoke(expr);
+
+		Evaluator callee = compile(call->callee);
+		std::vector<Evaluator> arguments = compileAll(call->arguments);
+
+		return [call, callee, arguments](Interpreter& interpreter)
+		{
+			track(call);
+
+			Object function = callee(interpreter);
+			if (!function.isCallable())
+				throw RuntimeError(call->callee->pos_start, call->callee->pos_end, "Expression is not callable");
+
+			return interpreter.apply(call, function.getCallable(), nullptr, evaluateAll(interpreter, arguments));
+		};
+	}
+
+	Evaluator ClosureCompiler::compileInvoke(ExprPtr expr)
+	{
+		auto call = static_cast<CallExpr*>(expr);
+		auto retrieve = static_cast<RetrieveExpr*>(call->callee);
+		Evaluator object = compile(retrieve->holder);
+		std::vector<Evaluator> arguments = compileAll(call->arguments);
+
+		return [call, retrieve, object, arguments](Interpreter& interpreter)
+		{
+			track(call);
+
+			Object holder = object(interpreter);
+
+			// 列表没有字段，直接在List的成员函数中查找
+			if (holder.isList())
+			{
+				CallablePtr method = List::getSingleton()->findMethods(retrieve->identifier.symbol);
+				if (!method)
+					throw RuntimeError(call->callee->pos_start, call->callee->pos_end, "Expression is not callable");
+
+				return interpreter.apply(call, method, &holder, evaluateAll(interpreter, arguments));
+			}
+
+			if (!holder.isInstance())
+			{
+				throw RuntimeError(retrieve->pos_start, retrieve->pos_end,
+					format("Cannot apply . to object type(%s)", ObjectTypeName(holder.type())));
+			}
+
+			const InstancePtr& instance = holder.getInstance();
+
+			// 字段优先于成员函数，字段中存放的函数按普通函数调用
+			if (Object* field = instance->field(retrieve->identifier.symbol, retrieve->cache))
+			{
+				Object callee = *field;
+				if (!callee.isCallable())
+					throw RuntimeError(call->callee->pos_start, call->callee->pos_end, "Expression is not callable");
+
+				return interpreter.apply(call, callee.getCallable(), nullptr, evaluateAll(interpreter, arguments));
+			}
+
+			CallablePtr method = instance->belonging->findMethods(retrieve->identifier.symbol);
+			if (!method)
+				throw RuntimeError(call->callee->pos_start, call->callee->pos_end, "Expression is not callable");
+
+			return interpreter.apply(call, method, &holder, evaluateAll(interpreter, arguments));
+		};
+	}
+
+	Evaluator ClosureCompiler::compileRetrieve(ExprPtr expr)
+	{
+		auto retrieve = static_cast<RetrieveExpr*>(expr);
+		Evaluator object = compile(retrieve->holder);
+
+		if (retrieve->type == OpType::DOT)
+			return [retrieve, object](Interpreter& interpreter)
+			{
+				track(retrieve);
+
+				Object holder = object(interpreter);
+				if (holder.isList())
+					return List::getMethod(holder, retrieve->identifier.symbol);
+
+				if (!holder.isInstance())
+					throw RuntimeError(retrieve->pos_start, retrieve->pos_end,
+						format("Cannot apply . to object type(%s)", ObjectTypeName(holder.type())));
+
+				return holder.getInstance()->get(retrieve->identifier.symbol, retrieve->cache);
+			};
+
+		Evaluator index = compile(retrieve->index);
+
+		return [retrieve, object, index](Interpreter& interpreter)
+		{
+			track(retrieve);
+
+			Object holder = object(interpreter);
+			if (MetaList* list = asList(holder))
+			{
+				Object i = index(interpreter);
+				if (!i.isNumber())
+					throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Index should be a number");
+
+				return list->at((int)i.getNumber());
+			}
+			else if (MetaMap* map = asMap(holder))
+			{
+				// 不存在的键与不存在的属性一样返回nil
+				Object* value = map->find(index(interpreter));
+				return value ? *value : Object();
+			}
+			else if (MetaFloat64Array* array = asFloat64Array(holder))
+			{
+				Object i = index(interpreter);
+				if (!i.isNumber())
+					throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Index should be a number");
+
+				return Object(array->at((int)i.getNumber()));
+			}
+			else if (holder.isList())
+			{
+				Object i = index(interpreter);
+				if (!i.isNumber())
+					throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Index should be a number");
+
+				return interpreter.listAt(holder, i);
+			}
+			else if (holder.isInstance())
+			{
+				Object attr = index(interpreter);
+				if (!attr.isString())
+					throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "attribute should be a string");
+
+				return holder.getInstance()->getAttr(attr.getString());
+			}
+
+			throw RuntimeError(retrieve->pos_start, retrieve->pos_end,
+				format("Cannot apply [] to object type(%s)", ObjectTypeName(holder.type())));
+		};
+	}
+
+	Evaluator ClosureCompiler::compileSet(ExprPtr expr)
+	{
+		auto set = static_cast<SetExpr*>(expr);
+		Evaluator object = compile(set->holder);
+		Evaluator value = compile(set->value);
+		TokenType operation = set->operation.type;
+
+		if (set->type == OpType::DOT)
+			return [set, object, value, operation](Interpreter& interpreter)
+			{
+				track(set);
+
+				Object holder = object(interpreter);
+				if (!holder.isInstance())
+					throw RuntimeError(set->pos_start, set->pos_end,
+						format("Cannot apply . to object type(%s)", ObjectTypeName(holder.type())));
+
+				const InstancePtr& instance = holder.getInstance();
+
+				// 只有复合赋值才需要旧值
+				Object prev;
+				if (operation != TokenType::EQ)
+					prev = instance->get(set->identifier);
+
+				Object result = interpreter.handleAssign(prev, value(interpreter), operation);
+				instance->set(set->identifier.symbol, result, set->cache);
+				return result;
+			};
+
+		Evaluator index = compile(set->index);
+
+		return [set, object, index, value, operation](Interpreter& interpreter)
+		{
+			track(set);
+
+			Object holder = object(interpreter);
+
+			// Map与List同样是实例，须先于普通实例判断
+			if (MetaMap* map = asMap(holder))
+			{
+				Object key = index(interpreter);
+
+				// 只有复合赋值才需要旧值
+				Object prev;
+				if (operation != TokenType::EQ)
+				{
+					if (Object* found = map->find(key))
+						prev = *found;
+				}
+
+				Object result = interpreter.handleAssign(prev, value(interpreter), operation);
+				map->set(key, result);
+				return result;
+			}
+			else if (MetaFloat64Array* array = asFloat64Array(holder))
+			{
+				Object i = index(interpreter);
+				if (!i.isNumber())
+					throw RuntimeError(set->index->pos_start, set->index->pos_end, "Index should be a number");
+
+				// 先检查下标，再对右侧求值
+				Object prev(array->at((int)i.getNumber()));
+				Object result = interpreter.handleAssign(prev, value(interpreter), operation);
+				if (!result.isNumber())
+					throw RuntimeError(set->value->pos_start, set->value->pos_end, "Float64Array can only hold numbers");
+
+				array->at((int)i.getNumber()) = result.getNumber();
+				return result;
+			}
+			else if (holder.isList())
+			{
+				Object i = index(interpreter);
+				if (!i.isNumber())
+					throw RuntimeError(set->index->pos_start, set->index->pos_end, "Index should be a number");
+
+				Object& prev = interpreter.listAt(holder, i);
+				Object result = interpreter.handleAssign(prev, value(interpreter), operation);
+				prev = result;
+				return result;
+			}
+			else if (holder.isInstance())
+			{
+				const InstancePtr& instance = holder.getInstance();
+
+				Object attr = index(interpreter);
+				if (!attr.isString())
+					throw RuntimeError(set->index->pos_start, set->index->pos_end, "Attribute should be a string");
+
+				Symbol name(attr.getString());
+				Object prev = instance->get(name);
+				Object result = interpreter.handleAssign(prev, value(interpreter), operation);
+				instance->set(name, result);
+				return result;
+			}
+
+			throw RuntimeError(set->pos_start, set->pos_end,
+				format("Cannot apply [] to object type(%s)", ObjectTypeName(holder.type())));
+		};
+	}
+
+	Executor ClosureCompiler::compile(StmtPtr stmt)
+	{
+		switch (stmt->stmtType)
+		{
+		case StmtType::Expression:
+		{
+			auto expression = static_cast<ExpressionStmt*>(stmt);
+			Evaluator evaluator = compile(expression->expr);
+
+			return [expression, evaluator](Interpreter& interpreter)
+			{
+				enter(expression);
+
+				Object result = evaluator(interpreter);
+				if (interpreter.replEcho && !result.isNil())
+					std::cout << result.to_string() << "\n";
+			};
+		}
+
+		case StmtType::VarDecl:
+		{
+			auto var = static_cast<VarDeclarationStmt*>(stmt);
+			if (!var->expr)
+				return [var](Interpreter& interpreter)
+				{
+					enter(var);
+					interpreter.define(var->identifier, var->slot, Object::Nil());
+				};
+
+			Evaluator initializer = compile(var->expr.value());
+			return [var, initializer](Interpreter& interpreter)
+			{
+				enter(var);
+				interpreter.define(var->identifier, var->slot, initializer(interpreter));
+			};
+		}
+
+		case StmtType::FuncDecl:
+			return compileFunction(stmt);
+
+		case StmtType::ClassDecl:
+			return compileClass(stmt);
+
+		case StmtType::Block:
+		{
+			auto block = static_cast<BlockStmt*>(stmt);
+			CompiledBody body = compile(block->statements);
+
+			return [block, body](Interpreter& interpreter)
+			{
+				enter(block);
+
+				// 循环体，判断语句的输出控制
+				auto task = interpreter.toggleRepl();
+
+				ScopedContext scope(interpreter.context, std::make_shared<Context>(interpreter.context, block->localCount));
+				execute(interpreter, *body);
+			};
+		}
+
+		case StmtType::If:
+		{
+			auto ifStmt = static_cast<IfStmt*>(stmt);
+			Evaluator condition = compile(ifStmt->condition);
+			Executor thenBranch = compile(ifStmt->thenBranch);
+			Executor elseBranch = ifStmt->elseBranch ? compile(ifStmt->elseBranch.value()) : Executor();
+
+			return [ifStmt, condition, thenBranch, elseBranch](Interpreter& interpreter)
+			{
+				enter(ifStmt);
+
+				if (condition(interpreter).is_true())
+					thenBranch(interpreter);
+				else if (elseBranch)
+					elseBranch(interpreter);
+			};
+		}
+
+		case StmtType::While:
+		{
+			auto whileStmt = static_cast<WhileStmt*>(stmt);
+			Evaluator condition = compile(whileStmt->condition);
+			Executor body = compile(whileStmt->body);
+
+			return [whileStmt, condition, body](Interpreter& interpreter)
+			{
+				enter(whileStmt);
+
+				while (condition(interpreter).is_true())
+				{
+					body(interpreter);
+
+					if (interpreter.completion != Completion::NORMAL && interpreter.loopExit())
+						return;
+				}
+			};
+		}
+
+		case StmtType::For:
+			return compileFor(stmt);
+
+		case StmtType::Break:
+			return [breakStmt = stmt](Interpreter& interpreter)
+			{
+				enter(breakStmt);
+				interpreter.completion = Completion::BREAK;
+			};
+
+		case StmtType::Continue:
+			return [continueStmt = stmt](Interpreter& interpreter)
+			{
+				enter(continueStmt);
+				interpreter.completion = Completion::CONTINUE;
+			};
+
+		case StmtType::Return:
+		{
+			auto returnStmt = static_cast<ReturnStmt*>(stmt);
+			Evaluator value = returnStmt->expr ? compile(returnStmt->expr.value()) : Evaluator();
+
+			return [returnStmt, value](Interpreter& interpreter)
+			{
+				enter(returnStmt);
+
+				interpreter.m_returns = value ? value(interpreter) : Object();
+				interpreter.completion = Completion::RETURN;
+			};
+		}
+
+		case StmtType::Import:
+		{
+			// 导入只在首次执行时加载模块，模块代码由loadModule编译
+			auto importStmt = static_cast<ImportStmt*>(stmt);
+			return [importStmt](Interpreter& interpreter)
+			{
+				enter(importStmt);
+				interpreter.visit(importStmt);
+			};
+		}
+
+		case StmtType::Pack:
+		{
+			auto pack = static_cast<PackStmt*>(stmt);
+			CompiledBody body = compile(pack->statements);
+
+			return [pack, body](Interpreter& interpreter)
+			{
+				enter(pack);
+				for (auto& executor : *body)
+					executor(interpreter);
+			};
+		}
+		}
+
+		return [stmt](Interpreter& interpreter) { interpreter.execute(stmt); };
+	}
+
+	Executor ClosureCompiler::compileFunction(StmtPtr stmt)
+	{
+		auto declaration = static_cast<FuncDeclarationStmt*>(stmt);
+		CompiledBody body = compileBody(declaration);
+		std::vector<Evaluator> defaults = compileAll(declaration->default_values);
+
+		return [declaration, body, defaults](Interpreter& interpreter)
+		{
+			enter(declaration);
+
+			auto function = std::make_shared<Function>(Object::Nil(), declaration, evaluateAll(interpreter, defaults),
+				interpreter.context, nullptr);
+			function->compiled = body;
+			interpreter.define(declaration->name, declaration->slot, Object(std::move(function)));
+		};
+	}
+
+	CompiledBody ClosureCompiler::compileBody(FuncDeclarationStmt* declaration)
+	{
+		if (!declaration->lazy)
+			return compile(declaration->body);
+
+		// Function::execute在执行函数体之前已将其补全
+		auto compiled = std::make_shared<CompiledBody>();
+		std::vector<Executor> trampoline{ [declaration, compiled](Interpreter& interpreter)
+		{
+			if (!*compiled)
+				*compiled = compile(declaration->body);
+
+			execute(interpreter, **compiled);
+		} };
+
+		return std::make_shared<const std::vector<Executor>>(std::move(trampoline));
+	}
+
+	Executor ClosureCompiler::compileClass(StmtPtr stmt)
+	{
+		struct Method
+		{
+			FuncDeclarationStmt* declaration;
+			CompiledBody body;
+			std::vector<Evaluator> defaults;
+		};
+
+		auto classDecl = static_cast<ClassDeclarationStmt*>(stmt);
+		Evaluator superClass = classDecl->superClass ? compile(classDecl->superClass.value()) : Evaluator();
+
+		std::vector<Method> methods;
+		for (auto& method : classDecl->methods)
+			methods.push_back({ method, compileBody(method), compileAll(method->default_values) });
+
+		return [classDecl, superClass, methods](Interpreter& interpreter)
+		{
+			enter(classDecl);
+
+			// 先声明，再赋值，允许类内函数调用该类
+			interpreter.define(classDecl->name, classDecl->slot, Object::Nil());
+
+			std::optional<std::shared_ptr<Class>> super;
+			if (superClass)
+			{
+				Object superclassObject = superClass(interpreter);
+				if (!superclassObject.isCallable() || superclassObject.getCallable()->type != Callable::CallableType::CLASS)
+				{
+					throw RuntimeError(classDecl->superClass.value()->pos_start, classDecl->superClass.value()->pos_end,
+						"SuperClass must be a Class");
+				}
+
+				super = std::static_pointer_cast<Class>(superclassObject.getCallable());
+			}
+
+			std::unordered_map<Symbol, CallablePtr> table;
+			std::shared_ptr<Class> classPtr = std::make_shared<Class>(classDecl->name.symbol.str(), table, std::move(super));
+			Object& classObject = interpreter.define(classDecl->name, classDecl->slot, Object(classPtr));
+
+			if (!methods.empty())
+			{
+				for (auto& method : methods)
+				{
+					auto function = std::make_shared<Function>(classObject, method.declaration,
+						evaluateAll(interpreter, method.defaults), interpreter.context, nullptr);
+					function->compiled = method.body;
+					table[method.declaration->name.symbol] = std::move(function);
+				}
+				classPtr->methods = std::move(table);
+			}
+		};
+	}
+
+	Executor ClosureCompiler::compileFor(StmtPtr stmt)
+	{
+		auto forStmt = static_cast<ForStmt*>(stmt);
+		Executor initializer = forStmt->initializer ? compile(forStmt->initializer.value()) : Executor();
+		Evaluator condition = forStmt->condition ? compile(forStmt->condition.value()) : Evaluator();
+		Evaluator increment = forStmt->increment ? compile(forStmt->increment.value()) : Evaluator();
+		Executor body = compile(forStmt->body);
+
+		return [forStmt, initializer, condition, increment, body](Interpreter& interpreter)
+		{
+			enter(forStmt);
+
+			// for循环内是一个新的变量环境
+			ScopedContext scoped(interpreter.context, std::make_shared<Context>(interpreter.context, forStmt->localCount));
+
+			if (initializer)
+				initializer(interpreter);
+
+			while (!condition || condition(interpreter).is_true())
+			{
+				body(interpreter);
+
+				if (interpreter.completion != Completion::NORMAL && interpreter.loopExit())
+					return;
+
+				if (increment)
+					increment(interpreter);
+			}
+		};
+	}
+
+}
@@ -3,7 +3,7 @@
 
 namespace CXX {
 
-	Context::Context(ContextPtr parent) : parent(std::move(parent)) {}
+	Context::Context(ContextPtr parent, size_t size) : parent(std::move(parent)), slots(size) {}
 
 	Context::~Context()
 	{
@@ -12,88 +12,47 @@ namespace CXX {
 
 	void Context::set(const Token& identifier, const Object& val)
 	{
-		variables[identifier.lexeme] = val;
+		variables[identifier.symbol] = val;
 	}
 
-	void Context::set(const std::string& key, const Object& val)
+	void Context::set(Symbol key, const Object& val)
 	{
 		variables[key] = val;
 	}
 
-	void Context::change(const Token& identifier, const Object& val)
+	Object& Context::get(const Token& identifier)
 	{
-		const std::string& key = identifier.lexeme;
-
-		auto it = variables.find(key);
-		if (it != variables.end())
-		{
-			it->second = val;
-			return;
-		}
-
-		if (parent != nullptr)
-		{
-			parent->change(identifier, val);
-		}
+		return get(identifier.symbol);
 	}
 
-	void Context::changeAt(const Token& identifier, const Object& val, int distance)
+	Object& Context::get(Symbol key)
 	{
-		Context* ptr = ancestor(distance);
-
-		const std::string& key = identifier.lexeme;
-
-		auto it = ptr->variables.find(key);
-		if (it != ptr->variables.end())
+		for (Context* ptr = this; ptr; ptr = ptr->parent.get())
 		{
-			it->second = val;
+			auto it = ptr->variables.find(key);
+			if (it != ptr->variables.end())
+				return it->second;
 		}
-	}
-
-	Object& Context::get(const Token& identifier)
-	{
-		const std::string& key = identifier.lexeme;
-
-		auto it = variables.find(key);
-		if (it != variables.end())
-			return it->second;
-
-		if (parent == nullptr)
-			return Object::Nil();
 
-		return parent->get(identifier);
+		return Object::Nil();
 	}
 
-	Object& Context::get(const std::string& key)
-	{
-		auto it = variables.find(key);
-		if (it != variables.end())
-			return it->second;
-
-		if (parent == nullptr)
-			return Object::Nil();
-
-		return parent->get(key);
-	}
-
-	Object& Context::getAt(const Token& identifier, int distance)
+	Object& Context::getAt(int distance, int slot)
 	{
 		Context* ptr = ancestor(distance);
 
-		const std::string& key = identifier.lexeme;
-
-		auto it = ptr->variables.find(key);
-		if (it != ptr->variables.end())
-			return it->second;
+		// 离开作用域时slots会被清空
+		if (slot < ptr->slots.size())
+			return ptr->slots[slot];
 		else
 			return Object::Nil();
 	}
 
-	Object& Context::getAt(const std::string& key, int distance)
+	Object& Context::getAt(int distance, const Token& identifier)
 	{
 		Context* ptr = ancestor(distance);
 
-		auto it = ptr->variables.find(key);
+		auto it = ptr->variables.find(identifier.symbol);
 		if (it != ptr->variables.end())
 			return it->second;
 		else
@@ -112,7 +71,30 @@ namespace CXX {
 		return curr;
 	}
 
-	ScopedContext::ScopedContext(ContextPtr& origin, ContextPtr newContext, bool shouldClear) : ref(origin), previous_copy(origin), shouldClear(shouldClear)
+	void Context::trace(GarbageCollector& gc) const
+	{
+		gc.mark(parent);
+
+		for (auto& slot : slots)
+			gc.mark(slot);
+
+		for (auto& [_, value] : variables)
+			gc.mark(value);
+	}
+
+	void Context::clear(std::vector<Object>& trash)
+	{
+		for (auto& slot : slots)
+			trash.push_back(std::move(slot));
+
+		for (auto& [_, value] : variables)
+			trash.push_back(std::move(value));
+
+		slots.clear();
+		variables.clear();
+	}
+
+	ScopedContext::ScopedContext(ContextPtr& origin, ContextPtr newContext) : ref(origin), previous_copy(origin)
 	{
 		// 这里的运作流程为：
 		// 1. ref引用origin
@@ -123,11 +105,6 @@ namespace CXX {
 
 	ScopedContext::~ScopedContext()
 	{
-		// Context和Function之间循环引用，无法自动释放
-		// 因此我们需要手动释放
-		if (shouldClear)
-			ref->variables.clear();
-
 		// 析构时，恢复原本的Context
 		ref = previous_copy;
 	}
@@ -0,0 +1,356 @@
+#include "Interpreter/Float64Kernels.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CXX_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace CXX {
+
+	namespace kernels {
+
+		namespace {
+
+			// 标量实现，也用于处理向量实现剩下的尾部元素
+
+			double sumScalar(const double* data, size_t n)
+			{
+				double result = 0.0;
+				for (size_t i = 0; i < n; i++)
+					result += data[i];
+				return result;
+			}
+
+			double minScalar(const double* data, size_t n)
+			{
+				double result = data[0];
+				for (size_t i = 1; i < n; i++)
+					result = data[i] < result ? data[i] : result;
+				return result;
+			}
+
+			double maxScalar(const double* data, size_t n)
+			{
+				double result = data[0];
+				for (size_t i = 1; i < n; i++)
+					result = data[i] > result ? data[i] : result;
+				return result;
+			}
+
+			double dotScalar(const double* x, const double* y, size_t n)
+			{
+				double result = 0.0;
+				for (size_t i = 0; i < n; i++)
+					result += x[i] * y[i];
+				return result;
+			}
+
+			void scaleScalar(double* x, double a, size_t n)
+			{
+				for (size_t i = 0; i < n; i++)
+					x[i] *= a;
+			}
+
+			void axpyScalar(double* y, double a, const double* x, size_t n)
+			{
+				for (size_t i = 0; i < n; i++)
+					y[i] += a * x[i];
+			}
+
+			void addScalar(double* x, const double* y, size_t n)
+			{
+				for (size_t i = 0; i < n; i++)
+					x[i] += y[i];
+			}
+
+			void mulScalar(double* x, const double* y, size_t n)
+			{
+				for (size_t i = 0; i < n; i++)
+					x[i] *= y[i];
+			}
+
+#ifndef CXX_X86_KERNELS
+			void prefixSumScalar(double* x, size_t n)
+			{
+				for (size_t i = 1; i < n; i++)
+					x[i] += x[i - 1];
+			}
+#endif
+
+#ifdef CXX_X86_KERNELS
+			// SSE2是x86-64的基本指令集，无需检测
+
+			double sumSSE2(const double* data, size_t n)
+			{
+				__m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					acc0 = _mm_add_pd(acc0, _mm_loadu_pd(data + i));
+					acc1 = _mm_add_pd(acc1, _mm_loadu_pd(data + i + 2));
+				}
+
+				double lanes[2];
+				_mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+				return lanes[0] + lanes[1] + sumScalar(data + i, n - i);
+			}
+
+			double minSSE2(const double* data, size_t n)
+			{
+				if (n < 2)
+					return minScalar(data, n);
+
+				__m128d acc = _mm_loadu_pd(data);
+				size_t i = 2;
+				for (; i + 2 <= n; i += 2)
+					acc = _mm_min_pd(_mm_loadu_pd(data + i), acc);
+
+				double lanes[2];
+				_mm_storeu_pd(lanes, acc);
+				double result = minScalar(lanes, 2);
+				return i < n ? (data[i] < result ? data[i] : result) : result;
+			}
+
+			double maxSSE2(const double* data, size_t n)
+			{
+				if (n < 2)
+					return maxScalar(data, n);
+
+				__m128d acc = _mm_loadu_pd(data);
+				size_t i = 2;
+				for (; i + 2 <= n; i += 2)
+					acc = _mm_max_pd(_mm_loadu_pd(data + i), acc);
+
+				double lanes[2];
+				_mm_storeu_pd(lanes, acc);
+				double result = maxScalar(lanes, 2);
+				return i < n ? (data[i] > result ? data[i] : result) : result;
+			}
+
+			double dotSSE2(const double* x, const double* y, size_t n)
+			{
+				__m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+					acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+				}
+
+				double lanes[2];
+				_mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+				return lanes[0] + lanes[1] + dotScalar(x + i, y + i, n - i);
+			}
+
+			void scaleSSE2(double* x, double a, size_t n)
+			{
+				__m128d factor = _mm_set1_pd(a);
+				size_t i = 0;
+				for (; i + 2 <= n; i += 2)
+					_mm_storeu_pd(x + i, _mm_mul_pd(_mm_loadu_pd(x + i), factor));
+				scaleScalar(x + i, a, n - i);
+			}
+
+			void axpySSE2(double* y, double a, const double* x, size_t n)
+			{
+				__m128d factor = _mm_set1_pd(a);
+				size_t i = 0;
+				for (; i + 2 <= n; i += 2)
+					_mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(factor, _mm_loadu_pd(x + i))));
+				axpyScalar(y + i, a, x + i, n - i);
+			}
+
+			void addSSE2(double* x, const double* y, size_t n)
+			{
+				size_t i = 0;
+				for (; i + 2 <= n; i += 2)
+					_mm_storeu_pd(x + i, _mm_add_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+				addScalar(x + i, y + i, n - i);
+			}
+
+			void mulSSE2(double* x, const double* y, size_t n)
+			{
+				size_t i = 0;
+				for (; i + 2 <= n; i += 2)
+					_mm_storeu_pd(x + i, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+				mulScalar(x + i, y + i, n - i);
+			}
+
+			void prefixSumSSE2(double* x, size_t n)
+			{
+				// [a, b] + [0, a] = [a, a+b]，再加上之前所有元素的和
+				__m128d carry = _mm_setzero_pd();
+				size_t i = 0;
+				for (; i + 2 <= n; i += 2)
+				{
+					__m128d v = _mm_loadu_pd(x + i);
+					v = _mm_add_pd(v, _mm_unpacklo_pd(_mm_setzero_pd(), v));
+					v = _mm_add_pd(v, carry);
+					_mm_storeu_pd(x + i, v);
+					carry = _mm_unpackhi_pd(v, v);
+				}
+
+				if (i < n)
+					x[i] += i > 0 ? x[i - 1] : 0.0;
+			}
+
+			// AVX需在运行时确认CPU支持，函数单独以avx为目标编译
+
+			__attribute__((target("avx"))) double sumAVX(const double* data, size_t n)
+			{
+				__m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8)
+				{
+					acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+					acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(data + i + 4));
+				}
+
+				double lanes[4];
+				_mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+				return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + sumSSE2(data + i, n - i);
+			}
+
+			__attribute__((target("avx"))) double minAVX(const double* data, size_t n)
+			{
+				if (n < 4)
+					return minSSE2(data, n);
+
+				__m256d acc = _mm256_loadu_pd(data);
+				size_t i = 4;
+				for (; i + 4 <= n; i += 4)
+					acc = _mm256_min_pd(_mm256_loadu_pd(data + i), acc);
+
+				double lanes[4];
+				_mm256_storeu_pd(lanes, acc);
+				double result = minScalar(lanes, 4);
+				if (i == n)
+					return result;
+
+				double rest = minSSE2(data + i, n - i);
+				return rest < result ? rest : result;
+			}
+
+			__attribute__((target("avx"))) double maxAVX(const double* data, size_t n)
+			{
+				if (n < 4)
+					return maxSSE2(data, n);
+
+				__m256d acc = _mm256_loadu_pd(data);
+				size_t i = 4;
+				for (; i + 4 <= n; i += 4)
+					acc = _mm256_max_pd(_mm256_loadu_pd(data + i), acc);
+
+				double lanes[4];
+				_mm256_storeu_pd(lanes, acc);
+				double result = maxScalar(lanes, 4);
+				if (i == n)
+					return result;
+
+				double rest = maxSSE2(data + i, n - i);
+				return rest > result ? rest : result;
+			}
+
+			__attribute__((target("avx"))) double dotAVX(const double* x, const double* y, size_t n)
+			{
+				__m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8)
+				{
+					acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+					acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+				}
+
+				double lanes[4];
+				_mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+				return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotSSE2(x + i, y + i, n - i);
+			}
+
+			__attribute__((target("avx"))) void scaleAVX(double* x, double a, size_t n)
+			{
+				__m256d factor = _mm256_set1_pd(a);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+					_mm256_storeu_pd(x + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), factor));
+				scaleScalar(x + i, a, n - i);
+			}
+
+			__attribute__((target("avx"))) void axpyAVX(double* y, double a, const double* x, size_t n)
+			{
+				__m256d factor = _mm256_set1_pd(a);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+					_mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_mul_pd(factor, _mm256_loadu_pd(x + i))));
+				axpyScalar(y + i, a, x + i, n - i);
+			}
+
+			__attribute__((target("avx"))) void addAVX(double* x, const double* y, size_t n)
+			{
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+					_mm256_storeu_pd(x + i, _mm256_add_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+				addScalar(x + i, y + i, n - i);
+			}
+
+			__attribute__((target("avx"))) void mulAVX(double* x, const double* y, size_t n)
+			{
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+					_mm256_storeu_pd(x + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+				mulScalar(x + i, y + i, n - i);
+			}
+#endif
+
+			struct Table
+			{
+				const char* isa;
+				double (*sum)(const double*, size_t);
+				double (*min)(const double*, size_t);
+				double (*max)(const double*, size_t);
+				double (*dot)(const double*, const double*, size_t);
+				void (*scale)(double*, double, size_t);
+				void (*axpy)(double*, double, const double*, size_t);
+				void (*add)(double*, const double*, size_t);
+				void (*mul)(double*, const double*, size_t);
+				void (*prefixSum)(double*, size_t);
+			};
+
+			const Table& table()
+			{
+#ifdef CXX_X86_KERNELS
+				// 前缀和的依赖链较长，加宽到AVX没有收益，两者共用SSE2实现
+				static const Table avx{ "avx", sumAVX, minAVX, maxAVX, dotAVX, scaleAVX, axpyAVX, addAVX, mulAVX, prefixSumSSE2 };
+				static const Table sse2{ "sse2", sumSSE2, minSSE2, maxSSE2, dotSSE2, scaleSSE2, axpySSE2, addSSE2, mulSSE2, prefixSumSSE2 };
+				static const Table& selected = __builtin_cpu_supports("avx") ? avx : sse2;
+				return selected;
+#else
+				static const Table scalar{ "scalar", sumScalar, minScalar, maxScalar, dotScalar, scaleScalar, axpyScalar, addScalar, mulScalar, prefixSumScalar };
+				return scalar;
+#endif
+			}
+
+		}
+
+		double sum(const double* data, size_t n) { return table().sum(data, n); }
+
+		double min(const double* data, size_t n) { return table().min(data, n); }
+
+		double max(const double* data, size_t n) { return table().max(data, n); }
+
+		double dot(const double* x, const double* y, size_t n) { return table().dot(x, y, n); }
+
+		void scale(double* x, double a, size_t n) { table().scale(x, a, n); }
+
+		void axpy(double* y, double a, const double* x, size_t n) { table().axpy(y, a, x, n); }
+
+		void add(double* x, const double* y, size_t n) { table().add(x, y, n); }
+
+		void mul(double* x, const double* y, size_t n) { table().mul(x, y, n); }
+
+		void prefixSum(double* x, size_t n) { table().prefixSum(x, n); }
+
+		const char* isa() { return table().isa; }
+
+	}
+
+}
@@ -1,49 +1,80 @@
 #include "Common/utils.h"
 #include "Interpreter/Function.h"
+#include "Interpreter/Class.h"
 #include "Interpreter/Interpreter.h"
+#include "Interpreter/GarbageCollector.h"
+#include "Parser/AstArena.h"
+#include "Resolver/Resolver.h"
 #include "Runner.h"
 
 namespace CXX
 {
 
-	Function::Function(Object &belonging, std::shared_ptr<FuncDeclarationStmt> funcDeclarationStmt, ContextPtr env)
-		: belonging(belonging), funcBody(std::move(funcDeclarationStmt)), closure(std::move(env))
+	Function::Function(Object &belonging, FuncDeclarationStmt *funcDeclarationStmt, ContextPtr env)
+		: belonging(belonging), funcBody(funcDeclarationStmt), arena(funcDeclarationStmt->arena->shared_from_this()),
+		  closure(std::move(env))
 	{
 		init_default_values();
 	}
 
-	Function::Function(Object &belonging, std::shared_ptr<FuncDeclarationStmt> body, const std::vector<Object> &default_values, ContextPtr env)
-		: belonging(belonging), funcBody(std::move(body)), default_values(default_values), closure(std::move(env)) {}
+	Function::Function(Object &belonging, FuncDeclarationStmt *body, const std::vector<Object> &default_values, ContextPtr env,
+					   InstancePtr receiver)
+		: belonging(belonging), funcBody(body), arena(body->arena->shared_from_this()), default_values(default_values), closure(std::move(env)),
+		  receiver(std::move(receiver)) {}
 
 	Object Function::call(Interpreter &interpreter, const std::vector<Object> &arguments)
 	{
-		ContextPtr newEnv = std::make_shared<Context>(closure);
+		return execute(interpreter, receiver, arguments);
+	}
+
+	Object Function::invoke(Interpreter &interpreter, const InstancePtr &receiver, const std::vector<Object> &arguments)
+	{
+		return execute(interpreter, receiver, arguments);
+	}
+
+	Object Function::execute(Interpreter &interpreter, const InstancePtr &self, const std::vector<Object> &arguments)
+	{
+		// 预解析的函数体在首次调用时补全，此后localCount才有效
+		// 解析错误已经输出，与立即解析时一样直接结束
+		if (funcBody->lazy && !Resolver::resolveBody(funcBody))
+			throw ReportedError();
+
+		ContextPtr newEnv = std::make_shared<Context>(closure, funcBody->localCount);
 
 		size_t i, arg_size = arguments.size();
 		int _arity = arity();
 
+		// Resolver保证了第i个参数位于第i个槽位
 		for (i = 0; i < arg_size; i++)
-			newEnv->set(funcBody->params[i], arguments[i]);
+			newEnv->slots[i] = arguments[i];
 
 		// 调用call之前已经确保了参数个数在合法范围内
 		// 这里只需要补全
 		if (arg_size < _arity)
 		{
 			for (size_t count = _arity - arg_size; count > 0; count--)
-				newEnv->set(funcBody->params[i++], *(default_values.end() - count));
+				newEnv->slots[i++] = *(default_values.end() - count);
 		}
 
-		ScopedContext scope(interpreter.context, std::move(newEnv), false);
+		if (funcBody->thisSlot >= 0)
+			newEnv->slots[funcBody->thisSlot] = Object(self);
+
+		ScopedContext scope(interpreter.context, std::move(newEnv));
 
-		for (auto &stmt : funcBody->body)
+		if (compiled)
+			ClosureCompiler::execute(interpreter, *compiled);
+		else
 		{
-			interpreter.execute(stmt.get());
+			for (auto &stmt : funcBody->body)
+			{
+				interpreter.execute(stmt);
 
-			if (interpreter.m_returns)
-				break;
+				if (interpreter.completion != Interpreter::Completion::NORMAL)
+					break;
+			}
 		}
 
-		return interpreter.m_returns ? interpreter.getReturn() : Object();
+		return interpreter.completion == Interpreter::Completion::RETURN ? interpreter.getReturn() : Object();
 	}
 
 	int Function::arity()
@@ -63,16 +94,24 @@ namespace CXX
 
 	std::string Function::name()
 	{
-		return funcBody->name.lexeme;
+		return funcBody->name.symbol.str();
 	}
 
 	CallablePtr Function::bindThis(InstancePtr instance)
 	{
-		ContextPtr newEnv = std::make_shared<Context>(closure);
-		newEnv->set("this", Object(instance));
-
 		// default_values一并传，不需要再计算一次
-		return std::make_shared<Function>(belonging, funcBody, default_values, std::move(newEnv));
+		auto function = std::make_shared<Function>(belonging, funcBody, default_values, closure, std::move(instance));
+		function->compiled = compiled;
+		return function;
+	}
+
+	void Function::trace(GarbageCollector &gc) const
+	{
+		gc.mark(closure);
+		gc.mark(receiver);
+
+		for (auto &value : default_values)
+			gc.mark(value);
 	}
 
 	void Function::init_default_values()
@@ -82,27 +121,30 @@ namespace CXX
 		{
 			for (auto &val : funcBody->default_values)
 			{
-				this->default_values.push_back(Runner::interpreter.interpret(val.get()));
+				this->default_values.push_back(Runner::interpreter.interpret(val));
 			}
 		}
 	}
 
-	LambdaFunction::LambdaFunction(std::shared_ptr<LambdaExpr> lambdaExpr, ContextPtr env)
-		: funcBody(std::move(lambdaExpr)), closure(std::move(env))
+	LambdaFunction::LambdaFunction(LambdaExpr *lambdaExpr, ContextPtr env)
+		: funcBody(lambdaExpr), arena(lambdaExpr->arena->shared_from_this()), closure(std::move(env))
 	{
 		init_default_values();
 	}
 
+	LambdaFunction::LambdaFunction(LambdaExpr *lambdaExpr, const std::vector<Object> &default_values, ContextPtr env)
+		: funcBody(lambdaExpr), arena(lambdaExpr->arena->shared_from_this()), default_values(default_values), closure(std::move(env)) {}
+
 	Object LambdaFunction::call(Interpreter &interpreter, const std::vector<Object> &arguments)
 	{
-		ContextPtr newEnv = std::make_shared<Context>(closure);
+		ContextPtr newEnv = std::make_shared<Context>(closure, funcBody->localCount);
 
 		size_t i, arg_size = arguments.size();
 		int _arity = arity();
 
 		for (i = 0; i < arg_size; i++)
 		{
-			newEnv->set(funcBody->params[i], arguments[i]);
+			newEnv->slots[i] = arguments[i];
 		}
 
 		// 调用call之前已经确保了参数个数在合法范围内
@@ -111,23 +153,28 @@ namespace CXX
 		{
 			for (size_t count = _arity - arg_size; count > 0; count--)
 			{
-				newEnv->set(funcBody->params[i++], *(default_values.end() - count));
+				newEnv->slots[i++] = *(default_values.end() - count);
 			}
 		}
 
-		ScopedContext scope(interpreter.context, std::move(newEnv), false);
+		ScopedContext scope(interpreter.context, std::move(newEnv));
 
-		for (auto &stmt : funcBody->body)
+		if (compiled)
+			ClosureCompiler::execute(interpreter, *compiled);
+		else
 		{
-			interpreter.execute(stmt.get());
-
-			if (interpreter.m_returns)
+			for (auto &stmt : funcBody->body)
 			{
-				break;
+				interpreter.execute(stmt);
+
+				if (interpreter.completion != Interpreter::Completion::NORMAL)
+				{
+					break;
+				}
 			}
 		}
 
-		return interpreter.m_returns ? interpreter.getReturn() : Object();
+		return interpreter.completion == Interpreter::Completion::RETURN ? interpreter.getReturn() : Object();
 	}
 
 	int LambdaFunction::arity()
@@ -155,6 +202,14 @@ namespace CXX
 		return nullptr;
 	}
 
+	void LambdaFunction::trace(GarbageCollector &gc) const
+	{
+		gc.mark(closure);
+
+		for (auto &value : default_values)
+			gc.mark(value);
+	}
+
 	void LambdaFunction::init_default_values()
 	{
 		// 该函数仅在首次构造Function时调用
@@ -162,7 +217,7 @@ namespace CXX
 		{
 			for (auto &val : funcBody->default_values)
 			{
-				this->default_values.push_back(Runner::interpreter.interpret(val.get()));
+				this->default_values.push_back(Runner::interpreter.interpret(val));
 			}
 		}
 	}
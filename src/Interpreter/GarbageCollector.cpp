@@ -0,0 +1,225 @@
+#include "Interpreter/GarbageCollector.h"
+#include "Interpreter/Class.h"
+#include "Interpreter/Container.h"
+#include "Interpreter/MetaList.h"
+#include <algorithm>
+
+namespace CXX {
+
+	size_t GarbageCollector::tracked = 0;
+	size_t GarbageCollector::threshold = GarbageCollector::MIN_THRESHOLD;
+	int GarbageCollector::paused = 0;
+
+	Collectable::Collectable()
+	{
+		GarbageCollector::track(this);
+	}
+
+	Collectable::~Collectable()
+	{
+		GarbageCollector::untrack(this);
+	}
+
+	Collectable*& GarbageCollector::head()
+	{
+		// 静态对象(如Runner::interpreter)构造时就会创建Context，这里避免静态初始化顺序问题
+		static Collectable* list = nullptr;
+		return list;
+	}
+
+	void GarbageCollector::track(Collectable* object)
+	{
+		Collectable*& list = head();
+
+		object->gcNext = list;
+		if (list)
+			list->gcPrev = object;
+		list = object;
+
+		tracked++;
+	}
+
+	void GarbageCollector::untrack(Collectable* object)
+	{
+		if (object->gcPrev)
+			object->gcPrev->gcNext = object->gcNext;
+		else
+			head() = object->gcNext;
+
+		if (object->gcNext)
+			object->gcNext->gcPrev = object->gcPrev;
+
+		tracked--;
+	}
+
+	void GarbageCollector::collect()
+	{
+		if (paused)
+			return;
+
+		Pause pause;
+
+		GarbageCollector gc;
+		gc.scan();
+		gc.sweep();
+
+		threshold = std::max(MIN_THRESHOLD, tracked * 2);
+	}
+
+	void GarbageCollector::mark(const Object& value)
+	{
+		// 字符串不会引用其他对象，不参与成环
+		if (!value.isHeap() || value.cell()->type == ObjectType::STRING)
+			return;
+
+		Object::Cell* cell = value.cell();
+		edge(cell, (long)cell->refCount, nullptr, nullptr, &value, {});
+	}
+
+	void GarbageCollector::edge(const void* key, long refs, const Collectable* collectable, const Callable* callable,
+		const Object* cell, std::weak_ptr<void> handle)
+	{
+		auto [it, inserted] = nodes.try_emplace(key);
+		Node& node = it->second;
+
+		if (inserted)
+		{
+			node.collectable = collectable;
+			node.callable = callable;
+			node.cell = cell;
+			worklist.push_back(&node);
+		}
+
+		// 由链表直接加入的Collectable此时才知道引用总数
+		if (node.refs < 0)
+		{
+			node.refs = refs;
+			node.handle = std::move(handle);
+		}
+
+		node.internal++;
+		current->children.push_back(&node);
+	}
+
+	void GarbageCollector::scan()
+	{
+		for (Collectable* object = head(); object; object = object->gcNext)
+		{
+			auto [it, inserted] = nodes.try_emplace(object);
+			if (inserted)
+			{
+				it->second.collectable = object;
+				worklist.push_back(&it->second);
+			}
+		}
+
+		// 遍历整张图，记录边与内部引用数
+		while (!worklist.empty())
+		{
+			current = worklist.back();
+			worklist.pop_back();
+
+			if (current->collectable)
+				current->collectable->trace(*this);
+			else if (current->callable)
+				current->callable->trace(*this);
+			else if (current->cell->isCallable())
+				mark(current->cell->getCallable());
+			else if (current->cell->isInstance())
+				mark(current->cell->getInstance());
+			else if (current->cell->isContainer())
+				mark(current->cell->getContainer());
+			else if (current->cell->isList())
+				mark(current->cell->getList());
+		}
+
+		// 被图外持有的对象为根，从根出发标记
+		for (auto& [_, node] : nodes)
+		{
+			if ((node.refs < 0 || node.refs > node.internal) && !node.reachable)
+			{
+				node.reachable = true;
+				worklist.push_back(&node);
+			}
+		}
+
+		while (!worklist.empty())
+		{
+			Node* node = worklist.back();
+			worklist.pop_back();
+
+			for (Node* child : node->children)
+			{
+				if (!child->reachable)
+				{
+					child->reachable = true;
+					worklist.push_back(child);
+				}
+			}
+		}
+	}
+
+	void GarbageCollector::sweep()
+	{
+		// 先持有所有垃圾对象，保证清理过程中它们不会被提前释放
+		std::vector<std::shared_ptr<void>> keep;
+		std::vector<std::pair<std::shared_ptr<void>, Instance*>> instances;
+		std::vector<Collectable*> garbage;
+
+		for (auto& [_, node] : nodes)
+		{
+			if (node.reachable || node.cell)
+				continue;
+
+			std::shared_ptr<void> holder = node.handle.lock();
+			if (!holder)
+				continue;
+
+			auto collectable = const_cast<Collectable*>(node.collectable);
+			if (auto instance = dynamic_cast<Instance*>(collectable))
+				instances.emplace_back(std::move(holder), instance);
+			else
+			{
+				if (collectable)
+					garbage.push_back(collectable);
+				keep.push_back(std::move(holder));
+			}
+		}
+
+		nodes.clear();
+
+		// 清空Context、Container等，打破引用环
+		std::vector<Object> trash;
+		for (Collectable* object : garbage)
+			object->clear(trash);
+
+		trash.clear();
+		keep.clear();
+
+		// 实例最后释放，使__del__执行时字段仍然完整
+		bool progress = true;
+		while (progress)
+		{
+			progress = false;
+			for (auto& [holder, _] : instances)
+			{
+				if (holder && holder.use_count() == 1)
+				{
+					holder.reset();
+					progress = true;
+				}
+			}
+		}
+
+		// 剩下的实例之间互相引用，只能清空字段
+		for (auto& [holder, instance] : instances)
+		{
+			if (holder)
+				instance->clear(trash);
+		}
+
+		trash.clear();
+		instances.clear();
+	}
+
+}
@@ -1,12 +1,20 @@
 #include "Common/utils.h"
 #include "Lexer/Lexer.h"
 #include "Parser/Parser.h"
-#include "Resolver/Resolver.h" // above headers are used in loadModule
+#include "Parser/AstCache.h"
+#include "Resolver/Resolver.h"
+#include "Optimizer/ConstantFolder.h"
+#include "Optimizer/TypeInferencer.h" // above headers are used in parseModule
+#include "Interpreter/ModuleLoader.h"
 #include "Interpreter/Interpreter.h"
 #include "Interpreter/loxlib/StandardFunctions.h"
 #include "Interpreter/loxlib/NativeClass.h"
 #include "Interpreter/Function.h"
 #include "Interpreter/MetaList.h"
+#include "Interpreter/MetaMap.h"
+#include "Interpreter/MetaFloat64Array.h"
+#include "Interpreter/ClosureCompiler.h"
+#include "Interpreter/Specialize.h"
 #include "Runner.h"
 #include <iostream>
 #include <algorithm>
@@ -27,22 +35,13 @@ namespace CXX
 	{
 		for (auto &stmt : statements)
 		{
-			execute(stmt.get());
-		}
-	}
-
-	void Interpreter::interpret(std::vector<StmtPtr> &&statements)
-	{
-		for (auto &stmt : statements)
-		{
-			execute(stmt.get());
-			stmt.reset();
+			execute(stmt);
 		}
 	}
 
 	void Interpreter::visit(const ExpressionStmt *expressionStmt)
 	{
-		Object result = interpret(expressionStmt->expr.get());
+		Object result = interpret(expressionStmt->expr);
 
 		if (replEcho && !result.isNil())
 		{
@@ -54,31 +53,31 @@ namespace CXX
 	{
 		if (varStmt->expr)
 		{
-			Object initializer = interpret(varStmt->expr.value().get());
-			context->set(varStmt->identifier, initializer);
+			Object initializer = interpret(varStmt->expr.value());
+			define(varStmt->identifier, varStmt->slot, initializer);
 		}
 		else
 		{
-			context->set(varStmt->identifier, Object::Nil());
+			define(varStmt->identifier, varStmt->slot, Object::Nil());
 		}
 	}
 
-	void Interpreter::visit(std::shared_ptr<FuncDeclarationStmt> funcDeclarationStmt)
+	void Interpreter::visit(FuncDeclarationStmt *funcDeclarationStmt)
 	{
 		std::shared_ptr<Function> function = std::make_shared<Function>(Object::Nil(), funcDeclarationStmt, context);
-		context->set(funcDeclarationStmt->name, Object(std::move(function)));
+		define(funcDeclarationStmt->name, funcDeclarationStmt->slot, Object(std::move(function)));
 	}
 
 	void Interpreter::visit(const ClassDeclarationStmt *classDeclStmt)
 	{
 		// 在定义类时，我们将分两步构造，先声明，再赋值
 		// 这样可以允许类内函数调用该类
-		context->set(classDeclStmt->name, Object::Nil());
+		define(classDeclStmt->name, classDeclStmt->slot, Object::Nil());
 
 		std::optional<std::shared_ptr<Class>> superClass;
 		if (classDeclStmt->superClass)
 		{
-			Object superclassObject = interpret(classDeclStmt->superClass.value().get());
+			Object superclassObject = interpret(classDeclStmt->superClass.value());
 			if (!superclassObject.isCallable() || superclassObject.getCallable()->type != Callable::CallableType::CLASS)
 			{
 				throw RuntimeError(classDeclStmt->superClass.value()->pos_start, classDeclStmt->superClass.value()->pos_end,
@@ -88,18 +87,16 @@ namespace CXX
 			superClass = std::static_pointer_cast<Class>(superclassObject.getCallable());
 		}
 
-		std::unordered_map<std::string, CallablePtr> methods;
-		std::shared_ptr<Class> classPtr = std::make_shared<Class>(classDeclStmt->name.lexeme, methods, std::move(superClass));
-		context->change(classDeclStmt->name, Object(classPtr));
+		std::unordered_map<Symbol, CallablePtr> methods;
+		std::shared_ptr<Class> classPtr = std::make_shared<Class>(classDeclStmt->name.symbol.str(), methods, std::move(superClass));
+		Object &classObject = define(classDeclStmt->name, classDeclStmt->slot, Object(classPtr));
 
 		// 因为我们需要给类成员函数绑定所处类，因此我们只能先定义类，再添加函数
 		if (!classDeclStmt->methods.empty())
 		{
-			Object &classObject = context->get(classDeclStmt->name);
 			for (auto &method : classDeclStmt->methods)
 			{
-				std::string func_name = method->name.lexeme;
-				methods[func_name] = std::make_shared<Function>(classObject, method, context);
+				methods[method->name.symbol] = std::make_shared<Function>(classObject, method, context);
 			}
 			classPtr->methods = std::move(methods);
 		}
@@ -110,47 +107,36 @@ namespace CXX
 		// 循环体，判断语句的输出控制
 		auto task = toggleRepl();
 
-		ScopedContext scope(context, std::make_shared<Context>(context));
+		ScopedContext scope(context, std::make_shared<Context>(context, blockStmt->localCount));
 
 		for (auto &stmt : blockStmt->statements)
 		{
-			execute(stmt.get());
+			execute(stmt);
 
-			if (m_returns)
+			if (completion != Completion::NORMAL)
 				return;
 		}
 	}
 
 	void Interpreter::visit(const IfStmt *ifStmt)
 	{
-		if (interpret(ifStmt->condition.get()).is_true())
+		if (interpret(ifStmt->condition).is_true())
 		{
-			execute(ifStmt->thenBranch.get());
+			execute(ifStmt->thenBranch);
 		}
 		else if (ifStmt->elseBranch)
 		{
-			execute(ifStmt->elseBranch.value().get());
+			execute(ifStmt->elseBranch.value());
 		}
 	}
 
 	void Interpreter::visit(const WhileStmt *whileStmt)
 	{
-		while (interpret(whileStmt->condition.get()).is_true())
+		while (interpret(whileStmt->condition).is_true())
 		{
-			try
-			{
-				execute(whileStmt->body.get());
-			}
-			catch (const BreakFlag &e)
-			{
-				return;
-			}
-			catch (const ContinueFlag &e)
-			{
-				// continue;
-			}
+			execute(whileStmt->body);
 
-			if (m_returns)
+			if (completion != Completion::NORMAL && loopExit())
 				return;
 		}
 	}
@@ -159,58 +145,60 @@ namespace CXX
 	{
 		// for循环内是一个新的变量环境
 		// for语句的第一个变量声明应设为新变量
-		ScopedContext scoped(context, std::make_shared<Context>(context));
+		ScopedContext scoped(context, std::make_shared<Context>(context, forStmt->localCount));
 
 		if (forStmt->initializer)
-			execute(forStmt->initializer.value().get());
+			execute(forStmt->initializer.value());
 
 		bool hasCondition = forStmt->condition.has_value();
 
-		while (!hasCondition || interpret(forStmt->condition.value().get()).is_true())
+		while (!hasCondition || interpret(forStmt->condition.value()).is_true())
 		{
-			try
-			{
-				execute(forStmt->body.get());
-			}
-			catch (const BreakFlag &e)
-			{
-				return;
-			}
-			catch (const ContinueFlag &e)
-			{
-				// continue;
-			}
+			execute(forStmt->body);
 
-			if (m_returns)
+			if (completion != Completion::NORMAL && loopExit())
 				return;
 
 			if (forStmt->increment)
-				interpret(forStmt->increment.value().get());
+				interpret(forStmt->increment.value());
 		}
 	}
 
 	void Interpreter::visit(const BreakStmt *breakStmt)
 	{
-		throw BreakFlag();
+		completion = Completion::BREAK;
 	}
 
 	void Interpreter::visit(const ContinueStmt *continueStmt)
 	{
-		throw ContinueFlag();
+		completion = Completion::CONTINUE;
 	}
 
 	void Interpreter::visit(const ReturnStmt *returnStmt)
 	{
 		if (returnStmt->expr)
-			m_returns = interpret(returnStmt->expr.value().get());
+			m_returns = interpret(returnStmt->expr.value());
 		else
 			m_returns = Object();
+
+		completion = Completion::RETURN;
+	}
+
+	bool Interpreter::loopExit()
+	{
+		// return需要继续向外传递，交给函数处理
+		if (completion == Completion::RETURN)
+			return true;
+
+		bool isBreak = completion == Completion::BREAK;
+		completion = Completion::NORMAL;
+		return isBreak;
 	}
 
 	void Interpreter::visit(const ImportStmt *importStmt)
 	{
 		std::shared_ptr<Module> importModule;
-		if (auto it = m_modules.find(importStmt->filepath.lexeme); it != m_modules.end())
+		if (auto it = m_modules.find(importStmt->filepath.symbol.str()); it != m_modules.end())
 		{
 			importModule = it->second;
 		}
@@ -234,16 +222,16 @@ namespace CXX
 		}
 		else
 		{
+			auto slot = importStmt->slots.begin();
 			for (const auto &[symbol, alias] : importStmt->symbols)
 			{
-				if (auto &obj = importModule->get(symbol.lexeme); &obj != &Object::Nil())
+				if (auto &obj = importModule->get(symbol.symbol); &obj != &Object::Nil())
 				{
-					const std::string &name = alias ? alias->lexeme : symbol.lexeme;
-					context->set(name, obj);
+					define(alias ? alias.value() : symbol, *slot++, obj);
 				}
 				else
 				{
-					throw RuntimeError(symbol.pos_start, symbol.pos_end, format("Can't find `%s` from module \"%s\".", symbol.lexeme.c_str(), importStmt->filepath.lexeme.c_str()));
+					throw RuntimeError(symbol.pos_start, symbol.pos_end, format("Can't find `%s` from module \"%s\".", symbol.symbol.c_str(), importStmt->filepath.symbol.c_str()));
 				}
 			}
 		}
@@ -253,13 +241,52 @@ namespace CXX
 	{
 		for (auto const &stmt : packStmt->statements)
 		{
-			execute(stmt.get());
+			execute(stmt);
 		}
 	}
 
 	Object Interpreter::visit(const BinaryExpr *binaryExpr)
 	{
-		Object left = interpret(binaryExpr->left.get()), right = interpret(binaryExpr->right.get());
+		Object left = interpret(binaryExpr->left), right = interpret(binaryExpr->right);
+
+		// 运算出错时指向运算符，三种执行方式一致
+		Runner::pos_start = const_cast<Position *>(&binaryExpr->op.pos_start);
+		Runner::pos_end = const_cast<Position *>(&binaryExpr->op.pos_end);
+
+		// 特化为NUMBER的节点只需检查两侧是否仍为数字
+		switch (binaryExpr->specialization)
+		{
+		case Specialization::NUMBER:
+			if (left.isNumber() && right.isNumber())
+				return binaryExpr->numberOp(left.asNumber(), right.asNumber());
+
+			binaryExpr->specialization = Specialization::GENERIC;
+			break;
+
+		case Specialization::STATIC_NUMBER:
+			return binaryExpr->numberOp(left.asNumber(), right.asNumber());
+
+		case Specialization::UNINITIALIZED:
+			binaryExpr->numberOp = numberOperator(binaryExpr->op.type);
+			if (binaryExpr->numberOp && binaryExpr->left->staticType == StaticType::NUMBER &&
+				binaryExpr->right->staticType == StaticType::NUMBER)
+			{
+				binaryExpr->specialization = Specialization::STATIC_NUMBER;
+				return binaryExpr->numberOp(left.asNumber(), right.asNumber());
+			}
+
+			if (binaryExpr->numberOp && left.isNumber() && right.isNumber())
+			{
+				binaryExpr->specialization = Specialization::NUMBER;
+				return binaryExpr->numberOp(left.asNumber(), right.asNumber());
+			}
+
+			binaryExpr->specialization = Specialization::GENERIC;
+			break;
+
+		default:
+			break;
+		}
 
 		switch (binaryExpr->op.type)
 		{
@@ -303,7 +330,9 @@ namespace CXX
 
 	Object Interpreter::visit(const UnaryExpr *unaryExpr)
 	{
-		Object expr = interpret(unaryExpr->expr.get());
+		Object expr = interpret(unaryExpr->expr);
+		Runner::pos_start = const_cast<Position *>(&unaryExpr->op.pos_start);
+		Runner::pos_end = const_cast<Position *>(&unaryExpr->op.pos_end);
 
 		switch (unaryExpr->op.type)
 		{
@@ -323,11 +352,11 @@ namespace CXX
 
 	Object Interpreter::visit(const VariableExpr *variableExpr)
 	{
-		Object &var = lookupVariable(variableExpr->identifier, variableExpr->depth);
+		Object &var = lookupVariable(variableExpr->identifier, variableExpr->depth, variableExpr->slot);
 		if (&var == &Object::Nil())
 		{
 			throw RuntimeError(variableExpr->identifier.pos_start, variableExpr->identifier.pos_end,
-							   format("Undefined variable %s", variableExpr->identifier.lexeme.c_str()));
+							   format("Undefined variable %s", variableExpr->identifier.symbol.c_str()));
 		}
 
 		return var;
@@ -335,16 +364,16 @@ namespace CXX
 
 	Object Interpreter::visit(const AssignmentExpr *assignmentExpr)
 	{
-		Object &var = lookupVariable(assignmentExpr->identifier, assignmentExpr->depth);
+		Object &var = lookupVariable(assignmentExpr->identifier, assignmentExpr->depth, assignmentExpr->slot);
 		if (&var == &Object::Nil())
 		{
 			// 注意这里是和静态成员Object::Nil()去比（地址）
 			// 成员可以赋值为nil，那将进行一个拷贝
 			throw RuntimeError(assignmentExpr->identifier.pos_start, assignmentExpr->value->pos_end,
-							   format("Undefined variable %s", assignmentExpr->identifier.lexeme.c_str()));
+							   format("Undefined variable %s", assignmentExpr->identifier.symbol.c_str()));
 		}
 
-		Object value = interpret(assignmentExpr->value.get());
+		Object value = interpret(assignmentExpr->value);
 		TokenType op_type = assignmentExpr->operation.type;
 		value = handleAssign(var, value, op_type);
 
@@ -355,16 +384,16 @@ namespace CXX
 
 	Object Interpreter::visit(const TernaryExpr *ternaryExpr)
 	{
-		Object check = interpret(ternaryExpr->expr.get());
+		Object check = interpret(ternaryExpr->expr);
 
 		if (check.is_true())
-			return interpret(ternaryExpr->thenBranch.get());
+			return interpret(ternaryExpr->thenBranch);
 		else
-			return interpret(ternaryExpr->elseBranch.get());
+			return interpret(ternaryExpr->elseBranch);
 		;
 	}
 
-	Object Interpreter::visit(std::shared_ptr<LambdaExpr> lambdaExpr)
+	Object Interpreter::visit(LambdaExpr *lambdaExpr)
 	{
 		std::shared_ptr<LambdaFunction> function = std::make_shared<LambdaFunction>(lambdaExpr, context);
 		return Object(std::move(function));
@@ -373,26 +402,26 @@ namespace CXX
 	Object Interpreter::visit(const OrExpr *orExpr)
 	{
 		// 或运算，一真则真
-		Object lhs = interpret(orExpr->left.get());
+		Object lhs = interpret(orExpr->left);
 		if (lhs.is_true())
 		{
 			return Object(true);
 		}
 
-		Object rhs = interpret(orExpr->right.get());
+		Object rhs = interpret(orExpr->right);
 		return Object(rhs.is_true());
 	}
 
 	Object Interpreter::visit(const AndExpr *andExpr)
 	{
 		// 与运算，一假则假
-		Object lhs = interpret(andExpr->left.get());
+		Object lhs = interpret(andExpr->left);
 		if (!lhs.is_true())
 		{
 			return Object(false);
 		}
 
-		Object rhs = interpret(andExpr->right.get());
+		Object rhs = interpret(andExpr->right);
 		return Object(rhs.is_true());
 	}
 
@@ -400,25 +429,44 @@ namespace CXX
 	{
 		using OpType = RetrieveExpr::OpType;
 
-		Object prev = interpret(incrementExpr->holder.get());
+		if (incrementExpr->specialization != Specialization::GENERIC)
+		{
+			Object prev, result;
+			if (stepNumber(incrementExpr->holder, incrementExpr->specialization, 1.0, prev, result))
+				return incrementExpr->type == IncrementExpr::Type::POSTFIX ? prev : result;
+		}
+
+		Object prev = interpret(incrementExpr->holder);
 		if (!prev.isNumber())
 			throw RuntimeError(incrementExpr->holder->pos_start, incrementExpr->holder->pos_end,
-							   format("Operator '++' does not support type(%s)", ObjectTypeName(prev.type)));
+							   format("Operator '++' does not support type(%s)", ObjectTypeName(prev.type())));
 
 		Object result = prev + Object(1.0);
 
 		if (incrementExpr->holder->exprType == ExprType::Variable)
 		{
-			auto var = static_cast<VariableExpr *>(incrementExpr->holder.get());
-			context->change(var->identifier, result);
+			auto var = static_cast<VariableExpr *>(incrementExpr->holder);
+			lookupVariable(var->identifier, var->depth, var->slot) = result;
 		}
 		else
 		{
-			auto retrieve = static_cast<RetrieveExpr *>(incrementExpr->holder.get());
-			Object holder = interpret(retrieve->holder.get());
-			if (Classifier::belongClass(holder, "List") && retrieve->type == OpType::BRACKET)
+			auto retrieve = static_cast<RetrieveExpr *>(incrementExpr->holder);
+			Object holder = interpret(retrieve->holder);
+			MetaMap *map = retrieve->type == OpType::BRACKET ? asMap(holder) : nullptr;
+			MetaFloat64Array *array = retrieve->type == OpType::BRACKET ? asFloat64Array(holder) : nullptr;
+			if (map)
+				map->set(interpret(retrieve->index), result);
+			else if (array)
 			{
-				Object index = interpret(retrieve->index.get());
+				Object index = interpret(retrieve->index);
+				if (!index.isNumber())
+					throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Index should be a number");
+
+				array->at((int)index.getNumber()) = result.getNumber();
+			}
+			else if (holder.isList() && retrieve->type == OpType::BRACKET)
+			{
+				Object index = interpret(retrieve->index);
 				if (!index.isNumber())
 					throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Index should be a number");
 
@@ -431,10 +479,10 @@ namespace CXX
 					holder.getInstance()->set(retrieve->identifier, result);
 				else
 				{
-					Object attr = interpret(retrieve->index.get());
+					Object attr = interpret(retrieve->index);
 					if (!attr.isString())
 						throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Attr should be a string");
-					holder.getInstance()->set(attr.getString(), result);
+					holder.getInstance()->set(Symbol(attr.getString()), result);
 				}
 			}
 		}
@@ -451,27 +499,46 @@ namespace CXX
 	{
 		using OpType = RetrieveExpr::OpType;
 
-		Object prev = interpret(decrementExpr->holder.get());
+		if (decrementExpr->specialization != Specialization::GENERIC)
+		{
+			Object prev, result;
+			if (stepNumber(decrementExpr->holder, decrementExpr->specialization, -1.0, prev, result))
+				return decrementExpr->type == DecrementExpr::Type::POSTFIX ? prev : result;
+		}
+
+		Object prev = interpret(decrementExpr->holder);
 		if (!prev.isNumber())
 		{
 			throw RuntimeError(decrementExpr->holder->pos_start, decrementExpr->holder->pos_end,
-							   format("Operator '--' does not support type(%s)", ObjectTypeName(prev.type)));
+							   format("Operator '--' does not support type(%s)", ObjectTypeName(prev.type())));
 		}
 
 		Object result = prev - Object(1.0);
 
 		if (decrementExpr->holder->exprType == ExprType::Variable)
 		{
-			auto var = static_cast<VariableExpr *>(decrementExpr->holder.get());
-			context->change(var->identifier, result);
+			auto var = static_cast<VariableExpr *>(decrementExpr->holder);
+			lookupVariable(var->identifier, var->depth, var->slot) = result;
 		}
 		else
 		{
-			auto retrieve = static_cast<RetrieveExpr *>(decrementExpr->holder.get());
-			Object holder = interpret(retrieve->holder.get());
-			if (Classifier::belongClass(holder, "List") && retrieve->type == OpType::BRACKET)
+			auto retrieve = static_cast<RetrieveExpr *>(decrementExpr->holder);
+			Object holder = interpret(retrieve->holder);
+			MetaMap *map = retrieve->type == OpType::BRACKET ? asMap(holder) : nullptr;
+			MetaFloat64Array *array = retrieve->type == OpType::BRACKET ? asFloat64Array(holder) : nullptr;
+			if (map)
+				map->set(interpret(retrieve->index), result);
+			else if (array)
+			{
+				Object index = interpret(retrieve->index);
+				if (!index.isNumber())
+					throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Index should be a number");
+
+				array->at((int)index.getNumber()) = result.getNumber();
+			}
+			else if (holder.isList() && retrieve->type == OpType::BRACKET)
 			{
-				Object index = interpret(retrieve->index.get());
+				Object index = interpret(retrieve->index);
 				if (!index.isNumber())
 					throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Index should be a number");
 
@@ -484,10 +551,10 @@ namespace CXX
 					holder.getInstance()->set(retrieve->identifier, result);
 				else
 				{
-					Object attr = interpret(retrieve->index.get());
+					Object attr = interpret(retrieve->index);
 					if (!attr.isString())
 						throw RuntimeError(retrieve->index->pos_start, retrieve->index->pos_end, "Attr should be a string");
-					holder.getInstance()->set(attr.getString(), result);
+					holder.getInstance()->set(Symbol(attr.getString()), result);
 				}
 			}
 		}
@@ -500,22 +567,102 @@ namespace CXX
 		return result;
 	}
 
+	bool Interpreter::stepNumber(Expr *holder, Specialization &specialization, double delta, Object &prev, Object &result)
+	{
+		if (holder->exprType == ExprType::Variable)
+		{
+			auto var = static_cast<VariableExpr *>(holder);
+
+			// 与interpret(holder)一样跟踪执行位置
+			Runner::pos_start = &holder->pos_start;
+			Runner::pos_end = &holder->pos_end;
+
+			// 原地修改变量，省去一次求值与一次查找
+			Object &value = lookupVariable(var->identifier, var->depth, var->slot);
+			if (value.isNumber())
+			{
+				specialization = Specialization::NUMBER;
+				prev = value;
+				value = result = Object(prev.getNumber() + delta);
+				return true;
+			}
+		}
+
+		specialization = Specialization::GENERIC;
+		return false;
+	}
+
 	Object Interpreter::visit(const CallExpr *callExpr)
 	{
-		Object callee = interpret(callExpr->callee.get());
+		if (callExpr->callee->exprType == ExprType::Retrieve &&
+			static_cast<RetrieveExpr *>(callExpr->callee)->type == RetrieveExpr::OpType::DOT)
+			return invoke(callExpr);
+
+		Object callee = interpret(callExpr->callee);
 
 		if (!callee.isCallable())
 		{
 			throw RuntimeError(callExpr->callee->pos_start, callExpr->callee->pos_end, "Expression is not callable");
 		}
 
+		return call(callExpr, callee.getCallable(), nullptr);
+	}
+
+	Object Interpreter::invoke(const CallExpr *callExpr)
+	{
+		auto retrieve = static_cast<RetrieveExpr *>(callExpr->callee);
+
+		Object holder = interpret(retrieve->holder);
+
+		// 列表没有字段，直接在List的成员函数中查找
+		if (holder.isList())
+		{
+			CallablePtr method = List::getSingleton()->findMethods(retrieve->identifier.symbol);
+			if (!method)
+				throw RuntimeError(callExpr->callee->pos_start, callExpr->callee->pos_end, "Expression is not callable");
+
+			return call(callExpr, method, &holder);
+		}
+
+		if (!holder.isInstance())
+		{
+			throw RuntimeError(retrieve->pos_start, retrieve->pos_end,
+							   format("Cannot apply . to object type(%s)", ObjectTypeName(holder.type())));
+		}
+
+		const InstancePtr &instance = holder.getInstance();
+
+		// 字段优先于成员函数，字段中存放的函数按普通函数调用
+		if (Object *field = instance->field(retrieve->identifier.symbol, retrieve->cache))
+		{
+			Object callee = *field;
+			if (!callee.isCallable())
+				throw RuntimeError(callExpr->callee->pos_start, callExpr->callee->pos_end, "Expression is not callable");
+
+			return call(callExpr, callee.getCallable(), nullptr);
+		}
+
+		CallablePtr method = instance->belonging->findMethods(retrieve->identifier.symbol);
+		if (!method)
+			throw RuntimeError(callExpr->callee->pos_start, callExpr->callee->pos_end, "Expression is not callable");
+
+		return call(callExpr, method, &holder);
+	}
+
+	Object Interpreter::call(const CallExpr *callExpr, const CallablePtr &callable, const Object *receiver)
+	{
 		std::vector<Object> args;
 		for (auto &arg : callExpr->arguments)
 		{
-			args.push_back(interpret(arg.get()));
+			args.push_back(interpret(arg));
 		}
 
-		CallablePtr callable = callee.getCallable();
+		return apply(callExpr, callable, receiver, args);
+	}
+
+	Object Interpreter::apply(const CallExpr *callExpr, const CallablePtr &callable, const Object *receiver,
+							  const std::vector<Object> &args)
+	{
 		size_t arg_size = args.size();
 
 		// 当函数参数元数为-1时，表示接收不限量参数，仅内置函数支持
@@ -526,12 +673,23 @@ namespace CXX
 							   format("Function expected %d argument(s), %d is required, only got %d", callable->arity(), callable->required_params(), arg_size));
 		}
 
+		// 原生函数的报错位置，与VM一致
+		const Expr *culprit = callExpr->culprit();
+		Runner::pos_start = const_cast<Position *>(&culprit->pos_start);
+		Runner::pos_end = const_cast<Position *>(&culprit->pos_end);
+
 		Callable *prev = currentFunction;
 		currentFunction = callable.get();
 
 		auto task = toggleRepl();
 
-		Object result = callable->call(*this, args);
+		Object result;
+		if (!receiver)
+			result = callable->call(*this, args);
+		else if (receiver->isInstance())
+			result = callable->invoke(*this, receiver->getInstance(), args);
+		else
+			result = static_cast<NativeMethod *>(callable.get())->invoke(*this, *receiver, args);
 		currentFunction = prev;
 
 		return result;
@@ -541,10 +699,49 @@ namespace CXX
 	{
 		using OpType = RetrieveExpr::OpType;
 
-		Object holder = interpret(retrieveExpr->holder.get());
-		if (Classifier::belongClass(holder, "List") && retrieveExpr->type == OpType::BRACKET)
+		Object holder = interpret(retrieveExpr->holder);
+
+		if (retrieveExpr->type == OpType::BRACKET && retrieveExpr->specialization != Specialization::GENERIC)
+		{
+			if (MetaList *list = asList(holder))
+			{
+				Object index = interpret(retrieveExpr->index);
+				if (!index.isNumber())
+				{
+					throw RuntimeError(retrieveExpr->index->pos_start, retrieveExpr->index->pos_end, "Index should be a number");
+				}
+
+				retrieveExpr->specialization = Specialization::LIST;
+				return list->at((int)index.getNumber());
+			}
+
+			retrieveExpr->specialization = Specialization::GENERIC;
+		}
+
+		if (retrieveExpr->type == OpType::BRACKET)
+		{
+			// 不存在的键与不存在的属性一样返回nil
+			if (MetaMap *map = asMap(holder))
+			{
+				Object *value = map->find(interpret(retrieveExpr->index));
+				return value ? *value : Object();
+			}
+
+			if (MetaFloat64Array *array = asFloat64Array(holder))
+			{
+				Object index = interpret(retrieveExpr->index);
+				if (!index.isNumber())
+				{
+					throw RuntimeError(retrieveExpr->index->pos_start, retrieveExpr->index->pos_end, "Index should be a number");
+				}
+
+				return Object(array->at((int)index.getNumber()));
+			}
+		}
+
+		if (retrieveExpr->type == OpType::BRACKET && holder.isList())
 		{
-			Object index = interpret(retrieveExpr->index.get());
+			Object index = interpret(retrieveExpr->index);
 			if (!index.isNumber())
 			{
 				throw RuntimeError(retrieveExpr->index->pos_start, retrieveExpr->index->pos_end, "Index should be a number");
@@ -552,58 +749,83 @@ namespace CXX
 
 			return listAt(holder, index);
 		}
+		else if (holder.isList() && retrieveExpr->type == OpType::DOT)
+		{
+			// 列表只有成员函数，取到的是绑定了该列表的函数
+			return List::getMethod(holder, retrieveExpr->identifier.symbol);
+		}
 		else if (holder.isInstance())
 		{
 			// 目前的设计是，如果对象没有索取的属性，则返回Nil
 			// 这种设计和JavaScript一致，但容易造成bug
 			if (retrieveExpr->type == OpType::DOT)
-				return holder.getInstance()->get(retrieveExpr->identifier);
+				return holder.getInstance()->get(retrieveExpr->identifier.symbol, retrieveExpr->cache);
 			else
 			{
-				Object attr = interpret(retrieveExpr->index.get());
+				Object attr = interpret(retrieveExpr->index);
 				if (!attr.isString())
 				{
 					throw RuntimeError(retrieveExpr->index->pos_start, retrieveExpr->index->pos_end, "attribute should be a string");
 				}
 
-				return holder.getInstance()->get(attr.getString());
+				return holder.getInstance()->getAttr(attr.getString());
 			}
 		}
 
 		const char *op = retrieveExpr->type == OpType::DOT ? "." : "[]";
 		throw RuntimeError(retrieveExpr->pos_start, retrieveExpr->pos_end,
-						   format("Cannot apply %s to object type(%s)", op, ObjectTypeName(holder.type)));
+						   format("Cannot apply %s to object type(%s)", op, ObjectTypeName(holder.type())));
 	}
 
 	Object Interpreter::visit(const SetExpr *setExpr)
 	{
 		using OpType = RetrieveExpr::OpType;
 
-		Object holder = interpret(setExpr->holder.get());
+		Object holder = interpret(setExpr->holder);
 
-		if (holder.isInstance())
+		// Map与List同样是实例，须先于普通实例判断
+		MetaMap *map = setExpr->type == OpType::BRACKET ? asMap(holder) : nullptr;
+		if (map)
 		{
-			if (setExpr->type == OpType::BRACKET)
+			Object key = interpret(setExpr->index);
+
+			// 只有复合赋值才需要旧值
+			Object prev;
+			if (setExpr->operation.type != TokenType::EQ)
 			{
-				Object attr = interpret(setExpr->index.get());
-				if (!attr.isString())
-				{
-					throw RuntimeError(setExpr->index->pos_start, setExpr->index->pos_end, "Attribute should be a string");
-				}
-				const_cast<SetExpr *>(setExpr)->identifier.lexeme = attr.getString();
+				if (Object *found = map->find(key))
+					prev = *found;
 			}
 
-			Object prev = holder.getInstance()->get(setExpr->identifier);
-			// 要赋予或改变的新value
-			Object value = interpret(setExpr->value.get());
+			Object value = interpret(setExpr->value);
 			value = handleAssign(prev, value, setExpr->operation.type);
-			holder.getInstance()->set(setExpr->identifier, value);
+			map->set(key, value);
+			return value;
+		}
+		else if (MetaFloat64Array *array = setExpr->type == OpType::BRACKET ? asFloat64Array(holder) : nullptr)
+		{
+			Object index = interpret(setExpr->index);
+			if (!index.isNumber())
+			{
+				throw RuntimeError(setExpr->index->pos_start, setExpr->index->pos_end, "Index should be a number");
+			}
+
+			// 先检查下标，再对右侧求值
+			Object prev(array->at((int)index.getNumber()));
+			Object value = interpret(setExpr->value);
+			value = handleAssign(prev, value, setExpr->operation.type);
+			if (!value.isNumber())
+			{
+				throw RuntimeError(setExpr->value->pos_start, setExpr->value->pos_end, "Float64Array can only hold numbers");
+			}
+
+			array->at((int)index.getNumber()) = value.getNumber();
 			return value;
 		}
-		else if (Classifier::belongClass(holder, "List") && setExpr->type == OpType::BRACKET)
+		else if (holder.isList() && setExpr->type == OpType::BRACKET)
 		{
 			// 这里为了拿到引用而不是复制，所以重复了Retrieve中的代码
-			Object index = interpret(setExpr->index.get());
+			Object index = interpret(setExpr->index);
 			if (!index.isNumber())
 			{
 				throw RuntimeError(setExpr->index->pos_start, setExpr->index->pos_end, "Index should be a number");
@@ -612,23 +834,53 @@ namespace CXX
 			Object &prev = listAt(holder, index);
 
 			// 要赋予或改变的新value
-			Object value = interpret(setExpr->value.get());
+			Object value = interpret(setExpr->value);
 			value = handleAssign(prev, value, setExpr->operation.type);
 
 			prev = value;
 			return value;
 		}
+		else if (holder.isInstance())
+		{
+			const InstancePtr &instance = holder.getInstance();
+			if (setExpr->type == OpType::BRACKET)
+			{
+				Object attr = interpret(setExpr->index);
+				if (!attr.isString())
+				{
+					throw RuntimeError(setExpr->index->pos_start, setExpr->index->pos_end, "Attribute should be a string");
+				}
+
+				Symbol name(attr.getString());
+				Object prev = instance->get(name);
+				// 要赋予或改变的新value
+				Object value = interpret(setExpr->value);
+				value = handleAssign(prev, value, setExpr->operation.type);
+				instance->set(name, value);
+				return value;
+			}
+
+			// 只有复合赋值才需要旧值
+			Object prev;
+			if (setExpr->operation.type != TokenType::EQ)
+				prev = instance->get(setExpr->identifier);
+
+			Object value = interpret(setExpr->value);
+			value = handleAssign(prev, value, setExpr->operation.type);
+			instance->set(setExpr->identifier.symbol, value, setExpr->cache);
+			return value;
+		}
 
 		const char *op = setExpr->type == OpType::DOT ? "." : "[]";
 		throw RuntimeError(setExpr->pos_start, setExpr->pos_end,
-						   format("Cannot apply %s to object type(%s)", op, ObjectTypeName(holder.type)));
+						   format("Cannot apply %s to object type(%s)", op, ObjectTypeName(holder.type())));
 
 		return Object();
 	}
 
 	Object Interpreter::visit(const ThisExpr *thisExpr)
 	{
-		return lookupVariable(thisExpr->keyword, thisExpr->depth);
+		return lookupVariable(thisExpr->keyword, thisExpr->depth, thisExpr->slot);
 	}
 
 	Object Interpreter::visit(const SuperExpr *superExpr)
@@ -646,13 +898,13 @@ namespace CXX
 			superClass = static_cast<Class *>(currentFunction)->superClass.value();
 		}
 
-		CallablePtr method = superClass->findMethods(superExpr->identifier.lexeme);
+		CallablePtr method = superClass->findMethods(superExpr->identifier.symbol);
 		if (!method)
 			throw RuntimeError(superExpr->pos_start, superExpr->pos_end,
-							   format("Undefined method %s", superExpr->identifier.lexeme.c_str()));
+							   format("Undefined method %s", superExpr->identifier.symbol.c_str()));
 
-		int distance = superExpr->depth;
-		Object &instance = context->getAt("this", distance);
+		// super与this共用同一个槽位
+		Object &instance = context->getAt(superExpr->depth, superExpr->slot);
 		CallablePtr bindMethod = method->bindThis(instance.getInstance());
 
 		return Object(bindMethod);
@@ -662,7 +914,7 @@ namespace CXX
 	{
 		std::vector<Object> items;
 		for (auto &expr : listExpr->items)
-			items.push_back(interpret(expr.get()));
+			items.push_back(interpret(expr));
 
 		return Object(List::instantiate(std::move(items)));
 	}
@@ -672,7 +924,7 @@ namespace CXX
 		Object ret;
 		for (auto const &expr : packExpr->expressions)
 		{
-			ret = interpret(expr.get());
+			ret = interpret(expr);
 		}
 
 		// 对于用','分隔的一整句，返回最后一个值
@@ -694,6 +946,9 @@ namespace CXX
 		Runner::pos_start = &pStmt->pos_start;
 		Runner::pos_end = &pStmt->pos_end;
 
+		// 语句之间是安全的回收时机
+		GarbageCollector::maybeCollect();
+
 		pStmt->accept(*this);
 	}
 
@@ -713,32 +968,51 @@ namespace CXX
 		// 内置类
 		auto StringClass = String::getSingleton();
 		auto ListClass = List::getSingleton();
+		auto MapClass = Map::getSingleton();
+		auto SetClass = Set::getSingleton();
+		auto Float64ArrayClass = Float64Array::getSingleton();
+		auto StringBuilderClass = StringBuilder::getSingleton();
 
 		std::vector<Object> built_in_functions = {
 			Object(std::move(clock)), Object(std::move(str)), Object(std::move(typo)),
 			Object(std::move(chr)), Object(std::move(getc)), Object(std::move(exit)),
 			Object(std::move(print)), Object(std::move(getattr)), Object(std::move(loadlib)),
-			Object(std::move(StringClass)), Object(std::move(ListClass))};
+			Object(std::move(StringClass)), Object(std::move(ListClass)), Object(std::move(MapClass)),
+			Object(std::move(SetClass)), Object(std::move(Float64ArrayClass)), Object(std::move(StringBuilderClass))};
 
 		for (auto const &func : built_in_functions)
 		{
-			presetContext->set(func.getCallable()->name(), func);
+			presetContext->set(Symbol(func.getCallable()->name()), func);
 		}
 
 		// 内置变量
 		presetContext->set("Math", Object(Mathematics::instantiate()));
 	}
 
-	Object &Interpreter::lookupVariable(const Token &identifier, int depth)
+	Object &Interpreter::lookupVariable(const Token &identifier, int depth, int slot)
 	{
 		if (depth != -1)
 		{
-			return context->getAt(identifier, depth);
+			// 模块顶层作用域中的变量没有槽位
+			if (slot != -1)
+				return context->getAt(depth, slot);
+
+			return context->getAt(depth, identifier);
 		}
 
 		return globalContext->get(identifier);
 	}
 
+	Object &Interpreter::define(const Token &identifier, int slot, const Object &value)
+	{
+		if (slot != -1)
+			return context->slots[slot] = value;
+
+		Object &var = context->variables[identifier.symbol];
+		var = value;
+		return var;
+	}
+
 	Object Interpreter::handleAssign(const Object &prev, const Object &value, TokenType op)
 	{
 		switch (op)
@@ -761,32 +1035,50 @@ namespace CXX
 
 	Object &Interpreter::listAt(const Object &holder, const Object &index)
 	{
-		// 内部类List的唯一成员items是一个MetaList
-		auto list = holder.getInstance()->get("@items");
-
 		// index必须是Number，在调用该函数前应检查
-		return getMetaList(list)->at((int)index.getNumber());
+		return holder.getList()->at((int)index.getNumber());
 	}
 
-	std::shared_ptr<Module> Interpreter::loadModule(const Token &filepath)
+	BlockStmt *Interpreter::parseModule(const Token &filepath, AstArenaPtr &arena)
 	{
-		std::optional<std::string> fileContent = readfile(filepath.lexeme);
+		// 已在后台预处理过的模块直接取用，暂存的错误此时才输出
+		if (auto prefetched = ModuleLoader::take(filepath.symbol.str()))
+		{
+			ErrorReporter::replay(prefetched->errors);
+			arena = std::move(prefetched->arena);
+			return prefetched->block;
+		}
+
+		std::optional<std::string> fileContent = readfile(filepath.symbol.str());
 		if (!fileContent)
 		{
-			throw RuntimeError(filepath.pos_start, filepath.pos_end, "Error in loading Module from file:" + filepath.lexeme);
+			throw RuntimeError(filepath.pos_start, filepath.pos_end, "Error in loading Module from file:" + filepath.symbol.str());
 		}
 
-#ifdef USE_STRING_VIEW
-		static std::vector<std::string> TEXT;
-		TEXT.push_back(std::move(fileContent.value()));
-		Lexer lexer(filepath.lexeme, TEXT.back());
-#else
-		Lexer lexer(filepath.lexeme, *fileContent);
-#endif
-		std::vector<Token> tokens;
+		return parseModuleSource(filepath.symbol.str(), std::move(*fileContent), arena);
+	}
+
+	BlockStmt *Interpreter::parseModuleSource(const std::string &path, std::string content, AstArenaPtr &arena)
+	{
+		const SourceFile &source = SourceFile::add(path, std::move(content));
+		if (auto cached = AstCache::load(source, AstCache::Unit::MODULE, arena))
+		{
+			// 模块缓存中只有一个包住整个模块的BlockStmt
+			if (cached->size() == 1 && cached->front()->stmtType == StmtType::Block)
+			{
+				auto blockStmt = static_cast<BlockStmt *>(cached->front());
+				TypeInferencer::inferModule(blockStmt);
+				return blockStmt;
+			}
+		}
+
+		Lexer lexer(source);
+		std::vector<StmtPtr> stmts;
 		try
 		{
-			tokens = std::move(lexer.tokenize());
+			Parser parser(lexer, Runner::lazyParsing());
+			stmts = parser.parse();
+			arena = parser.arena();
 		}
 		catch (const std::exception &e)
 		{
@@ -795,8 +1087,6 @@ namespace CXX
 			return nullptr;
 		}
 
-		Parser parser(std::move(tokens));
-		std::vector<StmtPtr> stmts = parser.parse();
 		if (ErrorReporter::errorCount != 0)
 		{
 			// parsing error
@@ -804,20 +1094,35 @@ namespace CXX
 		}
 
 		// 这里包起来主要是为了让Resolver的scopes层级+1，以符合import的语境
-		std::shared_ptr<BlockStmt> blockStmt = std::make_shared<BlockStmt>(std::move(stmts));
+		BlockStmt *blockStmt = arena->make<BlockStmt>(std::move(stmts));
 		Resolver resolver;
-		resolver.resolve(blockStmt.get());
+		resolver.resolveModule(blockStmt);
 		if (ErrorReporter::errorCount != 0)
 		{
 			// resolving error
 			return nullptr;
 		}
 
+		ConstantFolder(*arena).fold(blockStmt->statements);
+		TypeInferencer::inferModule(blockStmt);
+		AstCache::store(source, AstCache::Unit::MODULE, {blockStmt});
+		return blockStmt;
+	}
+
+	std::shared_ptr<Module> Interpreter::loadModule(const Token &filepath)
+	{
+		AstArenaPtr arena;
+		BlockStmt *blockStmt = parseModule(filepath, arena);
+		if (!blockStmt)
+		{
+			return nullptr;
+		}
+
 		// backup current context
 		ContextPtr context_bak = context, global_bak = globalContext;
 		// create new module global context
 		ContextPtr moduleEnv = std::make_shared<Context>(presetContext);
-		moduleEnv->set("__name__", Object(filepath.lexeme));
+		moduleEnv->set("__name__", Object(filepath.symbol));
 
 		globalContext = moduleEnv;
 		context = globalContext;
@@ -827,11 +1132,14 @@ namespace CXX
 			globalContext.swap(global_bak);
 			context.swap(context_bak); });
 
-		interpret(blockStmt->statements);
+		if (Runner::USE_CLOSURE)
+			ClosureCompiler::run(*this, blockStmt->statements);
+		else
+			interpret(blockStmt->statements);
 
 		moduleEnv->variables.erase("__name__");
 
-		return std::make_shared<Module>(moduleEnv->variables);
+		return std::make_shared<Module>(moduleEnv->variables, std::move(arena));
 	}
 
 	std::unique_ptr<Finally> Interpreter::toggleRepl()
@@ -847,9 +1155,8 @@ namespace CXX
 
 	Object Interpreter::getReturn()
 	{
-		Object value = *m_returns;
-		m_returns.reset();
-		return value;
+		completion = Completion::NORMAL;
+		return std::move(m_returns);
 	}
 
 }
\ No newline at end of file
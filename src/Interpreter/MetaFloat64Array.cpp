@@ -0,0 +1,144 @@
+#include "Interpreter/MetaFloat64Array.h"
+#include "Interpreter/Float64Kernels.h"
+#include "Interpreter/loxlib/NativeClass.h"
+#include "Common/utils.h"
+#include "Runner.h"
+
+namespace CXX {
+
+	MetaFloat64Array::MetaFloat64Array(size_t length) : Container("MetaFloat64Array"), data(length, 0.0) {}
+
+	MetaFloat64Array::MetaFloat64Array(std::vector<double> data) : Container("MetaFloat64Array"), data(std::move(data)) {}
+
+	double& MetaFloat64Array::at(int index)
+	{
+		assertBound(index);
+		return data[index];
+	}
+
+	void MetaFloat64Array::scale(double factor)
+	{
+		kernels::scale(data.data(), factor, data.size());
+	}
+
+	void MetaFloat64Array::axpy(double factor, const MetaFloat64Array& other)
+	{
+		assertSameLength(other, "axpy");
+		kernels::axpy(data.data(), factor, other.data.data(), data.size());
+	}
+
+	void MetaFloat64Array::add(const MetaFloat64Array& other)
+	{
+		assertSameLength(other, "add");
+		kernels::add(data.data(), other.data.data(), data.size());
+	}
+
+	void MetaFloat64Array::mul(const MetaFloat64Array& other)
+	{
+		assertSameLength(other, "mul");
+		kernels::mul(data.data(), other.data.data(), data.size());
+	}
+
+	void MetaFloat64Array::prefixSum()
+	{
+		kernels::prefixSum(data.data(), data.size());
+	}
+
+	double MetaFloat64Array::sum() const
+	{
+		return kernels::sum(data.data(), data.size());
+	}
+
+	Object MetaFloat64Array::min() const
+	{
+		if (data.empty())
+			return Object();
+
+		return Object(kernels::min(data.data(), data.size()));
+	}
+
+	Object MetaFloat64Array::max() const
+	{
+		if (data.empty())
+			return Object();
+
+		return Object(kernels::max(data.data(), data.size()));
+	}
+
+	double MetaFloat64Array::dot(const MetaFloat64Array& other) const
+	{
+		assertSameLength(other, "dot");
+		return kernels::dot(data.data(), other.data.data(), data.size());
+	}
+
+	MetaFloat64ArrayPtr MetaFloat64Array::copy() const
+	{
+		return std::make_shared<MetaFloat64Array>(data);
+	}
+
+	Object MetaFloat64Array::toList() const
+	{
+		std::vector<Object> items;
+		items.reserve(data.size());
+		for (double number : data)
+			items.emplace_back(number);
+
+		return Object(List::instantiate(std::move(items)));
+	}
+
+	size_t MetaFloat64Array::length() const
+	{
+		return data.size();
+	}
+
+	std::string MetaFloat64Array::to_string()
+	{
+		std::string result = "Float64Array[";
+		for (size_t i = 0; i < data.size(); i++)
+		{
+			if (i != 0)
+				result += ", ";
+			result += Object(data[i]).to_string();
+		}
+		result.push_back(']');
+
+		return result;
+	}
+
+	void MetaFloat64Array::assertBound(int& index) const
+	{
+		// 与List相同，负下标从末尾开始计数
+		if (index < 0)
+			index = data.size() + index;
+
+		if (index < 0 || index >= data.size())
+		{
+			throw RuntimeError(Runner::pos_start, Runner::pos_end, "Float64Array index out of bound");
+		}
+	}
+
+	void MetaFloat64Array::assertSameLength(const MetaFloat64Array& other, const char* name) const
+	{
+		if (other.data.size() != data.size())
+		{
+			throw RuntimeError(Runner::pos_start, Runner::pos_end,
+							   format("Float64Array length mismatch in %s: %d and %d", name, (int)data.size(), (int)other.data.size()));
+		}
+	}
+
+	bool isMetaFloat64Array(const Object& obj)
+	{
+		if (!obj.isContainer())
+			return false;
+
+		return obj.getContainer()->type == "MetaFloat64Array";
+	}
+
+	MetaFloat64ArrayPtr getMetaFloat64Array(const Object& obj)
+	{
+		// 该函数仅在isMetaFloat64Array判断后调用
+		// 所以没有做类型判断
+		return std::static_pointer_cast<MetaFloat64Array>(obj.getContainer());
+	}
+
+}
@@ -10,12 +10,26 @@ namespace CXX {
 
 	void MetaList::reverse()
 	{
-		std::reverse(items.begin(), items.end());
+		std::reverse(items.begin() + head, items.end());
+	}
+
+	void MetaList::trace(GarbageCollector& gc) const
+	{
+		for (size_t i = head; i < items.size(); i++)
+			gc.mark(items[i]);
+	}
+
+	void MetaList::clear(std::vector<Object>& trash)
+	{
+		for (size_t i = head; i < items.size(); i++)
+			trash.push_back(std::move(items[i]));
+
+		reset();
 	}
 
 	size_t MetaList::length()
 	{
-		return items.size();
+		return items.size() - head;
 	}
 
 	void MetaList::append(const Object& val)
@@ -25,39 +39,73 @@ namespace CXX {
 
 	Object MetaList::pop()
 	{
-		if (items.empty()) {
+		if (length() == 0) {
 			throw RuntimeError(Runner::pos_start, Runner::pos_end, "Poping from empty List");
 		}
 
-		Object ret = items.back();
+		Object ret = std::move(items.back());
 		items.pop_back();
+		if (length() == 0)
+			reset();
+
+		return ret;
+	}
+
+	Object MetaList::shift()
+	{
+		if (length() == 0) {
+			throw RuntimeError(Runner::pos_start, Runner::pos_end, "Shifting from empty List");
+		}
+
+		Object ret = std::move(items[head]);
+		items[head++] = Object();
+
+		// 空位超过一半时整体前移，移动的元素数不超过之前shift的次数
+		// 前移后仍保留元素数一半的空位，交替unshift/shift时不会反复移动全部元素
+		if (length() == 0)
+			reset();
+		else if (head >= 16 && head * 2 >= items.size())
+		{
+			size_t kept = length() / 2;
+			items.erase(items.begin(), items.begin() + (head - kept));
+			head = kept;
+		}
+
 		return ret;
 	}
 
 	void MetaList::remove(const Object& val)
 	{
-		auto it = std::find(items.begin(), items.end(), val);
+		auto it = std::find(items.begin() + head, items.end(), val);
 		if (it != items.end())
 			items.erase(it);
 	}
 
 	void MetaList::unshift(const Object& val)
 	{
-		items.insert(items.begin(), val);
+		// 头部没有空位时，预留与现有元素数相当的空位
+		if (head == 0)
+		{
+			size_t reserved = std::max<size_t>(length(), 8);
+			items.insert(items.begin(), reserved, Object());
+			head = reserved;
+		}
+
+		items[--head] = val;
 	}
 
 	Object& MetaList::at(int index)
 	{
 		assertBound(index);
-		return items.at(index);
+		return items[head + index];
 	}
 
 	Object MetaList::indexOf(const Object& val, int fromIndex)
 	{
 		assertBound(fromIndex);
-		auto pos = std::find(items.begin() + fromIndex, items.end(), val);
+		auto pos = std::find(items.begin() + head + fromIndex, items.end(), val);
 		if (pos != items.end())
-			return Object((double)(pos - items.begin()));
+			return Object((double)(pos - items.begin() - head));
 
 		return Object(-1.0);
 	}
@@ -65,25 +113,25 @@ namespace CXX {
 	Object MetaList::lastIndexOf(const Object& val, int fromIndex)
 	{
 		assertBound(fromIndex);
-		auto pos = std::find(items.rbegin() + fromIndex, items.rend(), val);
-		if (pos != items.rend())
-			return Object((double)(items.size() - (pos - items.rbegin()) - 1));
+		auto pos = std::find(items.rbegin() + fromIndex, items.rend() - head, val);
+		if (pos != items.rend() - head)
+			return Object((double)(length() - (pos - items.rbegin()) - 1));
 
 		return Object(-1.0);
 	}
 
 	Object MetaList::reduce(std::shared_ptr<Callable> func)
 	{
-		size_t length = items.size();
-		if (length == 0)
+		if (length() == 0)
 			return Object();
-		else if (length == 1)
-			return items[0];
+		else if (length() == 1)
+			return items[head];
 
-		Object reduction = func->call(Runner::interpreter, { items[0], items[1] });
-		for (size_t i = 2; i < length; i++)
+		// 回调可能修改列表，每次都重新检查长度
+		Object reduction = func->call(Runner::interpreter, { items[head], items[head + 1] });
+		for (size_t i = 2; i < length(); i++)
 		{
-			reduction = func->call(Runner::interpreter, { reduction, items[i] });
+			reduction = func->call(Runner::interpreter, { reduction, items[head + i] });
 		}
 
 		return reduction;
@@ -92,14 +140,12 @@ namespace CXX {
 	Object MetaList::map(std::shared_ptr<Callable> func)
 	{
 		std::vector<Object> newitems;
-		for (size_t i = 0; i < items.size(); i++)
+		for (size_t i = 0; i < length(); i++)
 		{
-			newitems.push_back(func->call(Runner::interpreter, { items[i] }));
+			newitems.push_back(func->call(Runner::interpreter, { items[head + i] }));
 		}
 
-		InstancePtr instance = List::instantiate(std::move(newitems));
-
-		return Object(std::move(instance));
+		return List::instantiate(std::move(newitems));
 	}
 
 	Object MetaList::slice(int fromIndex, int endIndex)
@@ -110,25 +156,19 @@ namespace CXX {
 			throw RuntimeError(Runner::pos_start, Runner::pos_end, "invalid range of List");
 		}
 
-		return Object(List::instantiate(std::vector<Object>(items.begin() + fromIndex, items.begin() + endIndex)));
+		return List::instantiate(std::vector<Object>(items.begin() + head + fromIndex, items.begin() + head + endIndex));
 	}
 
 	std::string MetaList::to_string()
 	{
 		std::string result = "[";
-		for (size_t i = 0; i < items.size(); i++)
+		for (size_t i = head; i < items.size(); i++)
 		{
 			Object& item = items[i];
 
 			// 要防止列表中包含自己导致的无限循环
-			if (Classifier::belongClass(item, "List"))
-			{
-				auto list = item.getInstance()->get("@items");
-				if (list.getContainer().get() == this)
-					result += "...";
-				else
-					result += item.to_string();
-			}
+			if (item.isList() && item.getList().get() == this)
+				result += "...";
 			else
 				result += item.to_string();
 
@@ -144,32 +184,35 @@ namespace CXX {
 	{
 		// 如果是负下标，assertBound会将其改为正值
 		if (index < 0)
-			index = items.size() + index;
+			index = length() + index;
 
-		if (index < 0 || index >= items.size())
+		if (index < 0 || index >= length())
 		{
 			throw RuntimeError(Runner::pos_start, Runner::pos_end, "List index out of bound");
 		}
 	}
 
+	void MetaList::reset()
+	{
+		items.clear();
+		head = 0;
+	}
+
 	bool operator==(const MetaList& lhs, const MetaList& rhs)
 	{
-		if (lhs.items.size() != rhs.items.size())
+		size_t length = lhs.items.size() - lhs.head;
+		if (rhs.items.size() - rhs.head != length)
 			return false;
 
-		for (size_t i = 0; i < lhs.items.size(); i++)
+		for (size_t i = 0; i < length; i++)
 		{
-			const Object& item = lhs.items[i];
+			const Object& item = lhs.items[lhs.head + i];
 
 			// 要防止列表中包含自己导致的无限循环
-			if (Classifier::belongClass(item, "List"))
-			{
-				auto list = item.getInstance()->get("@items");
-				if (list.getContainer().get() == &lhs)
-					return false;
-			}
-
-			if (item != rhs.items[i])
+			if (item.isList() && item.getList().get() == &lhs)
+				return false;
+
+			if (item != rhs.items[rhs.head + i])
 				return false;
 		}
 
@@ -178,17 +221,14 @@ namespace CXX {
 
 	bool isMetaList(const Object& obj)
 	{
-		if (!obj.isContainer())
-			return false;
-
-		return obj.getContainer()->type == "MetaList";
+		return obj.isList();
 	}
 
 	MetaListPtr getMetaList(const Object& obj)
 	{
 		// 该函数仅在isMetaList判断后调用
 		// 所以没有做类型判断
-		return std::dynamic_pointer_cast<MetaList>(obj.getContainer());
+		return obj.getList();
 	}
 
 }
\ No newline at end of file
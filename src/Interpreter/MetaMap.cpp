@@ -0,0 +1,300 @@
+#include "Interpreter/MetaMap.h"
+#include "Interpreter/Class.h"
+#include "Interpreter/loxlib/NativeClass.h"
+#include "Runner.h"
+#include <functional>
+
+namespace CXX {
+
+	MetaMap::MetaMap() : Container("MetaMap") {}
+
+	MetaMap::MetaMap(const char* type) : Container(type) {}
+
+	// std::hash对指针、整数基本是恒等映射，低位分布差，探测前先打散
+	static size_t mix(size_t hash)
+	{
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	size_t hashObject(const Object& obj)
+	{
+		switch (obj.type())
+		{
+		case ObjectType::NIL:
+			return 0;
+
+		case ObjectType::BOOL:
+			return obj.getBoolean() ? 1 : 2;
+
+		case ObjectType::NUMBER:
+		{
+			// 0.0 == -0.0，两者的哈希须相同
+			double number = obj.getNumber();
+			return std::hash<double>()(number == 0.0 ? 0.0 : number);
+		}
+
+		case ObjectType::STRING:
+			return std::hash<std::string>()(obj.getString());
+
+		case ObjectType::CALLABLE:
+			return std::hash<const void*>()(obj.getCallable().get());
+
+		case ObjectType::INSTANCE:
+		{
+			const InstancePtr& instance = obj.getInstance();
+			Object hashFunc = instance->get("__hash__");
+			if (!hashFunc.isNil())
+			{
+				Object result = hashFunc.getCallable()->call(Runner::interpreter, {});
+				if (!result.isNumber())
+					throw RuntimeError(Runner::pos_start, Runner::pos_end, "__hash__ should return a number");
+
+				double number = result.getNumber();
+				return std::hash<double>()(number == 0.0 ? 0.0 : number);
+			}
+
+			// 没有__hash__时，与其相等的只可能是同类实例，整个类共用一个哈希值
+			if (!instance->get("__equal__").isNil())
+				return std::hash<const void*>()(instance->belonging.get());
+
+			return std::hash<const void*>()(instance.get());
+		}
+
+		case ObjectType::LIST:
+			// 列表按内容比较且可以修改，所有列表共用一个哈希值
+			return 3;
+
+		default:
+			return std::hash<const void*>()(obj.getContainer().get());
+		}
+	}
+
+	Object* MetaMap::find(const Object& key)
+	{
+		long slot = lookup(key, hashObject(key));
+		return slot < 0 ? nullptr : &entries[index[slot]].value;
+	}
+
+	Object& MetaMap::at(const Object& key)
+	{
+		size_t hash = hashObject(key);
+		long slot = lookup(key, hash);
+		if (slot >= 0)
+			return entries[index[slot]].value;
+
+		return insert(key, hash).value;
+	}
+
+	void MetaMap::set(const Object& key, const Object& value)
+	{
+		at(key) = value;
+	}
+
+	bool MetaMap::remove(const Object& key)
+	{
+		long slot = lookup(key, hashObject(key));
+		if (slot < 0)
+			return false;
+
+		// 键值立即释放，entries中的空位留到rehash时压缩
+		Entry& entry = entries[index[slot]];
+		entry.key = Object();
+		entry.value = Object();
+		entry.removed = true;
+
+		index[slot] = DELETED;
+		count--;
+		version++;
+		return true;
+	}
+
+	long MetaMap::lookup(const Object& key, size_t hash)
+	{
+		if (count == 0)
+			return -1;
+
+		size_t mask = index.size() - 1;
+	restart:
+		for (size_t slot = mix(hash) & mask;; slot = (slot + 1) & mask)
+		{
+			int32_t position = index[slot];
+			if (position == EMPTY)
+				return -1;
+			if (position == DELETED || entries[position].hash != hash)
+				continue;
+
+			// 实例的__equal__可能修改这张表，此时重新查找
+			size_t current = version;
+			Object candidate = entries[position].key;
+			bool equal = key == candidate;
+			if (version != current)
+			{
+				mask = index.size() - 1;
+				goto restart;
+			}
+
+			if (equal)
+				return (long)slot;
+		}
+	}
+
+	MetaMap::Entry& MetaMap::insert(const Object& key, size_t hash)
+	{
+		// 负载因子(包括DELETED)不超过3/4
+		// 复用DELETED槽位时used不增长，已删除的键值对多于有效的时也要压缩，否则反复增删时entries无限增长
+		if ((used + 1) * 4 > index.size() * 3 || entries.size() >= count * 2 + 16)
+			rehash(count + 1);
+
+		size_t mask = index.size() - 1;
+		size_t slot = mix(hash) & mask;
+		while (index[slot] >= 0)
+			slot = (slot + 1) & mask;
+
+		// 复用DELETED槽位时used不变
+		if (index[slot] == EMPTY)
+			used++;
+
+		index[slot] = (int32_t)entries.size();
+		entries.push_back({ key, Object(), hash, false });
+		count++;
+		version++;
+
+		return entries.back();
+	}
+
+	void MetaMap::rehash(size_t expected)
+	{
+		size_t capacity = 8;
+		while (capacity * 3 < expected * 4 * 2)
+			capacity <<= 1;
+
+		// 压缩掉已删除的键值对，保持插入顺序
+		size_t kept = 0;
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			if (entries[i].removed)
+				continue;
+			if (kept != i)
+				entries[kept] = std::move(entries[i]);
+			kept++;
+		}
+		entries.resize(kept);
+
+		index.assign(capacity, EMPTY);
+		size_t mask = capacity - 1;
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			size_t slot = mix(entries[i].hash) & mask;
+			while (index[slot] != EMPTY)
+				slot = (slot + 1) & mask;
+			index[slot] = (int32_t)i;
+		}
+
+		used = entries.size();
+		version++;
+	}
+
+	Object MetaMap::keys()
+	{
+		std::vector<Object> items;
+		items.reserve(count);
+		for (auto& entry : entries)
+		{
+			if (!entry.removed)
+				items.push_back(entry.key);
+		}
+
+		return Object(List::instantiate(std::move(items)));
+	}
+
+	Object MetaMap::values()
+	{
+		std::vector<Object> items;
+		items.reserve(count);
+		for (auto& entry : entries)
+		{
+			if (!entry.removed)
+				items.push_back(entry.value);
+		}
+
+		return Object(List::instantiate(std::move(items)));
+	}
+
+	size_t MetaMap::size()
+	{
+		return count;
+	}
+
+	std::string MetaMap::to_string()
+	{
+		// 要防止包含自己导致的无限循环
+		auto repr = [this](const Object& item)
+		{
+			if (Classifier::belongClass(item, "Map") && item.getInstance()->get("@entries").getContainer().get() == this)
+				return std::string("{...}");
+
+			return item.to_string();
+		};
+
+		std::string result = "{";
+		bool first = true;
+		for (auto& entry : entries)
+		{
+			if (entry.removed)
+				continue;
+
+			if (!first)
+				result += ", ";
+			first = false;
+
+			result += repr(entry.key);
+			result += ": ";
+			result += repr(entry.value);
+		}
+		result.push_back('}');
+
+		return result;
+	}
+
+	void MetaMap::trace(GarbageCollector& gc) const
+	{
+		for (auto& entry : entries)
+		{
+			gc.mark(entry.key);
+			gc.mark(entry.value);
+		}
+	}
+
+	void MetaMap::clear(std::vector<Object>& trash)
+	{
+		for (auto& entry : entries)
+		{
+			trash.push_back(std::move(entry.key));
+			trash.push_back(std::move(entry.value));
+		}
+
+		entries.clear();
+		index.clear();
+		count = used = 0;
+		version++;
+	}
+
+	bool isMetaMap(const Object& obj)
+	{
+		if (!obj.isContainer())
+			return false;
+
+		return obj.getContainer()->type == "MetaMap";
+	}
+
+	MetaMapPtr getMetaMap(const Object& obj)
+	{
+		// 该函数仅在isMetaMap判断后调用
+		// 所以没有做类型判断
+		return std::static_pointer_cast<MetaMap>(obj.getContainer());
+	}
+
+}
@@ -0,0 +1,109 @@
+#include "Interpreter/MetaSet.h"
+#include "Interpreter/loxlib/NativeClass.h"
+
+namespace CXX {
+
+	MetaSet::MetaSet() : MetaMap("MetaSet") {}
+
+	MetaSet::MetaSet(const std::vector<Object>& items) : MetaMap("MetaSet")
+	{
+		for (auto& item : items)
+			add(item);
+	}
+
+	void MetaSet::add(const Object& val)
+	{
+		at(val);
+	}
+
+	bool MetaSet::has(const Object& val)
+	{
+		return find(val) != nullptr;
+	}
+
+	void MetaSet::copyEntry(size_t position, MetaSet& result)
+	{
+		// 比较时可能执行用户的__equal__，先复制一份，不持有entries中的引用
+		Entry entry = entries[position];
+		if (!entry.removed && result.lookup(entry.key, entry.hash) < 0)
+			result.insert(entry.key, entry.hash);
+	}
+
+	MetaSetPtr MetaSet::unite(MetaSet& other)
+	{
+		MetaSetPtr result = std::make_shared<MetaSet>();
+		for (size_t i = 0; i < entries.size(); i++)
+			copyEntry(i, *result);
+		for (size_t i = 0; i < other.entries.size(); i++)
+			other.copyEntry(i, *result);
+
+		return result;
+	}
+
+	MetaSetPtr MetaSet::intersect(MetaSet& other)
+	{
+		MetaSetPtr result = std::make_shared<MetaSet>();
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			Entry entry = entries[i];
+			if (!entry.removed && other.lookup(entry.key, entry.hash) >= 0)
+				copyEntry(i, *result);
+		}
+
+		return result;
+	}
+
+	MetaSetPtr MetaSet::subtract(MetaSet& other)
+	{
+		MetaSetPtr result = std::make_shared<MetaSet>();
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			Entry entry = entries[i];
+			if (!entry.removed && other.lookup(entry.key, entry.hash) < 0)
+				copyEntry(i, *result);
+		}
+
+		return result;
+	}
+
+	std::string MetaSet::to_string()
+	{
+		std::string result = "{";
+		bool first = true;
+		for (auto& entry : entries)
+		{
+			if (entry.removed)
+				continue;
+
+			if (!first)
+				result += ", ";
+			first = false;
+
+			// 要防止集合中包含自己导致的无限循环
+			if (Classifier::belongClass(entry.key, "Set") &&
+				entry.key.getInstance()->get("@items").getContainer().get() == this)
+				result += "{...}";
+			else
+				result += entry.key.to_string();
+		}
+		result.push_back('}');
+
+		return result;
+	}
+
+	bool isMetaSet(const Object& obj)
+	{
+		if (!obj.isContainer())
+			return false;
+
+		return obj.getContainer()->type == "MetaSet";
+	}
+
+	MetaSetPtr getMetaSet(const Object& obj)
+	{
+		// 该函数仅在isMetaSet判断后调用
+		// 所以没有做类型判断
+		return std::static_pointer_cast<MetaSet>(obj.getContainer());
+	}
+
+}
@@ -0,0 +1,63 @@
+#include "Interpreter/MetaStringBuilder.h"
+#include "Interpreter/loxlib/NativeClass.h"
+#include <algorithm>
+
+namespace CXX {
+
+	MetaStringBuilder::MetaStringBuilder(size_t capacity) : Container("MetaStringBuilder")
+	{
+		buffer.reserve(capacity);
+	}
+
+	void MetaStringBuilder::append(const Object& obj)
+	{
+		if (obj.isString())
+			append(obj.getString());
+		else if (Classifier::belongClass(obj, "String"))
+			append(obj.getInstance()->get("str").getString());
+		else
+			append(obj.to_string());
+	}
+
+	void MetaStringBuilder::append(const std::string& str)
+	{
+		// 容量按倍数增长，保证追加的均摊复杂度为O(1)
+		// 不依赖标准库的增长策略，reserve过的缓冲区写满后同样翻倍
+		size_t required = buffer.size() + str.size();
+		if (required > buffer.capacity())
+			buffer.reserve(std::max(required, buffer.capacity() * 2));
+
+		buffer.append(str);
+	}
+
+	size_t MetaStringBuilder::length() const
+	{
+		return buffer.size();
+	}
+
+	const std::string& MetaStringBuilder::str() const
+	{
+		return buffer;
+	}
+
+	std::string MetaStringBuilder::to_string()
+	{
+		return buffer;
+	}
+
+	bool isMetaStringBuilder(const Object& obj)
+	{
+		if (!obj.isContainer())
+			return false;
+
+		return obj.getContainer()->type == "MetaStringBuilder";
+	}
+
+	MetaStringBuilderPtr getMetaStringBuilder(const Object& obj)
+	{
+		// 该函数仅在isMetaStringBuilder判断后调用
+		// 所以没有做类型判断
+		return std::static_pointer_cast<MetaStringBuilder>(obj.getContainer());
+	}
+
+}
@@ -2,14 +2,15 @@
 
 namespace CXX {
 
-	Module::Module(std::unordered_map<std::string, Object> values) : m_values(std::move(values)) {}
+	Module::Module(std::unordered_map<Symbol, Object> values, AstArenaPtr arena)
+		: m_values(std::move(values)), m_arena(std::move(arena)) {}
 
 	Module::~Module()
 	{
 		m_values.clear();
 	}
 
-	Object& Module::get(const std::string& name)
+	Object& Module::get(Symbol name)
 	{
 		auto it = m_values.find(name);
 		if (it != m_values.end())
@@ -18,7 +19,7 @@ namespace CXX {
 		return Object::Nil();
 	}
 
-	void Module::set(const std::string& name, const Object& obj)
+	void Module::set(Symbol name, const Object& obj)
 	{
 		m_values.emplace(name, obj);
 	}
@@ -0,0 +1,182 @@
+#include "Interpreter/ModuleLoader.h"
+#include "Interpreter/Interpreter.h"
+#include "Parser/Stmt.h"
+#include "Common/Error.h"
+#include "Common/SourceFile.h"
+#include "Common/utils.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace CXX {
+
+	namespace {
+
+		// 按需创建工作线程，最多与CPU核数相同
+		// 析构时丢弃尚未开始的任务，等待正在执行的任务结束
+		class ThreadPool
+		{
+		public:
+			ThreadPool() : limit(std::thread::hardware_concurrency())
+			{
+				// 任务中用到的函数内静态变量须先于线程池构造，才会晚于线程池析构
+				// 脚本中途调用exit()时，后台任务可能仍在执行
+				(void)Object(Symbol{});
+				(void)SourceFile::find(0);
+
+				Symbol::shareAcrossThreads();
+			}
+
+			~ThreadPool()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					stopping = true;
+					tasks.clear();
+				}
+				ready.notify_all();
+
+				for (std::thread& worker : workers)
+					worker.join();
+			}
+
+			void submit(std::function<void()> task)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				tasks.push_back(std::move(task));
+
+				if (idle == 0 && workers.size() < limit)
+					workers.emplace_back([this]() { work(); });
+				else
+					ready.notify_one();
+			}
+
+		private:
+			void work()
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				while (true)
+				{
+					idle++;
+					ready.wait(lock, [this]() { return stopping || !tasks.empty(); });
+					idle--;
+
+					if (stopping)
+						return;
+
+					std::function<void()> task = std::move(tasks.front());
+					tasks.pop_front();
+
+					lock.unlock();
+					task();
+					lock.lock();
+				}
+			}
+
+		private:
+			const size_t limit;
+			size_t idle{ 0 };
+			bool stopping{ false };
+
+			std::mutex mutex;
+			std::condition_variable ready;
+			std::deque<std::function<void()>> tasks;
+			std::vector<std::thread> workers;
+		};
+
+		struct LoaderState
+		{
+			std::mutex mutex;
+			std::unordered_set<std::string> submitted; // 提交过的路径，取出后仍保留，避免重复提交
+			std::unordered_map<std::string, std::future<std::optional<ModuleLoader::Result>>> results;
+
+			ThreadPool pool; // 最后构造，最先析构
+		};
+
+		LoaderState& state()
+		{
+			static LoaderState instance;
+			return instance;
+		}
+
+	}
+
+	void ModuleLoader::prefetch(const std::vector<StmtPtr>& statements)
+	{
+		// 单核时并发解析没有收益，反而多了加锁与线程切换的开销，仍在import时同步解析
+		static const bool parallel = std::thread::hardware_concurrency() > 1;
+		if (!parallel)
+			return;
+
+		for (StmtPtr stmt : statements)
+		{
+			if (stmt->stmtType != StmtType::Import)
+				continue;
+
+			// Resolver已把路径换成了模块文件的绝对路径
+			const std::string& path = static_cast<ImportStmt*>(stmt)->filepath.symbol.str();
+
+			LoaderState& loader = state();
+			std::lock_guard<std::mutex> lock(loader.mutex);
+			if (!loader.submitted.insert(path).second)
+				continue;
+
+			// std::function要求可复制，packaged_task只能移动，用shared_ptr包一层
+			auto task = std::make_shared<std::packaged_task<std::optional<Result>()>>([path]() { return load(path); });
+			loader.results.emplace(path, task->get_future());
+			loader.pool.submit([task]() { (*task)(); });
+		}
+	}
+
+	std::optional<ModuleLoader::Result> ModuleLoader::take(const std::string& path)
+	{
+		std::future<std::optional<Result>> result;
+		{
+			LoaderState& loader = state();
+			std::lock_guard<std::mutex> lock(loader.mutex);
+
+			auto it = loader.results.find(path);
+			if (it == loader.results.end())
+				return std::nullopt;
+
+			result = std::move(it->second);
+			loader.results.erase(it);
+		}
+
+		try
+		{
+			return result.get();
+		}
+		catch (const std::exception&)
+		{
+			// 后台处理意外失败时，交由调用者重新同步解析
+			return std::nullopt;
+		}
+	}
+
+	std::optional<ModuleLoader::Result> ModuleLoader::load(const std::string& path)
+	{
+		// 读取失败的错误信息需要指向import语句，留给主线程同步解析时报告
+		std::optional<std::string> content = readfile(path);
+		if (!content)
+			return std::nullopt;
+
+		Result result;
+		ErrorReporter::errorCount = 0;
+		ErrorReporter::capture(&result.errors);
+		Finally restore([]()
+			{ ErrorReporter::capture(nullptr); });
+
+		result.block = Interpreter::parseModuleSource(path, std::move(*content), result.arena);
+		if (result.block)
+			prefetch(result.block->statements);
+
+		return result;
+	}
+
+}
@@ -4,42 +4,56 @@
 #include "Interpreter/Callable.h"
 #include "Interpreter/Class.h"
 #include "Interpreter/Container.h"
+#include "Interpreter/MetaList.h"
 #include "Interpreter/RuntimeError.h"
 #include "Runner.h"
+#include <unordered_map>
+#include <mutex>
 
 namespace CXX {
 
-	Object::Object() : type(ObjectType::NIL) {}
+	Object::Object(Symbol symbol) : bits(TAG_NIL)
+	{
+		// 驻留的字符串与符号表一样只增不减
+		// 导入的模块可能在后台线程中解析，构造字符串常量时须加锁
+		static std::unordered_map<Symbol, Object> literals;
+		static std::mutex mutex;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		auto [it, inserted] = literals.try_emplace(symbol);
+		if (inserted)
+		{
+			it->second = Object(symbol.str());
+			it->second.cell()->interned = true;
+		}
+
+		*this = it->second;
+	}
 
-	Object::Object(const Token& tok)
+	Object::Object(const Token& tok) : bits(TAG_NIL)
 	{
 		switch (tok.type)
 		{
 		case TokenType::NUMBER:
-			type = ObjectType::NUMBER;
 			if (tok.lexeme.compare(0, 2, "0b") == 0)
-				value = (double)(std::stoi(tok.lexeme.substr(2), 0, 2));
+				*this = Object((double)(std::stoi(std::string(tok.lexeme.substr(2)), 0, 2)));
 			else
-				value = std::stod(tok.lexeme);
+				*this = Object(std::stod(std::string(tok.lexeme)));
 			break;
 
 		case TokenType::TRUE:
-			type = ObjectType::BOOL;
-			value = true;
+			bits = TAG_TRUE;
 			break;
 
 		case TokenType::FALSE:
-			type = ObjectType::BOOL;
-			value = false;
+			bits = TAG_FALSE;
 			break;
 
 		case TokenType::STRING:
-			type = ObjectType::STRING;
-			value = tok.lexeme;
+			*this = Object(tok.symbol);
 			break;
 
 		case TokenType::NIL:
-			type = ObjectType::NIL;
 			break;
 
 		default:
@@ -47,17 +61,29 @@ namespace CXX {
 		}
 	}
 
-	Object::Object(double number) : type(ObjectType::NUMBER), value(number) {}
-
-	Object::Object(const std::string& str) : type(ObjectType::STRING), value(str) {}
-
-	Object::Object(bool boolean) : type(ObjectType::BOOL), value(boolean) {}
-
-	Object::Object(CallablePtr callable) : type(ObjectType::CALLABLE), value(std::move(callable)) {}
-
-	Object::Object(InstancePtr instance) : type(ObjectType::INSTANCE), value(std::move(instance)) {}
-
-	Object::Object(ContainerPtr list) : type(ObjectType::CONTAINER), value(std::move(list)) {}
+	void Object::destroy(Cell* cell)
+	{
+		switch (cell->type)
+		{
+		case ObjectType::STRING:
+			delete static_cast<Boxed<std::string>*>(cell);
+			break;
+		case ObjectType::CALLABLE:
+			delete static_cast<Boxed<CallablePtr>*>(cell);
+			break;
+		case ObjectType::INSTANCE:
+			delete static_cast<Boxed<InstancePtr>*>(cell);
+			break;
+		case ObjectType::CONTAINER:
+			delete static_cast<Boxed<ContainerPtr>*>(cell);
+			break;
+		case ObjectType::LIST:
+			delete static_cast<Boxed<MetaListPtr>*>(cell);
+			break;
+		default:
+			break;
+		}
+	}
 
 	Object& Object::Nil()
 	{
@@ -65,74 +91,9 @@ namespace CXX {
 		return nil;
 	}
 
-	bool Object::isNumber() const
-	{
-		return type == ObjectType::NUMBER;
-	}
-
-	bool Object::isBoolean() const
-	{
-		return type == ObjectType::BOOL;
-	}
-
-	bool Object::isString() const
-	{
-		return type == ObjectType::STRING;
-	}
-
-	bool Object::isCallable() const
-	{
-		return type == ObjectType::CALLABLE;
-	}
-
-	bool Object::isInstance() const
-	{
-		return type == ObjectType::INSTANCE;
-	}
-
-	bool Object::isNil() const
-	{
-		return type == ObjectType::NIL;
-	}
-
-	bool Object::isContainer() const
-	{
-		return type == ObjectType::CONTAINER;
-	}
-
-	double Object::getNumber() const
-	{
-		return std::get<double>(value);
-	}
-
-	bool Object::getBoolean() const
-	{
-		return std::get<bool>(value);
-	}
-
-	std::string Object::getString() const
-	{
-		return std::get<std::string>(value);
-	}
-
-	CallablePtr Object::getCallable() const
-	{
-		return std::get<CallablePtr>(value);
-	}
-
-	InstancePtr Object::getInstance() const
-	{
-		return std::get<InstancePtr>(value);
-	}
-
-	ContainerPtr Object::getContainer() const
-	{
-		return std::get<ContainerPtr>(value);
-	}
-
 	std::string Object::to_string() const
 	{
-		switch (type)
+		switch (type())
 		{
 		case ObjectType::NIL:
 			return "nil";
@@ -151,40 +112,25 @@ namespace CXX {
 			return (long long)val == val ? std::to_string((long long)val) : std::to_string(val);
 		}
 		case ObjectType::STRING:
-			return std::get<std::string>(value);
+			return getString();
 
 		case ObjectType::CALLABLE:
-			return std::get<CallablePtr>(value)->to_string();
+			return getCallable()->to_string();
 
 		case ObjectType::INSTANCE:
-			return std::get<InstancePtr>(value)->to_string();
+			return getInstance()->to_string();
 
 		case ObjectType::CONTAINER:
-			return std::get<ContainerPtr>(value)->to_string();
+			return getContainer()->to_string();
+
+		case ObjectType::LIST:
+			return getList()->to_string();
 
 		default:
 			return "Impossible";
 		}
 	}
 
-	bool Object::is_true() const
-	{
-		if (isBoolean())
-		{
-			return getBoolean();
-		}
-		else if (isNumber())
-		{
-			return getNumber() > 0;
-		}
-		else if (isNil())
-		{
-			return false;
-		}
-
-		return true;
-	}
-
 	const char* ObjectTypeName(ObjectType type)
 	{
 		switch (type)
@@ -203,6 +149,8 @@ namespace CXX {
 			return "instance";
 		case ObjectType::CONTAINER:
 			return "container";
+		case ObjectType::LIST:
+			return "list";
 		default:
 			return "impossible";
 		}
@@ -210,10 +158,10 @@ namespace CXX {
 
 	bool Object::isSameType(const Object& rhs, ObjectType expected) const
 	{
-		if (rhs.type != this->type)
+		if (rhs.type() != this->type())
 			return false;
 
-		return this->type == expected;
+		return this->type() == expected;
 	}
 
 	Object Object::operator+(const Object& rhs) const
@@ -224,7 +172,7 @@ namespace CXX {
 		}
 		else if (isSameType(rhs, ObjectType::STRING))
 		{
-			return Object(std::get<std::string>(this->value) + std::get<std::string>(rhs.value));
+			return Object(this->getString() + rhs.getString());
 		}
 		else if (this->isInstance())
 		{
@@ -242,8 +190,8 @@ namespace CXX {
 		}
 		else
 			throw RuntimeError(Runner::pos_start, Runner::pos_end,
-				format("Illegal operator '+' for operands type(%s) and type(%s)", ObjectTypeName(this->type),
-					ObjectTypeName(rhs.type)));
+				format("Illegal operator '+' for operands type(%s) and type(%s)", ObjectTypeName(this->type()),
+					ObjectTypeName(rhs.type())));
 	}
 
 	Object Object::operator-(const Object& rhs) const
@@ -266,8 +214,8 @@ namespace CXX {
 		}
 		else
 			throw RuntimeError(Runner::pos_start, Runner::pos_end,
-				format("Illegal operator '-' for operands type(%s) and type(%s)", ObjectTypeName(this->type),
-					ObjectTypeName(rhs.type)));
+				format("Illegal operator '-' for operands type(%s) and type(%s)", ObjectTypeName(this->type()),
+					ObjectTypeName(rhs.type())));
 	}
 
 	Object Object::operator*(const Object& rhs) const
@@ -303,8 +251,8 @@ namespace CXX {
 		}
 		else
 			throw RuntimeError(Runner::pos_start, Runner::pos_end,
-				format("Illegal operator '*' for operands type(%s) and type(%s)", ObjectTypeName(this->type),
-					ObjectTypeName(rhs.type)));
+				format("Illegal operator '*' for operands type(%s) and type(%s)", ObjectTypeName(this->type()),
+					ObjectTypeName(rhs.type())));
 	}
 
 	Object Object::operator/(const Object& rhs) const
@@ -335,8 +283,8 @@ namespace CXX {
 		}
 		else
 			throw RuntimeError(Runner::pos_start, Runner::pos_end,
-				format("Illegal operator '/' for operands type(%s) and type(%s)", ObjectTypeName(this->type),
-					ObjectTypeName(rhs.type)));
+				format("Illegal operator '/' for operands type(%s) and type(%s)", ObjectTypeName(this->type()),
+					ObjectTypeName(rhs.type())));
 	}
 
 	Object Object::operator%(const Object& rhs) const
@@ -363,16 +311,16 @@ namespace CXX {
 		}
 		else
 			throw RuntimeError(Runner::pos_start, Runner::pos_end,
-				format("Illegal operator '%' for operands type(%s) and type(%s)", ObjectTypeName(this->type),
-					ObjectTypeName(rhs.type)));
+				format("Illegal operator '%' for operands type(%s) and type(%s)", ObjectTypeName(this->type()),
+					ObjectTypeName(rhs.type())));
 	}
 
 	bool Object::operator==(const Object& rhs) const
 	{
-		if (this->type != rhs.type)
+		if (this->type() != rhs.type())
 			return false;
 
-		switch (this->type)
+		switch (this->type())
 		{
 		case ObjectType::NIL:
 			return true;
@@ -384,19 +332,23 @@ namespace CXX {
 			return this->getNumber() == rhs.getNumber();
 
 		case ObjectType::STRING:
-			// 这里不使用getString，否则会进行string的拷贝
-			// 严重影响性能
-			return std::get<std::string>(this->value) == std::get<std::string>(rhs.value);
+			// 同一个字符串常量会共享同一块堆内存
+			if (this->bits == rhs.bits)
+				return true;
+
+			// 两者都已驻留时，内容相同必然是同一块内存
+			if (this->cell()->interned && rhs.cell()->interned)
+				return false;
+
+			return this->getString() == rhs.getString();
 
 		case ObjectType::CALLABLE:
-			// shared_ptr同理，拷贝会造成atomic计数器+1
-			// 用时更甚
-			return std::get<CallablePtr>(this->value) == std::get<CallablePtr>(rhs.value);
+			return this->getCallable() == rhs.getCallable();
 
 		case ObjectType::INSTANCE:
 		{
-			auto& linstance = std::get<InstancePtr>(this->value);
-			if (linstance == std::get<InstancePtr>(rhs.value))
+			auto& linstance = this->getInstance();
+			if (linstance == rhs.getInstance())
 				return true;
 
 			// 没有判断rhs与lhs是否为同类型实例
@@ -411,6 +363,14 @@ namespace CXX {
 			}
 		}
 
+		case ObjectType::LIST:
+		{
+			// 指向同一个MetaList显然相同，否则逐个比较元素
+			auto& llist = this->getList();
+			auto& rlist = rhs.getList();
+			return llist == rlist || *llist == *rlist;
+		}
+
 		default:
 			return false;
 		}
@@ -429,13 +389,13 @@ namespace CXX {
 		}
 		else if (isSameType(rhs, ObjectType::STRING))
 		{
-			return std::get<std::string>(this->value) > std::get<std::string>(rhs.value);
+			return this->getString() > rhs.getString();
 		}
 		else
 		{
 			throw RuntimeError(Runner::pos_start, Runner::pos_end,
-				format("Illegal operator '>' for operands type(%s) and type(%s)", ObjectTypeName(this->type),
-					ObjectTypeName(rhs.type)));
+				format("Illegal operator '>' for operands type(%s) and type(%s)", ObjectTypeName(this->type()),
+					ObjectTypeName(rhs.type())));
 		}
 	}
 
@@ -452,13 +412,13 @@ namespace CXX {
 		}
 		else if (isSameType(rhs, ObjectType::STRING))
 		{
-			return std::get<std::string>(this->value) < std::get<std::string>(rhs.value);
+			return this->getString() < rhs.getString();
 		}
 		else
 		{
 			throw RuntimeError(Runner::pos_start, Runner::pos_end,
-				format("Illegal operator '<' for operands type(%s) and type(%s)", ObjectTypeName(this->type),
-					ObjectTypeName(rhs.type)));
+				format("Illegal operator '<' for operands type(%s) and type(%s)", ObjectTypeName(this->type()),
+					ObjectTypeName(rhs.type())));
 		}
 	}
 
@@ -474,7 +434,7 @@ namespace CXX {
 			return Object(-getNumber());
 		}
 
-		throw RuntimeError(Runner::pos_start, Runner::pos_end, format("Illegal operator '-' for operand type(%s)", ObjectTypeName(type)));
+		throw RuntimeError(Runner::pos_start, Runner::pos_end, format("Illegal operator '-' for operand type(%s)", ObjectTypeName(type())));
 	}
 
 	Object Object::operator!() const
@@ -484,7 +444,7 @@ namespace CXX {
 			return Object(!is_true());
 		}
 
-		throw RuntimeError(Runner::pos_start, Runner::pos_end, format("Illegal operator '!' for operand type(%s)", ObjectTypeName(type)));
+		throw RuntimeError(Runner::pos_start, Runner::pos_end, format("Illegal operator '!' for operand type(%s)", ObjectTypeName(type())));
 	}
 
 }
\ No newline at end of file
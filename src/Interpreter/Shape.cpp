@@ -0,0 +1,40 @@
+#include "Interpreter/Shape.h"
+
+namespace CXX {
+
+	const ShapePtr& Shape::root()
+	{
+		static ShapePtr empty = std::make_shared<Shape>();
+		return empty;
+	}
+
+	ShapePtr Shape::transition(Symbol name)
+	{
+		// 字典模式的Shape由实例独占，直接修改
+		if (dictionary)
+		{
+			offsets[name] = (int)names.size();
+			names.push_back(name);
+			return shared_from_this();
+		}
+
+		if (auto it = transitions.find(name); it != transitions.end())
+			return it->second;
+
+		auto next = std::make_shared<Shape>();
+		next->offsets = offsets;
+		next->names = names;
+		next->offsets[name] = (int)names.size();
+		next->names.push_back(name);
+
+		if (next->names.size() > MAX_FIELDS || transitions.size() >= MAX_TRANSITIONS)
+		{
+			next->dictionary = true;
+			return next;
+		}
+
+		transitions[name] = next;
+		return next;
+	}
+
+}
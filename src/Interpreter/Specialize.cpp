@@ -0,0 +1,104 @@
+#include "Interpreter/Specialize.h"
+#include "Interpreter/RuntimeError.h"
+#include "Interpreter/MetaList.h"
+#include "Interpreter/MetaMap.h"
+#include "Interpreter/MetaFloat64Array.h"
+#include "Interpreter/loxlib/NativeClass.h"
+#include "Runner.h"
+
+namespace CXX {
+
+	// 语义与Object的运算符在两侧均为数字时完全一致
+
+	static Object add(double lhs, double rhs) { return Object(lhs + rhs); }
+
+	static Object sub(double lhs, double rhs) { return Object(lhs - rhs); }
+
+	static Object mul(double lhs, double rhs) { return Object(lhs * rhs); }
+
+	static Object div(double lhs, double rhs)
+	{
+		if (rhs == 0.0)
+			throw RuntimeError(Runner::pos_start, Runner::pos_end, "Divided by 0!");
+
+		return Object(lhs / rhs);
+	}
+
+	static Object mod(double lhs, double rhs) { return Object((double)((long)lhs % (long)rhs)); }
+
+	static Object gt(double lhs, double rhs) { return Object(lhs > rhs); }
+
+	static Object gte(double lhs, double rhs) { return Object(lhs >= rhs); }
+
+	static Object lt(double lhs, double rhs) { return Object(lhs < rhs); }
+
+	static Object lte(double lhs, double rhs) { return Object(lhs <= rhs); }
+
+	static Object eq(double lhs, double rhs) { return Object(lhs == rhs); }
+
+	static Object neq(double lhs, double rhs) { return Object(lhs != rhs); }
+
+	NumberOp numberOperator(TokenType op)
+	{
+		switch (op)
+		{
+		case TokenType::PLUS:
+			return add;
+		case TokenType::MINUS:
+			return sub;
+		case TokenType::MUL:
+			return mul;
+		case TokenType::DIV:
+			return div;
+		case TokenType::MOD:
+			return mod;
+		case TokenType::GT:
+			return gt;
+		case TokenType::GTE:
+			return gte;
+		case TokenType::LT:
+			return lt;
+		case TokenType::LTE:
+			return lte;
+		case TokenType::EQEQ:
+			return eq;
+		case TokenType::BANGEQ:
+			return neq;
+		default:
+			return nullptr;
+		}
+	}
+
+	MetaMap* asMap(const Object& obj)
+	{
+		static const Class* mapClass = Map::getSingleton().get();
+		static const Symbol entries("@entries");
+
+		if (!obj.isInstance())
+			return nullptr;
+
+		const InstancePtr& instance = obj.getInstance();
+		if (instance->belonging.get() != mapClass)
+			return nullptr;
+
+		Object* field = instance->field(entries);
+		return field ? static_cast<MetaMap*>(field->getContainer().get()) : nullptr;
+	}
+
+	MetaFloat64Array* asFloat64Array(const Object& obj)
+	{
+		static const Class* arrayClass = Float64Array::getSingleton().get();
+		static const Symbol data("@data");
+
+		if (!obj.isInstance())
+			return nullptr;
+
+		const InstancePtr& instance = obj.getInstance();
+		if (instance->belonging.get() != arrayClass)
+			return nullptr;
+
+		Object* field = instance->field(data);
+		return field ? static_cast<MetaFloat64Array*>(field->getContainer().get()) : nullptr;
+	}
+
+}
@@ -1,6 +1,11 @@
 #include "Common/utils.h"
 #include "Interpreter/loxlib/NativeClass.h"
 #include "Interpreter/MetaList.h"
+#include "Interpreter/MetaMap.h"
+#include "Interpreter/MetaSet.h"
+#include "Interpreter/MetaFloat64Array.h"
+#include "Interpreter/MetaStringBuilder.h"
+#include "Interpreter/Specialize.h"
 #include "Runner.h"
 
 #include <cmath> // 部分函数要求c11
@@ -9,6 +14,15 @@
 
 namespace CXX {
 
+	// 预分配的长度上限(2^32)
+	static constexpr double MAX_PREALLOCATION = 4294967296.0;
+
+	// NaN、无穷大以及超出size_t范围的double转换为size_t是未定义行为，须先检查再转换
+	static bool isValidSize(double size)
+	{
+		return std::isfinite(size) && size >= 0 && size < MAX_PREALLOCATION && size == std::floor(size);
+	}
+
 	String::String() : NativeClass("String")
 	{
 		allowedFields.insert({ "str", ObjectType::STRING });
@@ -16,7 +30,7 @@ namespace CXX {
 		methods.insert(
 			{ "init", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													{
-														Object& instance = interpreter.context->get("this");
+														Object& instance = interpreter.context->slots[0];
 														instance.getInstance()->set("str", Object(args[0].to_string()));
 
 														return Object();
@@ -26,7 +40,7 @@ namespace CXX {
 		methods.insert(
 			{ "length", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													  {
-														  Object& instance = interpreter.context->get("this");
+														  Object& instance = interpreter.context->slots[0];
 														  // 因为初始化时已经转为字符串，所以这里一定拿到一个string
 														  Object str = instance.getInstance()->get("str");
 
@@ -37,7 +51,7 @@ namespace CXX {
 		methods.insert(
 			{ "trim", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													{
-														Object& instance = interpreter.context->get("this");
+														Object& instance = interpreter.context->slots[0];
 														// 因为初始化时已经转为字符串，所以这里一定拿到一个string
 														Object str = instance.getInstance()->get("str");
 
@@ -55,7 +69,7 @@ namespace CXX {
 															 throw RuntimeError(Runner::pos_start, Runner::pos_end, "Expecting a string delim to split string");
 														 }
 
-														 Object& instance = interpreter.context->get("this");
+														 Object& instance = interpreter.context->slots[0];
 														 // 因为初始化时已经转为字符串，所以这里一定拿到一个string
 														 Object str = instance.getInstance()->get("str");
 
@@ -74,7 +88,7 @@ namespace CXX {
 		methods.insert(
 			{ "__add__", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													   {
-														   Object& instance = interpreter.context->get("this");
+														   Object& instance = interpreter.context->slots[0];
 														   InstancePtr instancePtr = instance.getInstance();
 														   Object lhs = instancePtr->get("str");
 														   auto& rhs = args[0];
@@ -93,7 +107,7 @@ namespace CXX {
 															   throw RuntimeError(Runner::pos_start, Runner::pos_end,
 																				  format("Illegal operator '+' for operands InstanceOf(%s) and type(%s)",
 																						 className.c_str(),
-																						 ObjectTypeName(rhs.type)));
+																						 ObjectTypeName(rhs.type())));
 														   }
 
 														   return Object(instantiate(prop));
@@ -103,7 +117,7 @@ namespace CXX {
 		methods.insert(
 			{ "__mul__", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													   {
-														   Object& instance = interpreter.context->get("this");
+														   Object& instance = interpreter.context->slots[0];
 														   InstancePtr instancePtr = instance.getInstance();
 														   Object lhs = instancePtr->get("str");
 														   auto& rhs = args[0];
@@ -118,7 +132,7 @@ namespace CXX {
 															   throw RuntimeError(Runner::pos_start, Runner::pos_end,
 																				  format("Illegal operator '+' for operands InstanceOf(%s) and type(%s)",
 																						 className.c_str(),
-																						 ObjectTypeName(rhs.type)));
+																						 ObjectTypeName(rhs.type())));
 														   }
 
 														   return Object(instantiate(prop));
@@ -129,7 +143,7 @@ namespace CXX {
 			{ "__equal__",
 			 std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 											{
-												Object& instance = interpreter.context->get("this");
+												Object& instance = interpreter.context->slots[0];
 												Object lhs = instance.getInstance()->get("str");
 
 												// == 要求同类进行比较，因此rhs一定是instance
@@ -140,6 +154,17 @@ namespace CXX {
 												return Object(lhs == rhs);
 											},
 											1) });
+
+		methods.insert(
+			{ "__hash__", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+														{
+															Object& instance = interpreter.context->slots[0];
+															Object str = instance.getInstance()->get("str");
+
+															// 内容相同的String哈希值相同，取53位以内保证能精确存为double
+															return Object((double)(hashObject(str) >> 11));
+														},
+														0) });
 	}
 
 	std::shared_ptr<String> String::getSingleton()
@@ -165,29 +190,26 @@ namespace CXX {
 		return instance;
 	}
 
-	List::List() : NativeClass("List")
+	// 成员函数的this通常是列表值，也可能是继承List的类的实例
+	static MetaListPtr receiverList(Interpreter& interpreter)
 	{
-		// 不希望用户能取到MetaList，这里用一个用户无法使用的属性名
-		allowedFields.insert({ "@items", ObjectType::CONTAINER });
+		Object& self = interpreter.context->slots[0];
+		if (self.isList())
+			return self.getList();
 
+		return getMetaList(self.getInstance()->get("@items"));
+	}
+
+	List::List() : NativeClass("List")
+	{
+		// List(...)本身直接返回列表值，init只在构造继承List的类的实例时调用
 		methods.insert(
 			{ "init", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													{
-														Object& instanceObject = interpreter.context->get("this");
+														Object& instanceObject = interpreter.context->slots[0];
 														InstancePtr instancePtr = instanceObject.getInstance();
-														if (args.size() == 1 && isMetaList(args[0]))
-														{
-															instancePtr->set("@items", args[0]);
-															return Object();
-														}
 
-														std::vector<Object> items;
-														items.reserve(args.size());
-														for (auto& arg : args)
-														{
-															items.push_back(arg);
-														}
-														MetaListPtr list = std::make_shared<MetaList>(std::move(items));
+														MetaListPtr list = std::make_shared<MetaList>(args);
 														instancePtr->set("@items", Object(list));
 
 														return Object();
@@ -197,9 +219,7 @@ namespace CXX {
 		methods.insert(
 			{ "length", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													  {
-														  Object& instance = interpreter.context->get("this");
-														  // 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-														  MetaListPtr list = getMetaList(instance.getInstance()->get("@items"));
+														  MetaListPtr list = receiverList(interpreter);
 
 														  return Object((double)list->length());
 													  },
@@ -208,9 +228,7 @@ namespace CXX {
 		methods.insert(
 			{ "reverse", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													   {
-														   Object& instance = interpreter.context->get("this");
-														   // 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-														   MetaListPtr list = getMetaList(instance.getInstance()->get("@items"));
+														   MetaListPtr list = receiverList(interpreter);
 														   list->reverse();
 
 														   return Object();
@@ -220,9 +238,7 @@ namespace CXX {
 		methods.insert(
 			{ "append", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													  {
-														  Object& instance = interpreter.context->get("this");
-														  // 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-														  MetaListPtr list = getMetaList(instance.getInstance()->get("@items"));
+														  MetaListPtr list = receiverList(interpreter);
 														  list->append(args[0]);
 
 														  return Object();
@@ -232,9 +248,7 @@ namespace CXX {
 		methods.insert(
 			{ "remove", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													  {
-														  Object& instance = interpreter.context->get("this");
-														  // 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-														  MetaListPtr list = getMetaList(instance.getInstance()->get("@items"));
+														  MetaListPtr list = receiverList(interpreter);
 														  list->remove(args[0]);
 														  return Object();
 													  },
@@ -243,19 +257,23 @@ namespace CXX {
 		methods.insert(
 			{ "pop", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													  {
-														  Object& instance = interpreter.context->get("this");
-														  // 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-														  MetaListPtr list = getMetaList(instance.getInstance()->get("@items"));
+														  MetaListPtr list = receiverList(interpreter);
 														  return list->pop();
 													  },
 													  0) });
 
+		methods.insert(
+			{ "shift", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													 {
+														 MetaListPtr list = receiverList(interpreter);
+														 return list->shift();
+													 },
+													 0) });
+
 		methods.insert(
 			{ "unshift", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													   {
-														   Object& instance = interpreter.context->get("this");
-														   // 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-														   MetaListPtr list = getMetaList(instance.getInstance()->get("@items"));
+														   MetaListPtr list = receiverList(interpreter);
 														   list->unshift(args[0]);
 
 														   return Object();
@@ -265,9 +283,7 @@ namespace CXX {
 		methods.insert(
 			{ "indexOf", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 													   {
-														   Object& instance = interpreter.context->get("this");
-														   // 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-														   MetaListPtr list = getMetaList(instance.getInstance()->get("@items"));
+														   MetaListPtr list = receiverList(interpreter);
 
 														   if (args.size() == 2)
 														   {
@@ -286,9 +302,7 @@ namespace CXX {
 		methods.insert(
 			{ "lastIndexOf", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 														   {
-															   Object& instance = interpreter.context->get("this");
-															   // 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-															   MetaListPtr list = getMetaList(instance.getInstance()->get("@items"));
+															   MetaListPtr list = receiverList(interpreter);
 
 															   if (args.size() == 2)
 															   {
@@ -317,9 +331,7 @@ namespace CXX {
 															  throw RuntimeError(Runner::pos_start, Runner::pos_end, "Expecting a function with two parameters to reduce");
 														  }
 
-														  Object& instance = interpreter.context->get("this");
-														  // 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-														  MetaListPtr list = getMetaList(instance.getInstance()->get("@items"));
+														  MetaListPtr list = receiverList(interpreter);
 
 														  return list->reduce(std::move(func));
 													  },
@@ -339,9 +351,7 @@ namespace CXX {
 														   throw RuntimeError(Runner::pos_start, Runner::pos_end, "Expecting a function with one parameters to map");
 													   }
 
-													   Object& instance = interpreter.context->get("this");
-													   // 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-													   MetaListPtr list = getMetaList(instance.getInstance()->get("@items"));
+													   MetaListPtr list = receiverList(interpreter);
 
 													   return list->map(std::move(func));
 												   },
@@ -355,58 +365,660 @@ namespace CXX {
 														   throw RuntimeError(Runner::pos_start, Runner::pos_end, "range should be represented using Nubmer");
 													   }
 
-													   Object& instance = interpreter.context->get("this");
-													   // 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-													   MetaListPtr list = getMetaList(instance.getInstance()->get("@items"));
+													   MetaListPtr list = receiverList(interpreter);
 
 													   return list->slice(args[0].getNumber(),args[1].getNumber());
 												   },
 												   2) });
+	}
+
+	std::shared_ptr<List> List::getSingleton()
+	{
+		static std::shared_ptr<List> singleton = std::make_shared<List>();
+		return singleton;
+	}
+
+	Object List::call(Interpreter& interpreter, const std::vector<Object>& arguments)
+	{
+		return instantiate(arguments);
+	}
+
+	Object List::instantiate(std::vector<Object> items)
+	{
+		return Object(std::make_shared<MetaList>(std::move(items)));
+	}
+
+	Object List::getMethod(const Object& list, Symbol name)
+	{
+		// List的成员函数都是NativeMethod
+		if (auto method = getSingleton()->findMethods(name))
+			return Object(std::static_pointer_cast<NativeMethod>(method)->bindReceiver(list));
+
+		return Object();
+	}
+
+	Map::Map() : NativeClass("Map")
+	{
+		// 与List相同，用户无法取到MetaMap
+		allowedFields.insert({ "@entries", ObjectType::CONTAINER });
+
+		methods.insert(
+			{ "init", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													{
+														Object& instance = interpreter.context->slots[0];
+														instance.getInstance()->set("@entries", Object(std::make_shared<MetaMap>()));
+
+														return Object();
+													},
+													0) });
+
+		methods.insert(
+			{ "get", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+												   {
+													   Object& instance = interpreter.context->slots[0];
+													   // 因为初始化时已经创建，所以这里一定拿到一个MetaMap
+													   MetaMapPtr map = getMetaMap(instance.getInstance()->get("@entries"));
+
+													   // 键不存在时返回第二个参数，没有则返回nil
+													   if (Object* value = map->find(args[0]))
+														   return *value;
+
+													   return args.size() == 2 ? args[1] : Object();
+												   },
+												   2, 1) });
+
+		methods.insert(
+			{ "set", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+												   {
+													   Object& instance = interpreter.context->slots[0];
+													   // 因为初始化时已经创建，所以这里一定拿到一个MetaMap
+													   MetaMapPtr map = getMetaMap(instance.getInstance()->get("@entries"));
+													   map->set(args[0], args[1]);
+
+													   return Object();
+												   },
+												   2) });
+
+		methods.insert(
+			{ "has", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+												   {
+													   Object& instance = interpreter.context->slots[0];
+													   // 因为初始化时已经创建，所以这里一定拿到一个MetaMap
+													   MetaMapPtr map = getMetaMap(instance.getInstance()->get("@entries"));
+
+													   return Object(map->find(args[0]) != nullptr);
+												   },
+												   1) });
+
+		methods.insert(
+			{ "remove", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													  {
+														  Object& instance = interpreter.context->slots[0];
+														  // 因为初始化时已经创建，所以这里一定拿到一个MetaMap
+														  MetaMapPtr map = getMetaMap(instance.getInstance()->get("@entries"));
+
+														  // 返回键是否存在
+														  return Object(map->remove(args[0]));
+													  },
+													  1) });
+
+		methods.insert(
+			{ "keys", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													{
+														Object& instance = interpreter.context->slots[0];
+														// 因为初始化时已经创建，所以这里一定拿到一个MetaMap
+														MetaMapPtr map = getMetaMap(instance.getInstance()->get("@entries"));
+
+														return map->keys();
+													},
+													0) });
+
+		methods.insert(
+			{ "values", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													  {
+														  Object& instance = interpreter.context->slots[0];
+														  // 因为初始化时已经创建，所以这里一定拿到一个MetaMap
+														  MetaMapPtr map = getMetaMap(instance.getInstance()->get("@entries"));
+
+														  return map->values();
+													  },
+													  0) });
+
+		methods.insert(
+			{ "size", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													{
+														Object& instance = interpreter.context->slots[0];
+														// 因为初始化时已经创建，所以这里一定拿到一个MetaMap
+														MetaMapPtr map = getMetaMap(instance.getInstance()->get("@entries"));
+
+														return Object((double)map->size());
+													},
+													0) });
 
 		// reservedMethods
 		methods.insert(
-			{ "__equal__",
-			 std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
-											{
-												if (!Classifier::belongClass(args[0], "List"))
-													return Object(false);
+			{ "__repr__", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+														{
+															Object& instance = interpreter.context->slots[0];
+															// 因为初始化时已经创建，所以这里一定拿到一个MetaMap
+															Object map = instance.getInstance()->get("@entries");
 
-												Object& instance = interpreter.context->get("this");
-												// get two MetaListPtr
-												MetaListPtr lhs = getMetaList(instance.getInstance()->get("@items"));
-												MetaListPtr rhs = getMetaList(args[0].getInstance()->get("@items"));
+															return Object(map.to_string());
+														},
+														0) });
+	}
 
-												// 指向同一个MetaList显然相同
-												if (lhs == rhs)
-													return Object(true);
+	std::shared_ptr<Map> Map::getSingleton()
+	{
+		static std::shared_ptr<Map> singleton = std::make_shared<Map>();
+		return singleton;
+	}
 
-												return Object(*lhs == *rhs);
-											},
-											1) });
+	InstancePtr Map::instantiate()
+	{
+		InstancePtr instance = std::make_shared<Instance>(Map::getSingleton());
+
+		instance->set("@entries", Object(std::make_shared<MetaMap>()));
+
+		return instance;
+	}
+
+	Set::Set() : NativeClass("Set")
+	{
+		// 与List相同，用户无法取到MetaSet
+		allowedFields.insert({ "@items", ObjectType::CONTAINER });
+
+		methods.insert(
+			{ "init", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													{
+														Object& instance = interpreter.context->slots[0];
+														if (args.empty())
+														{
+															instance.getInstance()->set("@items", Object(std::make_shared<MetaSet>()));
+															return Object();
+														}
+
+														// 由List构造，重复的元素只保留第一个
+														MetaList* list = asList(args[0]);
+														if (!list)
+														{
+															throw RuntimeError(Runner::pos_start, Runner::pos_end, "Expecting a List to construct Set");
+														}
+
+														std::vector<Object> items;
+														items.reserve(list->length());
+														for (size_t i = 0; i < list->length(); i++)
+														{
+															items.push_back(list->at((int)i));
+														}
+														instance.getInstance()->set("@items", Object(std::make_shared<MetaSet>(items)));
+
+														return Object();
+													},
+													1, 1) });
+
+		methods.insert(
+			{ "add", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+												   {
+													   Object& instance = interpreter.context->slots[0];
+													   // 因为初始化时已经创建，所以这里一定拿到一个MetaSet
+													   MetaSetPtr set = getMetaSet(instance.getInstance()->get("@items"));
+													   set->add(args[0]);
+
+													   return Object();
+												   },
+												   1) });
+
+		methods.insert(
+			{ "has", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+												   {
+													   Object& instance = interpreter.context->slots[0];
+													   // 因为初始化时已经创建，所以这里一定拿到一个MetaSet
+													   MetaSetPtr set = getMetaSet(instance.getInstance()->get("@items"));
+
+													   return Object(set->has(args[0]));
+												   },
+												   1) });
+
+		methods.insert(
+			{ "remove", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													  {
+														  Object& instance = interpreter.context->slots[0];
+														  // 因为初始化时已经创建，所以这里一定拿到一个MetaSet
+														  MetaSetPtr set = getMetaSet(instance.getInstance()->get("@items"));
+
+														  // 返回元素是否存在
+														  return Object(set->remove(args[0]));
+													  },
+													  1) });
+
+		methods.insert(
+			{ "size", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													{
+														Object& instance = interpreter.context->slots[0];
+														// 因为初始化时已经创建，所以这里一定拿到一个MetaSet
+														MetaSetPtr set = getMetaSet(instance.getInstance()->get("@items"));
+
+														return Object((double)set->size());
+													},
+													0) });
+
+		methods.insert(
+			{ "values", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													  {
+														  Object& instance = interpreter.context->slots[0];
+														  // 因为初始化时已经创建，所以这里一定拿到一个MetaSet
+														  MetaSetPtr set = getMetaSet(instance.getInstance()->get("@items"));
+
+														  return set->keys();
+													  },
+													  0) });
+
+		// 集合运算的参数必须也是Set
+		auto operand = [](const Object& arg, const char* name)
+		{
+			if (!Classifier::belongClass(arg, "Set"))
+			{
+				throw RuntimeError(Runner::pos_start, Runner::pos_end, format("Expecting a Set to %s", name));
+			}
+
+			return getMetaSet(arg.getInstance()->get("@items"));
+		};
+
+		methods.insert(
+			{ "union", std::make_shared<NativeMethod>([=](Interpreter& interpreter, const std::vector<Object>& args)
+													 {
+														 MetaSetPtr other = operand(args[0], "union");
+
+														 Object& instance = interpreter.context->slots[0];
+														 MetaSetPtr set = getMetaSet(instance.getInstance()->get("@items"));
+
+														 return Object(instantiate(set->unite(*other)));
+													 },
+													 1) });
+
+		methods.insert(
+			{ "intersection", std::make_shared<NativeMethod>([=](Interpreter& interpreter, const std::vector<Object>& args)
+															{
+																MetaSetPtr other = operand(args[0], "intersect");
+
+																Object& instance = interpreter.context->slots[0];
+																MetaSetPtr set = getMetaSet(instance.getInstance()->get("@items"));
+
+																return Object(instantiate(set->intersect(*other)));
+															},
+															1) });
+
+		methods.insert(
+			{ "difference", std::make_shared<NativeMethod>([=](Interpreter& interpreter, const std::vector<Object>& args)
+														  {
+															  MetaSetPtr other = operand(args[0], "subtract");
 
+															  Object& instance = interpreter.context->slots[0];
+															  MetaSetPtr set = getMetaSet(instance.getInstance()->get("@items"));
+
+															  return Object(instantiate(set->subtract(*other)));
+														  },
+														  1) });
+
+		// reservedMethods
 		methods.insert(
 			{ "__repr__", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
 														{
-															Object& instance = interpreter.context->get("this");
-															// 因为初始化时已经转为列表，所以这里一定拿到一个MetaList
-															Object list = instance.getInstance()->get("@items");
+															Object& instance = interpreter.context->slots[0];
+															// 因为初始化时已经创建，所以这里一定拿到一个MetaSet
+															Object set = instance.getInstance()->get("@items");
 
-															return Object(list.to_string());
+															return Object(set.to_string());
 														},
 														0) });
 	}
 
-	std::shared_ptr<List> List::getSingleton()
+	std::shared_ptr<Set> Set::getSingleton()
 	{
-		static std::shared_ptr<List> singleton = std::make_shared<List>();
+		static std::shared_ptr<Set> singleton = std::make_shared<Set>();
+		return singleton;
+	}
+
+	InstancePtr Set::instantiate(MetaSetPtr items)
+	{
+		InstancePtr instance = std::make_shared<Instance>(Set::getSingleton());
+
+		instance->set("@items", Object(std::move(items)));
+
+		return instance;
+	}
+
+	Float64Array::Float64Array() : NativeClass("Float64Array")
+	{
+		// 与List相同，用户无法取到MetaFloat64Array
+		allowedFields.insert({ "@data", ObjectType::CONTAINER });
+
+		methods.insert(
+			{ "init", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													{
+														Object& instance = interpreter.context->slots[0];
+
+														// 以长度构造时全部填0
+														if (args[0].isNumber())
+														{
+															double length = args[0].getNumber();
+															if (!isValidSize(length))
+															{
+																throw RuntimeError(Runner::pos_start, Runner::pos_end, "Float64Array length should be a non-negative integer below 2^32");
+															}
+
+															instance.getInstance()->set("@data", Object(std::make_shared<MetaFloat64Array>((size_t)length)));
+															return Object();
+														}
+
+														MetaList* list = asList(args[0]);
+														if (!list)
+														{
+															throw RuntimeError(Runner::pos_start, Runner::pos_end, "Expecting a length or a List to construct Float64Array");
+														}
+
+														std::vector<double> data;
+														data.reserve(list->length());
+														for (size_t i = 0; i < list->length(); i++)
+														{
+															Object& item = list->at((int)i);
+															if (!item.isNumber())
+															{
+																throw RuntimeError(Runner::pos_start, Runner::pos_end, "Float64Array can only hold numbers");
+															}
+															data.push_back(item.getNumber());
+														}
+														instance.getInstance()->set("@data", Object(std::make_shared<MetaFloat64Array>(std::move(data))));
+
+														return Object();
+													},
+													1) });
+
+		methods.insert(
+			{ "length", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													  {
+														  Object& instance = interpreter.context->slots[0];
+														  // 因为初始化时已经创建，所以这里一定拿到一个MetaFloat64Array
+														  MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+
+														  return Object((double)array->length());
+													  },
+													  0) });
+
+		methods.insert(
+			{ "sum", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+												   {
+													   Object& instance = interpreter.context->slots[0];
+													   MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+
+													   return Object(array->sum());
+												   },
+												   0) });
+
+		methods.insert(
+			{ "min", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+												   {
+													   Object& instance = interpreter.context->slots[0];
+													   MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+
+													   // 空数组返回nil
+													   return array->min();
+												   },
+												   0) });
+
+		methods.insert(
+			{ "max", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+												   {
+													   Object& instance = interpreter.context->slots[0];
+													   MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+
+													   // 空数组返回nil
+													   return array->max();
+												   },
+												   0) });
+
+		// 参数必须也是Float64Array
+		auto operand = [](const Object& arg, const char* name)
+		{
+			if (!Classifier::belongClass(arg, "Float64Array"))
+			{
+				throw RuntimeError(Runner::pos_start, Runner::pos_end, format("Expecting a Float64Array to %s", name));
+			}
+
+			return getMetaFloat64Array(arg.getInstance()->get("@data"));
+		};
+
+		auto factor = [](const Object& arg, const char* name)
+		{
+			if (!arg.isNumber())
+			{
+				throw RuntimeError(Runner::pos_start, Runner::pos_end, format("Expecting a number to %s", name));
+			}
+
+			return arg.getNumber();
+		};
+
+		methods.insert(
+			{ "dot", std::make_shared<NativeMethod>([=](Interpreter& interpreter, const std::vector<Object>& args)
+												   {
+													   MetaFloat64ArrayPtr other = operand(args[0], "dot");
+
+													   Object& instance = interpreter.context->slots[0];
+													   MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+
+													   return Object(array->dot(*other));
+												   },
+												   1) });
+
+		// 以下运算都原地修改数组
+		methods.insert(
+			{ "scale", std::make_shared<NativeMethod>([=](Interpreter& interpreter, const std::vector<Object>& args)
+													 {
+														 double k = factor(args[0], "scale");
+
+														 Object& instance = interpreter.context->slots[0];
+														 MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+														 array->scale(k);
+
+														 return Object();
+													 },
+													 1) });
+
+		methods.insert(
+			{ "axpy", std::make_shared<NativeMethod>([=](Interpreter& interpreter, const std::vector<Object>& args)
+													{
+														// this += a * x
+														double a = factor(args[0], "axpy");
+														MetaFloat64ArrayPtr x = operand(args[1], "axpy");
+
+														Object& instance = interpreter.context->slots[0];
+														MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+														array->axpy(a, *x);
+
+														return Object();
+													},
+													2) });
+
+		methods.insert(
+			{ "add", std::make_shared<NativeMethod>([=](Interpreter& interpreter, const std::vector<Object>& args)
+												   {
+													   MetaFloat64ArrayPtr other = operand(args[0], "add");
+
+													   Object& instance = interpreter.context->slots[0];
+													   MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+													   array->add(*other);
+
+													   return Object();
+												   },
+												   1) });
+
+		methods.insert(
+			{ "mul", std::make_shared<NativeMethod>([=](Interpreter& interpreter, const std::vector<Object>& args)
+												   {
+													   MetaFloat64ArrayPtr other = operand(args[0], "mul");
+
+													   Object& instance = interpreter.context->slots[0];
+													   MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+													   array->mul(*other);
+
+													   return Object();
+												   },
+												   1) });
+
+		methods.insert(
+			{ "prefixSum", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+														 {
+															 Object& instance = interpreter.context->slots[0];
+															 MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+															 array->prefixSum();
+
+															 return Object();
+														 },
+														 0) });
+
+		methods.insert(
+			{ "copy", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													{
+														Object& instance = interpreter.context->slots[0];
+														MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+
+														return Object(instantiate(array->copy()));
+													},
+													0) });
+
+		methods.insert(
+			{ "toList", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													  {
+														  Object& instance = interpreter.context->slots[0];
+														  MetaFloat64ArrayPtr array = getMetaFloat64Array(instance.getInstance()->get("@data"));
+
+														  return array->toList();
+													  },
+													  0) });
+
+		// reservedMethods
+		methods.insert(
+			{ "__repr__", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+														{
+															Object& instance = interpreter.context->slots[0];
+															Object array = instance.getInstance()->get("@data");
+
+															return Object(array.to_string());
+														},
+														0) });
+	}
+
+	std::shared_ptr<Float64Array> Float64Array::getSingleton()
+	{
+		static std::shared_ptr<Float64Array> singleton = std::make_shared<Float64Array>();
 		return singleton;
 	}
 
-	InstancePtr List::instantiate(std::vector<Object> items)
+	InstancePtr Float64Array::instantiate(MetaFloat64ArrayPtr data)
 	{
-		InstancePtr instance = std::make_shared<Instance>(List::getSingleton());
+		InstancePtr instance = std::make_shared<Instance>(Float64Array::getSingleton());
 
-		instance->set("@items", Object(std::make_shared<MetaList>(std::move(items))));
+		instance->set("@data", Object(std::move(data)));
+
+		return instance;
+	}
+
+	StringBuilder::StringBuilder() : NativeClass("StringBuilder")
+	{
+		// 与List相同，用户无法取到MetaStringBuilder
+		allowedFields.insert({ "@buffer", ObjectType::CONTAINER });
+
+		methods.insert(
+			{ "init", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													{
+														Object& instance = interpreter.context->slots[0];
+
+														// 可选参数为预计的长度，提前分配缓冲区
+														size_t capacity = 0;
+														if (!args.empty())
+														{
+															if (!args[0].isNumber() || !isValidSize(args[0].getNumber()))
+															{
+																throw RuntimeError(Runner::pos_start, Runner::pos_end, "StringBuilder capacity should be a non-negative integer below 2^32");
+															}
+															capacity = (size_t)args[0].getNumber();
+														}
+
+														instance.getInstance()->set("@buffer", Object(std::make_shared<MetaStringBuilder>(capacity)));
+														return Object();
+													},
+													1, 1) });
+
+		// append和appendLine返回自身，可以链式调用
+		methods.insert(
+			{ "append", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													  {
+														  Object& instance = interpreter.context->slots[0];
+														  // 因为初始化时已经创建，所以这里一定拿到一个MetaStringBuilder
+														  MetaStringBuilderPtr buffer = getMetaStringBuilder(instance.getInstance()->get("@buffer"));
+														  buffer->append(args[0]);
+
+														  return instance;
+													  },
+													  1) });
+
+		methods.insert(
+			{ "appendLine", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+														  {
+															  Object& instance = interpreter.context->slots[0];
+															  MetaStringBuilderPtr buffer = getMetaStringBuilder(instance.getInstance()->get("@buffer"));
+															  if (!args.empty())
+																  buffer->append(args[0]);
+															  buffer->append("\n");
+
+															  return instance;
+														  },
+														  1, 1) });
+
+		methods.insert(
+			{ "length", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+													  {
+														  Object& instance = interpreter.context->slots[0];
+														  MetaStringBuilderPtr buffer = getMetaStringBuilder(instance.getInstance()->get("@buffer"));
+
+														  return Object((double)buffer->length());
+													  },
+													  0) });
+
+		methods.insert(
+			{ "toString", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+														{
+															Object& instance = interpreter.context->slots[0];
+															MetaStringBuilderPtr buffer = getMetaStringBuilder(instance.getInstance()->get("@buffer"));
+
+															return Object(buffer->str());
+														},
+														0) });
+
+		// reservedMethods
+		methods.insert(
+			{ "__repr__", std::make_shared<NativeMethod>([&](Interpreter& interpreter, const std::vector<Object>& args)
+														{
+															Object& instance = interpreter.context->slots[0];
+															Object buffer = instance.getInstance()->get("@buffer");
+
+															return Object(buffer.to_string());
+														},
+														0) });
+	}
+
+	std::shared_ptr<StringBuilder> StringBuilder::getSingleton()
+	{
+		static std::shared_ptr<StringBuilder> singleton = std::make_shared<StringBuilder>();
+		return singleton;
+	}
+
+	InstancePtr StringBuilder::instantiate(MetaStringBuilderPtr buffer)
+	{
+		InstancePtr instance = std::make_shared<Instance>(StringBuilder::getSingleton());
+
+		instance->set("@buffer", Object(std::move(buffer)));
 
 		return instance;
 	}
@@ -641,12 +1253,12 @@ namespace CXX {
 	{
 		// No shared_from_this, since this should be the only instance created
 		InstancePtr Math = std::make_shared<Instance>(std::make_shared<Mathematics>());
-		Math->fields["PI"] = Object(3.141592653589793);		 // pi
-		Math->fields["E"] = Object(2.718281828459045);		 // e
-		Math->fields["LN2"] = Object(0.6931471805599453);	 // 以e为底，2的对数
-		Math->fields["LN10"] = Object(2.302585092994046);	 // 以e为底，10的对数
-		Math->fields["LOG2E"] = Object(1.4426950408889634);	 // 以2为底，e的对数
-		Math->fields["LOG10E"] = Object(0.4342944819032518); // 以10为底，e的对数
+		Math->setField("PI", Object(3.141592653589793));		 // pi
+		Math->setField("E", Object(2.718281828459045));		 // e
+		Math->setField("LN2", Object(0.6931471805599453));	 // 以e为底，2的对数
+		Math->setField("LN10", Object(2.302585092994046));	 // 以e为底，10的对数
+		Math->setField("LOG2E", Object(1.4426950408889634));	 // 以2为底，e的对数
+		Math->setField("LOG10E", Object(0.4342944819032518)); // 以10为底，e的对数
 
 		return Math;
 	}
@@ -657,6 +1269,10 @@ namespace CXX {
 		{
 			return val.getInstance()->belonging->className;
 		}
+		else if (val.isList())
+		{
+			return "List";
+		}
 
 		return std::string();
 	}
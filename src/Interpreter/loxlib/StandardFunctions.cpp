@@ -91,7 +91,7 @@ namespace CXX
 
 		TypeOf::TypeOf() : NativeFunction([](Interpreter& interpreter, const std::vector<Object>& args)
 			{
-				switch (args[0].type)
+				switch (args[0].type())
 				{
 				case ObjectType::CALLABLE:
 				{
@@ -104,8 +104,11 @@ namespace CXX
 				case ObjectType::INSTANCE:
 					return Object(args[0].getInstance()->belonging->name());
 
+				case ObjectType::LIST:
+					return Object(std::string("List"));
+
 				default:
-					return Object(std::string(ObjectTypeName(args[0].type)));
+					return Object(std::string(ObjectTypeName(args[0].type())));
 				} 
 			},
 			"typeof", 1) {}
@@ -123,6 +126,14 @@ namespace CXX
 
 		GetAttr::GetAttr() : NativeFunction([](Interpreter& interpreter, const std::vector<Object>& args)
 			{
+				// 列表只有成员函数
+				if (args[0].isList())
+				{
+					std::optional<Symbol> name = Symbol::find(args[1].to_string());
+					Object method = name ? List::getMethod(args[0], *name) : Object();
+					return method.isNil() && args.size() == 3 ? args[2] : method;
+				}
+
 				// 不是instance，则无attribute
 				if (!args[0].isInstance())
 					return Object();
@@ -132,7 +143,7 @@ namespace CXX
 				// 实际上，我们应当要求第二个参数必须为字符串
 				// 但是考虑到我们有封装的String和std::string两种
 				// 所以用to_string
-				Object attr = instance->get(args[1].to_string());
+				Object attr = instance->getAttr(args[1].to_string());
 				if (attr.isNil()) {
 					if (args.size() == 3)
 						return args[2];
@@ -170,7 +181,7 @@ namespace CXX
 							break;
 
 						CallablePtr callable(funcFn());
-						interpreter.context->set(std::string(nameFn()), Object(std::move(callable)));
+						interpreter.context->set(Symbol(nameFn()), Object(std::move(callable)));
 					}
 
 					baseFunc = "getClass_";
@@ -183,7 +194,7 @@ namespace CXX
 							break;
 
 						CallablePtr callable(funcFn());
-						interpreter.context->set(std::string(nameFn()), Object(std::move(callable)));
+						interpreter.context->set(Symbol(nameFn()), Object(std::move(callable)));
 					}
 				}
 
@@ -201,7 +212,7 @@ namespace CXX
 
 	Object NativeMethod::call(Interpreter &interpreter, const std::vector<Object> &arguments)
 	{
-		ScopedContext scope(interpreter.context, context, false);
+		ScopedContext scope(interpreter.context, context);
 
 		Object result = callable(interpreter, arguments);
 
@@ -210,11 +221,36 @@ namespace CXX
 
 	std::shared_ptr<Callable> NativeMethod::bindThis(std::shared_ptr<Instance> instance)
 	{
-		ContextPtr newEnv = std::make_shared<Context>(context);
-		newEnv->set("this", Object(instance));
+		return bindReceiver(Object(std::move(instance)));
+	}
+
+	std::shared_ptr<Callable> NativeMethod::bindReceiver(const Object& receiver)
+	{
+		// 与Function::bindThis一致，this位于0号槽位
+		ContextPtr newEnv = std::make_shared<Context>(context, 1);
+		newEnv->slots[0] = receiver;
 		return std::make_shared<NativeMethod>(callable, _arity, _optional, newEnv);
 	}
 
+	Object NativeMethod::invoke(Interpreter& interpreter, const std::shared_ptr<Instance>& receiver, const std::vector<Object>& arguments)
+	{
+		return invoke(interpreter, Object(receiver), arguments);
+	}
+
+	Object NativeMethod::invoke(Interpreter& interpreter, const Object& receiver, const std::vector<Object>& arguments)
+	{
+		ContextPtr env = std::make_shared<Context>(context, 1);
+		env->slots[0] = receiver;
+		ScopedContext scope(interpreter.context, env);
+
+		return callable(interpreter, arguments);
+	}
+
+	void NativeMethod::trace(GarbageCollector &gc) const
+	{
+		gc.mark(context);
+	}
+
 	std::string NativeMethod::to_string()
 	{
 		return "<native method>";
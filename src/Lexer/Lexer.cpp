@@ -5,21 +5,42 @@
 namespace CXX
 {
 
-	Lexer::Lexer(const std::string &filename, const std::string &text) : text(text), filename(filename), pos(-1, 0, -1, filename, text), current_char('\0')
+	Lexer::Lexer(const std::string &filename, std::string text) : Lexer(SourceFile::add(filename, std::move(text)))
+	{
+	}
+
+	Lexer::Lexer(const SourceFile &source) : Lexer(source, Position(source.base()))
+	{
+	}
+
+	Lexer::Lexer(const SourceFile &source, const Position &start) : source(source), text(source.content()), pos(start.offset - 1),
+																	current_char('\0')
 	{
 		advance();
 	}
 
 	void Lexer::advance()
 	{
-		this->pos.advance(this->current_char);
-		if (this->pos.index < this->text.length())
-			this->current_char = this->text[this->pos.index];
+		this->pos.advance();
+		if (size_t index = this->pos.offset - source.base(); index < this->text.length())
+			this->current_char = this->text[index];
 		else
 			this->current_char = '\0';
 	}
 
 	std::vector<Token> &Lexer::tokenize()
+	{
+		// 按平均每4个字符一个Token预留，避免大文件反复扩容拷贝
+		tokens.reserve(text.size() / 4);
+		do
+		{
+			tokens.push_back(next());
+		} while (tokens.back().type != TokenType::END_OF_FILE);
+
+		return tokens;
+	}
+
+	Token Lexer::next()
 	{
 		while (current_char != '\0')
 		{
@@ -37,95 +58,62 @@ namespace CXX
 
 				// literals
 			case '(':
-				tokens.emplace_back(TokenType::LPAREN, "(", pos);
-				advance();
-				break;
+				return make_single(TokenType::LPAREN, "(");
 			case ')':
-				tokens.emplace_back(TokenType::RPAREN, ")", pos);
-				advance();
-				break;
+				return make_single(TokenType::RPAREN, ")");
 			case '{':
-				tokens.emplace_back(TokenType::LBRACE, "{", pos);
-				advance();
-				break;
+				return make_single(TokenType::LBRACE, "{");
 			case '}':
-				tokens.emplace_back(TokenType::RBRACE, "}", pos);
-				advance();
-				break;
+				return make_single(TokenType::RBRACE, "}");
 			case '[':
-				tokens.emplace_back(TokenType::LBRACKET, "[", pos);
-				advance();
-				break;
+				return make_single(TokenType::LBRACKET, "[");
 			case ']':
-				tokens.emplace_back(TokenType::RBRACKET, "]", pos);
-				advance();
-				break;
+				return make_single(TokenType::RBRACKET, "]");
 			case ',':
-				tokens.emplace_back(TokenType::COMMA, ",", pos);
-				advance();
-				break;
+				return make_single(TokenType::COMMA, ",");
 			case '.':
-				tokens.emplace_back(TokenType::DOT, ".", pos);
-				advance();
-				break;
+				return make_single(TokenType::DOT, ".");
 			case ';':
-				tokens.emplace_back(TokenType::SEMICOLON, ";", pos);
-				advance();
-				break;
+				return make_single(TokenType::SEMICOLON, ";");
 			case ':':
-				tokens.emplace_back(TokenType::COLON, ":", pos);
-				advance();
-				break;
+				return make_single(TokenType::COLON, ":");
 			case '+':
-				make_plus_plus();
-				break;
+				return make_plus_plus();
 			case '-':
-				make_minus_minus();
-				break;
+				return make_minus_minus();
 			case '*':
-				make_optional_token('=', TokenType::MUL_EQUAL, "*=", TokenType::MUL, "*");
-				break;
+				return make_optional_token('=', TokenType::MUL_EQUAL, "*=", TokenType::MUL, "*");
 			case '/':
-				make_optional_token('=', TokenType::DIV_EQUAL, "/=", TokenType::DIV, "/");
-				break;
+				return make_optional_token('=', TokenType::DIV_EQUAL, "/=", TokenType::DIV, "/");
 			case '%':
-				tokens.emplace_back(TokenType::MOD, "%", pos);
-				advance();
-				break;
+				return make_single(TokenType::MOD, "%");
 			case '?':
-				tokens.emplace_back(TokenType::QUESTION_MARK, "?", pos);
-				advance();
-				break;
+				return make_single(TokenType::QUESTION_MARK, "?");
 
 				// one or two character (e.g. <=)
 			case '!':
-				make_optional_token('=', TokenType::BANGEQ, "!=", TokenType::BANG, "!");
-				break;
+				return make_optional_token('=', TokenType::BANGEQ, "!=", TokenType::BANG, "!");
 
 			case '=':
-				make_optional_token('=', TokenType::EQEQ, "==", TokenType::EQ, "=");
-				break;
+				return make_optional_token('=', TokenType::EQEQ, "==", TokenType::EQ, "=");
 
 			case '<':
-				make_optional_token('=', TokenType::LTE, "<!>=", TokenType::LT, "<");
-				break;
+				return make_optional_token('=', TokenType::LTE, "<=", TokenType::LT, "<");
 
 			case '>':
-				make_optional_token('=', TokenType::GTE, ">=", TokenType::GT, ">");
-				break;
+				return make_optional_token('=', TokenType::GTE, ">=", TokenType::GT, ">");
 
 			case '"':
-				make_string();
-				break;
+				return make_string();
 
 			default:
 				if (isdigit((unsigned char)current_char))
 				{
-					make_number();
+					return make_number();
 				}
 				else if (isalpha((unsigned char)current_char) || current_char == '_')
 				{
-					make_identifier();
+					return make_identifier();
 				}
 				else
 				{
@@ -138,9 +126,15 @@ namespace CXX
 			}
 		}
 
-		tokens.emplace_back(TokenType::END_OF_FILE, "", pos);
+		// 到达末尾后重复返回END_OF_FILE
+		return Token(TokenType::END_OF_FILE, "", pos);
+	}
 
-		return tokens;
+	Token Lexer::make_single(TokenType type, std::string_view lexeme)
+	{
+		Position start = pos;
+		advance();
+		return Token(type, lexeme, start);
 	}
 
 	void Lexer::skip_comment()
@@ -155,74 +149,86 @@ namespace CXX
 		advance(); // 跳过换行
 	}
 
-	void Lexer::make_string()
+	Token Lexer::make_string()
 	{
-		std::string str;
 		Position start = pos;
 		advance(); // 跳过'"'
 
 		// 处理形如：str = "abc:\"xxx\""
 		// 读取到\后的下一个字符需要无条件读入
 		// 我们需要处理，如果\后面是n，则应为\n（换行）等情况
+		// 没有转义字符时，lexeme直接指向源码，不做拷贝
 
-		bool escape = false; // 当遇到'\\'，设为true，意为接收下一个字符
-
-		// 上一个字符是\\，则下一个n应被转换为\n；以此类推
-		std::unordered_map<char, char> escape_characters{
-			{'n', '\n'},
-			{'t', '\t'}};
+		bool escape = false;	 // 当遇到'\\'，设为true，意为接收下一个字符
+		bool hasEscape = false;	 // 是否需要另行构造字符串
+		Position begin = pos;
 
 		while (current_char != '\0' && (current_char != '\"' || escape))
 		{
 			if (escape)
-			{
-				if (escape_characters.find(current_char) != escape_characters.end())
-					str.push_back(escape_characters[current_char]);
-				else
-					str.push_back(current_char);
 				escape = false;
-			}
-			else
-			{
-				if (current_char == '\\')
-					escape = true;
-				else
-					str.push_back(current_char);
-			}
+			else if (current_char == '\\')
+				escape = hasEscape = true;
 			advance();
 		}
 
 		if (current_char != '\"')
 			throw ExpectCharError(start, this->pos, "'\"' at the end of a string");
 
+		std::string_view raw = slice(begin, pos);
 		advance(); // 跳过'"'
 
-		tokens.emplace_back(TokenType::STRING, str, start, pos);
+		if (!hasEscape)
+			return Token(TokenType::STRING, raw, start, pos);
+
+		// 上一个字符是\\，则下一个n应被转换为\n；以此类推
+		std::string str;
+		str.reserve(raw.size());
+		for (size_t i = 0; i < raw.size(); i++)
+		{
+			if (raw[i] != '\\')
+			{
+				str.push_back(raw[i]);
+				continue;
+			}
+
+			// 未转义的'\\'之后必然还有字符，否则上面会因缺少'"'而报错
+			switch (raw[++i])
+			{
+			case 'n':
+				str.push_back('\n');
+				break;
+			case 't':
+				str.push_back('\t');
+				break;
+			default:
+				str.push_back(raw[i]);
+			}
+		}
+
+		// 转义后的字符串由符号表持有
+		return Token(TokenType::STRING, Symbol(str).str(), start, pos);
 	}
 
-	bool validForIdentifier(char c)
+	static inline bool validForIdentifier(char c)
 	{
-		return isalpha(c) || isdigit(c) || c == '_';
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
 	}
 
-	void Lexer::make_identifier()
+	Token Lexer::make_identifier()
 	{
 		Position start = pos;
-		std::string value;
 
 		while (current_char != '\0' && validForIdentifier(current_char))
 		{
-			value.push_back(current_char);
 			advance();
 		}
 
-		if (reservedKeywords.find(value) != reservedKeywords.end())
-			tokens.emplace_back(reservedKeywords[value], value, start, pos);
-		else
-			tokens.emplace_back(TokenType::IDENTIFIER, value, start, pos);
+		std::string_view value = slice(start, pos);
+		return Token(keyword(value), value, start, pos);
 	}
 
-	void Lexer::make_number()
+	Token Lexer::make_number()
 	{
 		Position start = pos;
 
@@ -256,13 +262,11 @@ namespace CXX
 			}
 		}
 
-		std::string_view number = text.substr(start.index, (pos.index - start.index));
-
-		tokens.emplace_back(TokenType::NUMBER, std::string(number), start, pos);
+		return Token(TokenType::NUMBER, slice(start, pos), start, pos);
 	}
 
-	void Lexer::make_optional_token(char expect, TokenType optional, std::string optional_lexeme, TokenType fallback,
-									std::string fallback_lexeme)
+	Token Lexer::make_optional_token(char expect, TokenType optional, std::string_view optional_lexeme, TokenType fallback,
+									std::string_view fallback_lexeme)
 	{
 		Position start = pos;
 		advance();
@@ -270,15 +274,15 @@ namespace CXX
 		if (current_char == expect)
 		{
 			advance();
-			tokens.emplace_back(optional, optional_lexeme, start, pos);
+			return Token(optional, optional_lexeme, start, pos);
 		}
 		else
 		{
-			tokens.emplace_back(fallback, fallback_lexeme, start);
+			return Token(fallback, fallback_lexeme, start);
 		}
 	}
 
-	void Lexer::make_plus_plus()
+	Token Lexer::make_plus_plus()
 	{
 		Position start = pos;
 		advance(); // 跳过第一个'+'
@@ -286,20 +290,20 @@ namespace CXX
 		if (current_char == '+')
 		{
 			advance();
-			tokens.emplace_back(TokenType::PLUS_PLUS, "++", start, pos);
+			return Token(TokenType::PLUS_PLUS, "++", start, pos);
 		}
 		else if (current_char == '=')
 		{
 			advance();
-			tokens.emplace_back(TokenType::PLUS_EQUAL, "+=", start, pos);
+			return Token(TokenType::PLUS_EQUAL, "+=", start, pos);
 		}
 		else
 		{
-			tokens.emplace_back(TokenType::PLUS, "+", start);
+			return Token(TokenType::PLUS, "+", start);
 		}
 	}
 
-	void Lexer::make_minus_minus()
+	Token Lexer::make_minus_minus()
 	{
 		Position start = pos;
 		advance(); // 跳过第一个'-'
@@ -307,39 +311,86 @@ namespace CXX
 		if (current_char == '-')
 		{
 			advance();
-			tokens.emplace_back(TokenType::MINUS_MINUS, "--", start, pos);
+			return Token(TokenType::MINUS_MINUS, "--", start, pos);
 		}
 		else if (current_char == '=')
 		{
 			advance();
-			tokens.emplace_back(TokenType::MINUS_EQUAL, "-=", start, pos);
+			return Token(TokenType::MINUS_EQUAL, "-=", start, pos);
 		}
 		else
 		{
-			tokens.emplace_back(TokenType::MINUS, "-", start);
+			return Token(TokenType::MINUS, "-", start);
+		}
+	}
+
+	std::string_view Lexer::slice(const Position &start, const Position &end) const
+	{
+		return text.substr(start.offset - source.base(), end.offset - start.offset);
+	}
+
+	// 剩余部分与rest相同时为关键字type，否则为标识符
+	static TokenType checkKeyword(std::string_view word, size_t from, std::string_view rest, TokenType type)
+	{
+		return word.size() == from + rest.size() && word.substr(from) == rest ? type : TokenType::IDENTIFIER;
+	}
+
+	TokenType Lexer::keyword(std::string_view word)
+	{
+		// 按首字母(必要时再按第二个字母)分派，每个候选最多做一次比较，不需要哈希
+		switch (word[0])
+		{
+		case 'a':
+			if (word.size() == 2)
+				return checkKeyword(word, 1, "s", TokenType::AS);
+			return checkKeyword(word, 1, "nd", TokenType::AND);
+		case 'b':
+			return checkKeyword(word, 1, "reak", TokenType::BREAK);
+		case 'c':
+			if (word.size() == 5)
+				return checkKeyword(word, 1, "lass", TokenType::CLASS);
+			return checkKeyword(word, 1, "ontinue", TokenType::CONTINUE);
+		case 'e':
+			return checkKeyword(word, 1, "lse", TokenType::ELSE);
+		case 'f':
+			if (word.size() > 1)
+			{
+				switch (word[1])
+				{
+				case 'a':
+					return checkKeyword(word, 2, "lse", TokenType::FALSE);
+				case 'o':
+					return checkKeyword(word, 2, "r", TokenType::FOR);
+				case 'r':
+					return checkKeyword(word, 2, "om", TokenType::FROM);
+				case 'u':
+					return checkKeyword(word, 2, "nc", TokenType::FUNC);
+				}
+			}
+			break;
+		case 'i':
+			if (word.size() == 2)
+				return checkKeyword(word, 1, "f", TokenType::IF);
+			return checkKeyword(word, 1, "mport", TokenType::IMPORT);
+		case 'n':
+			return checkKeyword(word, 1, "il", TokenType::NIL);
+		case 'o':
+			return checkKeyword(word, 1, "r", TokenType::OR);
+		case 'r':
+			return checkKeyword(word, 1, "eturn", TokenType::RETURN);
+		case 's':
+			return checkKeyword(word, 1, "uper", TokenType::SUPER);
+		case 't':
+			if (word.size() == 4 && word[1] == 'h')
+				return checkKeyword(word, 2, "is", TokenType::THIS);
+			return checkKeyword(word, 1, "rue", TokenType::TRUE);
+		case 'v':
+			return checkKeyword(word, 1, "ar", TokenType::VAR);
+		case 'w':
+			return checkKeyword(word, 1, "hile", TokenType::WHILE);
 		}
+
+		return TokenType::IDENTIFIER;
 	}
 
-	std::unordered_map<std::string, TokenType> Lexer::reservedKeywords = {
-		{"nil", TokenType::NIL},
-		{"true", TokenType::TRUE},
-		{"false", TokenType::FALSE},
-		{"var", TokenType::VAR},
-		{"class", TokenType::CLASS},
-		{"this", TokenType::THIS},
-		{"super", TokenType::SUPER},
-		{"if", TokenType::IF},
-		{"else", TokenType::ELSE},
-		{"for", TokenType::FOR},
-		{"while", TokenType::WHILE},
-		{"break", TokenType::BREAK},
-		{"continue", TokenType::CONTINUE},
-		{"func", TokenType::FUNC},
-		{"return", TokenType::RETURN},
-		{"and", TokenType::AND},
-		{"or", TokenType::OR},
-		{"import", TokenType::IMPORT},
-		{"as", TokenType::AS},
-		{"from", TokenType::FROM}};
-
-}
\ No newline at end of file
+}
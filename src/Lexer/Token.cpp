@@ -4,31 +4,27 @@
 
 namespace CXX {
 
-	Token::Token(const TokenType& type, std::string lexeme, const Position& start, const Position& end) : type(type),
-		lexeme(std::move(lexeme))
+	Token::Token(const TokenType& type, std::string_view lexeme, const Position& start, const Position& end) : type(type),
+		lexeme(lexeme)
 	{
-		if (start.index != -1)
+		// 运算符与标点只按type使用，无需驻留
+		if (type >= TokenType::STRING)
+			symbol = Symbol(lexeme);
+
+		if (start.valid())
 		{
 			this->pos_start = start;
 			this->pos_end = start;
 			this->pos_end.advance();
 		}
 
-		if (end.index != -1)
+		if (end.valid())
 			this->pos_end = end;
 	}
 
-	Token::Token(const Token& other)
-	{
-		this->type = other.type;
-		this->lexeme = other.lexeme;
-		this->pos_start = other.pos_start;
-		this->pos_end = other.pos_end;
-	}
-
 	std::string Token::to_string() const
 	{
-		return format("Token: %s %s", TypeName(type), lexeme.c_str());
+		return format("Token: %s %.*s", TypeName(type), (int)lexeme.size(), lexeme.data());
 	}
 
 	bool Token::operator==(const Token& rhs) const
@@ -43,7 +39,7 @@ namespace CXX {
 		if (lexeme != rhs.lexeme)
 			return lexeme > rhs.lexeme;
 
-		return pos_start.index < rhs.pos_start.index;
+		return pos_start.offset < rhs.pos_start.offset;
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,412 @@
+#include "Optimizer/ConstantFolder.h"
+#include "Parser/Expr.h"
+#include "Parser/Stmt.h"
+#include "Parser/AstArena.h"
+#include <cmath>
+
+namespace CXX {
+
+	// 折叠得到的字符串过长时不折叠，避免字面量撑大AST与缓存
+	static constexpr size_t MAX_FOLDED_STRING = 4096;
+
+	void ConstantFolder::fold(std::vector<StmtPtr>& statements)
+	{
+		size_t kept = 0;
+		for (StmtPtr stmt : statements)
+		{
+			if (StmtPtr folded = fold(stmt))
+				statements[kept++] = folded;
+		}
+		statements.resize(kept);
+	}
+
+	void ConstantFolder::foldBody(FuncDeclarationStmt* function)
+	{
+		// 参数默认值在预解析时已随外层一起折叠
+		ConstantFolder(*function->arena).fold(function->body);
+	}
+
+	std::optional<Object> ConstantFolder::constant(ExprPtr expr)
+	{
+		if (expr->exprType != ExprType::Literal)
+			return std::nullopt;
+
+		// 字面量只可能是这几种类型，这里仍做检查，防止将来出现其他字面量
+		const Object& value = static_cast<LiteralExpr*>(expr)->value;
+		if (value.isNil() || value.isBoolean() || value.isNumber() || value.isString())
+			return value;
+
+		return std::nullopt;
+	}
+
+	ExprPtr ConstantFolder::literal(ExprPtr origin, Object value)
+	{
+		// 字符串结果与源码中的字符串常量一样驻留，相等比较仍可走指针比较的捷径
+		if (value.isString())
+			value = Object(Symbol(value.getString()));
+
+		return arena.make<LiteralExpr>(std::move(value), origin->pos_start, origin->pos_end);
+	}
+
+	ExprPtr ConstantFolder::fold(ExprPtr expr)
+	{
+		switch (expr->exprType)
+		{
+		case ExprType::Binary:
+			return foldBinary(expr);
+
+		case ExprType::Unary:
+			return foldUnary(expr);
+
+		case ExprType::Or:
+		case ExprType::And:
+			return foldLogical(expr);
+
+		case ExprType::Ternary:
+		{
+			auto ternary = static_cast<TernaryExpr*>(expr);
+			ternary->expr = fold(ternary->expr);
+			ternary->thenBranch = fold(ternary->thenBranch);
+			ternary->elseBranch = fold(ternary->elseBranch);
+
+			if (auto condition = constant(ternary->expr))
+				return condition->is_true() ? ternary->thenBranch : ternary->elseBranch;
+
+			return expr;
+		}
+
+		case ExprType::Assignment:
+		{
+			auto assignment = static_cast<AssignmentExpr*>(expr);
+			assignment->value = fold(assignment->value);
+			return expr;
+		}
+
+		case ExprType::Increment:
+		case ExprType::Decrement:
+		{
+			// holder只能是变量或下标访问，下标可以折叠
+			ExprPtr holder = expr->exprType == ExprType::Increment ? static_cast<IncrementExpr*>(expr)->holder
+																	 : static_cast<DecrementExpr*>(expr)->holder;
+			if (holder->exprType == ExprType::Retrieve)
+				fold(holder);
+			return expr;
+		}
+
+		case ExprType::Call:
+		{
+			auto call = static_cast<CallExpr*>(expr);
+			call->callee = fold(call->callee);
+			for (ExprPtr& argument : call->arguments)
+				argument = fold(argument);
+			return expr;
+		}
+
+		case ExprType::Retrieve:
+		{
+			auto retrieve = static_cast<RetrieveExpr*>(expr);
+			retrieve->holder = fold(retrieve->holder);
+			if (retrieve->index)
+				retrieve->index = fold(retrieve->index);
+			return expr;
+		}
+
+		case ExprType::Set:
+		{
+			auto set = static_cast<SetExpr*>(expr);
+			set->holder = fold(set->holder);
+			if (set->index)
+				set->index = fold(set->index);
+			set->value = fold(set->value);
+			return expr;
+		}
+
+		case ExprType::Lambda:
+		{
+			auto lambda = static_cast<LambdaExpr*>(expr);
+			for (ExprPtr& value : lambda->default_values)
+			{
+				if (value)
+					value = fold(value);
+			}
+			fold(lambda->body);
+			return expr;
+		}
+
+		case ExprType::List:
+		{
+			auto list = static_cast<ListExpr*>(expr);
+			for (ExprPtr& item : list->items)
+				item = fold(item);
+			return expr;
+		}
+
+		case ExprType::Pack:
+		{
+			auto pack = static_cast<PackExpr*>(expr);
+			for (ExprPtr& item : pack->expressions)
+				item = fold(item);
+			return expr;
+		}
+
+		default:
+			// Literal、Variable、This、Super
+			return expr;
+		}
+	}
+
+	ExprPtr ConstantFolder::foldBinary(ExprPtr expr)
+	{
+		auto binary = static_cast<BinaryExpr*>(expr);
+		binary->left = fold(binary->left);
+		binary->right = fold(binary->right);
+
+		auto lhs = constant(binary->left), rhs = constant(binary->right);
+		if (!lhs || !rhs)
+			return expr;
+
+		const Object& left = *lhs;
+		const Object& right = *rhs;
+		bool numbers = left.isNumber() && right.isNumber();
+		bool strings = left.isString() && right.isString();
+
+		// 只折叠一定不会报错的组合，其余情况保留节点，由运行时报错
+		switch (binary->op.type)
+		{
+		case TokenType::PLUS:
+			if (numbers || strings)
+			{
+				Object result = left + right;
+				if (numbers || result.getString().size() <= MAX_FOLDED_STRING)
+					return literal(expr, std::move(result));
+			}
+			return expr;
+
+		case TokenType::MINUS:
+			return numbers ? literal(expr, left - right) : expr;
+
+		case TokenType::MUL:
+			if (numbers)
+				return literal(expr, left * right);
+
+			if ((left.isNumber() && right.isString()) || (left.isString() && right.isNumber()))
+			{
+				double times = left.isNumber() ? left.getNumber() : right.getNumber();
+				const std::string& origin = left.isString() ? left.getString() : right.getString();
+				if (times >= 0 && times * origin.size() <= MAX_FOLDED_STRING)
+					return literal(expr, left * right);
+			}
+			return expr;
+
+		case TokenType::DIV:
+			return numbers && right.getNumber() != 0.0 ? literal(expr, left / right) : expr;
+
+		case TokenType::MOD:
+		{
+			// 运行时先转换为整数再取余，转换溢出或除数为0都不折叠
+			constexpr double LIMIT = 9007199254740992.0; // 2^53
+			if (!numbers || !(std::fabs(left.getNumber()) < LIMIT) || !(std::fabs(right.getNumber()) < LIMIT) ||
+				(long)right.getNumber() == 0)
+				return expr;
+
+			return literal(expr, left % right);
+		}
+
+		case TokenType::GT:
+			return numbers || strings ? literal(expr, Object(left > right)) : expr;
+
+		case TokenType::GTE:
+			return numbers || strings ? literal(expr, Object(left >= right)) : expr;
+
+		case TokenType::LT:
+			return numbers || strings ? literal(expr, Object(left < right)) : expr;
+
+		case TokenType::LTE:
+			return numbers || strings ? literal(expr, Object(left <= right)) : expr;
+
+		case TokenType::EQEQ:
+			return literal(expr, Object(left == right));
+
+		case TokenType::BANGEQ:
+			return literal(expr, Object(left != right));
+
+		default:
+			return expr;
+		}
+	}
+
+	ExprPtr ConstantFolder::foldUnary(ExprPtr expr)
+	{
+		auto unary = static_cast<UnaryExpr*>(expr);
+		unary->expr = fold(unary->expr);
+
+		auto operand = constant(unary->expr);
+		if (!operand)
+			return expr;
+
+		switch (unary->op.type)
+		{
+		case TokenType::MINUS:
+			return operand->isNumber() ? literal(expr, -*operand) : expr;
+
+		case TokenType::BANG:
+			return operand->isNumber() || operand->isBoolean() ? literal(expr, !*operand) : expr;
+
+		default:
+			return expr;
+		}
+	}
+
+	ExprPtr ConstantFolder::foldLogical(ExprPtr expr)
+	{
+		// and、or的结果总是bool，右侧不是常量时不能直接换成右侧表达式
+		bool isAnd = expr->exprType == ExprType::And;
+		ExprPtr& left = isAnd ? static_cast<AndExpr*>(expr)->left : static_cast<OrExpr*>(expr)->left;
+		ExprPtr& right = isAnd ? static_cast<AndExpr*>(expr)->right : static_cast<OrExpr*>(expr)->right;
+
+		left = fold(left);
+		right = fold(right);
+
+		auto lhs = constant(left);
+		if (!lhs)
+			return expr;
+
+		// false and x => false，true or x => true，右侧不会被求值
+		if (lhs->is_true() != isAnd)
+			return literal(expr, Object(!isAnd));
+
+		if (auto rhs = constant(right))
+			return literal(expr, Object(rhs->is_true()));
+
+		return expr;
+	}
+
+	StmtPtr ConstantFolder::fold(StmtPtr stmt)
+	{
+		switch (stmt->stmtType)
+		{
+		case StmtType::Expression:
+		{
+			// 即使是常量也要保留，REPL中会输出表达式语句的值
+			auto expression = static_cast<ExpressionStmt*>(stmt);
+			expression->expr = fold(expression->expr);
+			return stmt;
+		}
+
+		case StmtType::VarDecl:
+		{
+			auto var = static_cast<VarDeclarationStmt*>(stmt);
+			if (var->expr)
+				var->expr = fold(var->expr.value());
+			return stmt;
+		}
+
+		case StmtType::FuncDecl:
+		{
+			// 预解析的函数体在补全时再折叠
+			auto function = static_cast<FuncDeclarationStmt*>(stmt);
+			for (ExprPtr& value : function->default_values)
+			{
+				if (value)
+					value = fold(value);
+			}
+			if (!function->lazy)
+				fold(function->body);
+			return stmt;
+		}
+
+		case StmtType::ClassDecl:
+		{
+			auto classStmt = static_cast<ClassDeclarationStmt*>(stmt);
+			for (FuncDeclarationStmt* method : classStmt->methods)
+				fold(method);
+			return stmt;
+		}
+
+		case StmtType::Block:
+			fold(static_cast<BlockStmt*>(stmt)->statements);
+			return stmt;
+
+		case StmtType::If:
+			return foldIf(stmt);
+
+		case StmtType::While:
+		{
+			auto whileStmt = static_cast<WhileStmt*>(stmt);
+			whileStmt->condition = fold(whileStmt->condition);
+
+			if (auto condition = constant(whileStmt->condition); condition && !condition->is_true())
+				return nullptr;
+
+			whileStmt->body = foldRequired(whileStmt->body);
+			return stmt;
+		}
+
+		case StmtType::For:
+		{
+			// 初始化语句总会执行，这里只折叠各部分而不删除循环
+			auto forStmt = static_cast<ForStmt*>(stmt);
+			if (forStmt->initializer)
+				forStmt->initializer = fold(forStmt->initializer.value());
+			if (forStmt->condition)
+				forStmt->condition = fold(forStmt->condition.value());
+			if (forStmt->increment)
+				forStmt->increment = fold(forStmt->increment.value());
+			forStmt->body = foldRequired(forStmt->body);
+			return stmt;
+		}
+
+		case StmtType::Return:
+		{
+			auto returnStmt = static_cast<ReturnStmt*>(stmt);
+			if (returnStmt->expr)
+				returnStmt->expr = fold(returnStmt->expr.value());
+			return stmt;
+		}
+
+		case StmtType::Pack:
+			fold(static_cast<PackStmt*>(stmt)->statements);
+			return stmt;
+
+		default:
+			// Break、Continue、Import
+			return stmt;
+		}
+	}
+
+	StmtPtr ConstantFolder::foldRequired(StmtPtr stmt)
+	{
+		if (StmtPtr folded = fold(stmt))
+			return folded;
+
+		BlockStmt* empty = arena.make<BlockStmt>(std::vector<StmtPtr>());
+		empty->set_pos(stmt->pos_start, stmt->pos_end);
+		return empty;
+	}
+
+	StmtPtr ConstantFolder::foldIf(StmtPtr stmt)
+	{
+		auto ifStmt = static_cast<IfStmt*>(stmt);
+		ifStmt->condition = fold(ifStmt->condition);
+
+		// 条件为常量时以会执行的分支代替整条语句，分支若是块，其作用域随之保留
+		if (auto condition = constant(ifStmt->condition))
+		{
+			if (condition->is_true())
+				return fold(ifStmt->thenBranch);
+
+			return ifStmt->elseBranch ? fold(ifStmt->elseBranch.value()) : nullptr;
+		}
+
+		ifStmt->thenBranch = foldRequired(ifStmt->thenBranch);
+		if (ifStmt->elseBranch)
+		{
+			if (StmtPtr elseBranch = fold(ifStmt->elseBranch.value()))
+				ifStmt->elseBranch = elseBranch;
+			else
+				ifStmt->elseBranch = std::nullopt;
+		}
+		return stmt;
+	}
+
+}
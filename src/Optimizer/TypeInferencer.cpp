@@ -0,0 +1,509 @@
+#include "Optimizer/TypeInferencer.h"
+#include "Parser/Stmt.h"
+#include "Common/utils.h"
+#include <iostream>
+
+namespace CXX {
+
+	bool TypeInferencer::print = false;
+
+	static const char* typeName(StaticType type)
+	{
+		switch (type)
+		{
+		case StaticType::NUMBER:
+			return "number";
+		case StaticType::STRING:
+			return "string";
+		case StaticType::BOOL:
+			return "bool";
+		default:
+			return "unknown";
+		}
+	}
+
+	void TypeInferencer::infer(const std::vector<StmtPtr>& statements)
+	{
+		TypeInferencer inferencer;
+		inferencer.solve([&]()
+			{ inferencer.walk(statements); });
+	}
+
+	void TypeInferencer::inferModule(BlockStmt* module)
+	{
+		TypeInferencer inferencer;
+		inferencer.solve([&]()
+			{
+				inferencer.scopes.push_back(nullptr);
+				inferencer.walk(module->statements);
+				inferencer.scopes.pop_back(); });
+	}
+
+	void TypeInferencer::inferFunction(FuncDeclarationStmt* function)
+	{
+		TypeInferencer inferencer;
+		inferencer.solve([&]()
+			{ inferencer.walkFunction(function, function->localCount, function->params.size(), function->thisSlot, function->body); });
+	}
+
+	template <typename Walk>
+	void TypeInferencer::solve(Walk pass)
+	{
+		// 类型只会沿UNKNOWN的方向变化，遍历次数有限
+		do
+		{
+			changed = false;
+			pass();
+		} while (changed);
+
+		annotating = true;
+		pass();
+
+		if (print && total != 0)
+			std::cout << format("-- %d of %d expressions typed\n", (int)typed, (int)total);
+	}
+
+	TypeInferencer::Type TypeInferencer::walk(ExprPtr expr)
+	{
+		Type type = typeOf(expr);
+		if (annotating)
+		{
+			expr->staticType = type.value_or(StaticType::UNKNOWN);
+			if (print && expr->exprType != ExprType::Literal)
+				report(expr, expr->staticType);
+		}
+
+		return type;
+	}
+
+	TypeInferencer::Type TypeInferencer::typeOf(ExprPtr expr)
+	{
+		switch (expr->exprType)
+		{
+		case ExprType::Literal:
+		{
+			const Object& value = static_cast<LiteralExpr*>(expr)->value;
+			if (value.isNumber())
+				return StaticType::NUMBER;
+			if (value.isString())
+				return StaticType::STRING;
+			if (value.isBoolean())
+				return StaticType::BOOL;
+			return StaticType::UNKNOWN;
+		}
+
+		case ExprType::Variable:
+		{
+			auto var = static_cast<VariableExpr*>(expr);
+			return lookup(var->depth, var->slot);
+		}
+
+		case ExprType::Assignment:
+		{
+			auto assignment = static_cast<AssignmentExpr*>(expr);
+			Type value = walk(assignment->value);
+
+			// 复合赋值与对应的二元运算结果相同
+			Type result;
+			switch (assignment->operation.type)
+			{
+			case TokenType::EQ:
+				result = value;
+				break;
+			case TokenType::PLUS_EQUAL:
+				result = binary(TokenType::PLUS, lookup(assignment->depth, assignment->slot), value);
+				break;
+			case TokenType::MINUS_EQUAL:
+				result = binary(TokenType::MINUS, lookup(assignment->depth, assignment->slot), value);
+				break;
+			case TokenType::MUL_EQUAL:
+				result = binary(TokenType::MUL, lookup(assignment->depth, assignment->slot), value);
+				break;
+			case TokenType::DIV_EQUAL:
+				result = binary(TokenType::DIV, lookup(assignment->depth, assignment->slot), value);
+				break;
+			default:
+				result = StaticType::UNKNOWN;
+				break;
+			}
+
+			assign(assignment->depth, assignment->slot, result);
+			return result;
+		}
+
+		case ExprType::Binary:
+		{
+			auto binaryExpr = static_cast<BinaryExpr*>(expr);
+			Type lhs = walk(binaryExpr->left);
+			Type rhs = walk(binaryExpr->right);
+			return binary(binaryExpr->op.type, lhs, rhs);
+		}
+
+		case ExprType::Unary:
+		{
+			// 取负只接受数字，取反的结果总是bool，其他情况运行时报错
+			auto unary = static_cast<UnaryExpr*>(expr);
+			walk(unary->expr);
+			return unary->op.type == TokenType::BANG ? StaticType::BOOL : StaticType::NUMBER;
+		}
+
+		case ExprType::Or:
+		{
+			auto orExpr = static_cast<OrExpr*>(expr);
+			walk(orExpr->left);
+			walk(orExpr->right);
+			return StaticType::BOOL;
+		}
+
+		case ExprType::And:
+		{
+			auto andExpr = static_cast<AndExpr*>(expr);
+			walk(andExpr->left);
+			walk(andExpr->right);
+			return StaticType::BOOL;
+		}
+
+		case ExprType::Ternary:
+		{
+			auto ternary = static_cast<TernaryExpr*>(expr);
+			walk(ternary->expr);
+			Type thenType = walk(ternary->thenBranch);
+			Type elseType = walk(ternary->elseBranch);
+			return join(thenType, elseType);
+		}
+
+		case ExprType::Increment:
+		case ExprType::Decrement:
+		{
+			// ++与--只接受数字，结果必为数字
+			ExprPtr holder = expr->exprType == ExprType::Increment ? static_cast<IncrementExpr*>(expr)->holder
+																	 : static_cast<DecrementExpr*>(expr)->holder;
+			walk(holder);
+			if (holder->exprType == ExprType::Variable)
+			{
+				auto var = static_cast<VariableExpr*>(holder);
+				assign(var->depth, var->slot, StaticType::NUMBER);
+			}
+			return StaticType::NUMBER;
+		}
+
+		case ExprType::Call:
+		{
+			auto call = static_cast<CallExpr*>(expr);
+			walk(call->callee);
+			for (ExprPtr argument : call->arguments)
+				walk(argument);
+			return StaticType::UNKNOWN;
+		}
+
+		case ExprType::Retrieve:
+		{
+			auto retrieve = static_cast<RetrieveExpr*>(expr);
+			walk(retrieve->holder);
+			if (retrieve->index)
+				walk(retrieve->index);
+			return StaticType::UNKNOWN;
+		}
+
+		case ExprType::Set:
+		{
+			auto set = static_cast<SetExpr*>(expr);
+			walk(set->holder);
+			if (set->index)
+				walk(set->index);
+			walk(set->value);
+			return StaticType::UNKNOWN;
+		}
+
+		case ExprType::Lambda:
+		{
+			// 参数默认值不经过Resolver，其中的变量无法确定
+			auto lambda = static_cast<LambdaExpr*>(expr);
+			walkFunction(lambda, lambda->localCount, lambda->params.size(), -1, lambda->body);
+			return StaticType::UNKNOWN;
+		}
+
+		case ExprType::List:
+		{
+			for (ExprPtr item : static_cast<ListExpr*>(expr)->items)
+				walk(item);
+			return StaticType::UNKNOWN;
+		}
+
+		case ExprType::Pack:
+		{
+			// 结果为最后一个表达式的值
+			Type type = StaticType::UNKNOWN;
+			for (ExprPtr item : static_cast<PackExpr*>(expr)->expressions)
+				type = walk(item);
+			return type;
+		}
+
+		default:
+			// This、Super
+			return StaticType::UNKNOWN;
+		}
+	}
+
+	void TypeInferencer::walk(StmtPtr stmt)
+	{
+		switch (stmt->stmtType)
+		{
+		case StmtType::Expression:
+			walk(static_cast<ExpressionStmt*>(stmt)->expr);
+			break;
+
+		case StmtType::VarDecl:
+		{
+			// 只声明不赋值时为nil
+			auto var = static_cast<VarDeclarationStmt*>(stmt);
+			Type type = var->expr ? walk(var->expr.value()) : StaticType::UNKNOWN;
+			assign(0, var->slot, type);
+			break;
+		}
+
+		case StmtType::FuncDecl:
+		{
+			auto function = static_cast<FuncDeclarationStmt*>(stmt);
+			assign(0, function->slot, StaticType::UNKNOWN);
+
+			// 预解析的函数体在补全时再推断
+			if (!function->lazy)
+				walkFunction(function, function->localCount, function->params.size(), function->thisSlot, function->body);
+			break;
+		}
+
+		case StmtType::ClassDecl:
+		{
+			auto classStmt = static_cast<ClassDeclarationStmt*>(stmt);
+			assign(0, classStmt->slot, StaticType::UNKNOWN);
+			if (classStmt->superClass)
+				walk(classStmt->superClass.value());
+
+			for (FuncDeclarationStmt* method : classStmt->methods)
+			{
+				if (!method->lazy)
+					walkFunction(method, method->localCount, method->params.size(), method->thisSlot, method->body);
+			}
+			break;
+		}
+
+		case StmtType::Block:
+		{
+			auto block = static_cast<BlockStmt*>(stmt);
+			beginScope(block, block->localCount);
+			walk(block->statements);
+			endScope();
+			break;
+		}
+
+		case StmtType::If:
+		{
+			auto ifStmt = static_cast<IfStmt*>(stmt);
+			walk(ifStmt->condition);
+			walk(ifStmt->thenBranch);
+			if (ifStmt->elseBranch)
+				walk(ifStmt->elseBranch.value());
+			break;
+		}
+
+		case StmtType::While:
+		{
+			auto whileStmt = static_cast<WhileStmt*>(stmt);
+			walk(whileStmt->condition);
+			walk(whileStmt->body);
+			break;
+		}
+
+		case StmtType::For:
+		{
+			auto forStmt = static_cast<ForStmt*>(stmt);
+			beginScope(forStmt, forStmt->localCount);
+			if (forStmt->initializer)
+				walk(forStmt->initializer.value());
+			if (forStmt->condition)
+				walk(forStmt->condition.value());
+			if (forStmt->increment)
+				walk(forStmt->increment.value());
+			walk(forStmt->body);
+			endScope();
+			break;
+		}
+
+		case StmtType::Return:
+		{
+			auto returnStmt = static_cast<ReturnStmt*>(stmt);
+			if (returnStmt->expr)
+				walk(returnStmt->expr.value());
+			break;
+		}
+
+		case StmtType::Import:
+		{
+			for (int slot : static_cast<ImportStmt*>(stmt)->slots)
+				assign(0, slot, StaticType::UNKNOWN);
+			break;
+		}
+
+		case StmtType::Pack:
+			walk(static_cast<PackStmt*>(stmt)->statements);
+			break;
+
+		default:
+			// Break、Continue
+			break;
+		}
+	}
+
+	void TypeInferencer::walk(const std::vector<StmtPtr>& statements)
+	{
+		for (StmtPtr stmt : statements)
+			walk(stmt);
+	}
+
+	void TypeInferencer::walkFunction(const void* key, int localCount, size_t params, int thisSlot,
+		const std::vector<StmtPtr>& body)
+	{
+		// 参数依次占据最前面的槽位，this紧随其后
+		beginScope(key, localCount);
+		for (size_t i = 0; i < params; i++)
+			assign(0, (int)i, StaticType::UNKNOWN);
+		assign(0, thisSlot, StaticType::UNKNOWN);
+
+		walk(body);
+		endScope();
+	}
+
+	void TypeInferencer::beginScope(const void* key, int localCount)
+	{
+		Slots& slots = variables[key];
+		if (slots.size() < (size_t)localCount)
+			slots.resize(localCount);
+
+		scopes.push_back(&slots);
+	}
+
+	void TypeInferencer::endScope()
+	{
+		scopes.pop_back();
+	}
+
+	TypeInferencer::Type* TypeInferencer::variable(int depth, int slot)
+	{
+		// 全局变量、具名作用域中的变量以及补全的函数体之外的变量都没有记录
+		if (depth < 0 || slot < 0 || depth >= (int)scopes.size())
+			return nullptr;
+
+		Slots* slots = scopes[scopes.size() - 1 - depth];
+		if (!slots || slot >= (int)slots->size())
+			return nullptr;
+
+		return &(*slots)[slot];
+	}
+
+	TypeInferencer::Type TypeInferencer::lookup(int depth, int slot)
+	{
+		Type* type = variable(depth, slot);
+		return type ? *type : StaticType::UNKNOWN;
+	}
+
+	void TypeInferencer::assign(int depth, int slot, Type type)
+	{
+		Type* current = variable(depth, slot);
+		if (!current)
+			return;
+
+		Type joined = join(*current, type);
+		if (joined != *current)
+		{
+			*current = joined;
+			changed = true;
+		}
+	}
+
+	TypeInferencer::Type TypeInferencer::join(Type lhs, Type rhs)
+	{
+		if (!lhs)
+			return rhs;
+		if (!rhs)
+			return lhs;
+
+		return *lhs == *rhs ? lhs : StaticType::UNKNOWN;
+	}
+
+	TypeInferencer::Type TypeInferencer::binary(TokenType op, Type lhs, Type rhs)
+	{
+		switch (op)
+		{
+		// 比较的结果总是bool，实例的__equal__也会被转换为bool
+		case TokenType::GT:
+		case TokenType::GTE:
+		case TokenType::LT:
+		case TokenType::LTE:
+		case TokenType::EQEQ:
+		case TokenType::BANGEQ:
+			return StaticType::BOOL;
+
+		default:
+			break;
+		}
+
+		// 操作数尚无信息时结果也暂无信息，等待下一遍遍历
+		if (!lhs || !rhs)
+			return std::nullopt;
+
+		bool numbers = *lhs == StaticType::NUMBER && *rhs == StaticType::NUMBER;
+		switch (op)
+		{
+		case TokenType::PLUS:
+			if (numbers)
+				return StaticType::NUMBER;
+			if (*lhs == StaticType::STRING && *rhs == StaticType::STRING)
+				return StaticType::STRING;
+			return StaticType::UNKNOWN;
+
+		case TokenType::MUL:
+			if (numbers)
+				return StaticType::NUMBER;
+			if ((*lhs == StaticType::STRING && *rhs == StaticType::NUMBER) ||
+				(*lhs == StaticType::NUMBER && *rhs == StaticType::STRING))
+				return StaticType::STRING;
+			return StaticType::UNKNOWN;
+
+		case TokenType::MINUS:
+		case TokenType::DIV:
+		case TokenType::MOD:
+			return numbers ? StaticType::NUMBER : StaticType::UNKNOWN;
+
+		default:
+			return StaticType::UNKNOWN;
+		}
+	}
+
+	void TypeInferencer::report(ExprPtr expr, StaticType type)
+	{
+		total++;
+		if (type == StaticType::UNKNOWN)
+			return;
+
+		typed++;
+
+		// 输出表达式对应的源码，过长的截断
+		const SourceFile& file = expr->pos_start.file();
+		int start = expr->pos_start.index(), end = expr->pos_end.index();
+		std::string text;
+		if (start >= 0 && end > start)
+			text = file.content().substr(start, end - start);
+		if (text.size() > 40)
+			text = text.substr(0, 37) + "...";
+		for (char& c : text)
+		{
+			if (c == '\n' || c == '\t')
+				c = ' ';
+		}
+
+		std::cout << format("%s:%d:%d: %s : %s\n", file.name().c_str(), expr->pos_start.row() + 1,
+			expr->pos_start.column() + 1, text.c_str(), typeName(type));
+	}
+
+}
@@ -0,0 +1,34 @@
+#include "Parser/AstArena.h"
+#include <cstdint>
+#include <algorithm>
+
+namespace CXX {
+
+	AstArena::~AstArena()
+	{
+		// 与构造顺序相反
+		for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+			it->second(it->first);
+	}
+
+	void* AstArena::allocate(size_t size, size_t align)
+	{
+		auto aligned = [&]()
+		{
+			return (char*)(((uintptr_t)cursor + align - 1) & ~(uintptr_t)(align - 1));
+		};
+
+		if (!cursor || aligned() + size > limit)
+		{
+			size_t blockSize = std::max(BLOCK_SIZE, size + align);
+			blocks.emplace_back(new char[blockSize]);
+			cursor = blocks.back().get();
+			limit = cursor + blockSize;
+		}
+
+		char* ptr = aligned();
+		cursor = ptr + size;
+		return ptr;
+	}
+
+}
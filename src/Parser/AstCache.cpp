@@ -0,0 +1,1161 @@
+#include "Parser/AstCache.h"
+#include "Parser/AstArena.h"
+#include "Parser/Expr.h"
+#include "Parser/Stmt.h"
+#include "Common/utils.h"
+#include <cstring>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <filesystem>
+#include <type_traits>
+#include <unordered_map>
+#include <thread>
+
+#if defined(_MSC_VER) || defined(WIN64) || defined(_WIN64) || defined(__WIN64__) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace CXX {
+
+	std::string AstCache::directory;
+
+	namespace {
+
+		constexpr uint32_t MAGIC = 0x41584F4C; // "LOXA"
+		constexpr uint8_t NONE = 0xFF;		   // 空节点
+
+		// Token的编码标志：多数Token的位置紧贴词素，只需保存词素
+		constexpr uint8_t IN_SOURCE = 1;	  // 词素是源码的切片，保存其区间
+		constexpr uint8_t START_AT_LEXEME = 2; // pos_start即词素起点
+		constexpr uint8_t END_AT_LEXEME = 4;  // pos_end即pos_start加词素长度
+		constexpr uint8_t IN_SYMBOLS = 8;	  // 驻留的Token，保存其在文件符号表中的下标
+
+		// 文件头之后全部内容的校验和(FNV-1a)，损坏的缓存在重建AST之前就被拒绝
+		uint64_t checksum(std::string_view data)
+		{
+			uint64_t hash = 14695981039346656037ull;
+			for (unsigned char c : data)
+			{
+				hash ^= c;
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
+		// 先序输出AST：节点类型、各字段(子节点紧随其后)、最后是节点的位置
+		class AstWriter : public ExprVisitor, public StmtVisitor
+		{
+		public:
+			explicit AstWriter(const SourceFile& source) : source(source) {}
+
+			template <typename T>
+			void put(const T& value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+			}
+
+			// 长度与个数多数很小，按7位一组变长保存
+			void putSize(size_t size)
+			{
+				for (; size >= 0x80; size >>= 7)
+					put(uint8_t(size | 0x80));
+				put(uint8_t(size));
+			}
+
+			void putString(std::string_view str)
+			{
+				putSize(str.size());
+				buffer.append(str.data(), str.size());
+			}
+
+			uint32_t relative(const Position& pos) const
+			{
+				uint32_t base = source.base(), size = (uint32_t)source.content().size();
+				return pos.offset >= base && pos.offset <= base + size ? pos.offset - base + 1 : 0u;
+			}
+
+			// 有效位置保存为相对源码起点的偏移+1，0表示无效位置
+			void putPosition(const Position& pos)
+			{
+				put(relative(pos));
+			}
+
+			void putToken(const Token& token)
+			{
+				// 标识符、字符串与关键字引用符号表，加载时每个符号只需驻留一次
+				if (token.type >= TokenType::STRING)
+				{
+					auto [it, inserted] = symbolIndex.try_emplace(token.symbol, (uint32_t)symbols.size());
+					if (inserted)
+						symbols.push_back(token.symbol);
+
+					uint32_t start = relative(token.pos_start);
+					bool endAtLexeme = start && relative(token.pos_end) == start + token.lexeme.size();
+					put((uint8_t)token.type);
+					put(uint8_t(IN_SYMBOLS | (endAtLexeme ? END_AT_LEXEME : 0)));
+					putSize(it->second);
+					put(start);
+					if (!endAtLexeme)
+						putPosition(token.pos_end);
+					return;
+				}
+
+				// 指向源码的词素只保存区间，其余(运算符等)保存内容
+				auto begin = (uintptr_t)source.content().data(), end = begin + source.content().size();
+				auto lexeme = (uintptr_t)token.lexeme.data();
+				uint32_t start = relative(token.pos_start), offset = 0;
+
+				uint8_t flags = 0;
+				if (lexeme >= begin && lexeme + token.lexeme.size() <= end)
+				{
+					flags |= IN_SOURCE;
+					offset = (uint32_t)(lexeme - begin);
+					if (start == offset + 1)
+						flags |= START_AT_LEXEME;
+				}
+				if (start && relative(token.pos_end) == start + token.lexeme.size())
+					flags |= END_AT_LEXEME;
+
+				put((uint8_t)token.type);
+				put(flags);
+				if (flags & IN_SOURCE)
+				{
+					put(offset);
+					putSize(token.lexeme.size());
+				}
+				else
+				{
+					putString(token.lexeme);
+				}
+
+				if (!(flags & START_AT_LEXEME))
+					putPosition(token.pos_start);
+				if (!(flags & END_AT_LEXEME))
+					putPosition(token.pos_end);
+			}
+
+			void putTokens(const std::vector<Token>& tokens)
+			{
+				putSize(tokens.size());
+				for (auto& token : tokens)
+					putToken(token);
+			}
+
+			void putExpr(ExprPtr expr)
+			{
+				if (!expr)
+					return put(NONE);
+
+				put((uint8_t)expr->exprType);
+				expr->accept(*this);
+				putPosition(expr->pos_start);
+				putPosition(expr->pos_end);
+			}
+
+			void putExprs(const std::vector<ExprPtr>& exprs)
+			{
+				putSize(exprs.size());
+				for (auto& expr : exprs)
+					putExpr(expr);
+			}
+
+			void putStmt(StmtPtr stmt)
+			{
+				if (!stmt)
+					return put(NONE);
+
+				put((uint8_t)stmt->stmtType);
+				stmt->accept(*this);
+				putPosition(stmt->pos_start);
+				putPosition(stmt->pos_end);
+			}
+
+			void putStmts(const std::vector<StmtPtr>& stmts)
+			{
+				putSize(stmts.size());
+				for (auto& stmt : stmts)
+					putStmt(stmt);
+			}
+
+		public:
+			Object visit(const BinaryExpr* binaryExpr) override
+			{
+				putExpr(binaryExpr->left);
+				putExpr(binaryExpr->right);
+				putToken(binaryExpr->op);
+				return Object();
+			}
+
+			Object visit(const UnaryExpr* unaryExpr) override
+			{
+				putToken(unaryExpr->op);
+				putExpr(unaryExpr->expr);
+				return Object();
+			}
+
+			Object visit(const LiteralExpr* literalExpr) override
+			{
+				const Object& value = literalExpr->value;
+				if (value.isNumber())
+				{
+					put(uint8_t(1));
+					put(value.getNumber());
+				}
+				else if (value.isBoolean())
+				{
+					put(uint8_t(2));
+					put(value.getBoolean());
+				}
+				else if (value.isString())
+				{
+					put(uint8_t(3));
+					putString(value.getString());
+				}
+				else
+				{
+					put(uint8_t(0));
+				}
+				return Object();
+			}
+
+			Object visit(const VariableExpr* varExpr) override
+			{
+				putToken(varExpr->identifier);
+				put(varExpr->depth);
+				put(varExpr->slot);
+				return Object();
+			}
+
+			Object visit(const AssignmentExpr* assignmentExpr) override
+			{
+				putToken(assignmentExpr->identifier);
+				putToken(assignmentExpr->operation);
+				putExpr(assignmentExpr->value);
+				put(assignmentExpr->depth);
+				put(assignmentExpr->slot);
+				return Object();
+			}
+
+			Object visit(const TernaryExpr* ternaryExpr) override
+			{
+				putExpr(ternaryExpr->expr);
+				putExpr(ternaryExpr->thenBranch);
+				putExpr(ternaryExpr->elseBranch);
+				return Object();
+			}
+
+			Object visit(const OrExpr* orExpr) override
+			{
+				putExpr(orExpr->left);
+				putExpr(orExpr->right);
+				return Object();
+			}
+
+			Object visit(const AndExpr* andExpr) override
+			{
+				putExpr(andExpr->left);
+				putExpr(andExpr->right);
+				return Object();
+			}
+
+			Object visit(const IncrementExpr* incrementExpr) override
+			{
+				putExpr(incrementExpr->holder);
+				put((uint8_t)incrementExpr->type);
+				return Object();
+			}
+
+			Object visit(const DecrementExpr* decrementExpr) override
+			{
+				putExpr(decrementExpr->holder);
+				put((uint8_t)decrementExpr->type);
+				return Object();
+			}
+
+			Object visit(const CallExpr* callExpr) override
+			{
+				putExpr(callExpr->callee);
+				putExprs(callExpr->arguments);
+				return Object();
+			}
+
+			Object visit(const RetrieveExpr* retrieveExpr) override
+			{
+				put((uint8_t)retrieveExpr->type);
+				putExpr(retrieveExpr->holder);
+				putToken(retrieveExpr->identifier);
+				putExpr(retrieveExpr->index);
+				return Object();
+			}
+
+			Object visit(const SetExpr* setExpr) override
+			{
+				put((uint8_t)setExpr->type);
+				putExpr(setExpr->holder);
+				putToken(setExpr->identifier);
+				putExpr(setExpr->index);
+				putToken(setExpr->operation);
+				putExpr(setExpr->value);
+				return Object();
+			}
+
+			Object visit(LambdaExpr* lambdaExpr) override
+			{
+				putTokens(lambdaExpr->params);
+				putExprs(lambdaExpr->default_values);
+				putStmts(lambdaExpr->body);
+				put(lambdaExpr->localCount);
+				return Object();
+			}
+
+			Object visit(const ThisExpr* thisExpr) override
+			{
+				putToken(thisExpr->keyword);
+				put(thisExpr->depth);
+				put(thisExpr->slot);
+				return Object();
+			}
+
+			Object visit(const SuperExpr* superExpr) override
+			{
+				putToken(superExpr->keyword);
+				putToken(superExpr->identifier);
+				put(superExpr->depth);
+				put(superExpr->slot);
+				return Object();
+			}
+
+			Object visit(const ListExpr* listExpr) override
+			{
+				putToken(listExpr->leftBracket);
+				putExprs(listExpr->items);
+				putToken(listExpr->rightBracket);
+				return Object();
+			}
+
+			Object visit(const PackExpr* packExpr) override
+			{
+				putExprs(packExpr->expressions);
+				return Object();
+			}
+
+			void visit(const ExpressionStmt* expressionStmt) override
+			{
+				putExpr(expressionStmt->expr);
+			}
+
+			void visit(const VarDeclarationStmt* varStmt) override
+			{
+				putToken(varStmt->identifier);
+				putExpr(varStmt->expr.value_or(nullptr));
+				put(varStmt->slot);
+			}
+
+			void visit(FuncDeclarationStmt* funcStmt) override
+			{
+				putToken(funcStmt->name);
+				putTokens(funcStmt->params);
+				putExprs(funcStmt->default_values);
+				putStmts(funcStmt->body);
+				put(funcStmt->slot);
+				put(funcStmt->localCount);
+				put(funcStmt->thisSlot);
+			}
+
+			void visit(const ClassDeclarationStmt* classStmt) override
+			{
+				putToken(classStmt->name);
+				putSize(classStmt->methods.size());
+				for (auto method : classStmt->methods)
+					putStmt(method);
+				putExpr(classStmt->superClass.value_or(nullptr));
+				put(classStmt->slot);
+			}
+
+			void visit(const BlockStmt* blockStmt) override
+			{
+				putStmts(blockStmt->statements);
+				put(blockStmt->localCount);
+			}
+
+			void visit(const IfStmt* ifStmt) override
+			{
+				putExpr(ifStmt->condition);
+				putStmt(ifStmt->thenBranch);
+				putStmt(ifStmt->elseBranch.value_or(nullptr));
+			}
+
+			void visit(const WhileStmt* whileStmt) override
+			{
+				putExpr(whileStmt->condition);
+				putStmt(whileStmt->body);
+			}
+
+			void visit(const ForStmt* forStmt) override
+			{
+				putStmt(forStmt->initializer.value_or(nullptr));
+				putExpr(forStmt->condition.value_or(nullptr));
+				putExpr(forStmt->increment.value_or(nullptr));
+				putStmt(forStmt->body);
+				put(forStmt->localCount);
+			}
+
+			void visit(const BreakStmt* breakStmt) override
+			{
+				putToken(breakStmt->keyword);
+			}
+
+			void visit(const ContinueStmt* continueStmt) override
+			{
+				putToken(continueStmt->keyword);
+			}
+
+			void visit(const ReturnStmt* returnStmt) override
+			{
+				putToken(returnStmt->keyword);
+				putExpr(returnStmt->expr.value_or(nullptr));
+			}
+
+			void visit(const ImportStmt* importStmt) override
+			{
+				putToken(importStmt->keyword);
+				putSize(importStmt->symbols.size());
+				for (auto& [symbol, alias] : importStmt->symbols)
+				{
+					putToken(symbol);
+					put(alias.has_value());
+					if (alias)
+						putToken(alias.value());
+				}
+				putToken(importStmt->filepath);
+				putSize(importStmt->slots.size());
+				for (int slot : importStmt->slots)
+					put(slot);
+			}
+
+			void visit(const PackStmt* packStmt) override
+			{
+				putStmts(packStmt->statements);
+			}
+
+			// 输出AST中用到的符号，须在全部节点输出之后调用
+			void putSymbols()
+			{
+				putSize(symbols.size());
+				for (Symbol symbol : symbols)
+					putString(symbol.str());
+			}
+
+		public:
+			std::string buffer;
+
+		private:
+			const SourceFile& source;
+			std::vector<Symbol> symbols;
+			std::unordered_map<Symbol, uint32_t> symbolIndex;
+		};
+
+		// 按AstWriter的格式在arena中重建AST，数据不完整或不合法时抛出异常
+		class AstReader
+		{
+		public:
+			AstReader(const SourceFile& source, std::string_view data, AstArena& arena)
+				: source(source), data(data), arena(arena) {}
+
+			template <typename T>
+			T get()
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				need(sizeof(T));
+				T value;
+				std::memcpy(&value, data.data() + cursor, sizeof(T));
+				cursor += sizeof(T);
+				return value;
+			}
+
+			size_t getSize()
+			{
+				size_t size = 0;
+				for (int shift = 0; shift < 35; shift += 7)
+				{
+					uint8_t byte = get<uint8_t>();
+					size |= size_t(byte & 0x7F) << shift;
+					if (!(byte & 0x80))
+						return size;
+				}
+				fail();
+			}
+
+			std::string_view getString()
+			{
+				size_t size = getSize();
+				need(size);
+				std::string_view str = data.substr(cursor, size);
+				cursor += size;
+				return str;
+			}
+
+			Position getPosition()
+			{
+				uint32_t offset = get<uint32_t>();
+				if (offset > source.content().size() + 1)
+					fail();
+				return offset ? Position(source.base() + offset - 1) : Position();
+			}
+
+			// 紧随词素之后的位置，start须是源码内的有效位置
+			Position after(const Position& start, size_t size)
+			{
+				uint32_t base = source.base();
+				if (start.offset < base || start.offset - base + size > source.content().size())
+					fail();
+				return Position(start.offset + (uint32_t)size);
+			}
+
+			void getSymbols()
+			{
+				symbols.resize(count());
+				for (Symbol& symbol : symbols)
+					symbol = Symbol(getString());
+			}
+
+			Token getToken()
+			{
+				uint8_t type = get<uint8_t>();
+				uint8_t flags = get<uint8_t>();
+				if (type > (uint8_t)TokenType::END_OF_FILE || flags > (IN_SOURCE | START_AT_LEXEME | END_AT_LEXEME | IN_SYMBOLS))
+					fail();
+
+				if (flags & IN_SYMBOLS)
+				{
+					size_t index = getSize();
+					if (index >= symbols.size() || type < (uint8_t)TokenType::STRING || (flags & ~(IN_SYMBOLS | END_AT_LEXEME)))
+						fail();
+
+					// 词素指向驻留的字符串；先以运算符类型构造，避免再次驻留
+					Symbol symbol = symbols[index];
+					Token token(TokenType::PLUS, symbol.str());
+					token.type = (TokenType)type;
+					token.symbol = symbol;
+					token.pos_start = getPosition();
+					if (flags & END_AT_LEXEME)
+						token.pos_end = after(token.pos_start, token.lexeme.size());
+					else
+						token.pos_end = getPosition();
+					return token;
+				}
+
+				std::string_view lexeme;
+				uint32_t offset = 0;
+				if (flags & IN_SOURCE)
+				{
+					offset = get<uint32_t>();
+					size_t size = getSize();
+					if (offset + size > source.content().size())
+						fail();
+					lexeme = std::string_view(source.content()).substr(offset, size);
+				}
+				else
+				{
+					// 不在源码中的词素由符号表持有
+					if (flags & START_AT_LEXEME)
+						fail();
+					lexeme = Symbol(getString()).str();
+				}
+
+				Token token((TokenType)type, lexeme);
+				token.pos_start = flags & START_AT_LEXEME ? Position(source.base() + offset) : getPosition();
+				if (flags & END_AT_LEXEME)
+					token.pos_end = after(token.pos_start, lexeme.size());
+				else
+					token.pos_end = getPosition();
+				return token;
+			}
+
+			std::vector<Token> getTokens()
+			{
+				std::vector<Token> tokens(count());
+				for (auto& token : tokens)
+					token = getToken();
+				return tokens;
+			}
+
+			ExprPtr getExpr()
+			{
+				uint8_t tag = get<uint8_t>();
+				if (tag == NONE)
+					return nullptr;
+				if (tag > (uint8_t)ExprType::Pack)
+					fail();
+
+				ExprPtr expr = makeExpr((ExprType)tag);
+				expr->pos_start = getPosition();
+				expr->pos_end = getPosition();
+				return expr;
+			}
+
+			std::vector<ExprPtr> getExprs()
+			{
+				std::vector<ExprPtr> exprs(count());
+				for (auto& expr : exprs)
+					expr = require(getExpr());
+				return exprs;
+			}
+
+			StmtPtr getStmt()
+			{
+				uint8_t tag = get<uint8_t>();
+				if (tag == NONE)
+					return nullptr;
+				if (tag > (uint8_t)StmtType::Pack)
+					fail();
+
+				StmtPtr stmt = makeStmt((StmtType)tag);
+				stmt->pos_start = getPosition();
+				stmt->pos_end = getPosition();
+				return stmt;
+			}
+
+			std::vector<StmtPtr> getStmts()
+			{
+				std::vector<StmtPtr> stmts(count());
+				for (auto& stmt : stmts)
+					stmt = require(getStmt());
+				return stmts;
+			}
+
+			bool finished() const { return cursor == data.size(); }
+
+			// 尚未读取的部分
+			std::string_view rest() const { return data.substr(cursor); }
+
+		private:
+			[[noreturn]] static void fail()
+			{
+				throw std::runtime_error("corrupted AST cache");
+			}
+
+			void need(size_t size) const
+			{
+				if (size > data.size() - cursor)
+					fail();
+			}
+
+			// 元素个数，每个元素至少占一个字节
+			size_t count()
+			{
+				size_t n = getSize();
+				need(n);
+				return n;
+			}
+
+			// 槽位与深度的检查，与Resolver的作用域一一对应
+			// 缓存的AST不含预解析的函数体，每个函数体都已经过Resolver
+			struct Scope
+			{
+				int declared = 0; // 作用域内的声明个数，localCount不会超过它
+				int maxSlot = -1; // 用到的最大槽位，须小于localCount
+			};
+
+			void beginScope(size_t params = 0)
+			{
+				// 参数依次占据前面的槽位
+				scopes.push_back({ (int)params, (int)params - 1 });
+			}
+
+			int endScope(int localCount)
+			{
+				Scope scope = scopes.back();
+				scopes.pop_back();
+				if (localCount < 0 || localCount > scope.declared || scope.maxSlot >= localCount)
+					fail();
+				return localCount;
+			}
+
+			// 声明的槽位；脚本顶层没有作用域，只能是-1
+			int declare(int slot)
+			{
+				if (slot < -1 || (scopes.empty() && slot != -1))
+					fail();
+				if (!scopes.empty())
+				{
+					scopes.back().declared++;
+					scopes.back().maxSlot = std::max(scopes.back().maxSlot, slot);
+				}
+				return slot;
+			}
+
+			// 变量的引用；depth为-1表示全局变量，否则不能超出已进入的作用域
+			template <typename T>
+			void resolve(T* node)
+			{
+				int depth = get<int>(), slot = get<int>();
+				if (depth == -1 ? slot != -1 : depth < 0 || depth >= (int)scopes.size() || slot < -1)
+					fail();
+				if (depth != -1)
+				{
+					Scope& scope = scopes[scopes.size() - 1 - depth];
+					scope.maxSlot = std::max(scope.maxSlot, slot);
+				}
+				node->resolve(depth, slot);
+			}
+
+			bool getFlag()
+			{
+				uint8_t flag = get<uint8_t>();
+				if (flag > 1)
+					fail();
+				return flag;
+			}
+
+			// 自增自减的对象只能是变量或属性
+			static ExprPtr assignable(ExprPtr holder)
+			{
+				if (holder->exprType != ExprType::Variable && holder->exprType != ExprType::Retrieve)
+					fail();
+				return holder;
+			}
+
+			template <typename T>
+			static T* require(T* node)
+			{
+				if (!node)
+					fail();
+				return node;
+			}
+
+			template <typename T>
+			static std::optional<T*> optional(T* node)
+			{
+				return node ? std::optional<T*>(node) : std::nullopt;
+			}
+
+			template <typename T, typename... Args>
+			T* make(Args&&... args)
+			{
+				return arena.make<T>(std::forward<Args>(args)...);
+			}
+
+			// 注意参数求值顺序未指定，各字段须按写入顺序逐个读取
+			ExprPtr makeExpr(ExprType type)
+			{
+				switch (type)
+				{
+				case ExprType::Binary:
+				{
+					ExprPtr left = require(getExpr());
+					ExprPtr right = require(getExpr());
+					return make<BinaryExpr>(left, right, getToken());
+				}
+				case ExprType::Unary:
+				{
+					Token op = getToken();
+					return make<UnaryExpr>(op, require(getExpr()));
+				}
+				case ExprType::Literal:
+				{
+					switch (get<uint8_t>())
+					{
+					case 0:
+						return make<LiteralExpr>(Object());
+					case 1:
+						return make<LiteralExpr>(Object(get<double>()));
+					case 2:
+						return make<LiteralExpr>(Object(getFlag()));
+					case 3:
+						return make<LiteralExpr>(Object(Symbol(getString())));
+					default:
+						fail();
+					}
+				}
+				case ExprType::Variable:
+				{
+					auto variable = make<VariableExpr>(getToken());
+					resolve(variable);
+					return variable;
+				}
+				case ExprType::Assignment:
+				{
+					Token identifier = getToken();
+					Token operation = getToken();
+					auto assignment = make<AssignmentExpr>(identifier, operation, require(getExpr()));
+					resolve(assignment);
+					return assignment;
+				}
+				case ExprType::Ternary:
+				{
+					ExprPtr condition = require(getExpr());
+					ExprPtr thenBranch = require(getExpr());
+					return make<TernaryExpr>(condition, thenBranch, require(getExpr()));
+				}
+				case ExprType::Or:
+				{
+					ExprPtr left = require(getExpr());
+					return make<OrExpr>(left, require(getExpr()));
+				}
+				case ExprType::And:
+				{
+					ExprPtr left = require(getExpr());
+					return make<AndExpr>(left, require(getExpr()));
+				}
+				case ExprType::Increment:
+				{
+					ExprPtr holder = assignable(require(getExpr()));
+					return make<IncrementExpr>(holder, getFlag() ? IncrementExpr::Type::PREFIX : IncrementExpr::Type::POSTFIX);
+				}
+				case ExprType::Decrement:
+				{
+					ExprPtr holder = assignable(require(getExpr()));
+					return make<DecrementExpr>(holder, getFlag() ? DecrementExpr::Type::PREFIX : DecrementExpr::Type::POSTFIX);
+				}
+				case ExprType::Call:
+				{
+					ExprPtr callee = require(getExpr());
+					return make<CallExpr>(callee, getExprs());
+				}
+				case ExprType::Retrieve:
+				{
+					auto opType = getFlag() ? RetrieveExpr::OpType::BRACKET : RetrieveExpr::OpType::DOT;
+					ExprPtr holder = require(getExpr());
+					Token identifier = getToken();
+					ExprPtr index = getExpr();
+					if (opType == RetrieveExpr::OpType::DOT)
+						return make<RetrieveExpr>(holder, identifier);
+
+					auto retrieve = make<RetrieveExpr>(holder, require(index));
+					retrieve->identifier = identifier;
+					return retrieve;
+				}
+				case ExprType::Set:
+				{
+					auto opType = getFlag() ? RetrieveExpr::OpType::BRACKET : RetrieveExpr::OpType::DOT;
+					ExprPtr holder = require(getExpr());
+					Token identifier = getToken();
+					ExprPtr index = getExpr();
+					Token operation = getToken();
+					ExprPtr value = require(getExpr());
+					if (opType == RetrieveExpr::OpType::DOT)
+						return make<SetExpr>(holder, identifier, operation, value);
+
+					auto set = make<SetExpr>(holder, require(index), operation, value);
+					set->identifier = identifier;
+					return set;
+				}
+				case ExprType::This:
+				{
+					auto thisExpr = make<ThisExpr>(getToken());
+					resolve(thisExpr);
+					return thisExpr;
+				}
+				case ExprType::Super:
+				{
+					Token keyword = getToken();
+					auto superExpr = make<SuperExpr>(keyword, getToken());
+					resolve(superExpr);
+					return superExpr;
+				}
+				case ExprType::Lambda:
+				{
+					std::vector<Token> params = getTokens();
+					std::vector<ExprPtr> defaults = getExprs();
+					if (defaults.size() > params.size())
+						fail();
+
+					beginScope(params.size());
+					std::vector<StmtPtr> body = getStmts();
+					auto lambda = make<LambdaExpr>(std::move(params), std::move(defaults), std::move(body));
+					lambda->localCount = endScope(get<int>());
+					lambda->arena = &arena;
+					return lambda;
+				}
+				case ExprType::List:
+				{
+					Token left = getToken();
+					std::vector<ExprPtr> items = getExprs();
+					return make<ListExpr>(left, std::move(items), getToken());
+				}
+				case ExprType::Pack:
+					return make<PackExpr>(getExprs());
+				}
+
+				fail();
+			}
+
+			StmtPtr makeStmt(StmtType type)
+			{
+				switch (type)
+				{
+				case StmtType::Expression:
+					return make<ExpressionStmt>(require(getExpr()));
+				case StmtType::VarDecl:
+				{
+					Token identifier = getToken();
+					auto var = make<VarDeclarationStmt>(identifier, optional(getExpr()));
+					var->slot = declare(get<int>());
+					return var;
+				}
+				case StmtType::FuncDecl:
+					return getFunction();
+				case StmtType::ClassDecl:
+				{
+					Token name = getToken();
+					std::vector<FuncDeclarationStmt*> methods(count());
+					for (auto& method : methods)
+					{
+						if (get<uint8_t>() != (uint8_t)StmtType::FuncDecl)
+							fail();
+						method = getFunction();
+						method->pos_start = getPosition();
+						method->pos_end = getPosition();
+					}
+
+					ExprPtr superClass = getExpr();
+					if (superClass && superClass->exprType != ExprType::Variable)
+						fail();
+
+					auto classStmt = make<ClassDeclarationStmt>(name, std::move(methods), optional(static_cast<VariableExpr*>(superClass)));
+					classStmt->slot = declare(get<int>());
+					return classStmt;
+				}
+				case StmtType::Block:
+				{
+					beginScope();
+					auto block = make<BlockStmt>(getStmts());
+					block->localCount = endScope(get<int>());
+					return block;
+				}
+				case StmtType::If:
+				{
+					ExprPtr condition = require(getExpr());
+					StmtPtr thenBranch = require(getStmt());
+					return make<IfStmt>(condition, thenBranch, optional(getStmt()));
+				}
+				case StmtType::While:
+				{
+					ExprPtr condition = require(getExpr());
+					return make<WhileStmt>(condition, require(getStmt()));
+				}
+				case StmtType::For:
+				{
+					beginScope();
+					StmtPtr initializer = getStmt();
+					ExprPtr condition = getExpr();
+					ExprPtr increment = getExpr();
+					auto forStmt = make<ForStmt>(optional(initializer), optional(condition), optional(increment), require(getStmt()));
+					forStmt->localCount = endScope(get<int>());
+					return forStmt;
+				}
+				case StmtType::Break:
+					return make<BreakStmt>(getToken());
+				case StmtType::Continue:
+					return make<ContinueStmt>(getToken());
+				case StmtType::Return:
+				{
+					Token keyword = getToken();
+					return make<ReturnStmt>(keyword, optional(getExpr()));
+				}
+				case StmtType::Import:
+				{
+					Token keyword = getToken();
+					std::map<Token, std::optional<Token>> symbols;
+					for (size_t i = 0, n = count(); i < n; i++)
+					{
+						Token symbol = getToken();
+						std::optional<Token> alias;
+						if (getFlag())
+							alias = getToken();
+						symbols.emplace(symbol, alias);
+					}
+
+					// 每个导入的名字各有一个槽位，import { * }没有槽位
+					auto importStmt = make<ImportStmt>(keyword, std::move(symbols), getToken());
+					importStmt->slots.resize(count());
+					if (importStmt->symbols.empty() ||
+						(!importStmt->slots.empty() && importStmt->slots.size() != importStmt->symbols.size()))
+						fail();
+					for (int& slot : importStmt->slots)
+						slot = declare(get<int>());
+					return importStmt;
+				}
+				case StmtType::Pack:
+					return make<PackStmt>(getStmts());
+				}
+
+				fail();
+			}
+
+			FuncDeclarationStmt* getFunction()
+			{
+				Token name = getToken();
+				std::vector<Token> params = getTokens();
+				std::vector<ExprPtr> defaults = getExprs();
+				if (defaults.size() > params.size())
+					fail();
+
+				// 函数名声明在外层作用域，但写在函数体之后
+				beginScope(params.size());
+				std::vector<StmtPtr> body = getStmts();
+				auto function = make<FuncDeclarationStmt>(name, std::move(params), std::move(defaults), std::move(body));
+				int slot = get<int>();
+				int localCount = get<int>();
+
+				// this的槽位写在localCount之后，但属于函数自己的作用域
+				int thisSlot = get<int>();
+				if (thisSlot != -1)
+					declare(thisSlot);
+				function->localCount = endScope(localCount);
+				function->thisSlot = thisSlot;
+
+				function->slot = declare(slot);
+				function->arena = &arena;
+				return function;
+			}
+
+		private:
+			const SourceFile& source;
+			std::vector<Symbol> symbols;
+			std::vector<Scope> scopes;
+			std::string_view data;
+			size_t cursor{ 0 };
+			AstArena& arena;
+		};
+
+	}
+
+	std::optional<std::vector<StmtPtr>> AstCache::load(const SourceFile& source, Unit unit, AstArenaPtr& arena)
+	{
+		if (!enabled())
+			return std::nullopt;
+
+		std::string id = identity(source, unit);
+		uint64_t hash = key(id);
+		std::ifstream ifs(path(hash), std::ios::binary | std::ios::ate);
+		if (!ifs)
+			return std::nullopt;
+
+		// 缓存文件较大，按大小一次读入
+		std::string data(ifs.tellg(), '\0');
+		if (!ifs.seekg(0).read(data.data(), (std::streamsize)data.size()))
+			return std::nullopt;
+
+		try
+		{
+			auto cacheArena = std::make_shared<AstArena>();
+			AstReader reader(source, data, *cacheArena);
+
+			// 文件名只是哈希，须逐字节比较完整的键，哈希碰撞时视为未命中而不是运行其他程序的AST
+			if (reader.get<uint32_t>() != MAGIC || reader.get<uint32_t>() != VERSION ||
+				reader.get<uint64_t>() != hash || reader.getString() != id)
+				return std::nullopt;
+
+			// 内容被改动过的缓存不再解析
+			if (reader.get<uint64_t>() != checksum(reader.rest()))
+				return std::nullopt;
+
+			reader.getSymbols();
+			std::vector<StmtPtr> statements = reader.getStmts();
+			if (!reader.finished())
+				return std::nullopt;
+
+			arena = std::move(cacheArena);
+			return statements;
+		}
+		catch (const std::exception&)
+		{
+			return std::nullopt;
+		}
+	}
+
+	void AstCache::store(const SourceFile& source, Unit unit, const std::vector<StmtPtr>& statements)
+	{
+		if (!enabled())
+			return;
+
+		std::string id = identity(source, unit);
+		uint64_t hash = key(id);
+		AstWriter writer(source);
+		writer.putStmts(statements);
+
+		// 文件依次为：文件头、校验和、符号表、AST
+		std::string body = std::move(writer.buffer);
+		writer.buffer.clear();
+		writer.putSymbols();
+		body.insert(0, writer.buffer);
+
+		writer.buffer.clear();
+		writer.put(MAGIC);
+		writer.put(VERSION);
+		writer.put(hash);
+		writer.putString(id);
+		writer.put(checksum(body));
+		writer.buffer += body;
+
+		namespace fs = std::filesystem;
+		std::error_code ec;
+		fs::create_directories(directory, ec);
+
+		// 先写临时文件再改名，避免其他进程读到写了一半的缓存
+		// 临时文件名包含进程号与线程号，同时写入同一缓存的进程(线程)不会互相覆盖
+		std::string file = path(hash);
+		std::string temp = format("%s.%d.%zx.tmp", file.c_str(), (int)getpid(), std::hash<std::thread::id>()(std::this_thread::get_id()));
+		{
+			std::ofstream ofs(temp, std::ios::binary | std::ios::trunc);
+			if (!ofs.write(writer.buffer.data(), (std::streamsize)writer.buffer.size()))
+			{
+				ofs.close();
+				fs::remove(temp, ec);
+				return;
+			}
+		}
+
+		fs::rename(temp, file, ec);
+	}
+
+	std::string AstCache::identity(const SourceFile& source, Unit unit)
+	{
+		std::string id;
+		auto feed = [&](std::string_view data)
+		{
+			// 以长度为前缀，字段之间不会混淆
+			id += std::to_string(data.size());
+			id.push_back(':');
+			id.append(data.data(), data.size());
+		};
+
+		// Resolver会把导入路径解析为绝对路径，其结果取决于工作目录与LOXLIB
+		std::error_code ec;
+		const char* loxlib = std::getenv("LOXLIB");
+
+		feed(std::to_string(VERSION));
+		feed(std::to_string((int)unit));
+		feed(source.name());
+		feed(std::filesystem::current_path(ec).string());
+		feed(loxlib ? loxlib : "");
+		feed(source.content());
+		return id;
+	}
+
+	uint64_t AstCache::key(std::string_view identity)
+	{
+		// FNV-1a，只用于命名缓存文件
+		uint64_t hash = 14695981039346656037ull;
+		for (unsigned char c : identity)
+		{
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	std::string AstCache::path(uint64_t key)
+	{
+		return (std::filesystem::path(directory) / format("%016llx.ast", (unsigned long long)key)).string();
+	}
+
+}
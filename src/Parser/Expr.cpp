@@ -53,7 +53,7 @@ namespace CXX {
 		return format("Literal: %s", value.to_string().c_str());
 	}
 
-	VariableExpr::VariableExpr(const Token& identifier) : identifier(identifier), depth(-1)
+	VariableExpr::VariableExpr(const Token& identifier) : identifier(identifier), depth(-1), slot(-1)
 	{
 		this->exprType = ExprType::Variable;
 		set_pos(this->identifier.pos_start, this->identifier.pos_end);
@@ -69,15 +69,17 @@ namespace CXX {
 		return format("VariableExpr: %s", identifier.to_string().c_str());
 	}
 
-	void VariableExpr::resolve(int depth)
+	void VariableExpr::resolve(int depth, int slot)
 	{
 		this->depth = depth;
+		this->slot = slot;
 	}
 
 	AssignmentExpr::AssignmentExpr(const Token& identifier, const Token& operation, ExprPtr value) : identifier(identifier),
 		operation(operation),
 		value(std::move(value)),
-		depth(-1)
+		depth(-1),
+		slot(-1)
 	{
 		this->exprType = ExprType::Assignment;
 		set_pos(this->identifier.pos_start, this->value->pos_end);
@@ -90,13 +92,14 @@ namespace CXX {
 
 	std::string AssignmentExpr::to_string() const
 	{
-		return format("AssignExpr: [%s %s %s]", identifier.lexeme.c_str(), operation.lexeme.c_str(),
+		return format("AssignExpr: [%s %s %s]", identifier.symbol.c_str(), std::string(operation.lexeme).c_str(),
 			value->to_string().c_str());
 	}
 
-	void AssignmentExpr::resolve(int depth)
+	void AssignmentExpr::resolve(int depth, int slot)
 	{
 		this->depth = depth;
+		this->slot = slot;
 	}
 
 	TernaryExpr::TernaryExpr(ExprPtr ifExpr, ExprPtr thenBranch, ExprPtr elseBranch) : expr(std::move(ifExpr)), thenBranch(std::move(thenBranch)), elseBranch(std::move(elseBranch))
@@ -198,6 +201,18 @@ namespace CXX {
 		}
 	}
 
+	const Expr* CallExpr::culprit() const
+	{
+		// 实参可能被ConstantFolder替换，每次重新查找
+		if (!arguments.empty())
+			return arguments.back();
+
+		if (callee->exprType == ExprType::Retrieve && static_cast<const RetrieveExpr*>(callee)->type == RetrieveExpr::OpType::DOT)
+			return static_cast<const RetrieveExpr*>(callee)->holder;
+
+		return callee;
+	}
+
 	Object CallExpr::accept(ExprVisitor& visitor)
 	{
 		return visitor.visit(this);
@@ -235,7 +250,7 @@ namespace CXX {
 
 	Object LambdaExpr::accept(ExprVisitor& visitor)
 	{
-		return visitor.visit(shared_from_this());
+		return visitor.visit(this);
 	}
 
 	std::string LambdaExpr::to_string() const
@@ -298,7 +313,7 @@ namespace CXX {
 			break;
 		}
 
-		return format(form, holder->to_string().c_str(), identifier.lexeme.c_str());
+		return format(form, holder->to_string().c_str(), identifier.symbol.c_str());
 	}
 
 	SetExpr::SetExpr(ExprPtr expr, const Token& identifier, const Token& operation, ExprPtr value,
@@ -337,11 +352,11 @@ namespace CXX {
 			break;
 		}
 
-		return format(form, holder->to_string().c_str(), identifier.lexeme.c_str(), operation.lexeme.c_str(),
+		return format(form, holder->to_string().c_str(), identifier.symbol.c_str(), std::string(operation.lexeme).c_str(),
 			value->to_string().c_str());
 	}
 
-	ThisExpr::ThisExpr(const Token& keyword) : keyword(keyword), depth(-1)
+	ThisExpr::ThisExpr(const Token& keyword) : keyword(keyword), depth(-1), slot(-1)
 	{
 		this->exprType = ExprType::This;
 		set_pos(this->keyword.pos_start, this->keyword.pos_end);
@@ -357,12 +372,13 @@ namespace CXX {
 		return "This";
 	}
 
-	void ThisExpr::resolve(int depth)
+	void ThisExpr::resolve(int depth, int slot)
 	{
 		this->depth = depth;
+		this->slot = slot;
 	}
 
-	SuperExpr::SuperExpr(const Token& keyword, const Token& identifier) : keyword(keyword), identifier(identifier), depth(-1)
+	SuperExpr::SuperExpr(const Token& keyword, const Token& identifier) : keyword(keyword), identifier(identifier), depth(-1), slot(-1)
 	{
 		this->exprType = ExprType::Super;
 		set_pos(this->keyword.pos_start, this->identifier.pos_end);
@@ -378,9 +394,10 @@ namespace CXX {
 		return format("%s.%s", keyword.to_string().c_str(), identifier.to_string().c_str());
 	}
 
-	void SuperExpr::resolve(int depth)
+	void SuperExpr::resolve(int depth, int slot)
 	{
 		this->depth = depth;
+		this->slot = slot;
 	}
 
 	ListExpr::ListExpr(const Token& left, std::vector<ExprPtr> items, const Token& right) : leftBracket(left),
@@ -3,18 +3,47 @@
 #include "Parser/ParsingError.h"
 #include "Parser/Stmt.h"
 #include "Parser/Expr.h"
+#include "Parser/AstArena.h"
+#include "Common/utils.h"
 
 namespace CXX
 {
 
-	Parser::Parser(const std::vector<Token> &tokens) : tokens(tokens), tok_idx(-1)
+	Parser::Parser(Lexer &lexer, bool lazy) : lexer(lexer), tok_idx(-1), fetched(0), m_arena(std::make_shared<AstArena>()),
+											  lazy(lazy), blockDepth(0)
 	{
 		advance();
 	}
 
-	Parser::Parser(std::vector<Token> &&tokens) : tokens(std::move(tokens)), tok_idx(-1)
+	bool Parser::parseBody(FuncDeclarationStmt *function)
 	{
-		advance();
+		Lexer lexer(function->bodyStart.file(), function->bodyStart);
+		Parser parser(lexer);
+		parser.m_arena = function->arena->shared_from_this();
+
+		std::vector<StmtPtr> body;
+		try
+		{
+			body = parser.block();
+		}
+		catch (const ParsingError &e)
+		{
+			parser.errors.push_back(e);
+		}
+
+		for (auto &error : parser.errors)
+		{
+			ErrorReporter::report(error);
+		}
+
+		if (!parser.errors.empty())
+			return false;
+
+		function->body = std::move(body);
+		function->lazy = false;
+		if (!function->body.empty())
+			function->pos_end = function->body.back()->pos_end;
+		return true;
 	}
 
 	std::vector<StmtPtr> Parser::parse()
@@ -25,6 +54,13 @@ namespace CXX
 			statements.push_back(declaration());
 		}
 
+		// 语法错误在源码全部切分完后才报告
+		// 中途遇到词法错误时直接抛出，与先完整切分再解析时一样只报告词法错误
+		for (auto &error : errors)
+		{
+			ErrorReporter::report(error);
+		}
+
 		return statements; // 将亡值不要显示使用std::move
 	}
 
@@ -64,10 +100,10 @@ namespace CXX
 		}
 		catch (const ParsingError &e)
 		{
-			ErrorReporter::report(e);
+			errors.push_back(e);
 			synchronize();
 
-			return std::make_shared<ErrorStmt>(e.pos_start, e.pos_end);
+			return make<ErrorStmt>(e.pos_start, e.pos_end);
 		}
 	}
 
@@ -85,21 +121,40 @@ namespace CXX
 			{
 				initializer = ternary();
 			}
-			statements.push_back(std::make_shared<VarDeclarationStmt>(identifier, std::move(initializer)));
+			statements.push_back(make<VarDeclarationStmt>(identifier, std::move(initializer)));
 		} while (match(TokenType::COMMA));
 
 		expect(TokenType::SEMICOLON, "Expect ';' after variable declaration");
 
-		return statements.size() == 1 ? std::move(statements[0]) : std::make_shared<PackStmt>(std::move(statements));
+		return statements.size() == 1 ? std::move(statements[0]) : make<PackStmt>(std::move(statements));
 	}
 
 	StmtPtr Parser::funcDeclStatement()
 	{
 		Token name = previous();
 
-		std::shared_ptr<LambdaExpr> ptr = std::static_pointer_cast<LambdaExpr>(func_body());
+		if (lazy && blockDepth == 0)
+		{
+			std::vector<Token> params;
+			std::vector<ExprPtr> default_values;
+			parameters(params, default_values);
+			expect(TokenType::LBRACE, "Expected '{' before function body");
+
+			Position bodyStart = previous().pos_end;
+			skipBlock();
+
+			auto funcDecl = make<FuncDeclarationStmt>(name, std::move(params), std::move(default_values), std::vector<StmtPtr>());
+			funcDecl->arena = m_arena.get();
+			funcDecl->lazy = true;
+			funcDecl->bodyStart = bodyStart;
+			return funcDecl;
+		}
+
+		LambdaExpr *ptr = static_cast<LambdaExpr *>(func_body());
 
-		return std::make_shared<FuncDeclarationStmt>(name, std::move(ptr->params), std::move(ptr->default_values), std::move(ptr->body));
+		auto funcDecl = make<FuncDeclarationStmt>(name, std::move(ptr->params), std::move(ptr->default_values), std::move(ptr->body));
+		funcDecl->arena = m_arena.get();
+		return funcDecl;
 	}
 
 	StmtPtr Parser::classDeclStatement()
@@ -107,24 +162,24 @@ namespace CXX
 		expect(TokenType::IDENTIFIER, "Expect Class name");
 		Token name = previous();
 
-		std::optional<std::shared_ptr<VariableExpr>> superclass;
+		std::optional<VariableExpr *> superclass;
 		if (match(TokenType::GT))
 		{
 			expect(TokenType::IDENTIFIER, "Expect SuperClass name");
-			superclass = std::make_shared<VariableExpr>(previous());
+			superclass = make<VariableExpr>(previous());
 		}
 
 		expect(TokenType::LBRACE, "Expect '{' before class body");
-		std::vector<std::shared_ptr<FuncDeclarationStmt>> methods;
+		std::vector<FuncDeclarationStmt *> methods;
 		while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE))
 		{
 			expect(TokenType::IDENTIFIER, "Expect method name");
-			methods.push_back(std::static_pointer_cast<FuncDeclarationStmt>(funcDeclStatement()));
+			methods.push_back(static_cast<FuncDeclarationStmt *>(funcDeclStatement()));
 		}
 
 		expect(TokenType::RBRACE, "Expect '}' to close up class body");
 
-		return std::make_shared<ClassDeclarationStmt>(name, std::move(methods), std::move(superclass));
+		return make<ClassDeclarationStmt>(name, std::move(methods), std::move(superclass));
 	}
 
 	StmtPtr Parser::statement()
@@ -133,7 +188,7 @@ namespace CXX
 		{
 		case TokenType::LBRACE:
 			advance();
-			return std::make_shared<BlockStmt>(block());
+			return make<BlockStmt>(block());
 
 		case TokenType::IF:
 			advance();
@@ -174,7 +229,7 @@ namespace CXX
 
 		expect(TokenType::SEMICOLON, "Expect ';' at the end of an expression.");
 
-		return std::make_shared<ExpressionStmt>(std::move(expr));
+		return make<ExpressionStmt>(std::move(expr));
 	}
 
 	StmtPtr Parser::ifStatement()
@@ -190,7 +245,7 @@ namespace CXX
 			elseBranch = statement();
 		}
 
-		return std::make_shared<IfStmt>(std::move(condition), std::move(thenBranch), std::move(elseBranch));
+		return make<IfStmt>(std::move(condition), std::move(thenBranch), std::move(elseBranch));
 	}
 
 	StmtPtr Parser::whileStatement()
@@ -200,7 +255,7 @@ namespace CXX
 		expect(TokenType::RPAREN, "Expect ')' to close up condition");
 		StmtPtr body = statement();
 
-		return std::make_shared<WhileStmt>(std::move(condition), std::move(body));
+		return make<WhileStmt>(std::move(condition), std::move(body));
 	}
 
 	StmtPtr Parser::forStatement()
@@ -235,7 +290,7 @@ namespace CXX
 
 		StmtPtr body = statement();
 
-		return std::make_shared<ForStmt>(std::move(initializer), std::move(condition), std::move(increment),
+		return make<ForStmt>(std::move(initializer), std::move(condition), std::move(increment),
 										 std::move(body));
 	}
 
@@ -243,14 +298,14 @@ namespace CXX
 	{
 		Token keyword = previous();
 		expect(TokenType::SEMICOLON, "Expect ';' after break");
-		return std::make_shared<BreakStmt>(keyword);
+		return make<BreakStmt>(keyword);
 	}
 
 	StmtPtr Parser::continueStatement()
 	{
 		Token keyword = previous();
 		expect(TokenType::SEMICOLON, "Expect ';' after continue");
-		return std::make_shared<ContinueStmt>(keyword);
+		return make<ContinueStmt>(keyword);
 	}
 
 	StmtPtr Parser::returnStatement()
@@ -262,7 +317,7 @@ namespace CXX
 			expr = expression();
 		}
 		expect(TokenType::SEMICOLON, "Expected ';' after return statement");
-		return std::make_shared<ReturnStmt>(keyword, std::move(expr));
+		return make<ReturnStmt>(keyword, std::move(expr));
 	}
 
 	StmtPtr Parser::importStatement()
@@ -300,11 +355,15 @@ namespace CXX
 		Token filepath = previous();
 		expect(TokenType::SEMICOLON, "Expect ';' after import statement");
 
-		return std::make_shared<ImportStmt>(keyword, std::move(symbols), filepath);
+		return make<ImportStmt>(keyword, std::move(symbols), filepath);
 	}
 
 	std::vector<StmtPtr> Parser::block()
 	{
+		blockDepth++;
+		Finally task([&]()
+					 { blockDepth--; });
+
 		std::vector<StmtPtr> statements;
 		while (current_tok.type != TokenType::END_OF_FILE && !check(TokenType::RBRACE))
 		{
@@ -329,7 +388,7 @@ namespace CXX
 			expressions.push_back(assignment());
 		} while (match(TokenType::COMMA));
 
-		return expressions.size() == 1 ? std::move(expressions[0]) : std::make_shared<PackExpr>(std::move(expressions));
+		return expressions.size() == 1 ? std::move(expressions[0]) : make<PackExpr>(std::move(expressions));
 	}
 
 	ExprPtr Parser::assignment()
@@ -345,21 +404,21 @@ namespace CXX
 			// 需要检查一下要去赋值的是不是一个变量(identifier)
 			if (expr->exprType == ExprType::Variable)
 			{
-				Token identifier = std::static_pointer_cast<VariableExpr>(expr)->identifier;
-				return std::make_shared<AssignmentExpr>(identifier, op, std::move(rvalue));
+				Token identifier = static_cast<VariableExpr *>(expr)->identifier;
+				return make<AssignmentExpr>(identifier, op, std::move(rvalue));
 			}
 			else if (expr->exprType == ExprType::Retrieve)
 			{
-				auto retrieval = std::static_pointer_cast<RetrieveExpr>(expr);
+				auto retrieval = static_cast<RetrieveExpr *>(expr);
 
 				if (retrieval->type == RetrieveExpr::OpType::DOT)
 				{
 					Token identifier = retrieval->identifier;
-					return std::make_shared<SetExpr>(std::move(retrieval->holder), identifier, op, std::move(rvalue));
+					return make<SetExpr>(std::move(retrieval->holder), identifier, op, std::move(rvalue));
 				}
 				else
 				{
-					return std::make_shared<SetExpr>(std::move(retrieval->holder), std::move(retrieval->index), op, std::move(rvalue));
+					return make<SetExpr>(std::move(retrieval->holder), std::move(retrieval->index), op, std::move(rvalue));
 				}
 			}
 
@@ -379,7 +438,7 @@ namespace CXX
 			expect(TokenType::COLON, "Expect ':' after then branch for ternary expression");
 			ExprPtr elseBranch = assignment();
 
-			return std::make_shared<TernaryExpr>(std::move(expr), std::move(thenBranch), std::move(elseBranch));
+			return make<TernaryExpr>(std::move(expr), std::move(thenBranch), std::move(elseBranch));
 		}
 
 		return expr;
@@ -391,7 +450,7 @@ namespace CXX
 		while (match(TokenType::OR))
 		{
 			ExprPtr right = logicAnd();
-			expr = std::make_shared<OrExpr>(std::move(expr), std::move(right));
+			expr = make<OrExpr>(std::move(expr), std::move(right));
 		}
 
 		return expr;
@@ -403,7 +462,7 @@ namespace CXX
 		while (match(TokenType::AND))
 		{
 			ExprPtr right = equality();
-			expr = std::make_shared<AndExpr>(std::move(expr), std::move(right));
+			expr = make<AndExpr>(std::move(expr), std::move(right));
 		}
 
 		return expr;
@@ -435,7 +494,7 @@ namespace CXX
 		{
 			Token op = previous();
 			ExprPtr right = unary();
-			return std::make_shared<UnaryExpr>(op, std::move(right));
+			return make<UnaryExpr>(op, std::move(right));
 		}
 
 		return prefix();
@@ -451,9 +510,9 @@ namespace CXX
 			if (right->exprType == ExprType::Variable || right->exprType == ExprType::Retrieve)
 			{
 				if (op.type == TokenType::PLUS_PLUS)
-					return std::make_shared<IncrementExpr>(std::move(right), IncrementExpr::Type::PREFIX);
+					return make<IncrementExpr>(std::move(right), IncrementExpr::Type::PREFIX);
 				else if (op.type == TokenType::MINUS_MINUS)
-					return std::make_shared<DecrementExpr>(std::move(right), DecrementExpr::Type::PREFIX);
+					return make<DecrementExpr>(std::move(right), DecrementExpr::Type::PREFIX);
 			}
 			else
 			{
@@ -474,9 +533,9 @@ namespace CXX
 			if (expr->exprType == ExprType::Variable || expr->exprType == ExprType::Retrieve)
 			{
 				if (op.type == TokenType::PLUS_PLUS)
-					return std::make_shared<IncrementExpr>(std::move(expr), IncrementExpr::Type::POSTFIX);
+					return make<IncrementExpr>(std::move(expr), IncrementExpr::Type::POSTFIX);
 				else if (op.type == TokenType::MINUS_MINUS)
-					return std::make_shared<DecrementExpr>(std::move(expr), DecrementExpr::Type::POSTFIX);
+					return make<DecrementExpr>(std::move(expr), DecrementExpr::Type::POSTFIX);
 			}
 			else
 			{
@@ -498,13 +557,13 @@ namespace CXX
 			{
 				expect(TokenType::IDENTIFIER, "Expect property name after '.'");
 				Token prop = previous();
-				expr = std::make_shared<RetrieveExpr>(std::move(expr), prop);
+				expr = make<RetrieveExpr>(std::move(expr), prop);
 			}
 			else if (match(TokenType::LBRACKET))
 			{
 				ExprPtr index = logicOr();
 				expect(TokenType::RBRACKET, "Expect ']' to close up indexing");
-				expr = std::make_shared<RetrieveExpr>(std::move(expr), std::move(index));
+				expr = make<RetrieveExpr>(std::move(expr), std::move(index));
 			}
 			else
 				break;
@@ -518,11 +577,11 @@ namespace CXX
 		if (match(TokenType::NUMBER, TokenType::STRING, TokenType::TRUE, TokenType::FALSE, TokenType::NIL))
 		{
 			Token pre = previous();
-			return std::make_shared<LiteralExpr>(Object(pre), pre.pos_start, pre.pos_end);
+			return make<LiteralExpr>(Object(pre), pre.pos_start, pre.pos_end);
 		}
 		else if (match(TokenType::IDENTIFIER))
 		{
-			return std::make_shared<VariableExpr>(previous());
+			return make<VariableExpr>(previous());
 		}
 		else if (match(TokenType::LPAREN))
 		{
@@ -532,14 +591,14 @@ namespace CXX
 		}
 		else if (match(TokenType::THIS))
 		{
-			return std::make_shared<ThisExpr>(previous());
+			return make<ThisExpr>(previous());
 		}
 		else if (match(TokenType::SUPER))
 		{
 			Token keyword = previous();
 			expect(TokenType::DOT, "Expected '.' to access super fields");
 			expect(TokenType::IDENTIFIER, "Expected identifier after '.'");
-			return std::make_shared<SuperExpr>(keyword, previous());
+			return make<SuperExpr>(keyword, previous());
 		}
 		else if (match(TokenType::FUNC))
 		{
@@ -565,7 +624,7 @@ namespace CXX
 		expect(TokenType::RBRACKET, "Expect ']' to close up MetaList");
 		Token rbracket = previous();
 
-		return std::make_shared<ListExpr>(lbracket, std::move(args), rbracket);
+		return make<ListExpr>(lbracket, std::move(args), rbracket);
 	}
 
 	ExprPtr Parser::bin_op(const std::function<ExprPtr(Parser *)> &funcA, std::initializer_list<TokenType> ops,
@@ -576,7 +635,7 @@ namespace CXX
 		{
 			Token op = previous();
 			ExprPtr right = funcB(this);
-			expr = std::make_shared<BinaryExpr>(std::move(expr), std::move(right), op);
+			expr = make<BinaryExpr>(std::move(expr), std::move(right), op);
 		}
 
 		return expr;
@@ -602,15 +661,26 @@ namespace CXX
 
 		expect(TokenType::RPAREN, "Expect ')' to close up argument list");
 
-		return std::make_shared<CallExpr>(std::move(expr), std::move(args));
+		return make<CallExpr>(std::move(expr), std::move(args));
 	}
 
 	ExprPtr Parser::func_body()
 	{
-		expect(TokenType::LPAREN, "Expected '(' before parameter list");
-
-		std::vector<Token> parameters;
+		std::vector<Token> params;
 		std::vector<ExprPtr> default_values;
+		parameters(params, default_values);
+		expect(TokenType::LBRACE, "Expected '{' before function body");
+
+		std::vector<StmtPtr> body = block();
+
+		auto lambda = make<LambdaExpr>(std::move(params), std::move(default_values), std::move(body));
+		lambda->arena = m_arena.get();
+		return lambda;
+	}
+
+	void Parser::parameters(std::vector<Token> &params, std::vector<ExprPtr> &default_values)
+	{
+		expect(TokenType::LPAREN, "Expected '(' before parameter list");
 
 		if (!check(TokenType::RPAREN))
 		{
@@ -622,7 +692,7 @@ namespace CXX
 			do
 			{
 				expect(TokenType::IDENTIFIER, "Expected a parameter name");
-				parameters.push_back(previous());
+				params.push_back(previous());
 
 				// 默认值
 				if (match(TokenType::EQ))
@@ -646,32 +716,45 @@ namespace CXX
 		}
 
 		expect(TokenType::RPAREN, "Expected ')' after parameter list");
-		expect(TokenType::LBRACE, "Expected '{' before function body");
+	}
 
-		std::vector<StmtPtr> body = block();
+	void Parser::skipBlock()
+	{
+		// 字符串、注释等已由Lexer处理，按Token匹配括号即可
+		for (int depth = 1; depth > 0; advance())
+		{
+			if (check(TokenType::END_OF_FILE))
+				throw ParsingError(current_tok.pos_start, current_tok.pos_end, "Expected } at the end of a block");
 
-		return std::make_shared<LambdaExpr>(std::move(parameters), std::move(default_values), std::move(body));
+			if (check(TokenType::LBRACE))
+				depth++;
+			else if (check(TokenType::RBRACE))
+				depth--;
+		}
 	}
 
 	void Parser::advance()
 	{
 		tok_idx++;
-		if (tok_idx < tokens.size())
-			current_tok = tokens[tok_idx];
+		if (tok_idx == fetched)
+			window[fetched++ % WINDOW] = lexer.next();
+
+		current_tok = window[tok_idx % WINDOW];
 	}
 
 	void Parser::reverse(int step)
 	{
+		// 超出缓冲区的回退无法完成，保持原位
+		if (tok_idx - step < 0 || fetched - (tok_idx - step - 1) > WINDOW)
+			return;
+
 		tok_idx -= step;
-		if (tok_idx >= 0)
-			current_tok = tokens[tok_idx];
-		else
-			tok_idx += step;
+		current_tok = window[tok_idx % WINDOW];
 	}
 
 	Token Parser::previous()
 	{
-		return tokens[tok_idx - 1];
+		return window[(tok_idx - 1) % WINDOW];
 	}
 
 	bool Parser::check(const TokenType &type) const
@@ -42,9 +42,9 @@ namespace CXX {
 	std::string VarDeclarationStmt::to_string() const
 	{
 		if (expr)
-			return format("VAR %s = %s", identifier.lexeme.c_str(), expr.value()->to_string().c_str());
+			return format("VAR %s = %s", identifier.symbol.c_str(), expr.value()->to_string().c_str());
 
-		return format("VAR %s", identifier.lexeme.c_str());
+		return format("VAR %s", identifier.symbol.c_str());
 	}
 
 	FuncDeclarationStmt::FuncDeclarationStmt(const Token& name, std::vector<Token> params, std::vector<ExprPtr> default_values, std::vector<StmtPtr> body) :
@@ -59,12 +59,12 @@ namespace CXX {
 
 	void FuncDeclarationStmt::accept(StmtVisitor& visitor)
 	{
-		visitor.visit(shared_from_this());
+		visitor.visit(this);
 	}
 
 	std::string FuncDeclarationStmt::to_string() const
 	{
-		std::string result = format("FUNC %s(", name.lexeme.c_str());
+		std::string result = format("FUNC %s(", name.symbol.c_str());
 		if (!params.empty())
 		{
 			for (auto& param : params)
@@ -87,8 +87,8 @@ namespace CXX {
 	}
 
 	ClassDeclarationStmt::ClassDeclarationStmt(const Token& identifier,
-		std::vector<std::shared_ptr<FuncDeclarationStmt>> methods,
-		std::optional<std::shared_ptr<VariableExpr>> superclass)
+		std::vector<FuncDeclarationStmt*> methods,
+		std::optional<VariableExpr*> superclass)
 		: name(identifier), methods(std::move(methods)), superClass(std::move(superclass))
 	{
 		this->stmtType = StmtType::ClassDecl;
@@ -105,14 +105,14 @@ namespace CXX {
 
 	std::string ClassDeclarationStmt::to_string() const
 	{
-		return format("<CLASS %s>", name.lexeme.c_str());
+		return format("<CLASS %s>", name.symbol.c_str());
 	}
 
 	BlockStmt::BlockStmt(std::vector<StmtPtr> statements) : statements(std::move(statements))
 	{
 		this->stmtType = StmtType::Block;
 		if (!this->statements.empty())
-			set_pos(this->statements.begin()->get()->pos_start, this->statements.rbegin()->get()->pos_end);
+			set_pos(this->statements.front()->pos_start, this->statements.back()->pos_end);
 		else
 			set_pos(Position::preset, Position::preset);
 	}
@@ -353,14 +353,14 @@ namespace CXX {
 		for (auto& [name, alias] : symbols) {
 			result += name.lexeme;
 			if (alias) {
-				result += " as " + alias->lexeme;
+				result += " as " + alias->symbol.str();
 			}
 			result += ",";
 		}
 		if (result.back() == ',')
 			result.pop_back();
 
-		result += "} from " + filepath.lexeme;
+		result += "} from " + filepath.symbol.str();
 
 		return result;
 	}
@@ -1,4 +1,7 @@
 #include "Resolver/Resolver.h"
+#include "Parser/Parser.h"
+#include "Optimizer/ConstantFolder.h"
+#include "Optimizer/TypeInferencer.h"
 #include "Common/utils.h"
 #include <filesystem>
 #include <cstdlib>
@@ -10,22 +13,60 @@ namespace CXX
 	{
 		for (auto const &stmt : stmts)
 		{
-			resolve(stmt.get());
+			resolve(stmt);
 		}
 
 		return ErrorReporter::errorCount == 0;
 	}
 
+	void Resolver::resolveModule(const BlockStmt *blockStmt)
+	{
+		beginScope(true);
+		resolve(blockStmt->statements);
+
+		// 延迟解析的函数体在补全时需要模块作用域中的全部变量
+		if (moduleScope)
+			moduleScope->variables = std::move(scopes.back().variables);
+
+		const_cast<BlockStmt *>(blockStmt)->localCount = endScope();
+	}
+
+	bool Resolver::resolveBody(FuncDeclarationStmt *function)
+	{
+		if (!function->lazy)
+			return true;
+
+		int errorCount = ErrorReporter::errorCount;
+		if (!Parser::parseBody(function))
+			return false;
+
+		// 恢复函数声明处的状态，模块作用域只作为外部作用域查找
+		const LazyScope &lazyScope = *function->lazyScope;
+		Resolver resolver;
+		resolver.currentClass = lazyScope.currentClass;
+		resolver.outer = lazyScope.module.get();
+		resolver.outerVisible = lazyScope.visible;
+		resolver.resolveFunction(function, lazyScope.type);
+
+		function->lazyScope.reset();
+		if (ErrorReporter::errorCount != errorCount)
+			return false;
+
+		ConstantFolder::foldBody(function);
+		TypeInferencer::inferFunction(function);
+		return true;
+	}
+
 	Object Resolver::visit(const BinaryExpr *binaryExpr)
 	{
-		resolve(binaryExpr->left.get());
-		resolve(binaryExpr->right.get());
+		resolve(binaryExpr->left);
+		resolve(binaryExpr->right);
 		return Object();
 	}
 
 	Object Resolver::visit(const UnaryExpr *unaryExpr)
 	{
-		resolve(unaryExpr->expr.get());
+		resolve(unaryExpr->expr);
 		return Object();
 	}
 
@@ -36,62 +77,64 @@ namespace CXX
 
 	Object Resolver::visit(const VariableExpr *variableExpr)
 	{
-		const std::string &name = variableExpr->identifier.lexeme;
+		const std::string &name = variableExpr->identifier.symbol.str();
 
 		if (!scopes.empty())
 		{
-			auto &nearest_scope = scopes.back();
+			auto &nearest_scope = scopes.back().variables;
 
 			// 这里处理的情况是 var a = a;
-			if (nearest_scope.find(name) != nearest_scope.end() && !nearest_scope.find(name)->second)
+			if (auto it = nearest_scope.find(name); it != nearest_scope.end() && !it->second.defined)
 			{
 				ErrorReporter::report(ResolvingError(variableExpr->pos_start, variableExpr->pos_end, "Can't init a variable with it self"));
 				return Object();
 			}
 		}
 
-		const_cast<VariableExpr *>(variableExpr)->resolve(resolveLocal(variableExpr->identifier));
+		auto [depth, slot] = resolveLocal(variableExpr->identifier);
+		const_cast<VariableExpr *>(variableExpr)->resolve(depth, slot);
 		return Object();
 	}
 
 	Object Resolver::visit(const AssignmentExpr *assignmentExpr)
 	{
-		resolve(assignmentExpr->value.get());
-		const_cast<AssignmentExpr *>(assignmentExpr)->resolve(resolveLocal(assignmentExpr->identifier));
+		resolve(assignmentExpr->value);
+		auto [depth, slot] = resolveLocal(assignmentExpr->identifier);
+		const_cast<AssignmentExpr *>(assignmentExpr)->resolve(depth, slot);
 		return Object();
 	}
 
 	Object Resolver::visit(const TernaryExpr *ternaryExpr)
 	{
-		resolve(ternaryExpr->expr.get());
-		resolve(ternaryExpr->thenBranch.get());
-		resolve(ternaryExpr->elseBranch.get());
+		resolve(ternaryExpr->expr);
+		resolve(ternaryExpr->thenBranch);
+		resolve(ternaryExpr->elseBranch);
 
 		return Object();
 	}
 
 	Object Resolver::visit(const OrExpr *orExpr)
 	{
-		resolve(orExpr->left.get());
-		resolve(orExpr->right.get());
+		resolve(orExpr->left);
+		resolve(orExpr->right);
 
 		return Object();
 	}
 
 	Object Resolver::visit(const AndExpr *andExpr)
 	{
-		resolve(andExpr->left.get());
-		resolve(andExpr->right.get());
+		resolve(andExpr->left);
+		resolve(andExpr->right);
 
 		return Object();
 	}
 
 	Object Resolver::visit(const CallExpr *functionCallExpr)
 	{
-		resolve(functionCallExpr->callee.get());
+		resolve(functionCallExpr->callee);
 		for (auto const &arg : functionCallExpr->arguments)
 		{
-			resolve(arg.get());
+			resolve(arg);
 		}
 
 		return Object();
@@ -100,20 +143,20 @@ namespace CXX
 	Object Resolver::visit(const RetrieveExpr *retrieveExpr)
 	{
 		// Resolver只做静态分析，Retrieve属于运行时操作，因此没有绑定操作
-		resolve(retrieveExpr->holder.get());
+		resolve(retrieveExpr->holder);
 		if (retrieveExpr->index)
-			resolve(retrieveExpr->index.get());
+			resolve(retrieveExpr->index);
 
 		return Object();
 	}
 
 	Object Resolver::visit(const SetExpr *setExpr)
 	{
-		resolve(setExpr->holder.get());
+		resolve(setExpr->holder);
 		if (setExpr->index)
-			resolve(setExpr->index.get());
+			resolve(setExpr->index);
 
-		resolve(setExpr->value.get());
+		resolve(setExpr->value);
 		return Object();
 	}
 
@@ -121,13 +164,14 @@ namespace CXX
 	{
 		if (incrementExpr->holder->exprType == ExprType::Variable)
 		{
-			auto var = static_cast<VariableExpr *>(incrementExpr->holder.get());
-			var->resolve(resolveLocal(var->identifier));
+			auto var = static_cast<VariableExpr *>(incrementExpr->holder);
+			auto [depth, slot] = resolveLocal(var->identifier);
+			var->resolve(depth, slot);
 		}
 		else
 		{
 			// 若不是变量，则为Retrieve操作，运行时操作Resolver不处理
-			resolve(incrementExpr->holder.get());
+			resolve(incrementExpr->holder);
 		}
 
 		return Object();
@@ -137,21 +181,22 @@ namespace CXX
 	{
 		if (decrementExpr->holder->exprType == ExprType::Variable)
 		{
-			auto var = static_cast<VariableExpr *>(decrementExpr->holder.get());
-			var->resolve(resolveLocal(var->identifier));
+			auto var = static_cast<VariableExpr *>(decrementExpr->holder);
+			auto [depth, slot] = resolveLocal(var->identifier);
+			var->resolve(depth, slot);
 		}
 		else
 		{
 			// 若不是变量，则为Retrieve操作，运行时操作Resolver不处理
-			resolve(decrementExpr->holder.get());
+			resolve(decrementExpr->holder);
 		}
 
 		return Object();
 	}
 
-	Object Resolver::visit(std::shared_ptr<LambdaExpr> lambdaExpr)
+	Object Resolver::visit(LambdaExpr *lambdaExpr)
 	{
-		resolveFunction(lambdaExpr.get());
+		resolveFunction(lambdaExpr);
 		return Object();
 	}
 
@@ -163,7 +208,8 @@ namespace CXX
 			return Object();
 		}
 
-		const_cast<ThisExpr *>(thisExpr)->resolve(resolveLocal(thisExpr->keyword));
+		auto [depth, slot] = resolveLocal(thisExpr->keyword);
+		const_cast<ThisExpr *>(thisExpr)->resolve(depth, slot);
 
 		return Object();
 	}
@@ -176,7 +222,8 @@ namespace CXX
 			return Object();
 		}
 
-		const_cast<SuperExpr *>(superExpr)->resolve(resolveLocal(superExpr->keyword));
+		auto [depth, slot] = resolveLocal(superExpr->keyword);
+		const_cast<SuperExpr *>(superExpr)->resolve(depth, slot);
 
 		return Object();
 	}
@@ -184,7 +231,7 @@ namespace CXX
 	Object Resolver::visit(const ListExpr *listExpr)
 	{
 		for (auto &item : listExpr->items)
-			resolve(item.get());
+			resolve(item);
 
 		return Object();
 	}
@@ -193,7 +240,7 @@ namespace CXX
 	{
 		for (auto const &expr : packExpr->expressions)
 		{
-			resolve(expr.get());
+			resolve(expr);
 		}
 
 		return Object();
@@ -201,15 +248,15 @@ namespace CXX
 
 	void Resolver::visit(const ExpressionStmt *expressionStmt)
 	{
-		resolve(expressionStmt->expr.get());
+		resolve(expressionStmt->expr);
 	}
 
 	void Resolver::visit(const VarDeclarationStmt *varStmt)
 	{
-		declare(varStmt->identifier);
+		const_cast<VarDeclarationStmt *>(varStmt)->slot = declare(varStmt->identifier);
 		if (varStmt->expr)
 		{
-			resolve(varStmt->expr.value().get());
+			resolve(varStmt->expr.value());
 		}
 		define(varStmt->identifier);
 	}
@@ -218,16 +265,16 @@ namespace CXX
 	{
 		beginScope();
 		resolve(blockStmt->statements);
-		endScope();
+		const_cast<BlockStmt *>(blockStmt)->localCount = endScope();
 	}
 
 	void Resolver::visit(const IfStmt *ifStmt)
 	{
-		resolve(ifStmt->condition.get());
-		resolve(ifStmt->thenBranch.get());
+		resolve(ifStmt->condition);
+		resolve(ifStmt->thenBranch);
 		if (ifStmt->elseBranch)
 		{
-			resolve(ifStmt->elseBranch.value().get());
+			resolve(ifStmt->elseBranch.value());
 		}
 	}
 
@@ -235,8 +282,8 @@ namespace CXX
 	{
 		loopLayer++;
 
-		resolve(whileStmt->condition.get());
-		resolve(whileStmt->body.get());
+		resolve(whileStmt->condition);
+		resolve(whileStmt->body);
 
 		loopLayer--;
 	}
@@ -247,16 +294,16 @@ namespace CXX
 
 		beginScope();
 		if (forStmt->initializer)
-			resolve(forStmt->initializer.value().get());
+			resolve(forStmt->initializer.value());
 
 		if (forStmt->condition)
-			resolve(forStmt->condition.value().get());
+			resolve(forStmt->condition.value());
 
 		if (forStmt->increment)
-			resolve(forStmt->increment.value().get());
+			resolve(forStmt->increment.value());
 
-		resolve(forStmt->body.get());
-		endScope();
+		resolve(forStmt->body);
+		const_cast<ForStmt *>(forStmt)->localCount = endScope();
 
 		loopLayer--;
 	}
@@ -277,11 +324,11 @@ namespace CXX
 		}
 	}
 
-	void Resolver::visit(std::shared_ptr<FuncDeclarationStmt> funcDeclStmt)
+	void Resolver::visit(FuncDeclarationStmt *funcDeclStmt)
 	{
-		declare(funcDeclStmt->name);
+		funcDeclStmt->slot = declare(funcDeclStmt->name);
 		define(funcDeclStmt->name);
-		resolveFunction(funcDeclStmt.get(), FunctionType::FUNCTION);
+		resolveFunction(funcDeclStmt, FunctionType::FUNCTION);
 	}
 
 	void Resolver::visit(const ReturnStmt *returnStmt)
@@ -299,7 +346,7 @@ namespace CXX
 															"Can't 'return' non-nil value from an initializer"));
 			}
 
-			resolve(returnStmt->expr.value().get());
+			resolve(returnStmt->expr.value());
 		}
 	}
 
@@ -348,11 +395,21 @@ namespace CXX
 														"Invalid import path"));
 		}
 
-		const_cast<ImportStmt *>(importStmt)->filepath.lexeme = filepath.string();
+		// 解析后的路径由符号表持有
+		Token &path = const_cast<ImportStmt *>(importStmt)->filepath;
+		path.symbol = Symbol(filepath.string());
+		path.lexeme = path.symbol.str();
+
+		// import { * } 导入的名字在运行时才能确定，仍按名字存放
+		if (importStmt->symbols.begin()->first.type == TokenType::MUL)
+			return;
 
-		for (auto &[name, _] : importStmt->symbols)
+		auto &slots = const_cast<ImportStmt *>(importStmt)->slots;
+		slots.clear();
+		for (auto &[symbol, alias] : importStmt->symbols)
 		{
-			declare(name);
+			const Token &name = alias ? alias.value() : symbol;
+			slots.push_back(declare(name));
 			define(name);
 		}
 	}
@@ -361,7 +418,7 @@ namespace CXX
 	{
 		for (auto const &stmt : packStmt->statements)
 		{
-			resolve(stmt.get());
+			resolve(stmt);
 		}
 	}
 
@@ -370,14 +427,13 @@ namespace CXX
 		ClassType enclosing = currentClass;
 		currentClass = ClassType::CLASS;
 
-		declare(classDeclStmt->name);
+		const_cast<ClassDeclarationStmt *>(classDeclStmt)->slot = declare(classDeclStmt->name);
 		define(classDeclStmt->name);
 
-		bool defineSuper{false};
-		if (defineSuper = classDeclStmt->superClass.has_value())
+		if (classDeclStmt->superClass.has_value())
 		{
 			currentClass = ClassType::SUBCLASS;
-			auto ptr = classDeclStmt->superClass.value().get();
+			auto ptr = classDeclStmt->superClass.value();
 			if (ptr->identifier.lexeme == classDeclStmt->name.lexeme)
 			{
 				return ErrorReporter::report(ResolvingError(classDeclStmt->pos_start, ptr->pos_end, "A Class can't derived from itself"));
@@ -385,19 +441,14 @@ namespace CXX
 			resolve(ptr);
 		}
 
-		beginScope();
-		scopes.back().emplace("this", true);
-		if (defineSuper)
-			scopes.back().emplace("super", true);
-
-		// 利用析构函数保证endScope运行
+		// this位于各成员函数自己的作用域中，见resolveFunction
 		Finally task{[&]()
-					 {endScope(); currentClass = enclosing; }};
+					 { currentClass = enclosing; }};
 
 		for (auto &method : classDeclStmt->methods)
 		{
 			if (method->name.lexeme == "init")
-				resolveFunction(method.get(), FunctionType::INITIALIZER);
+				resolveFunction(method, FunctionType::INITIALIZER);
 			else if (method->name.lexeme == "__del__")
 			{
 				if (method->params.size() != 0)
@@ -405,27 +456,77 @@ namespace CXX
 					return ErrorReporter::report(ResolvingError(method->params.front().pos_start, method->params.back().pos_end, "Destructor shouldn't take arguments"));
 				}
 
-				resolveFunction(method.get(), FunctionType::METHOD);
+				resolveFunction(method, FunctionType::METHOD);
 			}
 			else
-				resolveFunction(method.get(), FunctionType::METHOD);
+				resolveFunction(method, FunctionType::METHOD);
 		}
 	}
 
 	void Resolver::resolveFunction(const FuncDeclarationStmt *functionStmt, FunctionType type)
 	{
+		if (functionStmt->lazy && defer(functionStmt, type))
+			return;
+
 		FunctionType enclosing = currentFunction;
 		currentFunction = type;
 
+		// 函数体内的break、continue不能作用于函数外的循环
+		int enclosingLoop = loopLayer;
+		loopLayer = 0;
+
 		beginScope();
 		for (auto &param : functionStmt->params)
 		{
-			declare(param);
+			declareParam(param);
 			define(param);
 		}
+
+		// 成员函数的this紧随参数之后，调用时由接收者直接填入，不需要额外的Context
+		// super通过this所在的槽位找到实例
+		if (type == FunctionType::METHOD || type == FunctionType::INITIALIZER)
+		{
+			Scope &scope = scopes.back();
+			int slot = scope.localCount++;
+			scope.variables.emplace("this", Variable{true, slot});
+			if (currentClass == ClassType::SUBCLASS)
+				scope.variables.emplace("super", Variable{true, slot});
+			const_cast<FuncDeclarationStmt *>(functionStmt)->thisSlot = slot;
+		}
+
 		resolve(functionStmt->body);
-		endScope();
+		const_cast<FuncDeclarationStmt *>(functionStmt)->localCount = endScope();
 		currentFunction = enclosing;
+		loopLayer = enclosingLoop;
+	}
+
+	bool Resolver::defer(const FuncDeclarationStmt *functionStmt, FunctionType type)
+	{
+		auto function = const_cast<FuncDeclarationStmt *>(functionStmt);
+
+		// Parser只预解析顶层的函数，其他情况不会出现，保险起见立即补全
+		bool topLevel = currentFunction == FunctionType::NONE && !outer &&
+						(scopes.empty() || (scopes.size() == 1 && scopes.back().named));
+		if (!topLevel)
+			return !Parser::parseBody(function);
+
+		auto lazyScope = std::make_shared<LazyScope>();
+		lazyScope->type = type;
+		lazyScope->currentClass = currentClass;
+		if (!scopes.empty())
+		{
+			if (!moduleScope)
+				moduleScope = std::make_shared<Scope>();
+			lazyScope->module = moduleScope;
+			lazyScope->visible = (int)scopes.back().variables.size();
+		}
+
+		// 成员函数的this紧随参数之后，调用时就需要
+		if (type == FunctionType::METHOD || type == FunctionType::INITIALIZER)
+			function->thisSlot = (int)function->params.size();
+
+		function->lazyScope = std::move(lazyScope);
+		return true;
 	}
 
 	void Resolver::resolveFunction(const LambdaExpr *lambdaExpr)
@@ -433,15 +534,19 @@ namespace CXX
 		FunctionType enclosing = currentFunction;
 		currentFunction = FunctionType::FUNCTION;
 
+		int enclosingLoop = loopLayer;
+		loopLayer = 0;
+
 		beginScope();
 		for (auto &param : lambdaExpr->params)
 		{
-			declare(param);
+			declareParam(param);
 			define(param);
 		}
 		resolve(lambdaExpr->body);
-		endScope();
+		const_cast<LambdaExpr *>(lambdaExpr)->localCount = endScope();
 		currentFunction = enclosing;
+		loopLayer = enclosingLoop;
 	}
 
 	void Resolver::resolve(Stmt *stmt)
@@ -454,31 +559,46 @@ namespace CXX
 		expr->accept(*this);
 	}
 
-	int Resolver::resolveLocal(const Token &name)
+	std::pair<int, int> Resolver::resolveLocal(const Token &name)
 	{
 		int totalLength = scopes.size();
 		for (int dist = totalLength - 1; dist >= 0; dist--)
 		{
-			if (scopes[dist].find(name.lexeme) != scopes[dist].end())
+			auto &variables = scopes[dist].variables;
+			if (auto it = variables.find(name.symbol.str()); it != variables.end())
 			{
 				// 计算出该变量所处作用域距离当前表达式有几"跳"
-				return totalLength - dist - 1;
+				return {totalLength - dist - 1, it->second.slot};
+			}
+		}
+
+		// 补全的函数体还能访问声明处可见的模块变量
+		if (outer)
+		{
+			auto &variables = outer->variables;
+			if (auto it = variables.find(name.symbol.str()); it != variables.end() && it->second.order < outerVisible)
+			{
+				return {totalLength, it->second.slot};
 			}
 		}
 
 		// 如果没有找到，则说明该变量为全局变量
 		// Resolver不处理全局变量
-		return -1;
+		return {-1, -1};
 	}
 
-	void Resolver::beginScope()
+	void Resolver::beginScope(bool named)
 	{
-		scopes.emplace_back(std::unordered_map<std::string, bool>{});
+		Scope scope;
+		scope.named = named;
+		scopes.push_back(std::move(scope));
 	}
 
-	void Resolver::endScope()
+	int Resolver::endScope()
 	{
+		int localCount = scopes.back().localCount;
 		scopes.pop_back();
+		return localCount;
 	}
 
 	void Resolver::define(const Token &name)
@@ -486,18 +606,35 @@ namespace CXX
 		if (scopes.empty())
 			return;
 
-		scopes.back()[name.lexeme] = true;
+		scopes.back().variables[name.symbol.str()].defined = true;
 	}
 
-	void Resolver::declare(const Token &name)
+	int Resolver::declare(const Token &name)
 	{
 		if (scopes.empty())
-			return;
+			return -1;
 
 		// 此处可以用来检查是否有变量重定义
 		// 我在此先允许，因为我认为这不会造成什么问题
 		// 但是这种代码不被推荐，很可能是误定义
-		scopes.back()[name.lexeme] = false;
+		Scope &scope = scopes.back();
+		if (auto it = scope.variables.find(name.symbol.str()); it != scope.variables.end())
+		{
+			it->second.defined = false;
+			return it->second.slot;
+		}
+
+		int slot = scope.named ? -1 : scope.localCount++;
+		scope.variables.emplace(name.lexeme, Variable{false, slot, (int)scope.variables.size()});
+		return slot;
+	}
+
+	int Resolver::declareParam(const Token &name)
+	{
+		Scope &scope = scopes.back();
+		int slot = scope.localCount++;
+		scope.variables[name.symbol.str()] = Variable{false, slot};
+		return slot;
 	}
 
-}
\ No newline at end of file
+}
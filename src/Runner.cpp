@@ -2,36 +2,38 @@
 #include "Common/utils.h"
 #include "Lexer/Lexer.h"
 #include "Parser/Parser.h"
+#include "Parser/AstCache.h"
 #include "Resolver/Resolver.h"
+#include "Optimizer/ConstantFolder.h"
+#include "Optimizer/TypeInferencer.h"
 #include "Interpreter/Interpreter.h"
+#include "Interpreter/ClosureCompiler.h"
+#include "Interpreter/ModuleLoader.h"
 #include "xmlTranspiler/Transpiler.h"
+#include "VM/VM.h"
 #include <iostream>
 #include <vector>
+#include <chrono>
 
 namespace CXX
 {
 
 	Interpreter Runner::interpreter = Interpreter();
 	Transpiler Runner::transpiler = Transpiler();
+	VM Runner::vm;
 	bool Runner::DEBUG = false;
+	bool Runner::USE_VM = false;
+	bool Runner::USE_CLOSURE = false;
+	bool Runner::LAZY = false;
 	Position *Runner::pos_start = nullptr;
 	Position *Runner::pos_end = nullptr;
 
-#ifdef USE_STRING_VIEW
-	static std::vector<std::string> TEXT;
-#endif
-
 	int Runner::runScript(const std::string &filename)
 	{
 		std::optional<std::string> content = readfile(filename);
 		if (content)
 		{
-#ifdef USE_STRING_VIEW
-			TEXT.push_back(std::move(content.value()));
-			return runCode(filename, TEXT.back());
-#else
 			return runCode(filename, *content);
-#endif
 		}
 
 		return -1;
@@ -55,41 +57,57 @@ namespace CXX
 				text += "\n" + input;
 			}
 
-#ifdef USE_STRING_VIEW
-			if (text.length() > 15)
-			{
-				TEXT.push_back(std::move(text));
-				runCode("<stdio>", TEXT.back(), true);
-			}
-			else
-#endif
-				runCode("<stdio>", text, true);
+			runCode("<stdio>", text, true);
 		}
 	}
 
-	std::optional<std::vector<StmtPtr>> getAST(const std::string &filename, const std::string &text)
+	bool Runner::lazyParsing()
 	{
-		Lexer lexer(filename, text);
-		std::vector<Token> tokens;
+		return LAZY && !USE_VM && !DEBUG && !AstCache::enabled();
+	}
+
+	// AST节点分配在arena中，使用AST期间须持有arena
+	// 源码来自文件(非REPL)时才使用AST缓存或延迟解析：缓存先查找，未命中则在Resolver处理后写入
+	std::optional<std::vector<StmtPtr>> getAST(const std::string &filename, const std::string &text, AstArenaPtr &arena,
+											   bool fromFile = false)
+	{
+		const SourceFile &source = SourceFile::add(filename, text);
+		bool cacheable = fromFile && !Runner::DEBUG && AstCache::enabled();
+		if (cacheable)
+		{
+			// 推断的类型不写入缓存，每次重新推断
+			if (auto cached = AstCache::load(source, AstCache::Unit::SCRIPT, arena))
+			{
+				TypeInferencer::infer(*cached);
+				return cached;
+			}
+		}
+
+		std::vector<StmtPtr> ast;
 		try
 		{
-			tokens = std::move(lexer.tokenize());
 			if (Runner::DEBUG)
 			{
-				for (auto &tok : tokens)
+				// 解析时Token是按需切分的，这里另外完整切分一遍用于输出
+				for (auto &tok : Lexer(filename, text).tokenize())
 				{
 					std::cout << tok.to_string() << "\n";
 				}
 			}
+
+			// Parser边解析边向Lexer索取Token，不保存完整的Token序列
+			Lexer lexer(source);
+			Parser parser(lexer, fromFile && Runner::lazyParsing());
+			ast = parser.parse();
+			arena = parser.arena();
 		}
 		catch (const std::exception &e)
 		{
+			// lexing error
 			ErrorReporter::report(e);
 			return std::nullopt;
 		}
 
-		Parser parser(std::move(tokens));
-		std::vector<StmtPtr> ast = parser.parse();
 		if (int errCnt = ErrorReporter::count())
 		{
 			return std::nullopt;
@@ -109,6 +127,12 @@ namespace CXX
 			return std::nullopt;
 		}
 
+		ConstantFolder(*arena).fold(ast);
+		TypeInferencer::infer(ast);
+
+		if (cacheable)
+			AstCache::store(source, AstCache::Unit::SCRIPT, ast);
+
 		return ast;
 	}
 
@@ -130,7 +154,8 @@ namespace CXX
 				text += "\n" + input;
 			}
 
-			auto ast_ptr = getAST("<stdio>", text);
+			AstArenaPtr arena;
+			auto ast_ptr = getAST("<stdio>", text, arena);
 			if (!ast_ptr)
 				continue;
 
@@ -144,19 +169,70 @@ namespace CXX
 		return 0;
 	}
 
+	int Runner::benchLexer(const std::string &filename)
+	{
+		std::optional<std::string> content = readfile(filename);
+		if (!content)
+			return -1;
+
+		constexpr int ROUNDS = 10;
+		size_t count = 0;
+		double best = 0;
+
+		for (int i = 0; i < ROUNDS; i++)
+		{
+			// 每轮都会向源码表登记一份源码，计时包含登记的拷贝
+			auto start = std::chrono::steady_clock::now();
+			Lexer lexer(filename, *content);
+			try
+			{
+				count = lexer.tokenize().size();
+			}
+			catch (const std::exception &e)
+			{
+				ErrorReporter::report(e);
+				return -1;
+			}
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			if (i == 0 || elapsed.count() < best)
+				best = elapsed.count();
+		}
+
+		std::cout << format("%zu tokens, %zu bytes, best of %d: %.3f ms\n", count, content->size(), ROUNDS, best * 1e3);
+		std::cout << format("%.2f Mtokens/s, %.1f MB/s\n", count / best / 1e6, content->size() / best / (1 << 20));
+		return 0;
+	}
+
 	int Runner::runCode(const std::string &filename, const std::string &text, bool repl)
 	{
 		interpreter.replEcho = repl ? true : false;
 
-		auto ast_ptr = getAST(filename, text);
+		AstArenaPtr arena;
+		auto ast_ptr = getAST(filename, text, arena, !repl);
 		if (!ast_ptr)
 			return -1;
 
 		std::vector<StmtPtr> &ast = ast_ptr.value();
 
+		// 执行期间，导入的模块在后台线程中并发解析
+		// 输出推断的类型时按导入的顺序解析，输出不会交错
+		if (!repl && !TypeInferencer::print)
+			ModuleLoader::prefetch(ast);
+
 		try
 		{
-			interpreter.interpret(std::move(ast));
+			if (USE_VM)
+				vm.interpret(ast, arena, repl);
+			else if (USE_CLOSURE)
+				ClosureCompiler::run(interpreter, ast);
+			else
+				interpreter.interpret(ast);
+		}
+		catch (const ReportedError &)
+		{
+			// 延迟解析的函数体出错，错误已在解析时输出
+			return -ErrorReporter::count();
 		}
 		catch (const std::exception &e)
 		{
@@ -0,0 +1,202 @@
+#include "VM/Chunk.h"
+#include "Common/Position.h"
+#include <iostream>
+#include <iomanip>
+
+namespace CXX
+{
+
+	void Chunk::write(uint8_t byte, Position *start, Position *end)
+	{
+		code.push_back(byte);
+		positions.emplace_back(start, end);
+	}
+
+	void Chunk::write(OpCode op, Position *start, Position *end)
+	{
+		write((uint8_t)op, start, end);
+	}
+
+	void Chunk::writeShort(uint16_t value, Position *start, Position *end)
+	{
+		write((uint8_t)((value >> 8) & 0xff), start, end);
+		write((uint8_t)(value & 0xff), start, end);
+	}
+
+	size_t Chunk::addConstant(const Object &value)
+	{
+		constants.push_back(value);
+		symbols.emplace_back();
+		return constants.size() - 1;
+	}
+
+	size_t Chunk::addName(Symbol name)
+	{
+		if (auto it = names.find(name); it != names.end())
+			return it->second;
+
+		size_t index = addConstant(Object(name.str()));
+		symbols[index] = name;
+		names.emplace(name, index);
+		return index;
+	}
+
+	static const char *opName(OpCode op)
+	{
+		switch (op)
+		{
+		case OpCode::CONSTANT:		return "CONSTANT";
+		case OpCode::NIL:			return "NIL";
+		case OpCode::TRUE:			return "TRUE";
+		case OpCode::FALSE:			return "FALSE";
+		case OpCode::POP:			return "POP";
+		case OpCode::DUP:			return "DUP";
+		case OpCode::DUP2:			return "DUP2";
+		case OpCode::GET_LOCAL:		return "GET_LOCAL";
+		case OpCode::SET_LOCAL:		return "SET_LOCAL";
+		case OpCode::GET_UPVALUE:	return "GET_UPVALUE";
+		case OpCode::SET_UPVALUE:	return "SET_UPVALUE";
+		case OpCode::DEFINE_GLOBAL: return "DEFINE_GLOBAL";
+		case OpCode::GET_GLOBAL:	return "GET_GLOBAL";
+		case OpCode::SET_GLOBAL:	return "SET_GLOBAL";
+		case OpCode::GET_PROPERTY:	return "GET_PROPERTY";
+		case OpCode::SET_PROPERTY:	return "SET_PROPERTY";
+		case OpCode::GET_INDEX:		return "GET_INDEX";
+		case OpCode::SET_INDEX:		return "SET_INDEX";
+		case OpCode::GET_SUPER:		return "GET_SUPER";
+		case OpCode::EQUAL:			return "EQUAL";
+		case OpCode::NOT_EQUAL:		return "NOT_EQUAL";
+		case OpCode::GREATER:		return "GREATER";
+		case OpCode::GREATER_EQUAL: return "GREATER_EQUAL";
+		case OpCode::LESS:			return "LESS";
+		case OpCode::LESS_EQUAL:	return "LESS_EQUAL";
+		case OpCode::ADD:			return "ADD";
+		case OpCode::SUBTRACT:		return "SUBTRACT";
+		case OpCode::MULTIPLY:		return "MULTIPLY";
+		case OpCode::DIVIDE:		return "DIVIDE";
+		case OpCode::MODULO:		return "MODULO";
+		case OpCode::NEGATE:		return "NEGATE";
+		case OpCode::NOT:			return "NOT";
+		case OpCode::TRUTHY:		return "TRUTHY";
+		case OpCode::INCREMENT:		return "INCREMENT";
+		case OpCode::JUMP:			return "JUMP";
+		case OpCode::JUMP_IF_FALSE: return "JUMP_IF_FALSE";
+		case OpCode::JUMP_IF_TRUE:	return "JUMP_IF_TRUE";
+		case OpCode::LOOP:			return "LOOP";
+		case OpCode::CALL:			return "CALL";
+		case OpCode::INVOKE:		return "INVOKE";
+		case OpCode::CLOSURE:		return "CLOSURE";
+		case OpCode::CLOSE_UPVALUE: return "CLOSE_UPVALUE";
+		case OpCode::RETURN:		return "RETURN";
+		case OpCode::CLASS:			return "CLASS";
+		case OpCode::INHERIT:		return "INHERIT";
+		case OpCode::METHOD:		return "METHOD";
+		case OpCode::LIST:			return "LIST";
+		case OpCode::IMPORT:		return "IMPORT";
+		case OpCode::IMPORT_SYMBOL: return "IMPORT_SYMBOL";
+		case OpCode::ECHO:			return "ECHO";
+		default:					return "UNKNOWN";
+		}
+	}
+
+	void Chunk::disassemble(const std::string &name) const
+	{
+		std::cout << "== " << name << " ==\n";
+
+		for (size_t offset = 0; offset < code.size();)
+		{
+			offset = disassembleInstruction(offset);
+		}
+	}
+
+	size_t Chunk::disassembleInstruction(size_t offset) const
+	{
+		auto readShort = [&](size_t at)
+		{ return (uint16_t)((code[at] << 8) | code[at + 1]); };
+
+		std::cout << std::setfill('0') << std::setw(4) << offset << std::setfill(' ') << " ";
+
+		const Position *pos = positions[offset].first;
+		if (offset > 0 && pos == positions[offset - 1].first)
+			std::cout << "   | ";
+		else
+			std::cout << std::setw(4) << (pos ? pos->row() + 1 : 0) << " ";
+
+		OpCode op = (OpCode)code[offset];
+		std::cout << std::left << std::setw(16) << opName(op) << std::right;
+
+		switch (op)
+		{
+		case OpCode::CONSTANT:
+		case OpCode::DEFINE_GLOBAL:
+		case OpCode::GET_GLOBAL:
+		case OpCode::SET_GLOBAL:
+		case OpCode::GET_PROPERTY:
+		case OpCode::SET_PROPERTY:
+		case OpCode::GET_SUPER:
+		case OpCode::CLASS:
+		case OpCode::METHOD:
+		{
+			uint16_t index = readShort(offset + 1);
+			std::cout << std::setw(4) << index << " '" << constants[index].to_string() << "'\n";
+			return offset + 3;
+		}
+
+		case OpCode::GET_LOCAL:
+		case OpCode::SET_LOCAL:
+		case OpCode::GET_UPVALUE:
+		case OpCode::SET_UPVALUE:
+		case OpCode::CALL:
+		case OpCode::INCREMENT:
+			std::cout << std::setw(4) << (int)code[offset + 1] << "\n";
+			return offset + 2;
+
+		case OpCode::JUMP:
+		case OpCode::JUMP_IF_FALSE:
+		case OpCode::JUMP_IF_TRUE:
+			std::cout << std::setw(4) << offset << " -> " << offset + 3 + readShort(offset + 1) << "\n";
+			return offset + 3;
+
+		case OpCode::LOOP:
+			std::cout << std::setw(4) << offset << " -> " << offset + 3 - readShort(offset + 1) << "\n";
+			return offset + 3;
+
+		case OpCode::LIST:
+		case OpCode::IMPORT:
+			std::cout << std::setw(4) << readShort(offset + 1) << "\n";
+			return offset + 3;
+
+		case OpCode::INVOKE:
+		{
+			uint16_t index = readShort(offset + 1);
+			std::cout << std::setw(4) << index << " '" << constants[index].to_string() << "' (" << (int)code[offset + 3] << " args)\n";
+			return offset + 4;
+		}
+
+		case OpCode::IMPORT_SYMBOL:
+		{
+			uint16_t index = readShort(offset + 3);
+			std::cout << std::setw(4) << readShort(offset + 1) << " '" << constants[index].to_string() << "'\n";
+			return offset + 5;
+		}
+
+		case OpCode::CLOSURE:
+		{
+			uint8_t count = code[offset + 3];
+			std::cout << std::setw(4) << readShort(offset + 1) << "\n";
+			offset += 4;
+			for (uint8_t i = 0; i < count; i++, offset += 2)
+			{
+				std::cout << std::setfill('0') << std::setw(4) << offset << std::setfill(' ') << "    |                     "
+						  << (code[offset] ? "local " : "upvalue ") << (int)code[offset + 1] << "\n";
+			}
+			return offset;
+		}
+
+		default:
+			std::cout << "\n";
+			return offset + 1;
+		}
+	}
+
+}
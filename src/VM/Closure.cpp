@@ -0,0 +1,115 @@
+#include "VM/Closure.h"
+#include "VM/VM.h"
+#include "Interpreter/Context.h"
+#include "Interpreter/Class.h"
+#include "Common/utils.h"
+#include "Runner.h"
+
+namespace CXX
+{
+
+	void Upvalue::trace(GarbageCollector &gc) const
+	{
+		// 仍在栈上的变量由虚拟机的栈持有
+		gc.mark(closed);
+		gc.mark(next);
+	}
+
+	void Upvalue::clear(std::vector<Object> &trash)
+	{
+		trash.push_back(std::move(closed));
+	}
+
+	Closure::Closure(PrototypePtr proto, ContextPtr globals)
+		: proto(std::move(proto)), globals(std::move(globals))
+	{
+		vmKind = VMKind::CLOSURE;
+	}
+
+	Object Closure::call(Interpreter &interpreter, const std::vector<Object> &arguments)
+	{
+		return Runner::vm.call(this, nullptr, arguments);
+	}
+
+	int Closure::arity()
+	{
+		return proto->arity;
+	}
+
+	size_t Closure::required_params()
+	{
+		return proto->arity - default_values.size();
+	}
+
+	CallablePtr Closure::bindThis(InstancePtr instance)
+	{
+		return std::make_shared<BoundMethod>(std::move(instance), shared_from_this());
+	}
+
+	std::string Closure::to_string()
+	{
+		if (proto->kind == FunctionKind::LAMBDA)
+			return "<anonymous function>";
+
+		return format("<function %s>", name().c_str());
+	}
+
+	std::string Closure::name()
+	{
+		return proto->name;
+	}
+
+	void Closure::trace(GarbageCollector &gc) const
+	{
+		for (auto &upvalue : upvalues)
+			gc.mark(upvalue);
+
+		for (auto &value : default_values)
+			gc.mark(value);
+
+		gc.mark(globals);
+	}
+
+	BoundMethod::BoundMethod(InstancePtr receiver, std::shared_ptr<Closure> method)
+		: receiver(std::move(receiver)), method(std::move(method))
+	{
+		vmKind = VMKind::BOUND_METHOD;
+	}
+
+	Object BoundMethod::call(Interpreter &interpreter, const std::vector<Object> &arguments)
+	{
+		return Runner::vm.call(method.get(), receiver, arguments);
+	}
+
+	int BoundMethod::arity()
+	{
+		return method->arity();
+	}
+
+	size_t BoundMethod::required_params()
+	{
+		return method->required_params();
+	}
+
+	CallablePtr BoundMethod::bindThis(InstancePtr instance)
+	{
+		return std::make_shared<BoundMethod>(std::move(instance), method);
+	}
+
+	std::string BoundMethod::to_string()
+	{
+		return method->to_string();
+	}
+
+	std::string BoundMethod::name()
+	{
+		return method->name();
+	}
+
+	void BoundMethod::trace(GarbageCollector &gc) const
+	{
+		gc.mark(receiver);
+		gc.mark(method);
+	}
+
+}
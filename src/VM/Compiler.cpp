@@ -0,0 +1,969 @@
+#include "VM/Compiler.h"
+#include "VM/CompilingError.h"
+#include "Parser/AstArena.h"
+#include "Common/utils.h"
+
+namespace CXX
+{
+
+	PrototypePtr Compiler::compile(const std::vector<StmtPtr> &statements, std::shared_ptr<const void> source, bool repl)
+	{
+		FunctionState state;
+		state.proto = std::make_shared<Prototype>();
+		state.proto->name = "script";
+		state.proto->kind = FunctionKind::SCRIPT;
+		state.proto->source = std::move(source);
+		// 0号槽位存放正在执行的闭包本身
+		state.locals.push_back({"", 0, false});
+
+		current = &state;
+		replEcho = repl;
+		pos_start = pos_end = nullptr;
+
+		Finally task([&]()
+					 { current = nullptr; });
+
+		for (auto &stmt : statements)
+		{
+			compile(stmt);
+		}
+
+		emit(OpCode::NIL);
+		emit(OpCode::RETURN);
+
+		state.proto->chunk.globalCache.resize(state.proto->chunk.constants.size());
+		return state.proto;
+	}
+
+	void Compiler::compile(Expr *expr)
+	{
+		Position *start = pos_start, *end = pos_end;
+		pos_start = &expr->pos_start;
+		pos_end = &expr->pos_end;
+
+		expr->accept(*this);
+
+		pos_start = start;
+		pos_end = end;
+	}
+
+	void Compiler::compile(Stmt *stmt)
+	{
+		Position *start = pos_start, *end = pos_end;
+		pos_start = &stmt->pos_start;
+		pos_end = &stmt->pos_end;
+
+		stmt->accept(*this);
+
+		pos_start = start;
+		pos_end = end;
+	}
+
+	void Compiler::visit(const ExpressionStmt *expressionStmt)
+	{
+		compile(expressionStmt->expr);
+
+		// 与树遍历解释器一致，REPL只回显顶层表达式的结果
+		if (replEcho && isGlobalScope())
+			emit(OpCode::ECHO);
+		else
+			emit(OpCode::POP);
+	}
+
+	void Compiler::visit(const VarDeclarationStmt *varStmt)
+	{
+		if (varStmt->expr)
+			compile(varStmt->expr.value());
+		else
+			emit(OpCode::NIL);
+
+		defineVariable(varStmt->identifier.symbol.str());
+	}
+
+	void Compiler::visit(FuncDeclarationStmt *funcDeclStmt)
+	{
+		// 先声明再定义，使函数体内可以递归调用自身
+		const std::string &name = funcDeclStmt->name.symbol.str();
+		declareVariable(name);
+
+		function(FunctionKind::FUNCTION, name, funcDeclStmt->params, funcDeclStmt->default_values, funcDeclStmt->body, funcDeclStmt->arena->shared_from_this());
+
+		defineVariable(name);
+	}
+
+	void Compiler::visit(const ClassDeclarationStmt *classDeclStmt)
+	{
+		const std::string &name = classDeclStmt->name.symbol.str();
+		declareVariable(name);
+
+		emitShort(OpCode::CLASS, makeName(Symbol(name)));
+		defineVariable(name);
+
+		Variable classVar = resolveVariable(name);
+
+		if (classDeclStmt->superClass)
+		{
+			compile(classDeclStmt->superClass.value());
+			emitVariable(classVar.get, classVar.arg);
+
+			// 报错位置应为父类表达式
+			Position *start = pos_start, *end = pos_end;
+			pos_start = &classDeclStmt->superClass.value()->pos_start;
+			pos_end = &classDeclStmt->superClass.value()->pos_end;
+			emit(OpCode::INHERIT);
+			pos_start = start;
+			pos_end = end;
+		}
+
+		emitVariable(classVar.get, classVar.arg);
+		for (auto &method : classDeclStmt->methods)
+		{
+			Position *start = pos_start, *end = pos_end;
+			pos_start = &method->pos_start;
+			pos_end = &method->pos_end;
+
+			function(FunctionKind::METHOD, method->name.symbol.str(), method->params, method->default_values, method->body, method->arena->shared_from_this());
+			emitShort(OpCode::METHOD, makeName(method->name.symbol));
+
+			pos_start = start;
+			pos_end = end;
+		}
+		emit(OpCode::POP);
+	}
+
+	void Compiler::visit(const BlockStmt *blockStmt)
+	{
+		beginScope();
+		for (auto &stmt : blockStmt->statements)
+		{
+			compile(stmt);
+		}
+		endScope();
+	}
+
+	void Compiler::visit(const IfStmt *ifStmt)
+	{
+		compile(ifStmt->condition);
+		size_t thenJump = emitJump(OpCode::JUMP_IF_FALSE);
+
+		compile(ifStmt->thenBranch);
+
+		if (ifStmt->elseBranch)
+		{
+			size_t elseJump = emitJump(OpCode::JUMP);
+			patchJump(thenJump);
+			compile(ifStmt->elseBranch.value());
+			patchJump(elseJump);
+		}
+		else
+		{
+			patchJump(thenJump);
+		}
+	}
+
+	void Compiler::visit(const WhileStmt *whileStmt)
+	{
+		size_t loopStart = chunk().code.size();
+		current->loops.push_back({current->scopeDepth, loopStart, {}, {}});
+
+		compile(whileStmt->condition);
+		size_t exitJump = emitJump(OpCode::JUMP_IF_FALSE);
+
+		compile(whileStmt->body);
+
+		for (size_t jump : current->loops.back().continues)
+			patchJump(jump);
+		emitLoop(loopStart);
+
+		patchJump(exitJump);
+		for (size_t jump : current->loops.back().breaks)
+			patchJump(jump);
+		current->loops.pop_back();
+	}
+
+	void Compiler::visit(const ForStmt *forStmt)
+	{
+		// 与树遍历解释器一致，整个循环共享一个变量环境
+		beginScope();
+
+		if (forStmt->initializer)
+			compile(forStmt->initializer.value());
+
+		size_t loopStart = chunk().code.size();
+		current->loops.push_back({current->scopeDepth, loopStart, {}, {}});
+
+		std::optional<size_t> exitJump;
+		if (forStmt->condition)
+		{
+			compile(forStmt->condition.value());
+			exitJump = emitJump(OpCode::JUMP_IF_FALSE);
+		}
+
+		compile(forStmt->body);
+
+		// continue跳转至increment
+		for (size_t jump : current->loops.back().continues)
+			patchJump(jump);
+
+		if (forStmt->increment)
+		{
+			compile(forStmt->increment.value());
+			emit(OpCode::POP);
+		}
+		emitLoop(loopStart);
+
+		if (exitJump)
+			patchJump(*exitJump);
+		for (size_t jump : current->loops.back().breaks)
+			patchJump(jump);
+		current->loops.pop_back();
+
+		endScope();
+	}
+
+	void Compiler::visit(const BreakStmt *breakStmt)
+	{
+		if (current->loops.empty())
+			error("Can't use 'break' outside of a loop");
+
+		Loop &loop = current->loops.back();
+		discardLocals(loop.scopeDepth);
+		loop.breaks.push_back(emitJump(OpCode::JUMP));
+	}
+
+	void Compiler::visit(const ContinueStmt *continueStmt)
+	{
+		if (current->loops.empty())
+			error("Can't use 'continue' outside of a loop");
+
+		Loop &loop = current->loops.back();
+		discardLocals(loop.scopeDepth);
+		loop.continues.push_back(emitJump(OpCode::JUMP));
+	}
+
+	void Compiler::visit(const ReturnStmt *returnStmt)
+	{
+		if (returnStmt->expr)
+			compile(returnStmt->expr.value());
+		else
+			emit(OpCode::NIL);
+
+		emit(OpCode::RETURN);
+	}
+
+	void Compiler::visit(const ImportStmt *importStmt)
+	{
+		auto &imports = current->proto->imports;
+		if (imports.size() > UINT16_MAX)
+			error("Too many imports in one chunk");
+
+		uint16_t index = (uint16_t)imports.size();
+		imports.push_back(importStmt);
+
+		emitShort(OpCode::IMPORT, index);
+
+		// import { * } 在运行时直接写入全局环境
+		if (importStmt->symbols.begin()->first.type == TokenType::MUL)
+			return;
+
+		for (const auto &[symbol, alias] : importStmt->symbols)
+		{
+			Position *start = pos_start, *end = pos_end;
+			pos_start = const_cast<Position *>(&symbol.pos_start);
+			pos_end = const_cast<Position *>(&symbol.pos_end);
+
+			emitShort(OpCode::IMPORT_SYMBOL, index);
+			chunk().writeShort(makeName(symbol.symbol), pos_start, pos_end);
+
+			pos_start = start;
+			pos_end = end;
+
+			defineVariable(alias ? alias->symbol.str() : symbol.symbol.str());
+		}
+	}
+
+	void Compiler::visit(const PackStmt *packStmt)
+	{
+		for (auto const &stmt : packStmt->statements)
+		{
+			compile(stmt);
+		}
+	}
+
+	Object Compiler::visit(const BinaryExpr *binaryExpr)
+	{
+		compile(binaryExpr->left);
+		compile(binaryExpr->right);
+
+		// 运算出错时指向运算符，与解释执行一致
+		Position *start = pos_start, *end = pos_end;
+		pos_start = const_cast<Position *>(&binaryExpr->op.pos_start);
+		pos_end = const_cast<Position *>(&binaryExpr->op.pos_end);
+
+		switch (binaryExpr->op.type)
+		{
+		case TokenType::PLUS:
+			emit(OpCode::ADD);
+			break;
+		case TokenType::MINUS:
+			emit(OpCode::SUBTRACT);
+			break;
+		case TokenType::MUL:
+			emit(OpCode::MULTIPLY);
+			break;
+		case TokenType::DIV:
+			emit(OpCode::DIVIDE);
+			break;
+		case TokenType::MOD:
+			emit(OpCode::MODULO);
+			break;
+		case TokenType::GT:
+			emit(OpCode::GREATER);
+			break;
+		case TokenType::GTE:
+			emit(OpCode::GREATER_EQUAL);
+			break;
+		case TokenType::LT:
+			emit(OpCode::LESS);
+			break;
+		case TokenType::LTE:
+			emit(OpCode::LESS_EQUAL);
+			break;
+		case TokenType::EQEQ:
+			emit(OpCode::EQUAL);
+			break;
+		case TokenType::BANGEQ:
+			emit(OpCode::NOT_EQUAL);
+			break;
+		default:
+			error("Invalid Binary operand");
+		}
+
+		pos_start = start;
+		pos_end = end;
+		return Object();
+	}
+
+	Object Compiler::visit(const UnaryExpr *unaryExpr)
+	{
+		compile(unaryExpr->expr);
+
+		Position *start = pos_start, *end = pos_end;
+		pos_start = const_cast<Position *>(&unaryExpr->op.pos_start);
+		pos_end = const_cast<Position *>(&unaryExpr->op.pos_end);
+
+		switch (unaryExpr->op.type)
+		{
+		case TokenType::MINUS:
+			emit(OpCode::NEGATE);
+			break;
+		case TokenType::BANG:
+			emit(OpCode::NOT);
+			break;
+		default:
+			error("Invalid Unary operand");
+		}
+
+		pos_start = start;
+		pos_end = end;
+		return Object();
+	}
+
+	Object Compiler::visit(const LiteralExpr *literalExpr)
+	{
+		const Object &value = literalExpr->value;
+		if (value.isNil())
+			emit(OpCode::NIL);
+		else if (value.isBoolean())
+			emit(value.getBoolean() ? OpCode::TRUE : OpCode::FALSE);
+		else
+			emitShort(OpCode::CONSTANT, makeConstant(value));
+
+		return Object();
+	}
+
+	Object Compiler::visit(const VariableExpr *variableExpr)
+	{
+		Variable var = resolveVariable(variableExpr->identifier.symbol.str());
+		emitVariable(var.get, var.arg);
+		return Object();
+	}
+
+	Object Compiler::visit(const AssignmentExpr *assignmentExpr)
+	{
+		Variable var = resolveVariable(assignmentExpr->identifier.symbol.str());
+		TokenType op = assignmentExpr->operation.type;
+
+		if (op != TokenType::EQ)
+			emitVariable(var.get, var.arg);
+
+		compile(assignmentExpr->value);
+
+		switch (op)
+		{
+		case TokenType::PLUS_EQUAL:
+			emit(OpCode::ADD);
+			break;
+		case TokenType::MINUS_EQUAL:
+			emit(OpCode::SUBTRACT);
+			break;
+		case TokenType::MUL_EQUAL:
+			emit(OpCode::MULTIPLY);
+			break;
+		case TokenType::DIV_EQUAL:
+			emit(OpCode::DIVIDE);
+			break;
+		default:
+			break;
+		}
+
+		emitVariable(var.set, var.arg);
+		return Object();
+	}
+
+	Object Compiler::visit(const TernaryExpr *ternaryExpr)
+	{
+		compile(ternaryExpr->expr);
+		size_t elseJump = emitJump(OpCode::JUMP_IF_FALSE);
+
+		compile(ternaryExpr->thenBranch);
+		size_t endJump = emitJump(OpCode::JUMP);
+
+		patchJump(elseJump);
+		compile(ternaryExpr->elseBranch);
+		patchJump(endJump);
+
+		return Object();
+	}
+
+	Object Compiler::visit(LambdaExpr *lambdaExpr)
+	{
+		function(FunctionKind::LAMBDA, "anonymous", lambdaExpr->params, lambdaExpr->default_values, lambdaExpr->body, lambdaExpr->arena->shared_from_this());
+		return Object();
+	}
+
+	Object Compiler::visit(const OrExpr *orExpr)
+	{
+		// 与树遍历解释器一致，逻辑运算的结果为bool
+		compile(orExpr->left);
+		size_t trueJump = emitJump(OpCode::JUMP_IF_TRUE);
+
+		compile(orExpr->right);
+		emit(OpCode::TRUTHY);
+		size_t endJump = emitJump(OpCode::JUMP);
+
+		patchJump(trueJump);
+		emit(OpCode::TRUE);
+		patchJump(endJump);
+
+		return Object();
+	}
+
+	Object Compiler::visit(const AndExpr *andExpr)
+	{
+		compile(andExpr->left);
+		size_t falseJump = emitJump(OpCode::JUMP_IF_FALSE);
+
+		compile(andExpr->right);
+		emit(OpCode::TRUTHY);
+		size_t endJump = emitJump(OpCode::JUMP);
+
+		patchJump(falseJump);
+		emit(OpCode::FALSE);
+		patchJump(endJump);
+
+		return Object();
+	}
+
+	Object Compiler::visit(const IncrementExpr *incrementExpr)
+	{
+		bool postfix = incrementExpr->type == IncrementExpr::Type::POSTFIX;
+		step(incrementExpr->holder, postfix ? 2 : 0);
+		return Object();
+	}
+
+	Object Compiler::visit(const DecrementExpr *decrementExpr)
+	{
+		bool postfix = decrementExpr->type == DecrementExpr::Type::POSTFIX;
+		step(decrementExpr->holder, (postfix ? 2 : 0) | 1);
+		return Object();
+	}
+
+	Object Compiler::visit(const CallExpr *callExpr)
+	{
+		if (callExpr->arguments.size() > UINT8_MAX)
+			error("Can't have more than 255 arguments");
+
+		uint8_t argc = (uint8_t)callExpr->arguments.size();
+		const Expr *callee = callExpr->callee;
+		const Expr *culprit = callExpr->culprit();
+
+		// 操作码处记录被调用的表达式，argc处记录原生函数的报错位置，与解释执行一致
+		// 参数个数错误指向整个调用表达式，由VM用两者拼出
+		Position *start = pos_start, *end = pos_end;
+
+		// obj.method(...) 直接调用方法，不必先创建绑定了this的函数
+		if (callee->exprType == ExprType::Retrieve &&
+			static_cast<const RetrieveExpr *>(callee)->type == RetrieveExpr::OpType::DOT)
+		{
+			auto retrieve = static_cast<const RetrieveExpr *>(callee);
+			compile(retrieve->holder);
+			for (auto &arg : callExpr->arguments)
+				compile(arg);
+
+			pos_start = const_cast<Position *>(&callee->pos_start);
+			pos_end = const_cast<Position *>(&callee->pos_end);
+			emitShort(OpCode::INVOKE, makeName(retrieve->identifier.symbol));
+		}
+		else
+		{
+			compile(callExpr->callee);
+			for (auto &arg : callExpr->arguments)
+				compile(arg);
+
+			pos_start = const_cast<Position *>(&callee->pos_start);
+			pos_end = const_cast<Position *>(&callee->pos_end);
+			chunk().write(OpCode::CALL, pos_start, pos_end);
+		}
+
+		chunk().write(argc, const_cast<Position *>(&culprit->pos_start), const_cast<Position *>(&culprit->pos_end));
+
+		pos_start = start;
+		pos_end = end;
+		return Object();
+	}
+
+	Object Compiler::visit(const RetrieveExpr *retrieveExpr)
+	{
+		compile(retrieveExpr->holder);
+
+		if (retrieveExpr->type == RetrieveExpr::OpType::DOT)
+		{
+			emitShort(OpCode::GET_PROPERTY, makeName(retrieveExpr->identifier.symbol));
+		}
+		else
+		{
+			compile(retrieveExpr->index);
+			emit(OpCode::GET_INDEX);
+		}
+
+		return Object();
+	}
+
+	Object Compiler::visit(const SetExpr *setExpr)
+	{
+		TokenType op = setExpr->operation.type;
+		OpCode binary = op == TokenType::PLUS_EQUAL	   ? OpCode::ADD
+						: op == TokenType::MINUS_EQUAL ? OpCode::SUBTRACT
+						: op == TokenType::MUL_EQUAL   ? OpCode::MULTIPLY
+													   : OpCode::DIVIDE;
+
+		compile(setExpr->holder);
+
+		if (setExpr->type == RetrieveExpr::OpType::DOT)
+		{
+			uint16_t name = makeName(setExpr->identifier.symbol);
+			if (op != TokenType::EQ)
+			{
+				emit(OpCode::DUP);
+				emitShort(OpCode::GET_PROPERTY, name);
+				compile(setExpr->value);
+				emit(binary);
+			}
+			else
+			{
+				compile(setExpr->value);
+			}
+
+			emitShort(OpCode::SET_PROPERTY, name);
+		}
+		else
+		{
+			compile(setExpr->index);
+			if (op != TokenType::EQ)
+			{
+				emit(OpCode::DUP2);
+				emit(OpCode::GET_INDEX);
+				compile(setExpr->value);
+				emit(binary);
+			}
+			else
+			{
+				compile(setExpr->value);
+			}
+
+			emit(OpCode::SET_INDEX);
+		}
+
+		return Object();
+	}
+
+	Object Compiler::visit(const ThisExpr *thisExpr)
+	{
+		Variable var = resolveVariable("this");
+		emitVariable(var.get, var.arg);
+		return Object();
+	}
+
+	Object Compiler::visit(const SuperExpr *superExpr)
+	{
+		Variable var = resolveVariable("this");
+		emitVariable(var.get, var.arg);
+		emitShort(OpCode::GET_SUPER, makeName(superExpr->identifier.symbol));
+		return Object();
+	}
+
+	Object Compiler::visit(const ListExpr *listExpr)
+	{
+		if (listExpr->items.size() > UINT16_MAX)
+			error("Too many items in list literal");
+
+		for (auto &item : listExpr->items)
+			compile(item);
+
+		emitShort(OpCode::LIST, (uint16_t)listExpr->items.size());
+		return Object();
+	}
+
+	Object Compiler::visit(const PackExpr *packExpr)
+	{
+		// 对于用','分隔的一整句，返回最后一个值
+		bool first = true;
+		for (auto const &expr : packExpr->expressions)
+		{
+			if (!first)
+				emit(OpCode::POP);
+			compile(expr);
+			first = false;
+		}
+
+		if (first)
+			emit(OpCode::NIL);
+
+		return Object();
+	}
+
+	void Compiler::function(FunctionKind kind, const std::string &name, const std::vector<Token> &params,
+							const std::vector<ExprPtr> &default_values, const std::vector<StmtPtr> &body,
+							std::shared_ptr<const void> source)
+	{
+		// 默认值在定义函数时于外层作用域中求值，由CLOSURE指令收集
+		for (auto &value : default_values)
+			compile(value);
+
+		FunctionState state;
+		state.enclosing = current;
+		state.proto = std::make_shared<Prototype>();
+		state.proto->name = name;
+		state.proto->kind = kind;
+		state.proto->arity = (int)params.size();
+		state.proto->defaults = default_values.size();
+		state.proto->source = std::move(source);
+		state.locals.push_back({kind == FunctionKind::METHOD ? "this" : "", 0, false});
+		state.scopeDepth = 1;
+
+		current = &state;
+		{
+			Finally task([&]()
+						 { current = state.enclosing; });
+
+			for (auto &param : params)
+			{
+				if (state.locals.size() > UINT8_MAX)
+					error("Too many local variables in function");
+				state.locals.push_back({param.symbol.str(), 1, false});
+			}
+
+			for (auto &stmt : body)
+				compile(stmt);
+
+			emit(OpCode::NIL);
+			emit(OpCode::RETURN);
+		}
+
+		PrototypePtr proto = state.proto;
+		proto->upvalueCount = (int)state.upvalues.size();
+		proto->chunk.globalCache.resize(proto->chunk.constants.size());
+
+		auto &protos = current->proto->protos;
+		if (protos.size() > UINT16_MAX)
+			error("Too many functions in one chunk");
+
+		emitShort(OpCode::CLOSURE, (uint16_t)protos.size());
+		chunk().write((uint8_t)state.upvalues.size(), pos_start, pos_end);
+		protos.push_back(std::move(proto));
+
+		for (auto &upvalue : state.upvalues)
+		{
+			chunk().write(upvalue.isLocal ? 1 : 0, pos_start, pos_end);
+			chunk().write(upvalue.index, pos_start, pos_end);
+		}
+	}
+
+	void Compiler::step(const Expr *holder, uint8_t flags)
+	{
+		// holder只可能是Variable或Retrieve
+		// INCREMENT的报错位置应为holder
+		auto increment = [&](uint8_t holders)
+		{
+			Position *start = pos_start, *end = pos_end;
+			pos_start = const_cast<Position *>(&holder->pos_start);
+			pos_end = const_cast<Position *>(&holder->pos_end);
+			emit(OpCode::INCREMENT, flags | (holders << 2));
+			pos_start = start;
+			pos_end = end;
+		};
+
+		if (holder->exprType == ExprType::Variable)
+		{
+			Variable var = resolveVariable(static_cast<const VariableExpr *>(holder)->identifier.symbol.str());
+			emitVariable(var.get, var.arg);
+			increment(0);
+			emitVariable(var.set, var.arg);
+		}
+		else
+		{
+			auto retrieve = static_cast<const RetrieveExpr *>(holder);
+			compile(retrieve->holder);
+
+			if (retrieve->type == RetrieveExpr::OpType::DOT)
+			{
+				uint16_t name = makeName(retrieve->identifier.symbol);
+				emit(OpCode::DUP);
+				emitShort(OpCode::GET_PROPERTY, name);
+				increment(1);
+				emitShort(OpCode::SET_PROPERTY, name);
+			}
+			else
+			{
+				compile(retrieve->index);
+				emit(OpCode::DUP2);
+				emit(OpCode::GET_INDEX);
+				increment(2);
+				emit(OpCode::SET_INDEX);
+			}
+		}
+
+		// 栈上为 [返回值, 新值]
+		emit(OpCode::POP);
+	}
+
+	Chunk &Compiler::chunk()
+	{
+		return current->proto->chunk;
+	}
+
+	void Compiler::emit(OpCode op)
+	{
+		chunk().write(op, pos_start, pos_end);
+	}
+
+	void Compiler::emit(OpCode op, uint8_t operand)
+	{
+		chunk().write(op, pos_start, pos_end);
+		chunk().write(operand, pos_start, pos_end);
+	}
+
+	void Compiler::emitShort(OpCode op, uint16_t operand)
+	{
+		chunk().write(op, pos_start, pos_end);
+		chunk().writeShort(operand, pos_start, pos_end);
+	}
+
+	void Compiler::emitVariable(OpCode op, uint16_t operand)
+	{
+		// 局部变量与upvalue的下标为u8，全局变量为常量下标u16
+		if (op == OpCode::GET_GLOBAL || op == OpCode::SET_GLOBAL)
+			emitShort(op, operand);
+		else
+			emit(op, (uint8_t)operand);
+	}
+
+	size_t Compiler::emitJump(OpCode op)
+	{
+		emitShort(op, 0xffff);
+		return chunk().code.size() - 2;
+	}
+
+	void Compiler::patchJump(size_t offset)
+	{
+		// 跳过操作数本身
+		size_t jump = chunk().code.size() - offset - 2;
+		if (jump > UINT16_MAX)
+			error("Too much code to jump over");
+
+		chunk().code[offset] = (jump >> 8) & 0xff;
+		chunk().code[offset + 1] = jump & 0xff;
+	}
+
+	void Compiler::emitLoop(size_t start)
+	{
+		size_t offset = chunk().code.size() - start + 3;
+		if (offset > UINT16_MAX)
+			error("Loop body too large");
+
+		emitShort(OpCode::LOOP, (uint16_t)offset);
+	}
+
+	uint16_t Compiler::makeConstant(const Object &value)
+	{
+		size_t index = chunk().addConstant(value);
+		if (index > UINT16_MAX)
+			error("Too many constants in one chunk");
+
+		return (uint16_t)index;
+	}
+
+	uint16_t Compiler::makeName(Symbol name)
+	{
+		size_t index = chunk().addName(name);
+		if (index > UINT16_MAX)
+			error("Too many constants in one chunk");
+
+		return (uint16_t)index;
+	}
+
+	void Compiler::beginScope()
+	{
+		current->scopeDepth++;
+	}
+
+	void Compiler::endScope()
+	{
+		current->scopeDepth--;
+
+		auto &locals = current->locals;
+		while (!locals.empty() && locals.back().depth > current->scopeDepth)
+		{
+			emit(locals.back().isCaptured ? OpCode::CLOSE_UPVALUE : OpCode::POP);
+			locals.pop_back();
+		}
+	}
+
+	void Compiler::discardLocals(int depth)
+	{
+		auto &locals = current->locals;
+		for (auto it = locals.rbegin(); it != locals.rend() && it->depth > depth; ++it)
+		{
+			emit(it->isCaptured ? OpCode::CLOSE_UPVALUE : OpCode::POP);
+		}
+	}
+
+	void Compiler::declareVariable(const std::string &name)
+	{
+		if (isGlobalScope())
+			return;
+
+		// 同一作用域内重复声明时沿用原有槽位
+		auto &locals = current->locals;
+		for (auto it = locals.rbegin(); it != locals.rend() && it->depth == current->scopeDepth; ++it)
+		{
+			if (it->name == name)
+				return;
+		}
+
+		// 此时值尚未压栈，先占位，值随后写入该槽位
+		emit(OpCode::NIL);
+		if (locals.size() > UINT8_MAX)
+			error("Too many local variables in function");
+		locals.push_back({name, current->scopeDepth, false});
+	}
+
+	void Compiler::defineVariable(const std::string &name)
+	{
+		// 栈顶为变量的值
+		if (isGlobalScope())
+		{
+			emitShort(OpCode::DEFINE_GLOBAL, makeName(Symbol(name)));
+			return;
+		}
+
+		auto &locals = current->locals;
+		for (int i = (int)locals.size() - 1; i >= 0 && locals[i].depth == current->scopeDepth; i--)
+		{
+			if (locals[i].name == name)
+			{
+				emit(OpCode::SET_LOCAL, (uint8_t)i);
+				emit(OpCode::POP);
+				return;
+			}
+		}
+
+		if (locals.size() > UINT8_MAX)
+			error("Too many local variables in function");
+		locals.push_back({name, current->scopeDepth, false});
+	}
+
+	Compiler::Variable Compiler::resolveVariable(const std::string &name)
+	{
+		if (int slot = resolveLocal(current, name); slot != -1)
+			return {OpCode::GET_LOCAL, OpCode::SET_LOCAL, (uint16_t)slot};
+
+		if (int index = resolveUpvalue(current, name); index != -1)
+			return {OpCode::GET_UPVALUE, OpCode::SET_UPVALUE, (uint16_t)index};
+
+		return {OpCode::GET_GLOBAL, OpCode::SET_GLOBAL, makeName(Symbol(name))};
+	}
+
+	int Compiler::resolveLocal(FunctionState *state, const std::string &name)
+	{
+		auto &locals = state->locals;
+		for (int i = (int)locals.size() - 1; i >= 0; i--)
+		{
+			if (locals[i].name == name)
+				return i;
+		}
+
+		return -1;
+	}
+
+	int Compiler::resolveUpvalue(FunctionState *state, const std::string &name)
+	{
+		// 顶层代码中的变量均为全局变量，不需要捕获
+		if (state->enclosing == nullptr)
+			return -1;
+
+		if (int local = resolveLocal(state->enclosing, name); local != -1)
+		{
+			state->enclosing->locals[local].isCaptured = true;
+			return addUpvalue(state, (uint8_t)local, true);
+		}
+
+		if (int upvalue = resolveUpvalue(state->enclosing, name); upvalue != -1)
+		{
+			return addUpvalue(state, (uint8_t)upvalue, false);
+		}
+
+		return -1;
+	}
+
+	int Compiler::addUpvalue(FunctionState *state, uint8_t index, bool isLocal)
+	{
+		auto &upvalues = state->upvalues;
+		for (size_t i = 0; i < upvalues.size(); i++)
+		{
+			if (upvalues[i].index == index && upvalues[i].isLocal == isLocal)
+				return (int)i;
+		}
+
+		if (upvalues.size() > UINT8_MAX)
+			error("Too many closure variables in function");
+
+		upvalues.push_back({index, isLocal});
+		return (int)upvalues.size() - 1;
+	}
+
+	bool Compiler::isGlobalScope() const
+	{
+		return current->proto->kind == FunctionKind::SCRIPT && current->scopeDepth == 0;
+	}
+
+	void Compiler::error(const std::string &message)
+	{
+		if (pos_start && pos_end)
+			throw CompilingError(*pos_start, *pos_end, message);
+
+		throw CompilingError(Position::preset, Position::preset, message);
+	}
+
+}
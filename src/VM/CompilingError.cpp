@@ -0,0 +1,9 @@
+#include "VM/CompilingError.h"
+
+namespace CXX {
+
+    CompilingError::CompilingError(const Position& start, const Position& end, std::string details) :
+        Error(start, end, "Compiling Error", std::move(details))
+    {}
+
+}
@@ -0,0 +1,977 @@
+#include "VM/VM.h"
+#include "VM/Compiler.h"
+#include "Common/utils.h"
+#include "Parser/Stmt.h"
+#include "Interpreter/Interpreter.h"
+#include "Interpreter/Class.h"
+#include "Interpreter/MetaList.h"
+#include "Interpreter/MetaMap.h"
+#include "Interpreter/MetaFloat64Array.h"
+#include "Interpreter/Specialize.h"
+#include "Interpreter/RuntimeError.h"
+#include "Interpreter/loxlib/NativeClass.h"
+#include "Runner.h"
+#include <iostream>
+
+namespace CXX
+{
+
+	static void disassemble(const Prototype &proto)
+	{
+		proto.chunk.disassemble(proto.name);
+		for (auto &inner : proto.protos)
+		{
+			disassemble(*inner);
+		}
+	}
+
+	VM::VM() : stack(STACK_MAX), frames(FRAMES_MAX)
+	{
+		stackTop = stack.data();
+		stackEnd = stack.data() + stack.size();
+	}
+
+	void VM::interpret(const std::vector<StmtPtr> &statements, AstArenaPtr arena, bool repl)
+	{
+		// 编译产物中的位置信息指向AST，由Prototype持有arena保活
+		Compiler compiler;
+		PrototypePtr proto = compiler.compile(statements, std::move(arena), repl);
+		if (Runner::DEBUG)
+		{
+			disassemble(*proto);
+		}
+
+		auto script = std::make_shared<Closure>(std::move(proto), Runner::interpreter.globalContext);
+		call(script.get(), nullptr, {});
+	}
+
+	Object VM::call(Closure *closure, const InstancePtr &receiver, const std::vector<Object> &arguments)
+	{
+		size_t exitDepth = frameCount;
+
+		try
+		{
+			// 0号槽位：类成员函数为this，否则为函数本身
+			if (receiver)
+				push(Object(receiver));
+			else
+				push(Object(CallablePtr(closure->shared_from_this())));
+
+			for (auto &arg : arguments)
+				push(arg);
+
+			calleeSpan = culpritSpan = {};
+			callClosure(closure, (int)arguments.size());
+			return run(exitDepth);
+		}
+		catch (...)
+		{
+			// 出错时调用栈已无法恢复，由最外层负责清理
+			if (exitDepth == 0)
+				reset();
+			throw;
+		}
+	}
+
+	Object VM::run(size_t exitDepth)
+	{
+		CallFrame *frame = &frames[frameCount - 1];
+		Chunk *chunk = &frame->closure->proto->chunk;
+		const uint8_t *ip = frame->ip;
+		const uint8_t *inst = ip;
+
+#define READ_BYTE() (*ip++)
+#define READ_SHORT() (ip += 2, (uint16_t)((ip[-2] << 8) | ip[-1]))
+#define READ_NAME() (chunk->symbols[READ_SHORT()])
+
+// 可能报错或调用其他代码前，保存ip并让Runner跟踪当前执行位置
+#define SYNC()                                                           \
+	do                                                                   \
+	{                                                                    \
+		frame->ip = ip;                                                  \
+		auto &position = chunk->positions[inst - chunk->code.data()];    \
+		Runner::pos_start = position.first;                              \
+		Runner::pos_end = position.second;                               \
+	} while (0)
+
+#define RELOAD()                                      \
+	do                                                \
+	{                                                 \
+		frame = &frames[frameCount - 1];              \
+		chunk = &frame->closure->proto->chunk;        \
+		ip = frame->ip;                               \
+	} while (0)
+
+#define NUMBER_OP(op, fallback)                                      \
+	do                                                               \
+	{                                                                \
+		Object &a = peek(1), &b = peek(0);                           \
+		if (a.isNumber() && b.isNumber())                            \
+		{                                                            \
+			a = Object(a.asNumber() op b.asNumber());                \
+			pop();                                                   \
+			break;                                                   \
+		}                                                            \
+		SYNC();                                                      \
+		Object result = fallback;                                    \
+		pop();                                                       \
+		peek(0) = std::move(result);                                 \
+	} while (0)
+
+		for (;;)
+		{
+			inst = ip;
+			switch ((OpCode)READ_BYTE())
+			{
+			case OpCode::CONSTANT:
+				push(chunk->constants[READ_SHORT()]);
+				break;
+
+			case OpCode::NIL:
+				push(Object());
+				break;
+
+			case OpCode::TRUE:
+				push(Object(true));
+				break;
+
+			case OpCode::FALSE:
+				push(Object(false));
+				break;
+
+			case OpCode::POP:
+				pop();
+				break;
+
+			case OpCode::DUP:
+				push(peek(0));
+				break;
+
+			case OpCode::DUP2:
+				push(peek(1));
+				push(peek(1));
+				break;
+
+			case OpCode::GET_LOCAL:
+				push(frame->slots[READ_BYTE()]);
+				break;
+
+			case OpCode::SET_LOCAL:
+				frame->slots[READ_BYTE()] = peek(0);
+				break;
+
+			case OpCode::GET_UPVALUE:
+				push(*frame->closure->upvalues[READ_BYTE()]->location);
+				break;
+
+			case OpCode::SET_UPVALUE:
+				*frame->closure->upvalues[READ_BYTE()]->location = peek(0);
+				break;
+
+			case OpCode::DEFINE_GLOBAL:
+			{
+				Symbol name = READ_NAME();
+				frame->closure->globals->set(name, peek(0));
+				pop();
+				break;
+			}
+
+			case OpCode::GET_GLOBAL:
+			{
+				uint16_t index = READ_SHORT();
+				Context *globals = frame->closure->globals.get();
+				auto &cache = chunk->globalCache[index];
+				if (cache.context == globals)
+				{
+					push(*cache.slot);
+					break;
+				}
+
+				Symbol name = chunk->symbols[index];
+				if (auto it = globals->variables.find(name); it != globals->variables.end())
+				{
+					cache = {globals, &it->second};
+					push(it->second);
+					break;
+				}
+
+				// 内置函数等位于上层环境，不做缓存
+				Object &value = globals->get(name);
+				if (&value == &Object::Nil())
+				{
+					SYNC();
+					runtimeError(format("Undefined variable %s", name.c_str()));
+				}
+				push(value);
+				break;
+			}
+
+			case OpCode::SET_GLOBAL:
+			{
+				uint16_t index = READ_SHORT();
+				Context *globals = frame->closure->globals.get();
+				auto &cache = chunk->globalCache[index];
+				if (cache.context == globals)
+				{
+					*cache.slot = peek(0);
+					break;
+				}
+
+				Symbol name = chunk->symbols[index];
+				if (auto it = globals->variables.find(name); it != globals->variables.end())
+				{
+					cache = {globals, &it->second};
+					it->second = peek(0);
+					break;
+				}
+
+				Object &value = globals->get(name);
+				if (&value == &Object::Nil())
+				{
+					SYNC();
+					runtimeError(format("Undefined variable %s", name.c_str()));
+				}
+				value = peek(0);
+				break;
+			}
+
+			case OpCode::GET_PROPERTY:
+			{
+				Symbol name = READ_NAME();
+				Object &holder = peek(0);
+				if (holder.isList())
+				{
+					Object method = List::getMethod(holder, name);
+					holder = std::move(method);
+					break;
+				}
+
+				if (!holder.isInstance())
+				{
+					SYNC();
+					runtimeError(format("Cannot apply . to object type(%s)", ObjectTypeName(holder.type())));
+				}
+
+				// 目前的设计是，如果对象没有索取的属性，则返回Nil
+				Object value = holder.getInstance()->get(name);
+				holder = std::move(value);
+				break;
+			}
+
+			case OpCode::SET_PROPERTY:
+			{
+				Symbol name = READ_NAME();
+				Object &holder = peek(1);
+				if (!holder.isInstance())
+				{
+					SYNC();
+					runtimeError(format("Cannot apply . to object type(%s)", ObjectTypeName(holder.type())));
+				}
+
+				holder.getInstance()->set(name, peek(0));
+				Object value = pop();
+				peek(0) = std::move(value);
+				break;
+			}
+
+			case OpCode::GET_INDEX:
+			{
+				Object &holder = peek(1), &index = peek(0);
+				SYNC();
+
+				Object value;
+				if (MetaMap *map = asMap(holder))
+				{
+					// __hash__、__equal__可能执行用户代码，栈上的引用会失效
+					Object key = index;
+					Object *found = map->find(key);
+					value = found ? *found : Object();
+				}
+				else if (MetaFloat64Array *array = asFloat64Array(holder))
+				{
+					if (!index.isNumber())
+						runtimeError("Index should be a number");
+
+					value = Object(array->at((int)index.getNumber()));
+				}
+				else if (holder.isList())
+				{
+					if (!index.isNumber())
+						runtimeError("Index should be a number");
+
+					value = holder.getList()->at((int)index.getNumber());
+				}
+				else if (holder.isInstance())
+				{
+					if (!index.isString())
+						runtimeError("attribute should be a string");
+
+					value = holder.getInstance()->getAttr(index.getString());
+				}
+				else
+				{
+					runtimeError(format("Cannot apply [] to object type(%s)", ObjectTypeName(holder.type())));
+				}
+
+				pop();
+				peek(0) = std::move(value);
+				break;
+			}
+
+			case OpCode::SET_INDEX:
+			{
+				Object &holder = peek(2), &index = peek(1), &value = peek(0);
+				SYNC();
+
+				if (MetaMap *map = asMap(holder))
+				{
+					Object key = index, element = value;
+					map->set(key, element);
+				}
+				else if (MetaFloat64Array *array = asFloat64Array(holder))
+				{
+					if (!index.isNumber())
+						runtimeError("Index should be a number");
+					if (!value.isNumber())
+						runtimeError("Float64Array can only hold numbers");
+
+					array->at((int)index.getNumber()) = value.getNumber();
+				}
+				else if (holder.isList())
+				{
+					if (!index.isNumber())
+						runtimeError("Index should be a number");
+
+					holder.getList()->at((int)index.getNumber()) = value;
+				}
+				else if (holder.isInstance())
+				{
+					if (!index.isString())
+						runtimeError("Attribute should be a string");
+
+					holder.getInstance()->set(Symbol(index.getString()), value);
+				}
+				else
+				{
+					runtimeError(format("Cannot apply [] to object type(%s)", ObjectTypeName(holder.type())));
+				}
+
+				Object result = pop();
+				pop();
+				peek(0) = std::move(result);
+				break;
+			}
+
+			case OpCode::GET_SUPER:
+			{
+				Symbol name = READ_NAME();
+				SYNC();
+
+				// Resolver保证了super只出现在子类的成员函数中
+				Class *klass = frame->closure->belonging;
+				if (!klass || !klass->superClass)
+					runtimeError("Can't use 'super' outside of a subclass");
+
+				CallablePtr method = klass->superClass.value()->findMethods(name);
+				if (!method)
+					runtimeError(format("Undefined method %s", name.c_str()));
+
+				CallablePtr bound = method->bindThis(peek(0).getInstance());
+				peek(0) = Object(std::move(bound));
+				break;
+			}
+
+			case OpCode::EQUAL:
+			{
+				Object &a = peek(1), &b = peek(0);
+				SYNC();
+				bool result = a == b;
+				pop();
+				peek(0) = Object(result);
+				break;
+			}
+
+			case OpCode::NOT_EQUAL:
+			{
+				Object &a = peek(1), &b = peek(0);
+				SYNC();
+				bool result = a != b;
+				pop();
+				peek(0) = Object(result);
+				break;
+			}
+
+			case OpCode::GREATER:
+				NUMBER_OP(>, Object(a > b));
+				break;
+
+			case OpCode::GREATER_EQUAL:
+				NUMBER_OP(>=, Object(a >= b));
+				break;
+
+			case OpCode::LESS:
+				NUMBER_OP(<, Object(a < b));
+				break;
+
+			case OpCode::LESS_EQUAL:
+				NUMBER_OP(<=, Object(a <= b));
+				break;
+
+			case OpCode::ADD:
+				NUMBER_OP(+, a + b);
+				break;
+
+			case OpCode::SUBTRACT:
+				NUMBER_OP(-, a - b);
+				break;
+
+			case OpCode::MULTIPLY:
+				NUMBER_OP(*, a * b);
+				break;
+
+			case OpCode::DIVIDE:
+			{
+				// 除数为0时需要报错，走Object的实现
+				SYNC();
+				Object result = peek(1) / peek(0);
+				pop();
+				peek(0) = std::move(result);
+				break;
+			}
+
+			case OpCode::MODULO:
+			{
+				SYNC();
+				Object result = peek(1) % peek(0);
+				pop();
+				peek(0) = std::move(result);
+				break;
+			}
+
+			case OpCode::NEGATE:
+			{
+				Object &value = peek(0);
+				if (value.isNumber())
+				{
+					value = Object(-value.asNumber());
+					break;
+				}
+
+				SYNC();
+				value = -value;
+				break;
+			}
+
+			case OpCode::NOT:
+			{
+				SYNC();
+				Object &value = peek(0);
+				value = !value;
+				break;
+			}
+
+			case OpCode::TRUTHY:
+			{
+				Object &value = peek(0);
+				value = Object(value.is_true());
+				break;
+			}
+
+			case OpCode::INCREMENT:
+			{
+				uint8_t flags = READ_BYTE();
+				int holders = flags >> 2;
+				bool decrement = flags & 1, postfix = flags & 2;
+
+				Object &value = peek(0);
+				if (!value.isNumber())
+				{
+					SYNC();
+					runtimeError(format("Operator '%s' does not support type(%s)", decrement ? "--" : "++", ObjectTypeName(value.type())));
+				}
+
+				double prev = value.asNumber();
+				double result = decrement ? prev - 1 : prev + 1;
+				value = Object(result);
+
+				// holders... new -> ret holders... new
+				push(Object());
+				for (int i = 0; i <= holders; i++)
+				{
+					peek(i) = std::move(peek(i + 1));
+				}
+				peek(holders + 1) = Object(postfix ? prev : result);
+				break;
+			}
+
+			case OpCode::JUMP:
+			{
+				uint16_t offset = READ_SHORT();
+				ip += offset;
+				break;
+			}
+
+			case OpCode::JUMP_IF_FALSE:
+			{
+				uint16_t offset = READ_SHORT();
+				if (!pop().is_true())
+					ip += offset;
+				break;
+			}
+
+			case OpCode::JUMP_IF_TRUE:
+			{
+				uint16_t offset = READ_SHORT();
+				if (pop().is_true())
+					ip += offset;
+				break;
+			}
+
+			case OpCode::LOOP:
+			{
+				uint16_t offset = READ_SHORT();
+				ip -= offset;
+
+				// 循环与调用是仅有的两处可能无限分配的位置
+				GarbageCollector::maybeCollect();
+				break;
+			}
+
+			case OpCode::CALL:
+			{
+				int argc = READ_BYTE();
+				SYNC();
+				calleeSpan = { Runner::pos_start, Runner::pos_end };
+				culpritSpan = chunk->positions[ip - 1 - chunk->code.data()];
+				if (callValue(peek(argc), argc))
+					RELOAD();
+				break;
+			}
+
+			case OpCode::INVOKE:
+			{
+				Symbol name = READ_NAME();
+				int argc = READ_BYTE();
+				SYNC();
+				calleeSpan = { Runner::pos_start, Runner::pos_end };
+				culpritSpan = chunk->positions[ip - 1 - chunk->code.data()];
+				invoke(name, argc);
+				RELOAD();
+				break;
+			}
+
+			case OpCode::CLOSURE:
+			{
+				const PrototypePtr &proto = frame->closure->proto->protos[READ_SHORT()];
+				uint8_t count = READ_BYTE();
+
+				auto closure = std::make_shared<Closure>(proto, frame->closure->globals);
+				closure->belonging = frame->closure->belonging;
+				closure->upvalues.reserve(count);
+				for (uint8_t i = 0; i < count; i++)
+				{
+					bool isLocal = READ_BYTE();
+					uint8_t index = READ_BYTE();
+					if (isLocal)
+						closure->upvalues.push_back(captureUpvalue(frame->slots + index));
+					else
+						closure->upvalues.push_back(frame->closure->upvalues[index]);
+				}
+
+				// 默认值已在栈上按顺序求值
+				Object *defaults = stackTop - proto->defaults;
+				closure->default_values.assign(std::make_move_iterator(defaults), std::make_move_iterator(stackTop));
+				discard(defaults);
+
+				push(Object(CallablePtr(std::move(closure))));
+				break;
+			}
+
+			case OpCode::CLOSE_UPVALUE:
+				closeUpvalues(stackTop - 1);
+				pop();
+				break;
+
+			case OpCode::RETURN:
+			{
+				Object result = pop();
+				if (frame->constructing)
+					result = frame->slots[0];
+
+				closeUpvalues(frame->slots);
+				discard(frame->slots);
+				frameCount--;
+
+				if (frameCount == exitDepth)
+					return result;
+
+				push(std::move(result));
+				RELOAD();
+				break;
+			}
+
+			case OpCode::CLASS:
+			{
+				Symbol name = READ_NAME();
+				push(Object(CallablePtr(std::make_shared<Class>(name.str(), std::unordered_map<Symbol, CallablePtr>()))));
+				break;
+			}
+
+			case OpCode::INHERIT:
+			{
+				Object &superclass = peek(1);
+				if (!superclass.isCallable() || superclass.getCallable()->type != Callable::CallableType::CLASS)
+				{
+					SYNC();
+					runtimeError("SuperClass must be a Class");
+				}
+
+				auto klass = std::static_pointer_cast<Class>(peek(0).getCallable());
+				klass->superClass = std::static_pointer_cast<Class>(superclass.getCallable());
+				pop();
+				pop();
+				break;
+			}
+
+			case OpCode::METHOD:
+			{
+				Symbol name = READ_NAME();
+				Class *klass = static_cast<Class *>(peek(1).getCallable().get());
+				static_cast<Closure *>(peek(0).getCallable().get())->belonging = klass;
+				klass->methods[name] = peek(0).getCallable();
+				pop();
+				break;
+			}
+
+			case OpCode::LIST:
+			{
+				uint16_t count = READ_SHORT();
+				Object *first = stackTop - count;
+				std::vector<Object> items(std::make_move_iterator(first), std::make_move_iterator(stackTop));
+				discard(first);
+				push(List::instantiate(std::move(items)));
+				break;
+			}
+
+			case OpCode::IMPORT:
+			{
+				const ImportStmt *importStmt = frame->closure->proto->imports[READ_SHORT()];
+				SYNC();
+
+				std::shared_ptr<Module> module = importModule(importStmt);
+
+				// import { * } from "module"
+				if (importStmt->symbols.begin()->first.type == TokenType::MUL)
+				{
+					for (auto &[name, obj] : module->m_values)
+					{
+						frame->closure->globals->set(name, obj);
+					}
+				}
+				break;
+			}
+
+			case OpCode::IMPORT_SYMBOL:
+			{
+				const ImportStmt *importStmt = frame->closure->proto->imports[READ_SHORT()];
+				Symbol name = READ_NAME();
+
+				Object &obj = m_modules[importStmt->filepath.symbol.str()]->get(name);
+				if (&obj == &Object::Nil())
+				{
+					SYNC();
+					runtimeError(format("Can't find `%s` from module \"%s\".", name.c_str(), importStmt->filepath.symbol.c_str()));
+				}
+				push(obj);
+				break;
+			}
+
+			case OpCode::ECHO:
+			{
+				Object value = pop();
+				if (!value.isNil())
+				{
+					SYNC();
+					std::cout << value.to_string() << "\n";
+				}
+				break;
+			}
+
+			default:
+				SYNC();
+				runtimeError("Unknown opcode");
+			}
+		}
+
+#undef READ_BYTE
+#undef READ_SHORT
+#undef READ_NAME
+#undef SYNC
+#undef RELOAD
+#undef NUMBER_OP
+	}
+
+	bool VM::callValue(const Object &callee, int argc)
+	{
+		if (!callee.isCallable())
+			runtimeError("Expression is not callable");
+
+		Callable *callable = callee.getCallable().get();
+		switch (callable->vmKind)
+		{
+		case Callable::VMKind::CLOSURE:
+			return callClosure(static_cast<Closure *>(callable), argc);
+
+		case Callable::VMKind::BOUND_METHOD:
+		{
+			// 用this替换栈上的callee，类持有成员函数，这里不必担心其被释放
+			auto bound = static_cast<BoundMethod *>(callable);
+			Closure *method = bound->method.get();
+			Object receiver(bound->receiver);
+			peek(argc) = std::move(receiver);
+			return callClosure(method, argc);
+		}
+
+		default:
+			break;
+		}
+
+		if (callable->type == Callable::CallableType::CLASS)
+		{
+			auto klass = static_cast<Class *>(callable);
+			CallablePtr initializer = klass->findMethods("init");
+			if (!initializer || initializer->vmKind != Callable::VMKind::CLOSURE)
+			{
+				// 没有init或为内置类，走通用的call
+				callNative(callable, argc);
+				return false;
+			}
+
+			checkArity(klass, argc);
+			Object instance(std::make_shared<Instance>(klass->shared_from_this()));
+			peek(argc) = std::move(instance);
+			return callClosure(static_cast<Closure *>(initializer.get()), argc, true);
+		}
+
+		callNative(callable, argc);
+		return false;
+	}
+
+	bool VM::callClosure(Closure *closure, int argc, bool constructing)
+	{
+		GarbageCollector::maybeCollect();
+
+		int arity = closure->proto->arity;
+		if (argc != arity)
+		{
+			checkArity(closure, argc);
+
+			// 补全默认参数
+			auto &default_values = closure->default_values;
+			for (int count = arity - argc; count > 0; count--)
+			{
+				push(*(default_values.end() - count));
+			}
+		}
+
+		if (frameCount == FRAMES_MAX)
+			stackOverflow();
+
+		CallFrame &frame = frames[frameCount++];
+		frame.closure = closure;
+		frame.ip = closure->proto->chunk.code.data();
+		frame.slots = stackTop - arity - 1;
+		frame.constructing = constructing;
+		return true;
+	}
+
+	void VM::callNative(Callable *callable, int argc)
+	{
+		checkArity(callable, argc);
+		locate(culpritSpan);
+
+		std::vector<Object> arguments(stackTop - argc, stackTop);
+		Object result = callable->call(Runner::interpreter, arguments);
+
+		discard(stackTop - argc - 1);
+		push(std::move(result));
+	}
+
+	void VM::invoke(Symbol name, int argc)
+	{
+		Object &receiver = peek(argc);
+		if (receiver.isList())
+		{
+			invokeList(name, argc);
+			return;
+		}
+
+		if (!receiver.isInstance())
+			runtimeError(format("Cannot apply . to object type(%s)", ObjectTypeName(receiver.type())));
+
+		Instance *instance = receiver.getInstance().get();
+
+		// 字段优先于成员函数
+		if (Object *value = instance->field(name))
+		{
+			Object field = *value;
+			receiver = std::move(field);
+			callValue(receiver, argc);
+			return;
+		}
+
+		CallablePtr method = instance->belonging->findMethods(name);
+		if (!method)
+			runtimeError("Expression is not callable");
+
+		// this已位于0号槽位，直接调用，无需创建绑定函数
+		if (method->vmKind == Callable::VMKind::CLOSURE)
+		{
+			callClosure(static_cast<Closure *>(method.get()), argc);
+			return;
+		}
+
+		Object bound(method->bindThis(receiver.getInstance()));
+		receiver = std::move(bound);
+		callValue(receiver, argc);
+	}
+
+	void VM::invokeList(Symbol name, int argc)
+	{
+		CallablePtr method = List::getSingleton()->findMethods(name);
+		if (!method)
+			runtimeError("Expression is not callable");
+
+		checkArity(method.get(), argc);
+		locate(culpritSpan);
+
+		// 列表的成员函数均为NativeMethod，以栈上的列表为this直接调用
+		std::vector<Object> arguments(stackTop - argc, stackTop);
+		Object receiver = peek(argc);
+		Object result = static_cast<NativeMethod *>(method.get())->invoke(Runner::interpreter, receiver, arguments);
+
+		discard(stackTop - argc - 1);
+		push(std::move(result));
+	}
+
+	UpvaluePtr VM::captureUpvalue(Object *local)
+	{
+		UpvaluePtr *link = &openUpvalues;
+		while (*link && (*link)->location > local)
+		{
+			link = &(*link)->next;
+		}
+
+		if (*link && (*link)->location == local)
+			return *link;
+
+		auto created = std::make_shared<Upvalue>(local);
+		created->next = std::move(*link);
+		*link = created;
+		return created;
+	}
+
+	void VM::closeUpvalues(Object *last)
+	{
+		while (openUpvalues && openUpvalues->location >= last)
+		{
+			Upvalue *upvalue = openUpvalues.get();
+			upvalue->closed = *upvalue->location;
+			upvalue->location = &upvalue->closed;
+
+			UpvaluePtr next = std::move(upvalue->next);
+			openUpvalues = std::move(next);
+		}
+	}
+
+	void VM::discard(Object *newTop)
+	{
+		// 释放实例可能触发__del__并重新进入虚拟机
+		// 因此先保持stackTop不变，使重入的调用压栈在更高处
+		for (Object *top = stackTop; top > newTop;)
+		{
+			Object dead = std::move(*--top);
+		}
+		stackTop = newTop;
+	}
+
+	void VM::checkArity(Callable *callable, int argc)
+	{
+		// 当函数参数元数为-1时，表示接收不限量参数，仅内置函数支持
+		// 否则实参个数应在范围：必须参数 <= 实参个数 <= 形参个数
+		int arity = callable->arity();
+		if (arity != -1 && (argc < (int)callable->required_params() || argc > arity))
+		{
+			// 指向整个调用表达式：从被调用的表达式到最后一个实参
+			locate({ calleeSpan.first, argc > 0 ? culpritSpan.second : calleeSpan.second });
+			runtimeError(format("Function expected %d argument(s), %d is required, only got %d",
+								arity, (int)callable->required_params(), argc));
+		}
+	}
+
+	std::shared_ptr<Module> VM::importModule(const ImportStmt *importStmt)
+	{
+		const Token &filepath = importStmt->filepath;
+		if (auto it = m_modules.find(filepath.symbol.str()); it != m_modules.end())
+			return it->second;
+
+		AstArenaPtr arena;
+		BlockStmt *block = Interpreter::parseModule(filepath, arena);
+		if (!block || ErrorReporter::count())
+		{
+			throw RuntimeError(importStmt->pos_start, importStmt->pos_end, "Failed to import Module, error occured");
+		}
+
+		// 模块拥有独立的全局变量环境
+		ContextPtr moduleEnv = std::make_shared<Context>(Runner::interpreter.presetContext);
+		moduleEnv->set("__name__", Object(filepath.symbol));
+
+		Compiler compiler;
+		PrototypePtr proto = compiler.compile(block->statements, arena);
+		if (Runner::DEBUG)
+		{
+			disassemble(*proto);
+		}
+
+		auto script = std::make_shared<Closure>(std::move(proto), moduleEnv);
+		call(script.get(), nullptr, {});
+
+		// 模块中的函数仍引用moduleEnv，这里拷贝一份导出
+		auto values = moduleEnv->variables;
+		values.erase("__name__");
+
+		auto module = std::make_shared<Module>(std::move(values));
+		m_modules.emplace(filepath.lexeme, module);
+		return module;
+	}
+
+	void VM::reset()
+	{
+		closeUpvalues(stack.data());
+		frameCount = 0;
+		discard(stack.data());
+	}
+
+	void VM::stackOverflow()
+	{
+		runtimeError("Stack overflow");
+	}
+
+	void VM::locate(const std::pair<Position *, Position *> &span)
+	{
+		if (!span.first)
+			return;
+
+		Runner::pos_start = span.first;
+		Runner::pos_end = span.second;
+	}
+
+	void VM::runtimeError(const std::string &message)
+	{
+		if (!Runner::pos_start)
+			throw RuntimeError(Position::preset, Position::preset, message);
+
+		throw RuntimeError(Runner::pos_start, Runner::pos_end, message);
+	}
+
+}
@@ -1,5 +1,7 @@
 #include "ThirdParty/argparse.h"
 #include "Runner.h"
+#include "Parser/AstCache.h"
+#include "Optimizer/TypeInferencer.h"
 #include <string>
 
 using namespace std;
@@ -10,6 +12,12 @@ struct MyArgs : public argparse::Args
 	bool &interactive = flag("i", "A flag to toggle interactive mode");
 	bool &verbose = flag("v,verbose", "A flag to toggle verbose");
 	bool &debug = flag("D,Debug", "A flag to toggle debug mode");
+	bool &vm = flag("vm", "Execute with the bytecode virtual machine");
+	bool &closure = flag("closure", "Execute with the closure-compiled tree-walker");
+	bool &lazy = flag("lazy", "Pre-parse top-level functions, parse their bodies on first call");
+	bool &types = flag("types", "Print the statically inferred type of each expression");
+	optional<string> &cache = kwarg("cache", "Cache resolved ASTs of scripts and modules in given directory");
+	optional<string> &bench_lexer = kwarg("bench-lexer", "Measure lexing throughput (tokens/sec) of given file_path");
 
 	void welcome() override
 	{
@@ -27,6 +35,27 @@ void ParseArgs(int argc, char *argv[])
 	if (args.debug)
 		CXX::Runner::DEBUG = true;
 
+	if (args.vm)
+		CXX::Runner::USE_VM = true;
+
+	if (args.closure)
+		CXX::Runner::USE_CLOSURE = true;
+
+	if (args.lazy)
+		CXX::Runner::LAZY = true;
+
+	if (args.types)
+		CXX::TypeInferencer::print = true;
+
+	if (args.cache)
+		CXX::AstCache::directory = args.cache.value();
+
+	if (args.bench_lexer)
+	{
+		CXX::Runner::benchLexer(args.bench_lexer.value());
+		return;
+	}
+
 	if (args.src_path)
 	{
 		CXX::Runner::runScript(args.src_path.value());
@@ -34,7 +34,7 @@ namespace CXX
 
 	void Transpiler::visit(const ExpressionStmt *expressionStmt)
 	{
-		translate(expressionStmt->expr.get());
+		translate(expressionStmt->expr);
 	}
 
 	void Transpiler::visit(const VarDeclarationStmt *varStmt)
@@ -46,15 +46,15 @@ namespace CXX
 		if (varStmt->expr)
 		{
 			xmlCode += "<block type=\"variables_set\" id=\"" + sole::uuid4().base62() + "\">";
-			xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + varStmt->identifier.lexeme + "</field>";
+			xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + varStmt->identifier.symbol.str() + "</field>";
 			xmlCode += "<value name=\"VALUE\">";
-			translate(varStmt->expr.value().get());
+			translate(varStmt->expr.value());
 			xmlCode += "</value>";
 			xmlCode += "</block>";
 		}
 	}
 
-	void Transpiler::visit(std::shared_ptr<FuncDeclarationStmt> funcDeclStmt)
+	void Transpiler::visit(FuncDeclarationStmt *funcDeclStmt)
 	{
 		std::string blockType = "procedures_defnoreturn";
 		const ReturnStmt *retPtr{nullptr};
@@ -63,7 +63,7 @@ namespace CXX
 		{
 			if ((*it)->stmtType == StmtType::Return)
 			{
-				auto rs = static_cast<ReturnStmt *>(it->get());
+				auto rs = static_cast<ReturnStmt *>(*it);
 				if (!rs->expr)
 					continue;
 				else
@@ -76,7 +76,7 @@ namespace CXX
 		}
 
 		Function func{
-			funcDeclStmt->name.lexeme, // name
+			funcDeclStmt->name.symbol.str(), // name
 			{},						   // arg_names
 			retPtr ? true : false	   // has return
 		};
@@ -88,7 +88,7 @@ namespace CXX
 		if (!funcDeclStmt->params.empty())
 		{
 			std::transform(funcDeclStmt->params.begin(), funcDeclStmt->params.end(), std::back_inserter(func.arg_names), [](const Token &tok)
-						   { return tok.lexeme; });
+						   { return tok.symbol.str(); });
 
 			xmlCode += "<mutation>";
 			for (auto const &arg : func.arg_names)
@@ -136,9 +136,9 @@ namespace CXX
 			xmlCode += "<block type=\"procedures_ifreturn\" id=\"" + sole::uuid4().base62() + "\">";
 			xmlCode += "<mutation value=\"1\"></mutation>";
 			xmlCode += "<value name=\"CONDITION\">";
-			translate(ifStmt->condition.get());
+			translate(ifStmt->condition);
 			xmlCode += "</value>";
-			visitRet(static_cast<ReturnStmt *>(ifStmt->thenBranch.get()), "VALUE");
+			visitRet(static_cast<ReturnStmt *>(ifStmt->thenBranch), "VALUE");
 			xmlCode += "</block>";
 		}
 		else
@@ -149,19 +149,19 @@ namespace CXX
 
 			// if-condition
 			xmlCode += "<value name=\"IF0\">";
-			translate(ifStmt->condition.get());
+			translate(ifStmt->condition);
 			xmlCode += "</value>";
 
 			// then
 			xmlCode += "<statement name=\"DO0\">";
-			translate(ifStmt->thenBranch.get());
+			translate(ifStmt->thenBranch);
 			xmlCode += "</statement>";
 
 			// else
 			if (ifStmt->elseBranch)
 			{
 				xmlCode += "<statement name=\"ELSE\">";
-				translate(ifStmt->elseBranch.value().get());
+				translate(ifStmt->elseBranch.value());
 				xmlCode += "</statement>";
 			}
 
@@ -175,11 +175,11 @@ namespace CXX
 		xmlCode += "<field name=\"MODE\">WHILE</field>";
 		// condition
 		xmlCode += "<value name=\"BOOL\">";
-		translate(whileStmt->condition.get());
+		translate(whileStmt->condition);
 		xmlCode += "</value>";
 		// then
 		xmlCode += "<statement name=\"DO\">";
-		translate(whileStmt->body.get());
+		translate(whileStmt->body);
 		xmlCode += "</statement>";
 		xmlCode += "</block>";
 	}
@@ -191,19 +191,19 @@ namespace CXX
 		std::string from;
 		if (forStmt->initializer)
 		{
-			Stmt *init = forStmt->initializer->get();
+			Stmt *init = *forStmt->initializer;
 			if (init->stmtType == StmtType::VarDecl)
 			{
 				VarDeclarationStmt *varStmt = static_cast<VarDeclarationStmt *>(init);
 
-				std::string &var_id = variableDB[varStmt->identifier.lexeme];
+				std::string &var_id = variableDB[varStmt->identifier.symbol.str()];
 				if (var_id.empty())
 					var_id = sole::uuid4().base62();
 
-				xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + varStmt->identifier.lexeme + "</field>";
+				xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + varStmt->identifier.symbol.str() + "</field>";
 				if (varStmt->expr && varStmt->expr.value()->exprType == ExprType::Literal)
 				{
-					LiteralExpr *fromExpr = static_cast<LiteralExpr *>(varStmt->expr->get());
+					LiteralExpr *fromExpr = static_cast<LiteralExpr *>(*varStmt->expr);
 					from = "<block type=\"math_number\" id=\"" + sole::uuid4().base62() + "\">"
 																						  "<field name=\"NUM\">" +
 						   fromExpr->value.to_string() + "</field></block>";
@@ -211,15 +211,15 @@ namespace CXX
 			}
 			else if (init->stmtType == StmtType::Expression && static_cast<ExpressionStmt *>(init)->expr->exprType == ExprType::Variable)
 			{
-				VariableExpr *varExpr = static_cast<VariableExpr *>(static_cast<ExpressionStmt *>(init)->expr.get());
-				std::string &var_id = variableDB[varExpr->identifier.lexeme];
+				VariableExpr *varExpr = static_cast<VariableExpr *>(static_cast<ExpressionStmt *>(init)->expr);
+				std::string &var_id = variableDB[varExpr->identifier.symbol.str()];
 				if (var_id.empty())
 					var_id = sole::uuid4().base62();
 
-				xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + varExpr->identifier.lexeme + "</field>";
+				xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + varExpr->identifier.symbol.str() + "</field>";
 				from = "<block type=\"variables_get\" id=\"" + sole::uuid4().base62() + "\">"
 																						"<field name=\"VAR\"> id=\"" +
-					   var_id + "\">" + varExpr->identifier.lexeme + "</field></block>";
+					   var_id + "\">" + varExpr->identifier.symbol.str() + "</field></block>";
 			}
 		}
 		else
@@ -246,10 +246,10 @@ namespace CXX
 
 		if (forStmt->condition && forStmt->condition.value()->exprType == ExprType::Binary)
 		{
-			BinaryExpr *binExpr = static_cast<BinaryExpr *>(forStmt->condition->get());
+			BinaryExpr *binExpr = static_cast<BinaryExpr *>(*forStmt->condition);
 			if (binExpr->right->exprType == ExprType::Literal)
 			{
-				translate(binExpr->right.get());
+				translate(binExpr->right);
 			}
 		}
 		xmlCode += "</value>";
@@ -263,13 +263,13 @@ namespace CXX
 		if (forStmt->increment && forStmt->increment.value()->exprType == ExprType::Assignment)
 		{
 			// +=
-			AssignmentExpr *assignExpr = static_cast<AssignmentExpr *>(forStmt->increment->get());
-			translate(assignExpr->value.get());
+			AssignmentExpr *assignExpr = static_cast<AssignmentExpr *>(*forStmt->increment);
+			translate(assignExpr->value);
 		}
 		xmlCode += "</value>";
 
 		xmlCode += "<statement name=\"DO\">";
-		translate(forStmt->body.get());
+		translate(forStmt->body);
 		xmlCode += "</statement>";
 
 		xmlCode += "</block>";
@@ -303,7 +303,7 @@ namespace CXX
 	void Transpiler::visit(const PackStmt *packStmt)
 	{
 		for (auto &stmt : packStmt->statements)
-			translate(stmt.get());
+			translate(stmt);
 	}
 
 	Object Transpiler::visit(const BinaryExpr *binaryExpr)
@@ -370,7 +370,7 @@ namespace CXX
 		xmlCode += "<field name=\"NUM\">1</field>";
 		xmlCode += "</shadow>";
 		// transpile left operand
-		translate(binaryExpr->left.get());
+		translate(binaryExpr->left);
 		xmlCode += "</value>";
 
 		// Right operand
@@ -380,7 +380,7 @@ namespace CXX
 		xmlCode += "<field name=\"NUM\">1</field>";
 		xmlCode += "</shadow>";
 		// transpile right operand
-		translate(binaryExpr->right.get());
+		translate(binaryExpr->right);
 		xmlCode += "</value>";
 
 		// End of block
@@ -395,7 +395,7 @@ namespace CXX
 		{
 			xmlCode += "<block type=\"logic_negate\" id=\"" + sole::uuid4().base62() + "\">";
 			xmlCode += "<value name=\"BOOL\">";
-			translate(unaryExpr->expr.get());
+			translate(unaryExpr->expr);
 			xmlCode += "</value>";
 			xmlCode += "</block>";
 		}
@@ -411,7 +411,7 @@ namespace CXX
 		std::string value = literalExpr->value.to_string();
 		std::string field_name;
 
-		switch (literalExpr->value.type)
+		switch (literalExpr->value.type())
 		{
 		case ObjectType::NUMBER:
 			blockType = "math_number";
@@ -449,7 +449,7 @@ namespace CXX
 		std::string var_id = varID(variableExpr);
 
 		xmlCode += "<block type=\"variables_get\" id=\"" + sole::uuid4().base62() + "\">";
-		xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + variableExpr->identifier.lexeme + "</field>";
+		xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + variableExpr->identifier.symbol.str() + "</field>";
 		xmlCode += "</block>";
 
 		return {};
@@ -457,14 +457,14 @@ namespace CXX
 
 	Object Transpiler::visit(const AssignmentExpr *assignmentExpr)
 	{
-		std::string var_id = varID(assignmentExpr->identifier.lexeme);
+		std::string var_id = varID(assignmentExpr->identifier.symbol.str());
 
 		xmlCode += "<block type=\"variables_set\" id=\"" + sole::uuid4().base62() + "\">";
-		xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + assignmentExpr->identifier.lexeme + "</field>";
+		xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + assignmentExpr->identifier.symbol.str() + "</field>";
 		xmlCode += "<value name=\"VALUE\">";
 		if (assignmentExpr->operation.type == TokenType::EQ)
 		{
-			translate(assignmentExpr->value.get());
+			translate(assignmentExpr->value);
 		}
 		else
 		{
@@ -494,13 +494,13 @@ namespace CXX
 			// origin
 			xmlCode += "<value name=\"A\">";
 			xmlCode += "<block type=\"variables_get\" id=\"" + sole::uuid4().base62() + "\">";
-			xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + assignmentExpr->identifier.lexeme + "</field>";
+			xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + assignmentExpr->identifier.symbol.str() + "</field>";
 			xmlCode += "</block>";
 			xmlCode += "</value>";
 
 			// delta value
 			xmlCode += "<value name=\"B\">";
-			translate(assignmentExpr->value.get());
+			translate(assignmentExpr->value);
 			xmlCode += "</value>";
 
 			xmlCode += "</block>";
@@ -515,22 +515,22 @@ namespace CXX
 		xmlCode += "<block type=\"logic_ternary\" id=\"" + sole::uuid4().base62() + "\">";
 		// if
 		xmlCode += "<value name=\"IF\">";
-		translate(ternaryExpr->expr.get());
+		translate(ternaryExpr->expr);
 		xmlCode += "</value>";
 		// then
 		xmlCode += "<value name=\"THEN\">";
-		translate(ternaryExpr->thenBranch.get());
+		translate(ternaryExpr->thenBranch);
 		xmlCode += "</value>";
 		// else
 		xmlCode += "<value name=\"ELSE\">";
-		translate(ternaryExpr->elseBranch.get());
+		translate(ternaryExpr->elseBranch);
 		xmlCode += "</value>";
 
 		xmlCode += "</block>";
 		return {};
 	}
 
-	Object Transpiler::visit(std::shared_ptr<LambdaExpr> lambdaExpr)
+	Object Transpiler::visit(LambdaExpr *lambdaExpr)
 	{
 		xmlCode += "<comment pinned=\"true\">TODO:LambdaExpr</comment>";
 		return {};
@@ -548,7 +548,7 @@ namespace CXX
 		xmlCode += "<field name=\"BOOL\">FALSE</field>";
 		xmlCode += "</shadow>";
 		// TODO: if left or right are not boolean, blockly doesn't accept it.
-		translate(orExpr->left.get());
+		translate(orExpr->left);
 		xmlCode += "</value>";
 		// Right Operand;
 		xmlCode += "<value name=\"B\">";
@@ -556,7 +556,7 @@ namespace CXX
 		xmlCode += "<shadow type=\"logic_boolean\" id=\"" + sole::uuid4().base62() + "\">";
 		xmlCode += "<field name=\"BOOL\">FALSE</field>";
 		xmlCode += "</shadow>";
-		translate(orExpr->right.get());
+		translate(orExpr->right);
 		xmlCode += "</value>";
 
 		xmlCode += "</block>";
@@ -575,7 +575,7 @@ namespace CXX
 		xmlCode += "<field name=\"BOOL\">FALSE</field>";
 		xmlCode += "</shadow>";
 		// TODO: if left or right are not boolean, blockly doesn't accept it.
-		translate(andExpr->left.get());
+		translate(andExpr->left);
 		xmlCode += "</value>";
 		// Right Operand;
 		xmlCode += "<value name=\"B\">";
@@ -583,7 +583,7 @@ namespace CXX
 		xmlCode += "<shadow type=\"logic_boolean\" id=\"" + sole::uuid4().base62() + "\">";
 		xmlCode += "<field name=\"BOOL\">FALSE</field>";
 		xmlCode += "</shadow>";
-		translate(andExpr->right.get());
+		translate(andExpr->right);
 		xmlCode += "</value>";
 
 		xmlCode += "</block>";
@@ -594,11 +594,11 @@ namespace CXX
 	{
 		if (incrementExpr->holder->exprType == ExprType::Variable)
 		{
-			auto pvar = static_cast<VariableExpr *>(incrementExpr->holder.get());
+			auto pvar = static_cast<VariableExpr *>(incrementExpr->holder);
 			std::string var_id = varID(pvar);
 
 			xmlCode += "<block type=\"math_change\" id=\"" + sole::uuid4().base62() + "\">";
-			xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + pvar->identifier.lexeme + "</field>";
+			xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + pvar->identifier.symbol.str() + "</field>";
 			xmlCode += "<value name=\"DELTA\">";
 			xmlCode += "<shadow type=\"math_number\" id=\"" + sole::uuid4().base62() + "\">";
 			xmlCode += "<field name=\"NUM\">1</field>";
@@ -616,11 +616,11 @@ namespace CXX
 	{
 		if (decrementExpr->holder->exprType == ExprType::Variable)
 		{
-			auto pvar = static_cast<VariableExpr *>(decrementExpr->holder.get());
+			auto pvar = static_cast<VariableExpr *>(decrementExpr->holder);
 			std::string var_id = varID(pvar);
 
 			xmlCode += "<block type=\"math_change\" id=\"" + sole::uuid4().base62() + "\">";
-			xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + pvar->identifier.lexeme + "</field>";
+			xmlCode += "<field name=\"VAR\" id=\"" + var_id + "\">" + pvar->identifier.symbol.str() + "</field>";
 			xmlCode += "<value name=\"DELTA\">";
 			xmlCode += "<shadow type=\"math_number\" id=\"" + sole::uuid4().base62() + "\">";
 			xmlCode += "<field name=\"NUM\">-1</field>";
@@ -639,11 +639,11 @@ namespace CXX
 		// func fib(n){if(n<2)return n;return fib(n-1)+fib(n-2);}
 		if (callExpr->callee->exprType == ExprType::Variable)
 		{
-			auto varExpr = static_cast<VariableExpr *>(callExpr->callee.get());
-			auto it = functionDB.find(varExpr->identifier.lexeme);
+			auto varExpr = static_cast<VariableExpr *>(callExpr->callee);
+			auto it = functionDB.find(varExpr->identifier.symbol.str());
 			if (it == functionDB.end())
 			{
-				std::string msg = "Calling undefined function \"" + varExpr->identifier.lexeme + "\"in CallExpr";
+				std::string msg = "Calling undefined function \"" + varExpr->identifier.symbol.str() + "\"in CallExpr";
 				ErrorReporter::report(std::runtime_error(msg));
 				xmlCode += "<comment pinned=\"true\">Error:" + msg + "</comment>";
 				return {};
@@ -664,7 +664,7 @@ namespace CXX
 			for (size_t i = 0; i < callExpr->arguments.size(); i++)
 			{
 				xmlCode += "<value name=\"ARG" + std::to_string(i) + "\">";
-				translate(callExpr->arguments[i].get());
+				translate(callExpr->arguments[i]);
 				xmlCode += "</value>";
 			}
 
@@ -714,7 +714,7 @@ namespace CXX
 			for (size_t i = 0; i < listExpr->items.size(); i++)
 			{
 				xmlCode += "<value name=\"ADD" + std::to_string(i) + "\">";
-				translate(listExpr->items[i].get());
+				translate(listExpr->items[i]);
 				xmlCode += "</value>";
 			}
 		}
@@ -727,7 +727,7 @@ namespace CXX
 	Object Transpiler::visit(const PackExpr *packExpr)
 	{
 		for (auto &expr : packExpr->expressions)
-			translate(expr.get());
+			translate(expr);
 
 		return {};
 	}
@@ -747,7 +747,7 @@ namespace CXX
 		if (returnStmt->expr)
 		{
 			xmlCode += "<value name=\"" + value_name + "\">";
-			translate(returnStmt->expr.value().get());
+			translate(returnStmt->expr.value());
 			xmlCode += "</value>";
 		}
 	}
@@ -759,12 +759,12 @@ namespace CXX
 
 			for (size_t i = 0; i < size - 1; i++)
 			{
-				translate(statements[i].get());
+				translate(statements[i]);
 				// replace </block> with <next>
 				xmlCode.replace(xmlCode.length() - 8, xmlCode.length(), "<next>");
 			}
 
-			translate(statements.back().get());
+			translate(statements.back());
 
 			for (size_t i = 0; i < size - 1; i++)
 			{
@@ -776,7 +776,7 @@ namespace CXX
 
 	std::string Transpiler::varID(const VariableExpr *variableExpr)
 	{
-		auto it = variableDB.find(variableExpr->identifier.lexeme);
+		auto it = variableDB.find(variableExpr->identifier.symbol.str());
 		if (it == variableDB.end())
 		{
 			ErrorReporter::report(std::runtime_error("Using undefined variable in VariableExpr"));